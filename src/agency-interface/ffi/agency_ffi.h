@@ -18,6 +18,328 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Kinds of file-backed resources an agency can provide.
+ */
+typedef enum {
+    AGENCY_RESOURCE_ISSUE_FINDER = 0,
+    AGENCY_RESOURCE_RESEARCH_CONNECTOR = 1,
+    AGENCY_RESOURCE_ASCII_ART = 2,
+    AGENCY_RESOURCE_COUNT
+} agency_resource_kind;
+
+/**
+ * @brief Status codes reported by the non-string agency functions.
+ */
+typedef enum {
+    AGENCY_STATUS_OK = 0,
+    AGENCY_STATUS_NOT_FOUND = 1,
+    AGENCY_STATUS_NOT_MODIFIED = 2,
+    AGENCY_STATUS_ERROR = -1
+} agency_status;
+
+/**
+ * @brief Identifies an asynchronous request. Zero is never a valid ticket.
+ */
+typedef uint64_t agency_ticket;
+
+/**
+ * @brief Result of an asynchronous request.
+ *
+ * On AGENCY_STATUS_OK, @c data holds a null-terminated copy of the resource
+ * that the receiver must release with agency_free_context(). It is NULL for
+ * every other status.
+ */
+typedef struct {
+    agency_ticket ticket;
+    int status;
+    char* data;
+    size_t length;
+    void* user_data;
+} agency_completion;
+
+/**
+ * @brief Callback invoked on an I/O thread when an asynchronous request completes.
+ *
+ * The callback takes ownership of @c completion->data. It must not block for
+ * long, since it runs on one of the library's I/O threads.
+ */
+typedef void (*agency_completion_fn)(const agency_completion* completion);
+
+/**
+ * @brief Default chunk size used by the streaming functions.
+ */
+#define AGENCY_STREAM_CHUNK_SIZE 16384
+
+/**
+ * @brief Largest chunk size the streaming functions use; larger requests are capped.
+ */
+#define AGENCY_STREAM_MAX_CHUNK_SIZE (4u * 1024 * 1024)
+
+/**
+ * @brief An open chunked stream over an agency resource.
+ */
+typedef struct agency_stream agency_stream;
+
+/**
+ * @brief Receives successive chunks from agency_stream_resource().
+ *
+ * @return 0 to continue, any other value to stop the stream.
+ */
+typedef int (*agency_chunk_writer)(const char* chunk, size_t length, void* user_data);
+
+/**
+ * @brief Size and effectiveness of the compressed resource store.
+ */
+typedef struct {
+    size_t resources;         /**< Resources held in the store. */
+    size_t raw_bytes;         /**< Total uncompressed size of those resources. */
+    size_t compressed_bytes;  /**< Total compressed size. */
+    size_t arena_bytes;       /**< Memory reserved by the store arena. */
+    uint64_t hot_hits;        /**< agency_store_get() calls served from a thread's cache. */
+    uint64_t hot_misses;      /**< agency_store_get() calls that had to decompress. */
+    uint64_t decompress_ns;   /**< Total time spent decompressing, in nanoseconds. */
+} agency_store_stats;
+
+/**
+ * @brief Effectiveness of the verdict cache.
+ *
+ * The hit rate is hits / (hits + misses).
+ */
+typedef struct {
+    size_t capacity;         /**< Verdicts the cache can hold. */
+    uint64_t hits;           /**< Verifications answered from the cache. */
+    uint64_t misses;         /**< Verifications that had to run. */
+    uint64_t evictions;      /**< Cached verdicts replaced by newer ones. */
+    uint64_t invalidations;  /**< Times a configuration reload emptied the cache. */
+} agency_verdict_cache_stats;
+
+/**
+ * @brief Verdict counts for a batch verification.
+ */
+typedef struct {
+    size_t issues;   /**< Issues read (non-blank lines). */
+    size_t valid;    /**< Issues with verdict 1. */
+    size_t invalid;  /**< Issues with verdict 0. */
+    size_t errors;   /**< Issues with verdict -1, e.g. malformed JSON. */
+} agency_batch_summary;
+
+/**
+ * @brief Encodings of a verification report.
+ */
+typedef enum {
+    AGENCY_REPORT_BINARY = 0,  /**< An agency_report_header followed by its rules. */
+    AGENCY_REPORT_JSON = 1     /**< A null-terminated JSON object. */
+} agency_report_format;
+
+/**
+ * @brief What a reported rule checked.
+ */
+typedef enum {
+    AGENCY_RULE_FIELD = 0,   /**< A schema check on one top-level field. */
+    AGENCY_RULE_THEOREM = 1  /**< A domain theorem applied to the description. */
+} agency_rule_kind;
+
+/**
+ * @brief Outcome of a reported rule.
+ */
+typedef enum {
+    AGENCY_RULE_PASSED = 0,
+    AGENCY_RULE_MISSING = 1,          /**< A required field is absent. */
+    AGENCY_RULE_WRONG_TYPE = 2,       /**< The field's value has a type the schema excludes. */
+    AGENCY_RULE_BAD_LENGTH = 3,       /**< The string is shorter or longer than allowed. */
+    AGENCY_RULE_NOT_IN_ENUM = 4,      /**< The string is not one of the allowed values. */
+    AGENCY_RULE_BAD_ITEMS = 5,        /**< The array has too few or too many elements. */
+    AGENCY_RULE_KEYWORD_MISSING = 6   /**< A theorem keyword is not in the description. */
+} agency_rule_outcome;
+
+/**
+ * @brief Start of a binary verification report.
+ *
+ * @c num_rules agency_report_rule entries follow the header, then the
+ * strings they refer to. String offsets count from the start of the report;
+ * each string is also null-terminated.
+ */
+typedef struct {
+    int32_t verdict;        /**< 1, 0 or -1, as returned by agency_verify_issue(). */
+    uint32_t num_rules;     /**< Rules evaluated, in evaluation order. */
+    uint64_t total_ns;      /**< Time spent verifying, in nanoseconds. */
+    uint64_t error_offset;  /**< Byte at which the JSON stops being valid, or UINT64_MAX. */
+} agency_report_header;
+
+/**
+ * @brief One evaluated rule of a binary verification report.
+ */
+typedef struct {
+    uint16_t kind;           /**< An agency_rule_kind. */
+    uint16_t outcome;        /**< An agency_rule_outcome. */
+    uint32_t name_offset;    /**< The field or theorem name. */
+    uint32_t name_length;
+    uint32_t field_offset;   /**< The field the rule checks. */
+    uint32_t field_length;
+    uint32_t detail_offset;  /**< The missing keyword for a failed theorem, else empty. */
+    uint32_t detail_length;
+    uint32_t reserved;
+    uint64_t ns;             /**< Time spent on the rule, in nanoseconds. */
+} agency_report_rule;
+
+/**
+ * @brief Default bytes to scan (description length times keyword count)
+ *        above which an issue's theorems are evaluated in parallel.
+ */
+#define AGENCY_THEOREM_CUTOFF_DEFAULT (1u << 20)
+
+/**
+ * @brief Configuration and activity of parallel theorem evaluation.
+ */
+typedef struct {
+    size_t threads;                   /**< Threads, the caller included, evaluating one issue. */
+    size_t cutoff;                    /**< Bytes to scan above which evaluation is parallel. */
+    uint64_t parallel_verifications;  /**< Issues whose theorems were evaluated in parallel. */
+    uint64_t items;                   /**< Keyword searches run by those evaluations. */
+    uint64_t steals;                  /**< Times a thread took work from another. */
+} agency_theorem_pool_stats;
+
+/**
+ * @brief Configuration reloads and the reclamation of replaced data.
+ */
+typedef struct {
+    uint64_t reloads;    /**< Successful agency_reload_config() calls. */
+    uint64_t epoch;      /**< Current reclamation epoch. */
+    uint64_t retired;    /**< Snapshots, resource manifests and issue matchers replaced by a reload. */
+    uint64_t reclaimed;  /**< Replaced objects freed, once no reader held them. */
+} agency_reload_stats;
+
+/**
+ * @brief Kinds of memory the library holds, for agency_get_memory_stats().
+ */
+typedef enum {
+    AGENCY_MEMORY_SNAPSHOT = 0,            /**< Configuration snapshots, current and replaced; objects are agencies. */
+    AGENCY_MEMORY_INDEXES = 1,             /**< Manifest, matcher, theorems and dedup indexes; objects are entries. */
+    AGENCY_MEMORY_RESOURCE_CACHE = 2,      /**< Resource store and decompressed copies; objects are both. */
+    AGENCY_MEMORY_VERIFICATION_CACHE = 3,  /**< Verdict cache; objects are verdicts. */
+    AGENCY_MEMORY_ARENAS = 4,              /**< Response arenas and scratch buffers; objects are both. */
+    AGENCY_MEMORY_CATEGORIES = 5
+} agency_memory_category;
+
+/**
+ * @brief Memory held in one category.
+ */
+typedef struct {
+    uint64_t bytes;      /**< Bytes held. */
+    uint64_t objects;    /**< Objects held, as agency_memory_category describes them. */
+    uint64_t limit;      /**< Ceiling from agency_set_memory_limit(), or 0 for none. */
+    uint64_t evictions;  /**< Objects dropped or shrunk to bring the category under its ceiling. */
+} agency_memory_usage;
+
+/**
+ * @brief Memory held by the library, by category.
+ */
+typedef struct {
+    agency_memory_usage categories[AGENCY_MEMORY_CATEGORIES];  /**< Indexed by agency_memory_category. */
+    uint64_t total_bytes;                                      /**< Bytes held over all categories. */
+} agency_memory_stats;
+
+/**
+ * @brief Memory pressure, as graded by the pressure monitor.
+ */
+typedef enum {
+    AGENCY_PRESSURE_NONE = 0,      /**< Caches keep their own ceilings. */
+    AGENCY_PRESSURE_MODERATE = 1,  /**< The verdict cache shrinks to a quarter and arenas are capped. */
+    AGENCY_PRESSURE_HIGH = 2,      /**< Caches keep little beyond what calls are using. */
+    AGENCY_PRESSURE_CRITICAL = 3   /**< As high, with the verdict cache down to one page. */
+} agency_pressure_level;
+
+/**
+ * @brief What the pressure monitor last read, and what it did.
+ */
+typedef struct {
+    int running;             /**< Whether the monitor is running. */
+    int level;               /**< The agency_pressure_level in force. */
+    double some_avg10;       /**< Percent of the last 10 s some tasks stalled on memory. */
+    double full_avg10;       /**< Percent of the last 10 s all tasks stalled on memory. */
+    uint64_t current_bytes;  /**< The cgroup's memory.current. */
+    uint64_t max_bytes;      /**< The cgroup's memory.max, or 0 if it has none. */
+    uint64_t checks;         /**< Times the monitor read the cgroup. */
+    uint64_t escalations;    /**< Times the level rose. */
+} agency_pressure_stats;
+
+/**
+ * @brief NUMA replication of the read-only structures.
+ */
+typedef struct {
+    unsigned nodes;        /**< Memory nodes of the host. */
+    unsigned replicas;     /**< Copies readers spread over; 1 when replication is off. */
+    unsigned replica;      /**< The copy the calling thread reads; 0 is the original. */
+    size_t replica_bytes;  /**< Memory held by the copies other than the originals. */
+} agency_numa_stats;
+
+/**
+ * @brief What backs the snapshot, index and resource store regions.
+ */
+typedef enum {
+    AGENCY_HUGE_PAGES_OFF = 0,     /**< Small pages from the allocator. */
+    AGENCY_HUGE_PAGES_THP = 1,     /**< Transparent huge pages, requested with madvise(). */
+    AGENCY_HUGE_PAGES_HUGETLB = 2  /**< Reserved hugetlbfs pages, else transparent ones. */
+} agency_huge_pages;
+
+/**
+ * @brief Huge-page backing of the library's large regions.
+ */
+typedef struct {
+    int mode;           /**< The agency_huge_pages mode in force. */
+    size_t page_size;   /**< Size of a huge page. */
+    size_t huge_bytes;  /**< Memory of the regions mapped for huge pages. */
+    uint64_t fallbacks; /**< Regions that got less than the mode asked for. */
+} agency_huge_page_stats;
+
+/**
+ * @brief Allocates @p size bytes, suitably aligned for any type, or returns NULL.
+ */
+typedef void* (*agency_alloc_fn)(size_t size, void* ctx);
+
+/**
+ * @brief Resizes a block from the allocator to @p size bytes, as realloc() does.
+ */
+typedef void* (*agency_realloc_fn)(void* ptr, size_t size, void* ctx);
+
+/**
+ * @brief Releases a block from the allocator. Never called with NULL.
+ */
+typedef void (*agency_free_fn)(void* ptr, void* ctx);
+
+/**
+ * @brief Similarity threshold suiting most near-duplicate indexes.
+ */
+#define AGENCY_DEDUP_DEFAULT_SIMILARITY 0.8
+
+/**
+ * @brief An index of issues for finding near-duplicates.
+ */
+typedef struct agency_dedup_index agency_dedup_index;
+
+/**
+ * @brief Contents and effectiveness of a near-duplicate index.
+ */
+typedef struct {
+    size_t issues;             /**< Canonical issues indexed. */
+    uint32_t bands;            /**< Bands the signature is cut into. */
+    uint32_t rows;             /**< Signature positions per band. */
+    uint64_t lookups;          /**< Issues looked up, including those then indexed. */
+    uint64_t duplicates;       /**< Lookups that found a near-duplicate. */
+    uint64_t candidates;       /**< Signatures compared, over all lookups. */
+} agency_dedup_stats;
+
+/**
+ * @brief Receives successive runs of verdicts from agency_verify_batch_fd().
+ *
+ * Each verdict is 1, 0 or -1, as returned by agency_verify_issue(), in input
+ * order.
+ *
+ * @return 0 to continue, any other value to stop the batch.
+ */
+typedef int (*agency_verdict_writer)(const int8_t* verdicts, size_t count, void* user_data);
+
 /**
  * @brief Get the context information for an agency.
  *
@@ -31,6 +353,47 @@ extern "C" {
  */
 char* agency_get_context(const char* agency);
 
+/**
+ * @brief Get the context information for an agency if it has changed.
+ *
+ * Every agency context carries a 64-bit content hash (XXH64 of the JSON
+ * returned by agency_get_context()), computed once. Passing the hash from a
+ * previous call lets unchanged contexts be answered without copying data.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param known_hash The hash the caller already holds, or 0 for none.
+ * @param context Receives the context on AGENCY_STATUS_OK, NULL otherwise.
+ *        Free it with agency_free_context().
+ * @param current_hash If not NULL, receives the current hash.
+ * @return AGENCY_STATUS_OK, AGENCY_STATUS_NOT_MODIFIED,
+ *         AGENCY_STATUS_NOT_FOUND or AGENCY_STATUS_ERROR.
+ */
+int agency_get_context_conditional(const char* agency, uint64_t known_hash,
+                                   char** context, uint64_t* current_hash);
+
+/**
+ * @brief Get a file-backed agency resource if it has changed.
+ *
+ * Every resource carries a 64-bit content hash (XXH64 of the bytes served),
+ * cached together with the file's size, modification time and inode. A
+ * matching @p known_hash is answered from the cache after a stat(), without
+ * reading the file; once the file changes it is read and hashed again. A
+ * resource in the store is hashed as stored and never examined on disk.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param kind The resource to fetch.
+ * @param known_hash The hash the caller already holds, or 0 for none.
+ * @param data Receives the resource on AGENCY_STATUS_OK, NULL otherwise.
+ *        Free it with agency_free_context().
+ * @param length If not NULL, receives the resource length on AGENCY_STATUS_OK.
+ * @param current_hash If not NULL, receives the current hash.
+ * @return AGENCY_STATUS_OK, AGENCY_STATUS_NOT_MODIFIED,
+ *         AGENCY_STATUS_NOT_FOUND or AGENCY_STATUS_ERROR.
+ */
+int agency_get_resource_conditional(const char* agency, agency_resource_kind kind,
+                                    uint64_t known_hash, char** data, size_t* length,
+                                    uint64_t* current_hash);
+
 /**
  * @brief Get the issue finder data for an agency.
  *
@@ -118,7 +481,25 @@ char* agency_get_agencies_by_domain(const char* domain);
 /**
  * @brief Verify an issue using the agency theorem prover.
  *
- * Verifies that an issue is valid according to domain theorems.
+ * Verifies that an issue is valid according to domain theorems. The issue
+ * must satisfy the agency's issue schema from the "issue_schemas" section
+ * of the configuration (by default: carry `id`, `title`, `description` and
+ * `affected_areas`), and every theorem of the agency's domain must hold for
+ * its description. The theorem
+ * models are compiled natively on first use and give the same verdicts as
+ * prover_integration.py; agencies whose domain has no theorem model never
+ * verify.
+ *
+ * The JSON is validated in a single streaming pass over the whole document,
+ * without building a document tree. Data after the issue makes it
+ * malformed, and a repeated top-level key is checked on its last value,
+ * as json.loads reads it.
+ *
+ * Verdicts are cached by agency and by the issue's text with insignificant
+ * whitespace removed, so a resubmitted issue is answered without being
+ * verified again. Reloading the configuration empties the cache. Theorem
+ * models are compiled once, on first use, and are not reloaded; a changed
+ * model takes effect in a new process.
  *
  * @param agency The agency acronym (e.g., "HHS", "DOD").
  * @param issue_json JSON-formatted issue data.
@@ -126,6 +507,549 @@ char* agency_get_agencies_by_domain(const char* domain);
  */
 int agency_verify_issue(const char* agency, const char* issue_json);
 
+/**
+ * @brief Start the asynchronous I/O thread pool.
+ *
+ * Calling this is optional: the first asynchronous request starts the pool
+ * with a default size. It fails if the pool is already running.
+ *
+ * @param num_threads Number of I/O threads, or 0 for the default.
+ * @return AGENCY_STATUS_OK on success, AGENCY_STATUS_ERROR otherwise.
+ */
+int agency_async_init(size_t num_threads);
+
+/**
+ * @brief Stop the asynchronous I/O thread pool.
+ *
+ * Requests already submitted are completed first. Completions that nobody
+ * polled are discarded and their data freed.
+ */
+void agency_async_shutdown(void);
+
+/**
+ * @brief Fetch an agency resource asynchronously.
+ *
+ * The resource is resolved and read on an I/O thread, so this call never
+ * blocks on the filesystem; an agency without the resource completes with
+ * AGENCY_STATUS_NOT_FOUND. When @p callback is NULL, the completion
+ * is queued for agency_poll_completions(); otherwise the callback receives it
+ * on the I/O thread and it is not queued.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param kind The resource to fetch.
+ * @param callback Optional completion callback.
+ * @param user_data Opaque pointer passed back in the completion.
+ * @return A ticket identifying the request, or 0 if it could not be submitted.
+ */
+agency_ticket agency_fetch_async(const char* agency, agency_resource_kind kind,
+                                 agency_completion_fn callback, void* user_data);
+
+/**
+ * @brief Collect completed asynchronous requests.
+ *
+ * @param completions Array receiving up to @p max_completions results.
+ * @param max_completions Capacity of @p completions.
+ * @param timeout_ms How long to wait when none are ready: 0 returns at once,
+ *        a negative value waits indefinitely.
+ * @return The number of completions written, or -1 if an error occurs.
+ */
+int agency_poll_completions(agency_completion* completions, size_t max_completions,
+                            int timeout_ms);
+
+/**
+ * @brief Get a descriptor that becomes readable when completions are queued.
+ *
+ * The descriptor is a non-blocking eventfd owned by the library; do not close
+ * it. It stays the same for the life of the process, across
+ * agency_async_shutdown(). A runtime with its own event loop waits for it to
+ * become readable, reads it to clear it, then calls agency_poll_completions()
+ * with a zero timeout, so that no thread ever waits inside the library.
+ * A wakeup may find the queue already drained by another poller.
+ *
+ * @return The descriptor, or -1 if it could not be created.
+ */
+int agency_completion_fd(void);
+
+/**
+ * @brief Open a chunked stream over an agency resource.
+ *
+ * Memory use is bounded by @p chunk_size regardless of the resource size,
+ * plus a 64 KiB decode window when the resource is already in the store,
+ * in which case it is streamed from there rather than from disk. Close the
+ * stream with agency_stream_close().
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param kind The resource to stream.
+ * @param chunk_size Maximum bytes per chunk, or 0 for AGENCY_STREAM_CHUNK_SIZE;
+ *        capped at AGENCY_STREAM_MAX_CHUNK_SIZE.
+ * @return A stream handle, or NULL if the agency has no such resource or an
+ *         error occurs.
+ */
+agency_stream* agency_stream_open(const char* agency, agency_resource_kind kind,
+                                  size_t chunk_size);
+
+/**
+ * @brief Read the next chunk from a stream.
+ *
+ * The chunk stays valid until the next call on the same stream.
+ *
+ * @param stream The stream.
+ * @param chunk Receives a pointer to the chunk data.
+ * @param length Receives the chunk length in bytes.
+ * @return 1 if a chunk was produced, 0 at end of stream, -1 if an error occurs.
+ */
+int agency_stream_next(agency_stream* stream, const char** chunk, size_t* length);
+
+/**
+ * @brief Close a stream opened with agency_stream_open().
+ *
+ * @param stream The stream to close. May be NULL.
+ */
+void agency_stream_close(agency_stream* stream);
+
+/**
+ * @brief Push an agency resource to a writer in fixed-size chunks.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param kind The resource to stream.
+ * @param chunk_size Maximum bytes per chunk, or 0 for AGENCY_STREAM_CHUNK_SIZE;
+ *        capped at AGENCY_STREAM_MAX_CHUNK_SIZE.
+ * @param writer Called once per chunk, in order.
+ * @param user_data Opaque pointer passed to @p writer.
+ * @return AGENCY_STATUS_OK when the whole resource was written,
+ *         AGENCY_STATUS_NOT_FOUND if the agency has no such resource, or
+ *         AGENCY_STATUS_ERROR on a read error or when the writer stops early.
+ */
+int agency_stream_resource(const char* agency, agency_resource_kind kind, size_t chunk_size,
+                           agency_chunk_writer writer, void* user_data);
+
+/**
+ * @brief Preload every file-backed resource into the compressed store.
+ *
+ * Reads each finder, connector and ASCII art resource in the manifest once
+ * and keeps it LZ4-compressed in memory. Afterwards every getter serves
+ * these resources without filesystem access. Calling it again only loads
+ * resources that are not stored yet, such as those a configuration reload
+ * added; a reload keeps every stored resource whose file it still uses.
+ *
+ * @return AGENCY_STATUS_OK if every resource was stored, AGENCY_STATUS_ERROR
+ *         if any could not be read or stored.
+ */
+int agency_store_preload(void);
+
+/**
+ * @brief Get a stored resource in compressed form, without copying.
+ *
+ * The data is an LZ4 block (no frame header) that decompresses to exactly
+ * @p raw_length bytes. It remains valid for the life of the process.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param kind The resource to fetch.
+ * @param data Receives a pointer to the compressed bytes.
+ * @param compressed_length If not NULL, receives the compressed length.
+ * @param raw_length If not NULL, receives the decompressed length.
+ * @return AGENCY_STATUS_OK, AGENCY_STATUS_NOT_FOUND if the agency has no
+ *         such resource, or AGENCY_STATUS_ERROR if it is not in the store.
+ */
+int agency_store_get_compressed(const char* agency, agency_resource_kind kind,
+                                const void** data, size_t* compressed_length,
+                                size_t* raw_length);
+
+/**
+ * @brief Get a stored resource decompressed, from a small per-thread cache.
+ *
+ * The returned buffer is owned by the calling thread's cache and stays
+ * valid until that thread's next call to agency_store_get(). Do not free it.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param kind The resource to fetch.
+ * @param data Receives a pointer to the null-terminated contents.
+ * @param length If not NULL, receives the length in bytes.
+ * @return AGENCY_STATUS_OK, AGENCY_STATUS_NOT_FOUND if the agency has no
+ *         such resource, or AGENCY_STATUS_ERROR if it is not in the store.
+ */
+int agency_store_get(const char* agency, agency_resource_kind kind,
+                     const char** data, size_t* length);
+
+/**
+ * @brief Report the size and hit rates of the compressed resource store.
+ *
+ * @param stats Receives the statistics.
+ */
+void agency_get_store_stats(agency_store_stats* stats);
+
+/**
+ * @brief Verify a batch of NDJSON issues on a pool of worker threads.
+ *
+ * Each non-blank line of @p ndjson is one issue, verified as by
+ * agency_verify_issue(). The agency's schema and theorems are resolved once
+ * for the whole batch.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param ndjson Newline-delimited issue JSON. Need not be null-terminated.
+ * @param length Length of @p ndjson in bytes.
+ * @param num_threads Worker threads, or 0 for one per online CPU.
+ * @param verdicts Receives one verdict per issue, in input order.
+ * @param max_verdicts Capacity of @p verdicts.
+ * @param summary If not NULL, receives the verdict counts.
+ * @return AGENCY_STATUS_OK on success, or AGENCY_STATUS_ERROR if an argument
+ *         is invalid or the input holds more than @p max_verdicts issues. In
+ *         the latter case @p summary->issues reports the number required.
+ */
+int agency_verify_batch(const char* agency, const char* ndjson, size_t length,
+                        size_t num_threads, int8_t* verdicts, size_t max_verdicts,
+                        agency_batch_summary* summary);
+
+/**
+ * @brief Verify NDJSON issues read from a file descriptor until end of file.
+ *
+ * Input is read and verified in windows of a few megabytes, so memory use
+ * does not grow with the input. Verdicts are passed to @p writer in input
+ * order as each window completes. The schema and theorems are resolved
+ * again for each window, so a configuration reload applies from the next
+ * window on, and data it replaces is not kept alive while the batch waits
+ * for input.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param fd Descriptor to read issues from. It is not closed.
+ * @param num_threads Worker threads, or 0 for one per online CPU.
+ * @param writer Receives the verdicts.
+ * @param user_data Opaque pointer passed to @p writer.
+ * @param summary If not NULL, receives the verdict counts.
+ * @return AGENCY_STATUS_OK when all input was verified, or
+ *         AGENCY_STATUS_ERROR on a read error or when the writer stops early.
+ */
+int agency_verify_batch_fd(const char* agency, int fd, size_t num_threads,
+                           agency_verdict_writer writer, void* user_data,
+                           agency_batch_summary* summary);
+
+/**
+ * @brief Report the verdict cache's capacity and hit rates.
+ *
+ * @param stats Receives the statistics.
+ */
+void agency_get_verdict_cache_stats(agency_verdict_cache_stats* stats);
+
+/**
+ * @brief Drop every cached verdict.
+ *
+ * Only needed to measure uncached verification; reloads empty the cache
+ * on their own.
+ */
+void agency_verdict_cache_clear(void);
+
+/**
+ * @brief Verify an issue and report every rule evaluated.
+ *
+ * Gives the same verdict as agency_verify_issue(), bypassing the verdict
+ * cache, and reports each schema field check and theorem evaluated with
+ * its outcome and timing. Every theorem is evaluated, even after one fails,
+ * so the report shows the cost of each. A syntax error reports the rules
+ * checked before it and the offset of the error.
+ *
+ * @param agency The agency acronym (e.g., "HHS", "DOD").
+ * @param issue_json JSON-formatted issue data to verify.
+ * @param format Encoding of the report.
+ * @param buffer Receives the report.
+ * @param capacity Capacity of @p buffer in bytes.
+ * @param length Receives the length of the report (for JSON, without the
+ *        terminator), or the capacity required if @p buffer is too small.
+ *        A JSON report's length varies with its timings, so a retry should
+ *        leave some room to spare.
+ * @return AGENCY_STATUS_OK on success, or AGENCY_STATUS_ERROR if an argument
+ *         is invalid, memory runs out or @p buffer is too small.
+ */
+int agency_verify_issue_report(const char* agency, const char* issue_json,
+                               agency_report_format format, char* buffer, size_t capacity,
+                               size_t* length);
+
+/**
+ * @brief Find the theorems and domain topics an issue touches.
+ *
+ * The issue's title, description and affected areas are searched for every
+ * theorem component of every domain and every topic in the configuration,
+ * in one pass whose cost does not grow with the number of theorems.
+ * Matching ignores ASCII case, treats '_' like a space, and finds patterns
+ * anywhere in the text, not only at word boundaries.
+ *
+ * The result is a JSON object: "theorems" lists each theorem with at least
+ * one matching component as {"domain", "name", "components"}, and "topics"
+ * lists each matching topic as {"domain", "topic"}.
+ * The caller is responsible for freeing the returned string using
+ * agency_free_context() when it is no longer needed.
+ *
+ * @param issue_json JSON-formatted issue data.
+ * @return A pointer to a null-terminated string containing the matches, or
+ *         NULL if the JSON is malformed or an error occurs.
+ */
+char* agency_match_issue(const char* issue_json);
+
+/**
+ * @brief Create an empty near-duplicate index.
+ *
+ * Issues are compared by the three-word shingles of their title,
+ * description and affected areas, ignoring case and punctuation. Two issues
+ * are near-duplicates when the Jaccard similarity of their shingle sets,
+ * estimated from 64-hash MinHash signatures, is at least @p min_similarity.
+ * Lookups only compare issues that share a band of their signatures, so
+ * their cost grows with the number of similar issues, not with the size of
+ * the index; a near-duplicate at the threshold is found with at least 99%
+ * probability, and a more similar one more surely.
+ *
+ * The index only detects and reports near-duplicates; it does not answer
+ * for them. Near-duplicates can differ in exactly what verification checks,
+ * so each issue is verified on its own with agency_verify_issue(), whose
+ * verdict cache already answers byte-identical resubmissions.
+ *
+ * An index may be used from several threads at once.
+ *
+ * @param min_similarity Threshold in (0, 1]; AGENCY_DEDUP_DEFAULT_SIMILARITY
+ *        suits most uses.
+ * @return The index, to be released with agency_dedup_destroy(), or NULL if
+ *         @p min_similarity is out of range or memory runs out.
+ */
+agency_dedup_index* agency_dedup_create(double min_similarity);
+
+/**
+ * @brief Release a near-duplicate index.
+ */
+void agency_dedup_destroy(agency_dedup_index* index);
+
+/**
+ * @brief Look up an issue, indexing it if no near-duplicate is indexed.
+ *
+ * The first issue of a group of near-duplicates becomes its canonical
+ * issue; later ones are not indexed. Issues without an "id" are looked up
+ * but never indexed, and issues without text neither.
+ *
+ * @param index The index.
+ * @param issue_json JSON-formatted issue data.
+ * @param canonical_id Receives the id of the canonical issue, truncated to
+ *        fit and null-terminated; the issue's own id when it is new. May be
+ *        NULL.
+ * @param capacity Capacity of @p canonical_id in bytes.
+ * @return 1 if a near-duplicate was already indexed, 0 if not, or -1 if the
+ *         JSON is malformed or memory runs out.
+ */
+int agency_dedup_add(agency_dedup_index* index, const char* issue_json, char* canonical_id,
+                     size_t capacity);
+
+/**
+ * @brief Report the contents and effectiveness of a near-duplicate index.
+ *
+ * @param index The index.
+ * @param stats Receives the statistics.
+ */
+void agency_get_dedup_stats(agency_dedup_index* index, agency_dedup_stats* stats);
+
+/**
+ * @brief Configure parallel theorem evaluation within one issue.
+ *
+ * An issue whose description is long enough is searched for its domain's
+ * theorem keywords on a shared work-stealing pool, segment by segment, with
+ * the calling thread taking part; shorter ones are evaluated on the calling
+ * thread alone. The verdict is the same either way. By default the pool has
+ * one thread per online CPU and the cutoff is AGENCY_THEOREM_CUTOFF_DEFAULT.
+ *
+ * @param num_threads Threads, the caller included, that may evaluate one
+ *        issue: 0 for one per online CPU, 1 to always evaluate serially.
+ * @param cutoff Description length times the domain's keyword count, in
+ *        bytes, from which evaluation is parallel; 0 for the default.
+ */
+void agency_set_theorem_parallelism(size_t num_threads, size_t cutoff);
+
+/**
+ * @brief Report the configuration and activity of parallel theorem evaluation.
+ *
+ * @param stats Receives the statistics.
+ */
+void agency_get_theorem_pool_stats(agency_theorem_pool_stats* stats);
+
+/**
+ * @brief Reload the configuration file while readers keep running.
+ *
+ * The agency data, issue schemas and resource manifest are rebuilt and
+ * swapped in as a whole; a call already in progress finishes on the data it
+ * started with, and the old data is freed once no call can still be using
+ * it. Resources and `ascii_template` overrides added or removed since the
+ * last load are visible after the reload. Verdicts cached before the reload
+ * are not reused after it. The issue matcher is rebuilt with the reloaded
+ * topics.
+ *
+ * @return AGENCY_STATUS_OK, or AGENCY_STATUS_ERROR if the file could not be
+ *         loaded, in which case the current configuration stays in place.
+ */
+int agency_reload_config(void);
+
+/**
+ * @brief Report configuration reloads and the reclamation of replaced data.
+ *
+ * @param stats Receives the statistics.
+ */
+void agency_get_reload_stats(agency_reload_stats* stats);
+
+/**
+ * @brief Route the library's allocations through the caller's allocator.
+ *
+ * Every block the library allocates, including the strings and buffers it
+ * returns, comes from @p alloc and @p realloc and goes back through @p free;
+ * agency_free_context() calls @p free_fn. A host whose allocator releases
+ * memory in bulk, such as an arena, may skip agency_free_context()
+ * altogether. The JSON parser's own nodes still come from the C library.
+ *
+ * Call it before any other agency function: once the library has allocated,
+ * the allocator can no longer change. Passing NULL for all three functions
+ * keeps the C library's allocator.
+ *
+ * @param alloc_fn Allocates a block.
+ * @param realloc_fn Resizes a block.
+ * @param free_fn Releases a block.
+ * @param ctx Passed to each of the three functions.
+ * @return AGENCY_STATUS_OK, or AGENCY_STATUS_ERROR if the library has already
+ *         allocated or only some of the functions are given.
+ */
+int agency_set_allocator(agency_alloc_fn alloc_fn, agency_realloc_fn realloc_fn, agency_free_fn free_fn, void* ctx);
+
+/**
+ * @brief Report the memory the library holds, by category.
+ *
+ * Reads counters kept as memory is taken and released, so it takes no
+ * locks and walks no structures, and can be scraped as often as needed.
+ * Blocks the JSON parser allocates for itself are not counted.
+ *
+ * @param stats Receives the statistics.
+ */
+void agency_get_memory_stats(agency_memory_stats* stats);
+
+/**
+ * @brief Cap the memory a cache may hold.
+ *
+ * The verification cache shrinks to fit at once. Threads give back resource
+ * copies and arena blocks above the ceiling at their next call that uses
+ * them, so an idle thread keeps what it holds; the compressed resource store
+ * is never evicted, and a ceiling below it leaves each thread only the copy
+ * in use.
+ *
+ * @param category AGENCY_MEMORY_RESOURCE_CACHE, AGENCY_MEMORY_VERIFICATION_CACHE
+ *        or AGENCY_MEMORY_ARENAS.
+ * @param bytes The ceiling, or 0 to remove it.
+ * @return AGENCY_STATUS_OK, or AGENCY_STATUS_ERROR if the category cannot be
+ *         evicted.
+ */
+int agency_set_memory_limit(agency_memory_category category, uint64_t bytes);
+
+/**
+ * @brief Start shrinking the caches as the cgroup comes under memory pressure.
+ *
+ * A background thread reads the cgroup v2 files memory.pressure,
+ * memory.current and memory.max every @p interval_ms, grades the pressure
+ * and tightens the cache ceilings step by step as it rises, well before
+ * the cgroup reaches memory.max. The ceilings apply alongside those set by
+ * agency_set_memory_limit(), and are lifted one level per interval once
+ * the pressure falls.
+ *
+ * Any directory holding files in the same format will do, so a test can
+ * drive the monitor by writing them.
+ *
+ * @param cgroup_dir The cgroup's directory, or NULL for the calling
+ *        process's own cgroup.
+ * @param interval_ms Time between checks, or 0 for one second.
+ * @return AGENCY_STATUS_OK, or AGENCY_STATUS_ERROR if the monitor is
+ *         already running or the directory has neither memory.pressure
+ *         nor memory.current.
+ */
+int agency_pressure_monitor_start(const char* cgroup_dir, unsigned interval_ms);
+
+/**
+ * @brief Stop the pressure monitor and lift its ceilings. Does nothing if it
+ *        is not running.
+ */
+void agency_pressure_monitor_stop(void);
+
+/**
+ * @brief Report the pressure monitor's last reading and level.
+ *
+ * @param stats Receives the statistics.
+ */
+void agency_get_pressure_stats(agency_pressure_stats* stats);
+
+/**
+ * @brief Build everything the library would otherwise build on first use,
+ *        ahead of a fork.
+ *
+ * Loads the configuration snapshot, the resource manifest, the issue
+ * matcher and the theorem models, preloads the resource store, frees
+ * snapshots replaced by earlier reloads and returns free heap memory to the
+ * system. None of these is written again on the read path, so worker
+ * processes forked afterwards share their pages with the parent instead of
+ * each building and holding a copy of its own.
+ *
+ * Call it from the thread that will fork, while no other thread is inside
+ * the library.
+ *
+ * @return AGENCY_STATUS_OK, or AGENCY_STATUS_ERROR if any of them could not
+ *         be built; whatever was built stays shared.
+ */
+int agency_prefork_prepare(void);
+
+/**
+ * @brief Keep a copy of the configuration snapshot, the theorem models and
+ *        the issue matcher on each NUMA node.
+ *
+ * Each reader then reads the copy on the node its CPU belongs to, rather
+ * than reaching across the interconnect for the one copy. The copies are
+ * made now, and the snapshot is republished as agency_reload_config() does;
+ * later reloads copy the new snapshot in turn. The manifest and resource
+ * store are not copied.
+ *
+ * @param replicas Copies to keep: 0 for one per node, 1 to turn replication
+ *        off. More than there are nodes is allowed, for testing; readers
+ *        are then dealt over the copies by CPU.
+ * @return AGENCY_STATUS_OK, or AGENCY_STATUS_ERROR if @p replicas exceeds
+ *         16 or the copies could not be made.
+ */
+int agency_numa_replicate(unsigned replicas);
+
+/**
+ * @brief Have the calling thread read the copy of a given node, whatever CPU it runs on.
+ *
+ * @param node The node, or -1 to follow the CPU again.
+ * @return AGENCY_STATUS_OK, or AGENCY_STATUS_ERROR if @p node is out of range.
+ */
+int agency_numa_set_thread_node(int node);
+
+/**
+ * @brief Report the NUMA topology and replication.
+ *
+ * @param stats Receives the statistics.
+ */
+void agency_get_numa_stats(agency_numa_stats* stats);
+
+/**
+ * @brief Back the configuration snapshot, the indexes and the preloaded
+ *        resources with huge pages.
+ *
+ * Queries that walk these regions end to end then take far fewer TLB
+ * misses. Each region is rounded up to whole huge pages. A region that
+ * cannot get the pages asked for falls back: hugetlbfs to transparent huge
+ * pages, and those to ordinary pages from the allocator.
+ *
+ * The mode applies to regions built afterwards: call it before the library
+ * is first used or agency_prefork_prepare(), or follow it with
+ * agency_reload_config() to rebuild the snapshot.
+ *
+ * @param mode An agency_huge_pages mode.
+ * @return AGENCY_STATUS_OK, or AGENCY_STATUS_ERROR for an unknown mode.
+ */
+int agency_set_huge_pages(int mode);
+
+/**
+ * @brief Report the huge-page mode and the memory it backs.
+ *
+ * @param stats Receives the statistics.
+ */
+void agency_get_huge_page_stats(agency_huge_page_stats* stats);
+
 #ifdef __cplusplus
 }
 #endif
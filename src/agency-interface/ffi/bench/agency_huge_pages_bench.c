@@ -0,0 +1,151 @@
+/**
+ * @file agency_huge_pages_bench.c
+ * @brief Full-scan query throughput with and without huge pages.
+ *
+ * For each huge-page mode (off, transparent, hugetlbfs) a child process
+ * sets the mode, builds everything with agency_prefork_prepare(), and then
+ * runs full scans for a fixed number of rounds: every tier's and every
+ * domain's agency list, every agency's context, and a pass over every
+ * stored resource's compressed bytes. Each mode runs in a process of its
+ * own, since the resource store is built once per process. The bench
+ * reports scans per second, the memory mapped for huge pages, the part the
+ * kernel actually backs with them (AnonHugePages plus hugetlbfs pages) and
+ * how many regions fell back to smaller pages.
+ *
+ * With the shipped configuration the snapshot spans a few dozen small
+ * pages and the difference is within noise; it grows with the number of
+ * agencies and resources, once the regions outgrow the TLB's reach.
+ *
+ * Build from the ffi directory against the library:
+ *
+ *     cc -O2 -pthread -Ic -o agency_huge_pages_bench bench/agency_huge_pages_bench.c \
+ *        -Lc -lagency_ffi -ljson-c
+ *
+ * and run it from the ffi directory, so the configuration resolves:
+ *
+ *     ./agency_huge_pages_bench [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+static const char* g_mode_names[] = {"off", "thp", "hugetlb"};
+
+static size_t g_rounds = 2000;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Sum the process's memory backed by huge pages, in kB.
+ */
+static unsigned long huge_backed_kb(void) {
+    FILE* file = fopen("/proc/self/smaps_rollup", "r");
+    if (file == NULL) {
+        return 0;
+    }
+    char line[256];
+    unsigned long total = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        unsigned long kb = 0;
+        if (sscanf(line, "AnonHugePages: %lu kB", &kb) == 1 || sscanf(line, "Private_Hugetlb: %lu kB", &kb) == 1 ||
+            sscanf(line, "Shared_Hugetlb: %lu kB", &kb) == 1) {
+            total += kb;
+        }
+    }
+    fclose(file);
+    return total;
+}
+
+/**
+ * @brief One full scan of the snapshot and the resource store.
+ *
+ * @return A sum of what was read, so the reads are not optimized away.
+ */
+static size_t full_scan(const agency_snapshot* snapshot) {
+    size_t sum = 0;
+    for (int tier = 0; tier <= 4; tier++) {
+        char* list = agency_get_agencies_by_tier(tier);
+        sum += list != NULL ? strlen(list) : 0;
+        free(list);
+    }
+    for (size_t i = 0; i < snapshot->num_domains; i++) {
+        char* list = agency_get_agencies_by_domain(agency_snapshot_string(snapshot, snapshot->domains[i].domain));
+        sum += list != NULL ? strlen(list) : 0;
+        free(list);
+    }
+
+    for (size_t i = 0; i < snapshot->num_entries; i++) {
+        const char* acronym = agency_snapshot_string(snapshot, snapshot->entries[i].acronym);
+        char* context = agency_get_context(acronym);
+        sum += context != NULL ? strlen(context) : 0;
+        free(context);
+
+        for (int kind = 0; kind < AGENCY_RESOURCE_COUNT; kind++) {
+            const void* data = NULL;
+            size_t length = 0;
+            if (agency_store_get_compressed(acronym, (agency_resource_kind)kind, &data, &length, NULL) ==
+                AGENCY_STATUS_OK) {
+                const unsigned char* bytes = (const unsigned char*)data;
+                for (size_t b = 0; b < length; b += 64) {
+                    sum += bytes[b];
+                }
+            }
+        }
+    }
+    return sum;
+}
+
+/**
+ * @brief Build everything under one mode and time the scans. Runs in a child.
+ */
+static int run_mode(int mode) {
+    if (agency_set_huge_pages(mode) != AGENCY_STATUS_OK || agency_prefork_prepare() != AGENCY_STATUS_OK) {
+        return 1;
+    }
+    const agency_snapshot* snapshot = agency_snapshot_current();
+
+    size_t sum = full_scan(snapshot);
+    double start = now_seconds();
+    for (size_t i = 0; i < g_rounds; i++) {
+        sum += full_scan(snapshot);
+    }
+    double elapsed = now_seconds() - start;
+
+    agency_huge_page_stats stats;
+    agency_get_huge_page_stats(&stats);
+    printf("%8s %14.0f %12zu %12lu %10llu %s\n", g_mode_names[mode], (double)g_rounds / elapsed,
+           stats.huge_bytes / 1024, huge_backed_kb(), (unsigned long long)stats.fallbacks, sum != 0 ? "" : "?");
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        g_rounds = strtoul(argv[1], NULL, 10);
+    }
+
+    printf("%8s %14s %12s %12s %10s\n", "mode", "scans/s", "mapped kB", "backed kB", "fallbacks");
+    fflush(stdout);
+    for (int mode = AGENCY_HUGE_PAGES_OFF; mode <= AGENCY_HUGE_PAGES_HUGETLB; mode++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(run_mode(mode));
+        }
+        int status = 0;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Error running mode %s\n", g_mode_names[mode]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
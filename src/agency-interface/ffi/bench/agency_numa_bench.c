@@ -0,0 +1,183 @@
+/**
+ * @file agency_numa_bench.c
+ * @brief Read-path throughput with and without NUMA replication.
+ *
+ * Reader threads call the configuration getters and agency_match_issue()
+ * for a fixed number of rounds, first with replication off, every reader
+ * on the one copy, and then with the given number of copies. Each reader
+ * is assigned node (thread % replicas) with agency_numa_set_thread_node(),
+ * as a thread running on that node would be, so the bench also runs on a
+ * single-node machine with the count forced; there the copies share one
+ * node and show the access pattern rather than a speedup. For each run it
+ * reports calls per second and, for each copy, how many readers read it,
+ * where its snapshot lies and the node its pages are on.
+ *
+ * Build from the ffi directory against the library:
+ *
+ *     cc -O2 -pthread -Ic -o agency_numa_bench bench/agency_numa_bench.c \
+ *        -Lc -lagency_ffi -ljson-c
+ *
+ * and run it from the ffi directory, so the configuration resolves:
+ *
+ *     ./agency_numa_bench [replicas] [threads] [rounds]
+ *
+ * where replicas 0, the default, keeps one copy per node.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+#define BENCH_MAX_THREADS 64
+
+// Calls per round
+#define BENCH_CALLS_PER_ROUND 5
+
+static const char* g_agencies[] = {"HHS", "DOD", "EPA", "NASA", "DOE", "USDA", "SSA", "XYZ"};
+static const char* g_domains[] = {"healthcare", "defense", "environment", "space", "nope"};
+static const char g_issue[] =
+    "{\"id\": 1, \"title\": \"Privacy\", \"description\": \"patient privacy and data protection\","
+    " \"affected_areas\": [\"privacy\", \"national security\"]}";
+
+static size_t g_rounds = 20000;
+static unsigned g_replicas = 1;
+static pthread_barrier_t g_start;
+
+static double g_started[BENCH_MAX_THREADS];
+static double g_finished[BENCH_MAX_THREADS];
+
+// The copy each reader read, as the library chose it
+static unsigned g_replica_read[BENCH_MAX_THREADS];
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief The node a page lies on, or -1 if the kernel will not say.
+ */
+static int page_node(const void* address) {
+    void* page = (void*)((uintptr_t)address & ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1));
+    int status = -1;
+    if (syscall(SYS_move_pages, 0, 1ul, &page, NULL, &status, 0) != 0) {
+        return -1;
+    }
+    return status;
+}
+
+/**
+ * @brief Body of each reader thread.
+ */
+static void* reader_main(void* arg) {
+    size_t seed = (size_t)(uintptr_t)arg;
+    const size_t num_agencies = sizeof(g_agencies) / sizeof(g_agencies[0]);
+    const size_t num_domains = sizeof(g_domains) / sizeof(g_domains[0]);
+
+    agency_numa_set_thread_node((int)(seed % g_replicas));
+    g_replica_read[seed] = agency_numa_replica();
+
+    pthread_barrier_wait(&g_start);
+    g_started[seed] = now_seconds();
+    for (size_t i = 0; i < g_rounds; i++) {
+        const char* agency = g_agencies[(seed + i) % num_agencies];
+        free(agency_get_context(agency));
+        free(agency_get_all_agencies());
+        free(agency_get_agencies_by_tier((int)((seed + i) % 4)));
+        free(agency_get_agencies_by_domain(g_domains[(seed + i) % num_domains]));
+        free(agency_match_issue(g_issue));
+    }
+    g_finished[seed] = now_seconds();
+    return NULL;
+}
+
+/**
+ * @brief Run the readers against some number of copies.
+ *
+ * @return Calls per second over all threads.
+ */
+static double run(unsigned replicas, size_t num_threads) {
+    if (agency_numa_replicate(replicas) != AGENCY_STATUS_OK) {
+        return 0;
+    }
+    g_replicas = agency_numa_replicas();
+
+    pthread_t threads[BENCH_MAX_THREADS];
+    pthread_barrier_init(&g_start, NULL, (unsigned)num_threads + 1);
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_create(&threads[t], NULL, reader_main, (void*)(uintptr_t)t);
+    }
+
+    pthread_barrier_wait(&g_start);
+    double start = 0;
+    double end = 0;
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+        if (t == 0 || g_started[t] < start) {
+            start = g_started[t];
+        }
+        if (g_finished[t] > end) {
+            end = g_finished[t];
+        }
+    }
+    pthread_barrier_destroy(&g_start);
+
+    return (double)(num_threads * g_rounds * BENCH_CALLS_PER_ROUND) / (end - start);
+}
+
+/**
+ * @brief Print, for each copy, its readers and where its snapshot lies.
+ */
+static void print_pattern(size_t num_threads) {
+    // The original holds the copies; the main thread reads it as node 0
+    agency_numa_set_thread_node(0);
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    for (unsigned r = 0; r < g_replicas; r++) {
+        size_t readers = 0;
+        for (size_t t = 0; t < num_threads; t++) {
+            readers += g_replica_read[t] == r;
+        }
+        const agency_snapshot* copy = r == 0 ? snapshot : snapshot->replicas[r];
+        printf("%10s replica %2u: %3zu readers, snapshot at %p on node %d\n", "", r, readers,
+               (const void*)copy, copy != NULL ? page_node(copy) : -1);
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned replicas = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 0;
+    size_t num_threads = argc > 2 ? strtoul(argv[2], NULL, 10) : 8;
+    if (argc > 3) {
+        g_rounds = strtoul(argv[3], NULL, 10);
+    }
+    if (num_threads == 0 || num_threads > BENCH_MAX_THREADS) {
+        num_threads = BENCH_MAX_THREADS;
+    }
+
+    // Load everything outside the timed runs
+    if (agency_load_config() == NULL || agency_load_matcher() != 0) {
+        return 1;
+    }
+
+    agency_numa_stats stats;
+    agency_get_numa_stats(&stats);
+    printf("%u NUMA node(s), %zu reader threads\n", stats.nodes, num_threads);
+    printf("%10s %14s %14s\n", "replicas", "calls/s", "replica bytes");
+
+    unsigned counts[] = {1, replicas};
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        double rate = run(counts[i], num_threads);
+        if (rate == 0) {
+            return 1;
+        }
+        agency_get_numa_stats(&stats);
+        printf("%10u %14.0f %14zu\n", stats.replicas, rate, stats.replica_bytes);
+        print_pattern(num_threads);
+    }
+
+    return 0;
+}
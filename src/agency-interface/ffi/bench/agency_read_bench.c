@@ -0,0 +1,132 @@
+/**
+ * @file agency_read_bench.c
+ * @brief Read-path throughput against reader threads.
+ *
+ * Each reader thread calls the configuration getters in a fixed mix
+ * (agency_get_context(), agency_get_context_conditional() with a current
+ * hash, agency_get_all_agencies() and agency_get_agencies_by_tier() and
+ * _by_domain()) for a fixed number of rounds, and frees what it gets. The
+ * bench reports total calls per second for 1, 2, 4, ... 64 threads and the
+ * speedup over one thread; with every getter served from the immutable
+ * snapshot, throughput should grow with threads up to the online CPUs.
+ *
+ * Build from the ffi directory against the library:
+ *
+ *     cc -O2 -pthread -Ic -o agency_read_bench bench/agency_read_bench.c \
+ *        -Lc -lagency_ffi -ljson-c
+ *
+ * and run it from the ffi directory, so the configuration resolves:
+ *
+ *     ./agency_read_bench [max_threads] [rounds]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "agency_internal.h"
+
+#define BENCH_MAX_THREADS 64
+
+// Getter calls per round
+#define BENCH_CALLS_PER_ROUND 6
+
+static const char* g_agencies[] = {"HHS", "DOD", "EPA", "NASA", "DOE", "USDA", "SSA", "XYZ"};
+static const char* g_domains[] = {"healthcare", "defense", "environment", "space", "nope"};
+
+static size_t g_rounds = 20000;
+static pthread_barrier_t g_start;
+
+// When each reader started and finished; the run spans the earliest to the latest
+static double g_started[BENCH_MAX_THREADS];
+static double g_finished[BENCH_MAX_THREADS];
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Body of each reader thread.
+ */
+static void* reader_main(void* arg) {
+    size_t seed = (size_t)(uintptr_t)arg;
+    const size_t num_agencies = sizeof(g_agencies) / sizeof(g_agencies[0]);
+    const size_t num_domains = sizeof(g_domains) / sizeof(g_domains[0]);
+
+    pthread_barrier_wait(&g_start);
+    g_started[seed] = now_seconds();
+    for (size_t i = 0; i < g_rounds; i++) {
+        const char* agency = g_agencies[(seed + i) % num_agencies];
+        uint64_t hash = 0;
+        char* context = NULL;
+
+        free(agency_get_context(agency));
+        agency_get_context_conditional(agency, 0, &context, &hash);
+        free(context);
+        agency_get_context_conditional(agency, hash, &context, &hash);
+        free(context);
+        free(agency_get_all_agencies());
+        free(agency_get_agencies_by_tier((int)((seed + i) % 4)));
+        free(agency_get_agencies_by_domain(g_domains[(seed + i) % num_domains]));
+    }
+    g_finished[seed] = now_seconds();
+    return NULL;
+}
+
+/**
+ * @brief Run the mix on some threads.
+ *
+ * @return Calls per second over all threads.
+ */
+static double run(size_t num_threads) {
+    pthread_t threads[BENCH_MAX_THREADS];
+    pthread_barrier_init(&g_start, NULL, (unsigned)num_threads + 1);
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_create(&threads[t], NULL, reader_main, (void*)(uintptr_t)t);
+    }
+
+    pthread_barrier_wait(&g_start);
+    double start = 0;
+    double end = 0;
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+        if (t == 0 || g_started[t] < start) {
+            start = g_started[t];
+        }
+        if (g_finished[t] > end) {
+            end = g_finished[t];
+        }
+    }
+    pthread_barrier_destroy(&g_start);
+
+    return (double)(num_threads * g_rounds * BENCH_CALLS_PER_ROUND) / (end - start);
+}
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_MAX_THREADS;
+    if (argc > 2) {
+        g_rounds = strtoul(argv[2], NULL, 10);
+    }
+    if (max_threads == 0 || max_threads > BENCH_MAX_THREADS) {
+        max_threads = BENCH_MAX_THREADS;
+    }
+
+    // Load the configuration outside the timed runs
+    if (agency_load_config() == NULL) {
+        return 1;
+    }
+
+    printf("%8s %14s %9s\n", "threads", "calls/s", "speedup");
+    double single = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double rate = run(threads);
+        if (threads == 1) {
+            single = rate;
+        }
+        printf("%8zu %14.0f %8.2fx\n", threads, rate, rate / single);
+    }
+
+    return 0;
+}
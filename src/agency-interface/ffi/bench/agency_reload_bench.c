@@ -0,0 +1,134 @@
+/**
+ * @file agency_reload_bench.c
+ * @brief Read and reload throughput while both run at once.
+ *
+ * For 1, 2, 4, ... reader threads, runs the readers for a fixed time twice:
+ * once alone, and once with a writer thread calling agency_reload_config()
+ * back to back. Readers call agency_get_context() and
+ * agency_get_all_agencies() and free the results. The bench reports reads
+ * per second in both runs, reloads per second, and how many replaced
+ * snapshots were still waiting to be freed when the run ended.
+ *
+ * Build from the ffi directory against the library:
+ *
+ *     cc -O2 -pthread -Ic -o agency_reload_bench bench/agency_reload_bench.c \
+ *        -Lc -lagency_ffi -ljson-c
+ *
+ * and run it from the ffi directory, so the configuration resolves:
+ *
+ *     ./agency_reload_bench [max_readers] [milliseconds]
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "agency_internal.h"
+
+#define BENCH_MAX_READERS 64
+
+static const char* g_agencies[] = {"HHS", "DOD", "EPA", "NASA", "DOE", "USDA", "SSA", "XYZ"};
+
+static atomic_int g_stop;
+static uint64_t g_reads[BENCH_MAX_READERS];
+static uint64_t g_reloads;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Body of each reader thread.
+ */
+static void* reader_main(void* arg) {
+    size_t id = (size_t)(uintptr_t)arg;
+    const size_t num_agencies = sizeof(g_agencies) / sizeof(g_agencies[0]);
+    uint64_t reads = 0;
+
+    while (!atomic_load_explicit(&g_stop, memory_order_relaxed)) {
+        free(agency_get_context(g_agencies[(id + reads) % num_agencies]));
+        free(agency_get_all_agencies());
+        reads += 2;
+    }
+    g_reads[id] = reads;
+    return NULL;
+}
+
+/**
+ * @brief Body of the writer thread.
+ */
+static void* writer_main(void* arg) {
+    (void)arg;
+    uint64_t reloads = 0;
+
+    while (!atomic_load_explicit(&g_stop, memory_order_relaxed)) {
+        if (agency_reload_config() == AGENCY_STATUS_OK) {
+            reloads++;
+        }
+    }
+    g_reloads = reloads;
+    return NULL;
+}
+
+/**
+ * @brief Run the readers, and the writer if asked, for some time.
+ *
+ * @return Reads per second over all readers.
+ */
+static double run(size_t num_readers, int reload, double seconds) {
+    pthread_t readers[BENCH_MAX_READERS];
+    pthread_t writer;
+
+    atomic_store(&g_stop, 0);
+    g_reloads = 0;
+    for (size_t t = 0; t < num_readers; t++) {
+        pthread_create(&readers[t], NULL, reader_main, (void*)(uintptr_t)t);
+    }
+    if (reload) {
+        pthread_create(&writer, NULL, writer_main, NULL);
+    }
+
+    struct timespec duration = {(time_t)seconds, (long)((seconds - (double)(time_t)seconds) * 1e9)};
+    double start = now_seconds();
+    nanosleep(&duration, NULL);
+    atomic_store(&g_stop, 1);
+
+    uint64_t reads = 0;
+    for (size_t t = 0; t < num_readers; t++) {
+        pthread_join(readers[t], NULL);
+        reads += g_reads[t];
+    }
+    if (reload) {
+        pthread_join(writer, NULL);
+    }
+    return (double)reads / (now_seconds() - start);
+}
+
+int main(int argc, char** argv) {
+    size_t max_readers = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    double seconds = argc > 2 ? strtod(argv[2], NULL) / 1000.0 : 0.5;
+    if (max_readers == 0 || max_readers > BENCH_MAX_READERS) {
+        max_readers = BENCH_MAX_READERS;
+    }
+
+    // Load the configuration outside the timed runs
+    if (agency_load_config() == NULL) {
+        return 1;
+    }
+
+    printf("%8s %14s %14s %10s %8s\n", "readers", "reads/s", "with reload", "reloads/s", "pending");
+    for (size_t readers = 1; readers <= max_readers; readers *= 2) {
+        double quiet = run(readers, 0, seconds);
+        double contended = run(readers, 1, seconds);
+
+        agency_reload_stats stats;
+        agency_get_reload_stats(&stats);
+        printf("%8zu %14.0f %14.0f %10.0f %8llu\n", readers, quiet, contended,
+               (double)g_reloads / seconds, (unsigned long long)(stats.retired - stats.reclaimed));
+    }
+
+    return 0;
+}
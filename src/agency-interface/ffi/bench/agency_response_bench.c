@@ -0,0 +1,133 @@
+/**
+ * @file agency_response_bench.c
+ * @brief Response-building cost: calls per second and heap allocations per call.
+ *
+ * Runs each response-building call a fixed number of times on one thread,
+ * after a few warm-up calls, and reports calls per second and the heap
+ * allocations and bytes each call made. The bench counts allocations by
+ * interposing malloc(), calloc() and realloc() over the whole process, so
+ * json-c's allocations count as well as the library's; it therefore needs
+ * glibc. A call that builds its response in the thread's arena should show
+ * one allocation, its result, or none when it writes to the caller's buffer.
+ *
+ * Build from the ffi directory against the library:
+ *
+ *     cc -O2 -pthread -Ic -o agency_response_bench bench/agency_response_bench.c \
+ *        -Lc -lagency_ffi -ljson-c
+ *
+ * and run it from the ffi directory, so the configuration resolves:
+ *
+ *     ./agency_response_bench [calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "agency_internal.h"
+
+// glibc's own allocator, which the interposed functions forward to
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static int g_counting;
+static unsigned long long g_allocations;
+static unsigned long long g_bytes;
+
+static void count(size_t size) {
+    if (g_counting) {
+        g_allocations++;
+        g_bytes += size;
+    }
+}
+
+void* malloc(size_t size) {
+    count(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size) {
+    count(num * size);
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    count(size);
+    return __libc_realloc(ptr, size);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char g_issue[64 * 1024];
+static char g_report[256 * 1024];
+
+static void call_all_agencies(void) {
+    agency_free_context(agency_get_all_agencies());
+}
+
+static void call_context(void) {
+    agency_free_context(agency_get_context("HHS"));
+}
+
+static void call_match(void) {
+    agency_free_context(agency_match_issue(g_issue));
+}
+
+static void call_report(void) {
+    size_t length = 0;
+    agency_verify_issue_report("HHS", g_issue, AGENCY_REPORT_JSON, g_report, sizeof(g_report), &length);
+}
+
+/**
+ * @brief Time one call and count its allocations.
+ */
+static void run(const char* name, void (*call)(void), size_t calls) {
+    for (size_t i = 0; i < 16; i++) {
+        call();
+    }
+
+    g_allocations = 0;
+    g_bytes = 0;
+    g_counting = 1;
+    double start = now_seconds();
+    for (size_t i = 0; i < calls; i++) {
+        call();
+    }
+    double elapsed = now_seconds() - start;
+    g_counting = 0;
+
+    printf("%-16s %12.0f %14.2f %14.0f\n", name, (double)calls / elapsed,
+           (double)g_allocations / (double)calls, (double)g_bytes / (double)calls);
+}
+
+int main(int argc, char** argv) {
+    size_t calls = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    if (calls == 0) {
+        calls = 1;
+    }
+
+    // An issue mentioning several theorems and topics, so the match lists grow
+    snprintf(g_issue, sizeof(g_issue),
+             "{\"id\": 1, \"title\": \"Patient privacy and national security\", "
+             "\"description\": \"Protected health information, data security, clinical trials, "
+             "information assurance and environmental compliance for the program.\", "
+             "\"affected_areas\": [\"security\", \"privacy\"]}");
+
+    // Load the configuration and build the matcher outside the timed runs
+    if (agency_load_config() == NULL) {
+        return 1;
+    }
+    call_match();
+
+    printf("%-16s %12s %14s %14s\n", "call", "calls/s", "allocs/call", "bytes/call");
+    run("all_agencies", call_all_agencies, calls);
+    run("context", call_context, calls);
+    run("match_issue", call_match, calls);
+    run("report_json", call_report, calls);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file agency_scan_bench.c
+ * @brief Parse throughput of the structural scanner against json-c.
+ *
+ * Reads an NDJSON issue corpus and reports, in GB/s over the corpus bytes:
+ * the structural index alone and full agency_verify_json() for each scanner
+ * implementation the CPU supports, and json-c's tokenizer building a tree
+ * for the same lines. Each figure is the best of several passes, on one
+ * thread.
+ *
+ * Build from the ffi directory against the library:
+ *
+ *     cc -O2 -pthread -Ic -o agency_scan_bench bench/agency_scan_bench.c \
+ *        -Lc -lagency_ffi -ljson-c
+ *
+ * and run it from the ffi directory, so the configuration resolves:
+ *
+ *     ./agency_scan_bench issues.ndjson [agency]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "agency_internal.h"
+
+#define BENCH_PASSES 5
+
+typedef struct {
+    const char* start;
+    size_t length;
+} bench_line;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t split_lines(char* data, size_t length, bench_line** out) {
+    size_t count = 0;
+    size_t capacity = 1024;
+    bench_line* lines = (bench_line*)malloc(capacity * sizeof(bench_line));
+
+    char* p = data;
+    char* end = data + length;
+    while (lines != NULL && p < end) {
+        char* newline = (char*)memchr(p, '\n', (size_t)(end - p));
+        char* line_end = newline != NULL ? newline : end;
+        if (line_end > p) {
+            if (count == capacity) {
+                capacity *= 2;
+                bench_line* grown = (bench_line*)realloc(lines, capacity * sizeof(bench_line));
+                if (grown == NULL) {
+                    free(lines);
+                    return 0;
+                }
+                lines = grown;
+            }
+            lines[count].start = p;
+            lines[count].length = (size_t)(line_end - p);
+            count++;
+        }
+        p = line_end + 1;
+    }
+
+    *out = lines;
+    return count;
+}
+
+static size_t run_index(const bench_line* lines, size_t count) {
+    size_t tokens = 0;
+    for (size_t i = 0; i < count; i++) {
+        agency_scanner scanner;
+        agency_scanner_init(&scanner, lines[i].start, lines[i].length);
+        while (agency_scanner_next(&scanner) < lines[i].length) {
+            tokens++;
+        }
+    }
+    return tokens;
+}
+
+static size_t run_verify(const bench_line* lines, size_t count, const char* agency) {
+    const agency_schema* schema = agency_schema_for_agency(agency);
+    const agency_theorem_domain* theorems = agency_theorems_for_agency(agency);
+    size_t valid = 0;
+    for (size_t i = 0; i < count; i++) {
+        valid += agency_verify_json(schema, theorems, lines[i].start, lines[i].length) > 0;
+    }
+    return valid;
+}
+
+static size_t run_json_c(const bench_line* lines, size_t count) {
+    json_tokener* tokener = json_tokener_new();
+    size_t parsed = 0;
+    for (size_t i = 0; i < count; i++) {
+        json_tokener_reset(tokener);
+        json_object* obj = json_tokener_parse_ex(tokener, lines[i].start, (int)lines[i].length);
+        if (obj != NULL) {
+            parsed++;
+            json_object_put(obj);
+        }
+    }
+    json_tokener_free(tokener);
+    return parsed;
+}
+
+typedef enum { BENCH_INDEX, BENCH_VERIFY, BENCH_JSON_C } bench_kind;
+
+static void report(const char* name, bench_kind kind, const bench_line* lines, size_t count,
+                   size_t bytes, const char* agency) {
+    double best = 0.0;
+    size_t result = 0;
+
+    for (int pass = 0; pass < BENCH_PASSES; pass++) {
+        double start = now_seconds();
+        switch (kind) {
+        case BENCH_INDEX: result = run_index(lines, count); break;
+        case BENCH_VERIFY: result = run_verify(lines, count, agency); break;
+        case BENCH_JSON_C: result = run_json_c(lines, count); break;
+        }
+        double elapsed = now_seconds() - start;
+        if (pass == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    printf("%-24s %8.3f GB/s %12.0f lines/s  (result %zu)\n", name, (double)bytes / best / 1e9,
+           (double)count / best, result);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s issues.ndjson [agency]\n", argv[0]);
+        return 2;
+    }
+    const char* agency = argc > 2 ? argv[2] : "HHS";
+
+    size_t length = 0;
+    char* data = agency_read_file(argv[1], &length);
+    if (data == NULL) {
+        return 1;
+    }
+    bench_line* lines = NULL;
+    size_t count = split_lines(data, length, &lines);
+    if (count == 0) {
+        fprintf(stderr, "No issues in %s\n", argv[1]);
+        free(data);
+        return 1;
+    }
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bytes += lines[i].length;
+    }
+    printf("%zu issues, %.1f MB, agency %s, default scanner %s\n", count, (double)bytes / 1e6, agency,
+           agency_scan_isa());
+
+    // Warm the configuration, schema and theorem caches outside the timings
+    run_verify(lines, 1, agency);
+
+    static const char* const isas[] = {"avx2", "sse4.2", "scalar"};
+    for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); i++) {
+        if (agency_scan_select(isas[i]) != 0) {
+            continue;
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "index/%s", isas[i]);
+        report(name, BENCH_INDEX, lines, count, bytes, agency);
+        snprintf(name, sizeof(name), "verify/%s", isas[i]);
+        report(name, BENCH_VERIFY, lines, count, bytes, agency);
+    }
+    report("json-c tokener", BENCH_JSON_C, lines, count, bytes, agency);
+
+    free(lines);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file agency_store_bench.c
+ * @brief Size and read latency of the compressed resource store.
+ *
+ * Reads every file-backed resource of every agency three ways, over a fixed
+ * number of rounds: from the file (the page cache, once warm) before the
+ * store is loaded; from the store, cycling over more resources than the
+ * per-thread cache holds so each read decompresses; and from the store,
+ * reading one resource over and over so each read is a cache hit. It
+ * reports the store's size against the raw resources and the mean time per
+ * read of each way.
+ *
+ * Build from the ffi directory against the library:
+ *
+ *     cc -O2 -pthread -Ic -o agency_store_bench bench/agency_store_bench.c \
+ *        -Lc -lagency_ffi -ljson-c
+ *
+ * and run it from the ffi directory, so the configuration resolves:
+ *
+ *     ./agency_store_bench [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "agency_internal.h"
+
+// Resources the bench reads; the configuration holds fewer
+#define BENCH_MAX_RESOURCES 4096
+
+typedef struct {
+    const char* agency;
+    agency_resource_kind kind;
+} bench_resource;
+
+static bench_resource g_resources[BENCH_MAX_RESOURCES];
+static size_t g_num_resources = 0;
+static size_t g_rounds = 20;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Read a resource the way the getters do.
+ */
+static char* read_resource(const bench_resource* resource) {
+    switch (resource->kind) {
+    case AGENCY_RESOURCE_ISSUE_FINDER:
+        return agency_get_issue_finder(resource->agency);
+    case AGENCY_RESOURCE_RESEARCH_CONNECTOR:
+        return agency_get_research_connector(resource->agency);
+    default:
+        return agency_get_ascii_art(resource->agency);
+    }
+}
+
+/**
+ * @brief Note every resource the configuration's agencies have.
+ */
+static void collect_resources(void) {
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    for (size_t i = 0; i < snapshot->num_entries; i++) {
+        const char* agency = agency_snapshot_string(snapshot, snapshot->entries[i].acronym);
+        for (int kind = 0; kind < AGENCY_RESOURCE_COUNT && g_num_resources < BENCH_MAX_RESOURCES; kind++) {
+            if (agency_manifest_path(agency, (agency_resource_kind)kind) != NULL) {
+                g_resources[g_num_resources++] = (bench_resource){agency, (agency_resource_kind)kind};
+            }
+        }
+    }
+}
+
+/**
+ * @return Mean microseconds per read from the files.
+ */
+static double time_files(void) {
+    // One pass to warm the page cache
+    for (size_t i = 0; i < g_num_resources; i++) {
+        free(read_resource(&g_resources[i]));
+    }
+    double start = now_seconds();
+    for (size_t round = 0; round < g_rounds; round++) {
+        for (size_t i = 0; i < g_num_resources; i++) {
+            free(read_resource(&g_resources[i]));
+        }
+    }
+    return (now_seconds() - start) * 1e6 / (double)(g_rounds * g_num_resources);
+}
+
+/**
+ * @return Mean microseconds per read from the store; @p hits reads one
+ *         resource throughout, so each read after the first is a cache hit.
+ */
+static double time_store(int hits) {
+    const char* data;
+    size_t length;
+    double start = now_seconds();
+    for (size_t round = 0; round < g_rounds; round++) {
+        for (size_t i = 0; i < g_num_resources; i++) {
+            const bench_resource* resource = &g_resources[hits ? 0 : i];
+            agency_store_get(resource->agency, resource->kind, &data, &length);
+        }
+    }
+    return (now_seconds() - start) * 1e6 / (double)(g_rounds * g_num_resources);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        g_rounds = strtoul(argv[1], NULL, 10);
+    }
+
+    if (agency_load_config() == NULL) {
+        return 1;
+    }
+    collect_resources();
+    if (g_num_resources == 0) {
+        fprintf(stderr, "Error: no resources to read\n");
+        return 1;
+    }
+
+    double file_us = time_files();
+    if (agency_store_preload() != AGENCY_STATUS_OK) {
+        return 1;
+    }
+    double miss_us = time_store(0);
+    double hit_us = time_store(1);
+
+    agency_store_stats stats;
+    agency_get_store_stats(&stats);
+    printf("%zu resources, %zu raw bytes, %zu compressed (%.1f%%), %zu arena bytes\n", stats.resources,
+           stats.raw_bytes, stats.compressed_bytes, 100.0 * (double)stats.compressed_bytes / (double)stats.raw_bytes,
+           stats.arena_bytes);
+    printf("%16s %12s\n", "read", "us/read");
+    printf("%16s %12.2f\n", "file", file_us);
+    printf("%16s %12.2f\n", "store, miss", miss_us);
+    printf("%16s %12.3f\n", "store, hit", hit_us);
+    printf("%llu hits, %llu misses, %.2f us decompressing per miss\n", (unsigned long long)stats.hot_hits,
+           (unsigned long long)stats.hot_misses,
+           stats.hot_misses != 0 ? (double)stats.decompress_ns / 1e3 / (double)stats.hot_misses : 0.0);
+    return 0;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file agency_theorem_bench.c
+ * @brief Single-issue verification latency against pool threads.
+ *
+ * Builds one large issue per description size, half of them passing every
+ * theorem, and verifies each repeatedly through agency_verify_issue() with
+ * the verdict cache cleared, so every call evaluates the theorems. Reports
+ * the median and 99th percentile latency for 1, 2, 4, ... threads up to
+ * the online CPUs, with the cutoff set so every size runs on the pool.
+ *
+ * Build from the ffi directory against the library:
+ *
+ *     cc -O2 -pthread -Ic -o agency_theorem_bench bench/agency_theorem_bench.c \
+ *        -Lc -lagency_ffi -ljson-c
+ *
+ * and run it from the ffi directory, so the configuration resolves:
+ *
+ *     ./agency_theorem_bench [agency]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+#define BENCH_RUNS 200
+
+static const size_t g_sizes[] = {64 << 10, 1 << 20, 8 << 20};
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Build an issue whose description has every keyword near its end.
+ */
+static char* build_issue(const agency_theorem_domain* domain, size_t size, int valid) {
+    char* issue = (char*)malloc(size + 4096 + domain->pool_size);
+    if (issue == NULL) {
+        return NULL;
+    }
+
+    char* p = issue + sprintf(issue, "{\"id\": 1, \"title\": \"t\", \"affected_areas\": [], \"description\": \"");
+    for (size_t i = 0; i < size; i++) {
+        *p++ = (i % 8 == 7) ? ' ' : (char)('a' + (i * 7) % 26);
+    }
+    // An invalid issue lacks the last keyword, so it is searched to the end
+    size_t keywords = valid ? domain->num_keywords : domain->num_keywords - 1;
+    for (size_t k = 0; k < keywords; k++) {
+        *p++ = ' ';
+        memcpy(p, domain->pool + domain->keywords[k].offset, domain->keywords[k].length);
+        p += domain->keywords[k].length;
+    }
+    strcpy(p, "\"}");
+    return issue;
+}
+
+int main(int argc, char** argv) {
+    const char* agency = argc > 1 ? argv[1] : "HHS";
+    const agency_theorem_domain* domain = agency_theorems_for_agency(agency);
+    if (domain == NULL || domain->num_keywords == 0) {
+        fprintf(stderr, "No theorems for %s\n", agency);
+        return 1;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    double* latencies = (double*)malloc(BENCH_RUNS * sizeof(double));
+    if (latencies == NULL) {
+        return 1;
+    }
+
+    printf("%-10s %8s %12s %12s\n", "size", "threads", "p50 us", "p99 us");
+    for (size_t s = 0; s < sizeof(g_sizes) / sizeof(g_sizes[0]); s++) {
+        char* issues[2] = {build_issue(domain, g_sizes[s], 1), build_issue(domain, g_sizes[s], 0)};
+        if (issues[0] == NULL || issues[1] == NULL) {
+            return 1;
+        }
+
+        for (long threads = 1; threads <= (cpus > 0 ? cpus : 1); threads *= 2) {
+            agency_set_theorem_parallelism((size_t)threads, 1);
+            for (int run = 0; run < BENCH_RUNS; run++) {
+                agency_verdict_cache_clear();
+                double start = now_us();
+                agency_verify_issue(agency, issues[run % 2]);
+                latencies[run] = now_us() - start;
+            }
+            qsort(latencies, BENCH_RUNS, sizeof(double), compare_doubles);
+            printf("%-10zu %8ld %12.1f %12.1f\n", g_sizes[s], threads, latencies[BENCH_RUNS / 2],
+                   latencies[BENCH_RUNS * 99 / 100]);
+        }
+
+        free(issues[0]);
+        free(issues[1]);
+    }
+
+    free(latencies);
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file agency_alloc.c
+ * @brief The allocator every library allocation goes through.
+ *
+ * By default blocks come from the C library. An embedder may substitute its
+ * own allocator with agency_set_allocator() before the library first
+ * allocates; after that the allocator is fixed, so a block is always freed
+ * by the allocator that made it.
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "agency_internal.h"
+
+static void* libc_alloc(size_t size, void* ctx) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void* libc_realloc(void* ptr, size_t size, void* ctx) {
+    (void)ctx;
+    return realloc(ptr, size);
+}
+
+static void libc_free(void* ptr, void* ctx) {
+    (void)ctx;
+    free(ptr);
+}
+
+static struct {
+    agency_alloc_fn alloc;
+    agency_realloc_fn realloc;
+    agency_free_fn free;
+    void* ctx;
+} g_allocator = {libc_alloc, libc_realloc, libc_free, NULL};
+
+// Set on the first allocation; the allocator cannot change after it
+static atomic_bool g_allocated;
+
+/**
+ * @brief Record that the library has allocated, touching the flag only once.
+ */
+static inline void mark_allocated(void) {
+    if (!atomic_load_explicit(&g_allocated, memory_order_relaxed)) {
+        atomic_store(&g_allocated, 1);
+    }
+}
+
+int agency_set_allocator(agency_alloc_fn alloc_fn, agency_realloc_fn realloc_fn, agency_free_fn free_fn, void* ctx) {
+    if (alloc_fn == NULL && realloc_fn == NULL && free_fn == NULL) {
+        alloc_fn = libc_alloc;
+        realloc_fn = libc_realloc;
+        free_fn = libc_free;
+        ctx = NULL;
+    } else if (alloc_fn == NULL || realloc_fn == NULL || free_fn == NULL) {
+        fprintf(stderr, "Error setting allocator: alloc, realloc and free must all be given\n");
+        return AGENCY_STATUS_ERROR;
+    }
+
+    if (atomic_load(&g_allocated)) {
+        fprintf(stderr, "Error setting allocator: the library has already allocated memory\n");
+        return AGENCY_STATUS_ERROR;
+    }
+
+    g_allocator.alloc = alloc_fn;
+    g_allocator.realloc = realloc_fn;
+    g_allocator.free = free_fn;
+    g_allocator.ctx = ctx;
+    return AGENCY_STATUS_OK;
+}
+
+void* agency_malloc(size_t size) {
+    mark_allocated();
+    return g_allocator.alloc(size, g_allocator.ctx);
+}
+
+void* agency_calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    void* ptr = agency_malloc(count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void* agency_realloc(void* ptr, size_t size) {
+    mark_allocated();
+    return g_allocator.realloc(ptr, size, g_allocator.ctx);
+}
+
+void agency_free(void* ptr) {
+    if (ptr != NULL) {
+        g_allocator.free(ptr, g_allocator.ctx);
+    }
+}
+
+char* agency_strndup(const char* str, size_t length) {
+    char* copy = (char*)agency_malloc(length + 1);
+    if (copy != NULL) {
+        memcpy(copy, str, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+char* agency_strdup(const char* str) {
+    return agency_strndup(str, strlen(str));
+}
+
+void agency_release_free_memory(void) {
+#ifdef __GLIBC__
+    // A host allocator manages its own memory; only glibc's is trimmed here
+    if (g_allocator.free == libc_free) {
+        malloc_trim(0);
+    }
+#endif
+}
@@ -0,0 +1,160 @@
+/**
+ * @file agency_arena.c
+ * @brief Per-thread bump arenas for the temporary state of one call.
+ *
+ * A call that builds a response takes its thread's arena with
+ * agency_arena_begin(), allocates from it without freeing, and gives it back
+ * with agency_arena_end(); everything allocated in between is released at
+ * once when the outermost call ends. The arena keeps one block between
+ * calls, sized to what the busiest call needed, so a thread in steady state
+ * allocates nothing from the heap for its temporary state. Over the arenas'
+ * memory ceiling, a thread instead gives its blocks back as its call ends.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "agency_internal.h"
+
+// Size of the first block, and of later ones unless an allocation needs more
+#define ARENA_BLOCK_SIZE (16 * 1024)
+
+// Largest block a thread keeps between calls
+#define ARENA_MAX_RETAINED (1024 * 1024)
+
+typedef struct arena_block {
+    struct arena_block* next;
+    size_t used;
+    size_t size;
+    unsigned char data[];
+} arena_block;
+
+struct agency_arena {
+    arena_block* blocks;  // most recent first
+    unsigned depth;       // nested calls inside
+    size_t call_bytes;    // bytes allocated since the outermost call began
+    size_t block_size;    // size of the next first block
+};
+
+static pthread_key_t g_arena_key;
+static pthread_once_t g_arena_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Free every block of an arena.
+ *
+ * @return The number of blocks freed.
+ */
+static uint64_t free_blocks(agency_arena* arena) {
+    uint64_t freed = 0;
+    int64_t bytes = 0;
+    while (arena->blocks != NULL) {
+        arena_block* next = arena->blocks->next;
+        bytes += (int64_t)(sizeof(arena_block) + arena->blocks->size);
+        agency_free(arena->blocks);
+        arena->blocks = next;
+        freed++;
+    }
+    agency_memory_charge(AGENCY_MEMORY_ARENAS, -bytes, 0);
+    return freed;
+}
+
+static void arena_destroy(void* ptr) {
+    agency_arena* arena = (agency_arena*)ptr;
+    free_blocks(arena);
+    agency_free(arena);
+    agency_memory_charge(AGENCY_MEMORY_ARENAS, -(int64_t)sizeof(agency_arena), -1);
+}
+
+static void arena_key_create(void) {
+    pthread_key_create(&g_arena_key, arena_destroy);
+}
+
+agency_arena* agency_arena_begin(void) {
+    pthread_once(&g_arena_key_once, arena_key_create);
+
+    agency_arena* arena = (agency_arena*)pthread_getspecific(g_arena_key);
+    if (arena == NULL) {
+        arena = (agency_arena*)agency_calloc(1, sizeof(agency_arena));
+        if (arena == NULL) {
+            fprintf(stderr, "Error allocating response arena\n");
+            return NULL;
+        }
+        if (pthread_setspecific(g_arena_key, arena) != 0) {
+            agency_free(arena);
+            return NULL;
+        }
+        arena->block_size = ARENA_BLOCK_SIZE;
+        agency_memory_charge(AGENCY_MEMORY_ARENAS, (int64_t)sizeof(agency_arena), 1);
+    }
+
+    arena->depth++;
+    return arena;
+}
+
+void agency_arena_end(agency_arena* arena) {
+    if (arena == NULL || --arena->depth > 0) {
+        return;
+    }
+
+    if (arena->blocks != NULL && agency_memory_over_limit(AGENCY_MEMORY_ARENAS)) {
+        // Over the ceiling, the next call starts again from a first-sized block
+        agency_memory_evicted(AGENCY_MEMORY_ARENAS, free_blocks(arena));
+        arena->block_size = ARENA_BLOCK_SIZE;
+    } else if (arena->blocks != NULL &&
+               (arena->blocks->next != NULL || arena->blocks->size > ARENA_MAX_RETAINED)) {
+        // A call that overflowed the block gets one big enough for it next time
+        free_blocks(arena);
+        size_t size = arena->call_bytes;
+        arena->block_size = size < ARENA_BLOCK_SIZE ? ARENA_BLOCK_SIZE :
+                            size > ARENA_MAX_RETAINED ? ARENA_MAX_RETAINED : size;
+    } else if (arena->blocks != NULL) {
+        arena->blocks->used = 0;
+    }
+    arena->call_bytes = 0;
+}
+
+void* agency_arena_alloc(agency_arena* arena, size_t size) {
+    size = (size + 7) & ~(size_t)7;
+
+    arena_block* block = arena->blocks;
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+        block = (arena_block*)agency_malloc(sizeof(arena_block) + block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->used = 0;
+        block->size = block_size;
+        block->next = arena->blocks;
+        arena->blocks = block;
+        agency_memory_charge(AGENCY_MEMORY_ARENAS, (int64_t)(sizeof(arena_block) + block_size), 0);
+    }
+
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->call_bytes += size;
+    return ptr;
+}
+
+void* agency_arena_grow(agency_arena* arena, void* ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL) {
+        return agency_arena_alloc(arena, new_size);
+    }
+
+    // The latest allocation can grow in place while its block has room
+    size_t old_rounded = (old_size + 7) & ~(size_t)7;
+    size_t new_rounded = (new_size + 7) & ~(size_t)7;
+    arena_block* block = arena->blocks;
+    if ((unsigned char*)ptr + old_rounded == block->data + block->used && new_rounded >= old_rounded &&
+        block->size - block->used >= new_rounded - old_rounded) {
+        block->used += new_rounded - old_rounded;
+        arena->call_bytes += new_rounded - old_rounded;
+        return ptr;
+    }
+
+    void* grown = agency_arena_alloc(arena, new_size);
+    if (grown != NULL) {
+        memcpy(grown, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return grown;
+}
@@ -0,0 +1,328 @@
+/**
+ * @file agency_async.c
+ * @brief Asynchronous resource fetches served by an internal I/O thread pool.
+ *
+ * Callers submit a request and get a ticket back immediately; the file read
+ * happens on one of the pool's threads. Results are delivered either to a
+ * completion callback or to a completion queue the caller polls, so a
+ * runtime such as Go never parks an OS thread inside a blocking read.
+ *
+ * A runtime with its own event loop waits for the queue through an eventfd
+ * the I/O threads signal, then polls without a timeout, so not even the
+ * wait parks a thread inside the library.
+ */
+
+#define _GNU_SOURCE  // clock_gettime
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "agency_internal.h"
+
+// I/O threads started when the pool is brought up implicitly
+#define ASYNC_DEFAULT_THREADS 4
+
+/**
+ * @brief A request travelling through the work queue, then the completion queue.
+ */
+typedef struct async_request {
+    char agency[AGENCY_NAME_MAX];  // empty if the name is too long to be indexed
+    agency_resource_kind kind;
+    agency_completion_fn callback;
+    agency_completion completion;
+    struct async_request* next;
+} async_request;
+
+/**
+ * @brief A FIFO of requests.
+ */
+typedef struct {
+    async_request* head;
+    async_request* tail;
+} request_queue;
+
+// Pool state, guarded by g_pool.lock
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t done_ready;
+    pthread_t* threads;
+    size_t num_threads;
+    int running;
+    int stopping;
+    request_queue work;
+    request_queue done;
+    int notify_fd;  // eventfd signalled per queued completion, or -1
+} g_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work_ready = PTHREAD_COND_INITIALIZER,
+    .done_ready = PTHREAD_COND_INITIALIZER,
+    .notify_fd = -1,
+};
+
+static atomic_uint_fast64_t g_next_ticket = 1;
+
+/**
+ * @brief Append a request to a queue.
+ */
+static void queue_push(request_queue* queue, async_request* request) {
+    request->next = NULL;
+    if (queue->tail != NULL) {
+        queue->tail->next = request;
+    } else {
+        queue->head = request;
+    }
+    queue->tail = request;
+}
+
+/**
+ * @brief Remove the oldest request from a queue.
+ *
+ * @return The request, or NULL if the queue is empty.
+ */
+static async_request* queue_pop(request_queue* queue) {
+    async_request* request = queue->head;
+    if (request != NULL) {
+        queue->head = request->next;
+        if (queue->head == NULL) {
+            queue->tail = NULL;
+        }
+    }
+    return request;
+}
+
+/**
+ * @brief Signal the completion eventfd, if one was asked for. Must be called
+ * with g_pool.lock held.
+ */
+static void notify_locked(void) {
+    if (g_pool.notify_fd < 0) {
+        return;
+    }
+    // Fails only with the counter about to overflow, when it is readable anyway
+    uint64_t one = 1;
+    ssize_t written = write(g_pool.notify_fd, &one, sizeof(one));
+    (void)written;
+}
+
+/**
+ * @brief Perform the read for one request and fill in its completion.
+ */
+static void run_request(async_request* request) {
+    agency_completion* completion = &request->completion;
+
+    // The first lookup builds the manifest, which is filesystem work too
+    agency_epoch_record* epoch = agency_epoch_enter();
+    agency_resource* resource = agency_manifest_lookup(request->agency, request->kind);
+    if (resource == NULL) {
+        completion->status = AGENCY_STATUS_NOT_FOUND;
+    } else {
+        completion->data = agency_resource_read(resource, &completion->length);
+        completion->status = completion->data != NULL ? AGENCY_STATUS_OK : AGENCY_STATUS_ERROR;
+    }
+    agency_epoch_leave(epoch);
+}
+
+/**
+ * @brief Body of each I/O thread.
+ */
+static void* io_thread_main(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&g_pool.lock);
+        while (g_pool.work.head == NULL && !g_pool.stopping) {
+            pthread_cond_wait(&g_pool.work_ready, &g_pool.lock);
+        }
+        async_request* request = queue_pop(&g_pool.work);
+        pthread_mutex_unlock(&g_pool.lock);
+
+        // Drained and asked to stop
+        if (request == NULL) {
+            break;
+        }
+
+        run_request(request);
+
+        if (request->callback != NULL) {
+            request->callback(&request->completion);
+            agency_free(request);
+            continue;
+        }
+
+        pthread_mutex_lock(&g_pool.lock);
+        queue_push(&g_pool.done, request);
+        pthread_cond_signal(&g_pool.done_ready);
+        notify_locked();
+        pthread_mutex_unlock(&g_pool.lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Start the I/O threads. Must be called with g_pool.lock held.
+ *
+ * @return AGENCY_STATUS_OK on success, AGENCY_STATUS_ERROR otherwise.
+ */
+static int start_pool_locked(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = ASYNC_DEFAULT_THREADS;
+    }
+
+    g_pool.threads = (pthread_t*)agency_calloc(num_threads, sizeof(pthread_t));
+    if (g_pool.threads == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+
+    g_pool.stopping = 0;
+    for (size_t i = 0; i < num_threads; i++) {
+        if (pthread_create(&g_pool.threads[i], NULL, io_thread_main, NULL) != 0) {
+            fprintf(stderr, "Error starting agency I/O thread\n");
+            break;
+        }
+        g_pool.num_threads++;
+    }
+
+    if (g_pool.num_threads == 0) {
+        agency_free(g_pool.threads);
+        g_pool.threads = NULL;
+        return AGENCY_STATUS_ERROR;
+    }
+
+    g_pool.running = 1;
+    return AGENCY_STATUS_OK;
+}
+
+int agency_async_init(size_t num_threads) {
+    pthread_mutex_lock(&g_pool.lock);
+    int status = g_pool.running ? AGENCY_STATUS_ERROR : start_pool_locked(num_threads);
+    pthread_mutex_unlock(&g_pool.lock);
+    return status;
+}
+
+void agency_async_shutdown(void) {
+    pthread_mutex_lock(&g_pool.lock);
+    if (!g_pool.running || g_pool.stopping) {
+        pthread_mutex_unlock(&g_pool.lock);
+        return;
+    }
+    g_pool.stopping = 1;
+    pthread_cond_broadcast(&g_pool.work_ready);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    // The threads drain the work queue before they exit
+    for (size_t i = 0; i < g_pool.num_threads; i++) {
+        pthread_join(g_pool.threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&g_pool.lock);
+    async_request* request;
+    while ((request = queue_pop(&g_pool.done)) != NULL) {
+        agency_free(request->completion.data);
+        agency_free(request);
+    }
+    agency_free(g_pool.threads);
+    g_pool.threads = NULL;
+    g_pool.num_threads = 0;
+    g_pool.running = 0;
+    g_pool.stopping = 0;
+    pthread_cond_broadcast(&g_pool.done_ready);
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+agency_ticket agency_fetch_async(const char* agency, agency_resource_kind kind,
+                                 agency_completion_fn callback, void* user_data) {
+    if (agency == NULL || kind < 0 || kind >= AGENCY_RESOURCE_COUNT) {
+        return 0;
+    }
+
+    async_request* request = (async_request*)agency_calloc(1, sizeof(async_request));
+    if (request == NULL) {
+        return 0;
+    }
+
+    // The name is resolved on the I/O thread; one too long to index misses there
+    size_t length = strlen(agency);
+    if (length < AGENCY_NAME_MAX) {
+        memcpy(request->agency, agency, length + 1);
+    }
+    request->kind = kind;
+    request->callback = callback;
+    request->completion.user_data = user_data;
+    agency_ticket ticket = atomic_fetch_add(&g_next_ticket, 1);
+    request->completion.ticket = ticket;
+
+    pthread_mutex_lock(&g_pool.lock);
+    if (g_pool.stopping ||
+        (!g_pool.running && start_pool_locked(0) != AGENCY_STATUS_OK)) {
+        pthread_mutex_unlock(&g_pool.lock);
+        agency_free(request);
+        return 0;
+    }
+    queue_push(&g_pool.work, request);
+    pthread_cond_signal(&g_pool.work_ready);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    // The request may already be completed and freed; report the saved ticket
+    return ticket;
+}
+
+int agency_poll_completions(agency_completion* completions, size_t max_completions,
+                            int timeout_ms) {
+    if (completions == NULL || max_completions == 0) {
+        return -1;
+    }
+
+    struct timespec deadline;
+    if (timeout_ms > 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&g_pool.lock);
+    while (g_pool.done.head == NULL && timeout_ms != 0 && g_pool.running) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&g_pool.done_ready, &g_pool.lock);
+        } else if (pthread_cond_timedwait(&g_pool.done_ready, &g_pool.lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+
+    size_t count = 0;
+    async_request* request;
+    while (count < max_completions && (request = queue_pop(&g_pool.done)) != NULL) {
+        completions[count++] = request->completion;
+        agency_free(request);
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+
+    return (int)count;
+}
+
+int agency_completion_fd(void) {
+    pthread_mutex_lock(&g_pool.lock);
+    if (g_pool.notify_fd < 0) {
+        g_pool.notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (g_pool.notify_fd < 0) {
+            fprintf(stderr, "Error creating agency completion eventfd\n");
+        } else if (g_pool.done.head != NULL) {
+            // Completions queued before the descriptor existed are waiting too
+            notify_locked();
+        }
+    }
+    int fd = g_pool.notify_fd;
+    pthread_mutex_unlock(&g_pool.lock);
+    return fd;
+}
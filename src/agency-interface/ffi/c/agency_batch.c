@@ -0,0 +1,417 @@
+/**
+ * @file agency_batch.c
+ * @brief Bulk verification of NDJSON issues on a pool of worker threads.
+ *
+ * The input is split into lines on the calling thread, then the workers
+ * claim runs of lines from a shared counter and write each verdict straight
+ * into its slot, so results come out in input order without any merging.
+ * The agency's schema and theorems are resolved once per window and each
+ * line goes through the verdict cache and the streaming validator, so no
+ * JSON tree is built.
+ * Descriptor input is processed in bounded windows; the workers persist
+ * across windows. The epoch that keeps the schema alive is held only while
+ * a window is verified, never across a read, so a batch blocked on its
+ * input does not hold back reclamation after a reload.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+// Lines a worker claims at a time
+#define BATCH_CLAIM 64
+
+// Bytes read from a descriptor per window; grows only for longer lines
+#define BATCH_WINDOW_BYTES (4u << 20)
+
+/**
+ * @brief One issue line inside the current window.
+ */
+typedef struct {
+    const char* start;
+    size_t length;
+} batch_line;
+
+/**
+ * @brief Shared state of one batch call.
+ */
+typedef struct {
+    const char* agency;
+
+    // Resolved for the current window, whose epoch keeps the schema's snapshot alive
+    const agency_schema* schema;
+    const agency_theorem_domain* theorems;
+    uint64_t scope;
+    agency_epoch_record* epoch;
+
+    // Current window, published under lock with a new generation
+    const batch_line* lines;
+    int8_t* verdicts;
+    size_t count;
+    atomic_size_t next;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    uint64_t generation;
+    size_t active;
+    int stopping;
+
+    pthread_t* threads;
+    size_t num_threads;
+
+    atomic_size_t valid;
+    atomic_size_t invalid;
+    atomic_size_t errors;
+} batch;
+
+/**
+ * @brief Claim and verify runs of lines until the window is exhausted.
+ */
+static void run_window(batch* b) {
+    size_t valid = 0;
+    size_t invalid = 0;
+    size_t errors = 0;
+
+    for (;;) {
+        size_t first = atomic_fetch_add_explicit(&b->next, BATCH_CLAIM, memory_order_relaxed);
+        if (first >= b->count) {
+            break;
+        }
+        size_t last = first + BATCH_CLAIM < b->count ? first + BATCH_CLAIM : b->count;
+
+        for (size_t i = first; i < last; i++) {
+            int verdict = agency_verify_cached(b->scope, b->schema, b->theorems,
+                                               b->lines[i].start, b->lines[i].length);
+            b->verdicts[i] = (int8_t)verdict;
+            if (verdict > 0) {
+                valid++;
+            } else if (verdict == 0) {
+                invalid++;
+            } else {
+                errors++;
+            }
+        }
+    }
+
+    atomic_fetch_add(&b->valid, valid);
+    atomic_fetch_add(&b->invalid, invalid);
+    atomic_fetch_add(&b->errors, errors);
+}
+
+/**
+ * @brief Body of each worker thread.
+ */
+static void* worker_main(void* arg) {
+    batch* b = (batch*)arg;
+    uint64_t seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&b->lock);
+        while (b->generation == seen && !b->stopping) {
+            pthread_cond_wait(&b->work_ready, &b->lock);
+        }
+        if (b->stopping) {
+            pthread_mutex_unlock(&b->lock);
+            break;
+        }
+        seen = b->generation;
+        pthread_mutex_unlock(&b->lock);
+
+        run_window(b);
+
+        pthread_mutex_lock(&b->lock);
+        if (--b->active == 0) {
+            pthread_cond_signal(&b->work_done);
+        }
+        pthread_mutex_unlock(&b->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Initialize a batch and start its workers.
+ *
+ * The calling thread counts as one worker, so @p num_threads - 1 threads are
+ * started. Failing to start some of them only reduces parallelism.
+ */
+static void batch_start(batch* b, const char* agency, size_t num_threads) {
+    memset(b, 0, sizeof(*b));
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->work_ready, NULL);
+    pthread_cond_init(&b->work_done, NULL);
+    b->agency = agency;
+
+    if (num_threads <= 1) {
+        return;
+    }
+
+    b->threads = (pthread_t*)agency_calloc(num_threads - 1, sizeof(pthread_t));
+    if (b->threads == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < num_threads - 1; i++) {
+        if (pthread_create(&b->threads[i], NULL, worker_main, b) != 0) {
+            fprintf(stderr, "Error starting agency batch thread\n");
+            break;
+        }
+        b->num_threads++;
+    }
+}
+
+/**
+ * @brief Stop the workers and release the batch.
+ */
+static void batch_finish(batch* b, agency_batch_summary* summary) {
+    pthread_mutex_lock(&b->lock);
+    b->stopping = 1;
+    pthread_cond_broadcast(&b->work_ready);
+    pthread_mutex_unlock(&b->lock);
+
+    for (size_t i = 0; i < b->num_threads; i++) {
+        pthread_join(b->threads[i], NULL);
+    }
+    agency_free(b->threads);
+
+    pthread_cond_destroy(&b->work_done);
+    pthread_cond_destroy(&b->work_ready);
+    pthread_mutex_destroy(&b->lock);
+
+    if (summary != NULL) {
+        summary->valid = atomic_load(&b->valid);
+        summary->invalid = atomic_load(&b->invalid);
+        summary->errors = atomic_load(&b->errors);
+        summary->issues = summary->valid + summary->invalid + summary->errors;
+    }
+}
+
+/**
+ * @brief Verify one window on every worker and the calling thread.
+ */
+static void batch_run(batch* b, const batch_line* lines, int8_t* verdicts, size_t count) {
+    // Resolved afresh so each window sees the configuration current when it starts;
+    // the scope is read first, as a reload moves the generation after the snapshot
+    b->scope = agency_verdict_scope(b->agency);
+    b->epoch = agency_epoch_enter();
+    b->schema = agency_schema_for_agency(b->agency);
+    b->theorems = agency_theorems_for_agency(b->agency);
+
+    pthread_mutex_lock(&b->lock);
+    b->lines = lines;
+    b->verdicts = verdicts;
+    b->count = count;
+    atomic_store(&b->next, 0);
+    b->active = b->num_threads;
+    b->generation++;
+    pthread_cond_broadcast(&b->work_ready);
+    pthread_mutex_unlock(&b->lock);
+
+    run_window(b);
+
+    pthread_mutex_lock(&b->lock);
+    while (b->active > 0) {
+        pthread_cond_wait(&b->work_done, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+
+    agency_epoch_leave(b->epoch);
+    b->epoch = NULL;
+}
+
+/**
+ * @brief Split a buffer into non-blank lines.
+ *
+ * @param lines Receives up to @p max_lines lines; may be NULL to only count.
+ * @return The number of non-blank lines in the buffer.
+ */
+static size_t split_lines(const char* data, size_t length, batch_line* lines, size_t max_lines) {
+    size_t count = 0;
+    const char* p = data;
+    const char* end = data + length;
+
+    while (p < end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* line_end = newline != NULL ? newline : end;
+
+        // Skip blank lines, including those holding only whitespace or "\r"
+        const char* q = p;
+        while (q < line_end && (*q == ' ' || *q == '\t' || *q == '\r')) {
+            q++;
+        }
+        if (q < line_end) {
+            if (lines != NULL && count < max_lines) {
+                lines[count].start = p;
+                lines[count].length = (size_t)(line_end - p);
+            }
+            count++;
+        }
+
+        p = newline != NULL ? newline + 1 : end;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Resolve the worker count for a request.
+ */
+static size_t resolve_threads(size_t num_threads) {
+    if (num_threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    return num_threads;
+}
+
+int agency_verify_batch(const char* agency, const char* ndjson, size_t length,
+                        size_t num_threads, int8_t* verdicts, size_t max_verdicts,
+                        agency_batch_summary* summary) {
+    if (summary != NULL) {
+        memset(summary, 0, sizeof(*summary));
+    }
+    if (agency == NULL || (ndjson == NULL && length > 0) || (verdicts == NULL && max_verdicts > 0)) {
+        return AGENCY_STATUS_ERROR;
+    }
+
+    size_t count = split_lines(ndjson, length, NULL, 0);
+    if (count > max_verdicts) {
+        if (summary != NULL) {
+            summary->issues = count;
+        }
+        return AGENCY_STATUS_ERROR;
+    }
+    if (count == 0) {
+        return AGENCY_STATUS_OK;
+    }
+
+    batch_line* lines = (batch_line*)agency_malloc(count * sizeof(batch_line));
+    if (lines == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+    split_lines(ndjson, length, lines, count);
+
+    // No point starting workers that would find nothing left to claim
+    size_t max_workers = (count + BATCH_CLAIM - 1) / BATCH_CLAIM;
+    num_threads = resolve_threads(num_threads);
+    if (num_threads > max_workers) {
+        num_threads = max_workers;
+    }
+
+    batch b;
+    batch_start(&b, agency, num_threads);
+    batch_run(&b, lines, verdicts, count);
+    batch_finish(&b, summary);
+
+    agency_free(lines);
+    return AGENCY_STATUS_OK;
+}
+
+int agency_verify_batch_fd(const char* agency, int fd, size_t num_threads,
+                           agency_verdict_writer writer, void* user_data,
+                           agency_batch_summary* summary) {
+    if (summary != NULL) {
+        memset(summary, 0, sizeof(*summary));
+    }
+    if (agency == NULL || fd < 0 || writer == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+
+    size_t capacity = BATCH_WINDOW_BYTES;
+    char* buffer = (char*)agency_malloc(capacity);
+    batch_line* lines = NULL;
+    int8_t* verdicts = NULL;
+    size_t max_lines = 0;
+    if (buffer == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+
+    batch b;
+    batch_start(&b, agency, resolve_threads(num_threads));
+
+    int status = AGENCY_STATUS_OK;
+    size_t filled = 0;
+    int at_eof = 0;
+    while (status == AGENCY_STATUS_OK && !(at_eof && filled == 0)) {
+        // Fill the window, growing it only when one line does not fit
+        if (!at_eof) {
+            if (filled == capacity) {
+                char* grown = (char*)agency_realloc(buffer, capacity * 2);
+                if (grown == NULL) {
+                    status = AGENCY_STATUS_ERROR;
+                    break;
+                }
+                buffer = grown;
+                capacity *= 2;
+            }
+            ssize_t bytes_read = read(fd, buffer + filled, capacity - filled);
+            if (bytes_read < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fprintf(stderr, "Error reading batch input\n");
+                status = AGENCY_STATUS_ERROR;
+                break;
+            }
+            if (bytes_read == 0) {
+                at_eof = 1;
+            }
+            filled += (size_t)bytes_read;
+            if (!at_eof && filled < capacity) {
+                continue;
+            }
+        }
+
+        // Verify whole lines only; a trailing partial line waits for more input
+        size_t usable = filled;
+        if (!at_eof) {
+            const char* p = buffer + filled;
+            while (p > buffer && p[-1] != '\n') {
+                p--;
+            }
+            usable = (size_t)(p - buffer);
+            if (usable == 0) {
+                continue;
+            }
+        }
+
+        size_t count = split_lines(buffer, usable, NULL, 0);
+        if (count > max_lines) {
+            batch_line* new_lines = (batch_line*)agency_realloc(lines, count * sizeof(batch_line));
+            if (new_lines != NULL) {
+                lines = new_lines;
+            }
+            int8_t* new_verdicts = (int8_t*)agency_realloc(verdicts, count);
+            if (new_verdicts != NULL) {
+                verdicts = new_verdicts;
+            }
+            if (new_lines == NULL || new_verdicts == NULL) {
+                status = AGENCY_STATUS_ERROR;
+                break;
+            }
+            max_lines = count;
+        }
+        split_lines(buffer, usable, lines, count);
+
+        if (count > 0) {
+            batch_run(&b, lines, verdicts, count);
+            if (writer(verdicts, count, user_data) != 0) {
+                status = AGENCY_STATUS_ERROR;
+            }
+        }
+
+        memmove(buffer, buffer + usable, filled - usable);
+        filled -= usable;
+    }
+
+    batch_finish(&b, summary);
+    agency_free(verdicts);
+    agency_free(lines);
+    agency_free(buffer);
+    return status;
+}
@@ -0,0 +1,432 @@
+/**
+ * @file agency_dedup.c
+ * @brief Near-duplicate issue index.
+ *
+ * Each issue is reduced to the set of three-word shingles of its title,
+ * description and affected areas, with words taken as runs of ASCII letters
+ * and digits (case-folded) or non-ASCII bytes, and the set is sketched by
+ * its MinHash signature: the minimum of each of 64 hash functions over the
+ * shingles. The fraction of positions where two signatures agree estimates
+ * the Jaccard similarity of the two sets.
+ *
+ * Lookups are sublinear by banding: the signature is cut into bands, and
+ * only issues agreeing with the query on every position of some band are
+ * compared. The band width is the widest that still finds a pair at the
+ * index's similarity threshold with at least 99% probability, which keeps
+ * dissimilar issues out of each other's buckets.
+ *
+ * The first issue indexed from a group of near-duplicates is canonical;
+ * later ones are not indexed and resolve to its id. The index only detects
+ * and reports near-duplicates: they can differ in exactly what verification
+ * checks, so each is verified on its own text, and byte-identical
+ * resubmissions are already answered by the verdict cache.
+ */
+
+#define _GNU_SOURCE  // pthread_rwlock_t
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agency_internal.h"
+
+// Words per shingle
+#define DEDUP_SHINGLE_WORDS 3
+
+// Hash functions in a signature
+#define DEDUP_HASHES 64
+
+// Bucket heads over all bands (a power of two)
+#define DEDUP_BUCKETS (1 << 18)
+
+// Longest id kept for a canonical issue
+#define DEDUP_ID_MAX 256
+
+// Probability a pair at the threshold must share a band with
+#define DEDUP_RECALL 0.99
+
+/**
+ * @brief One canonical issue.
+ */
+typedef struct {
+    uint32_t signature[DEDUP_HASHES];
+    uint32_t id_offset;
+    uint32_t id_length;
+} dedup_entry;
+
+struct agency_dedup_index {
+    int min_matches;  // signature positions that must agree
+    int rows;         // signature positions per band
+    int num_bands;
+    uint32_t band_mask;
+    uint64_t multipliers[DEDUP_HASHES];
+    uint64_t increments[DEDUP_HASHES];
+    pthread_rwlock_t lock;
+    uint32_t* buckets;  // DEDUP_BUCKETS heads, split between the bands, each an entry + 1 or 0
+    uint32_t* next;     // per entry, per band, the next entry + 1 in its bucket, or 0
+    dedup_entry* entries;
+    size_t num_entries;
+    size_t entry_capacity;
+    char* ids;
+    size_t ids_size;
+    size_t ids_capacity;
+    _Atomic(uint64_t) lookups;
+    _Atomic(uint64_t) duplicates;
+    _Atomic(uint64_t) candidates;
+};
+
+/**
+ * @brief Sketch state while an issue's fields are visited.
+ */
+typedef struct {
+    const agency_dedup_index* index;
+    uint32_t signature[DEDUP_HASHES];
+    uint64_t window[DEDUP_SHINGLE_WORDS];
+    size_t shingles;
+    char id[DEDUP_ID_MAX];
+    size_t id_length;
+} issue_sketch;
+
+static int is_word_byte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double power(double base, int exponent) {
+    double result = 1.0;
+    while (exponent-- > 0) {
+        result *= base;
+    }
+    return result;
+}
+
+static void add_shingle(issue_sketch* sketch, size_t words) {
+    const agency_dedup_index* index = sketch->index;
+    uint64_t hash = agency_hash64(sketch->window + DEDUP_SHINGLE_WORDS - words,
+                                  words * sizeof(uint64_t), 0);
+    for (int k = 0; k < DEDUP_HASHES; k++) {
+        uint32_t value = (uint32_t)((hash * index->multipliers[k] + index->increments[k]) >> 32);
+        if (value < sketch->signature[k]) {
+            sketch->signature[k] = value;
+        }
+    }
+    sketch->shingles++;
+}
+
+/**
+ * @brief Add the shingles of one field; a field shorter than a shingle is one.
+ */
+static int sketch_field(agency_issue_field field, const char* text, size_t length, void* user_data) {
+    issue_sketch* sketch = (issue_sketch*)user_data;
+
+    if (field == AGENCY_ISSUE_ID) {
+        sketch->id_length = length < DEDUP_ID_MAX ? length : DEDUP_ID_MAX - 1;
+        memcpy(sketch->id, text, sketch->id_length);
+        return 0;
+    }
+
+    size_t words = 0;
+    size_t i = 0;
+    while (i < length) {
+        while (i < length && !is_word_byte((unsigned char)text[i])) {
+            i++;
+        }
+        if (i == length) {
+            break;
+        }
+
+        // FNV-1a over the case-folded word
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        while (i < length && is_word_byte((unsigned char)text[i])) {
+            unsigned char c = (unsigned char)text[i++];
+            hash = (hash ^ (c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c)) * 0x100000001B3ULL;
+        }
+
+        memmove(sketch->window, sketch->window + 1, (DEDUP_SHINGLE_WORDS - 1) * sizeof(uint64_t));
+        sketch->window[DEDUP_SHINGLE_WORDS - 1] = hash;
+        if (++words >= DEDUP_SHINGLE_WORDS) {
+            add_shingle(sketch, DEDUP_SHINGLE_WORDS);
+        }
+    }
+    if (words > 0 && words < DEDUP_SHINGLE_WORDS) {
+        add_shingle(sketch, words);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Sketch an issue.
+ *
+ * @return 1 if the issue has text to sketch, 0 if it has none, -1 if the
+ *         JSON is malformed.
+ */
+static int sketch_issue(const agency_dedup_index* index, const char* json, issue_sketch* sketch) {
+    memset(sketch, 0, sizeof(*sketch));
+    memset(sketch->signature, 0xFF, sizeof(sketch->signature));
+    sketch->index = index;
+    if (agency_issue_visit_text(json, strlen(json), sketch_field, sketch) != 0) {
+        return -1;
+    }
+    return sketch->shingles > 0;
+}
+
+/**
+ * @brief Find the bucket of a signature in one band.
+ */
+static uint32_t* band_bucket(const agency_dedup_index* index, const uint32_t* signature, int band) {
+    uint64_t hash = agency_hash64(signature + band * index->rows,
+                                  (size_t)index->rows * sizeof(uint32_t), (uint64_t)band);
+    return &index->buckets[(size_t)band * (index->band_mask + 1) + (hash & index->band_mask)];
+}
+
+/**
+ * @brief Find the most similar canonical issue at or above the threshold.
+ *
+ * An issue sharing several bands with the query is compared once per band;
+ * comparing is cheaper than working out which band it was first seen in.
+ * Called with the lock held.
+ *
+ * @return The entry + 1, or 0 if there is none.
+ */
+static size_t find_nearest(agency_dedup_index* index, const uint32_t* signature) {
+    size_t best = 0;
+    int best_matches = index->min_matches - 1;
+    uint64_t candidates = 0;
+
+    for (int band = 0; band < index->num_bands; band++) {
+        uint32_t e = *band_bucket(index, signature, band);
+        for (; e != 0; e = index->next[(size_t)(e - 1) * index->num_bands + band]) {
+            const uint32_t* other = index->entries[e - 1].signature;
+            int matches = 0;
+            for (int k = 0; k < DEDUP_HASHES; k++) {
+                matches += other[k] == signature[k];
+            }
+            candidates++;
+            if (matches == DEDUP_HASHES) {
+                // Only one indexed issue can have the query's signature
+                atomic_fetch_add_explicit(&index->candidates, candidates, memory_order_relaxed);
+                return e;
+            }
+            // Ties go to the issue indexed first
+            if (matches > best_matches || (matches == best_matches && e < best)) {
+                best = e;
+                best_matches = matches;
+            }
+        }
+    }
+
+    atomic_fetch_add_explicit(&index->candidates, candidates, memory_order_relaxed);
+    return best;
+}
+
+/**
+ * @brief Index a canonical issue. Called with the lock held for writing.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int insert_entry(agency_dedup_index* index, const issue_sketch* sketch) {
+    if (index->num_entries == index->entry_capacity) {
+        size_t capacity = index->entry_capacity ? index->entry_capacity * 2 : 1024;
+        dedup_entry* entries = (dedup_entry*)agency_realloc(index->entries, capacity * sizeof(dedup_entry));
+        if (entries == NULL) {
+            return -1;
+        }
+        index->entries = entries;
+        uint32_t* next = (uint32_t*)agency_realloc(index->next,
+                                            capacity * (size_t)index->num_bands * sizeof(uint32_t));
+        if (next == NULL) {
+            return -1;
+        }
+        index->next = next;
+        agency_memory_charge(AGENCY_MEMORY_INDEXES, (int64_t)(capacity - index->entry_capacity) *
+                             (int64_t)(sizeof(dedup_entry) + (size_t)index->num_bands * sizeof(uint32_t)), 0);
+        index->entry_capacity = capacity;
+    }
+    if (index->ids_size + sketch->id_length > index->ids_capacity) {
+        size_t capacity = index->ids_capacity ? index->ids_capacity : 16384;
+        while (capacity < index->ids_size + sketch->id_length) {
+            capacity *= 2;
+        }
+        char* ids = (char*)agency_realloc(index->ids, capacity);
+        if (ids == NULL) {
+            return -1;
+        }
+        index->ids = ids;
+        agency_memory_charge(AGENCY_MEMORY_INDEXES, (int64_t)(capacity - index->ids_capacity), 0);
+        index->ids_capacity = capacity;
+    }
+
+    dedup_entry* entry = &index->entries[index->num_entries];
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->signature, sketch->signature, sizeof(entry->signature));
+    entry->id_offset = (uint32_t)index->ids_size;
+    entry->id_length = (uint32_t)sketch->id_length;
+    memcpy(index->ids + index->ids_size, sketch->id, sketch->id_length);
+    index->ids_size += sketch->id_length;
+
+    uint32_t* next = &index->next[index->num_entries * (size_t)index->num_bands];
+    index->num_entries++;
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, 0, 1);
+    for (int band = 0; band < index->num_bands; band++) {
+        uint32_t* bucket = band_bucket(index, entry->signature, band);
+        next[band] = *bucket;
+        *bucket = (uint32_t)index->num_entries;
+    }
+    return 0;
+}
+
+/**
+ * @brief Copy an id into the caller's buffer, truncating it to fit.
+ */
+static void copy_id(char* out, size_t capacity, const char* id, size_t length) {
+    if (out == NULL || capacity == 0) {
+        return;
+    }
+    if (length >= capacity) {
+        length = capacity - 1;
+    }
+    memcpy(out, id, length);
+    out[length] = '\0';
+}
+
+/**
+ * @brief Resolve an issue to its canonical issue, indexing it if it is new.
+ *
+ * @return 1 if a near-duplicate was indexed before, 0 if not, -1 if the
+ *         JSON is malformed or memory runs out.
+ */
+static int resolve(agency_dedup_index* index, const char* issue_json, char* canonical_id,
+                   size_t capacity) {
+    issue_sketch sketch;
+    copy_id(canonical_id, capacity, "", 0);
+
+    int status = sketch_issue(index, issue_json, &sketch);
+    if (status < 0) {
+        return -1;
+    }
+    atomic_fetch_add_explicit(&index->lookups, 1, memory_order_relaxed);
+    if (status == 0) {
+        // Nothing to compare; the issue is its own canonical issue
+        copy_id(canonical_id, capacity, sketch.id, sketch.id_length);
+        return 0;
+    }
+
+    pthread_rwlock_rdlock(&index->lock);
+    size_t nearest = find_nearest(index, sketch.signature);
+    if (nearest == 0) {
+        // Look again for an issue indexed between the two locks
+        pthread_rwlock_unlock(&index->lock);
+        pthread_rwlock_wrlock(&index->lock);
+        nearest = find_nearest(index, sketch.signature);
+        if (nearest == 0) {
+            if (sketch.id_length > 0) {
+                if (insert_entry(index, &sketch) != 0) {
+                    pthread_rwlock_unlock(&index->lock);
+                    return -1;
+                }
+            }
+            pthread_rwlock_unlock(&index->lock);
+            copy_id(canonical_id, capacity, sketch.id, sketch.id_length);
+            return 0;
+        }
+    }
+
+    const dedup_entry* canonical = &index->entries[nearest - 1];
+    copy_id(canonical_id, capacity, index->ids + canonical->id_offset, canonical->id_length);
+    pthread_rwlock_unlock(&index->lock);
+
+    atomic_fetch_add_explicit(&index->duplicates, 1, memory_order_relaxed);
+    return 1;
+}
+
+/**
+ * @brief Add up the memory an index holds.
+ */
+static size_t dedup_bytes(const agency_dedup_index* index) {
+    return sizeof(agency_dedup_index) + DEDUP_BUCKETS * sizeof(uint32_t) + index->ids_capacity +
+           index->entry_capacity * (sizeof(dedup_entry) + (size_t)index->num_bands * sizeof(uint32_t));
+}
+
+agency_dedup_index* agency_dedup_create(double min_similarity) {
+    if (!(min_similarity > 0.0 && min_similarity <= 1.0)) {
+        return NULL;
+    }
+
+    agency_dedup_index* index = (agency_dedup_index*)agency_calloc(1, sizeof(agency_dedup_index));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->min_matches = (int)(min_similarity * DEDUP_HASHES - 1e-9) + 1;
+
+    // The widest band that a pair at the threshold shares with the wanted probability
+    index->rows = 1;
+    for (int rows = DEDUP_HASHES / 2; rows > 1; rows /= 2) {
+        double miss = power(1.0 - power(min_similarity, rows), DEDUP_HASHES / rows);
+        if (1.0 - miss >= DEDUP_RECALL) {
+            index->rows = rows;
+            break;
+        }
+    }
+    index->num_bands = DEDUP_HASHES / index->rows;
+    index->band_mask = (uint32_t)(DEDUP_BUCKETS / index->num_bands - 1);
+
+    uint64_t seed = 0x5DEECE66DULL;
+    for (int k = 0; k < DEDUP_HASHES; k++) {
+        index->multipliers[k] = splitmix64(&seed) | 1;
+        index->increments[k] = splitmix64(&seed);
+    }
+
+    index->buckets = (uint32_t*)agency_calloc(DEDUP_BUCKETS, sizeof(uint32_t));
+    if (index->buckets == NULL || pthread_rwlock_init(&index->lock, NULL) != 0) {
+        agency_free(index->buckets);
+        agency_free(index);
+        return NULL;
+    }
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, (int64_t)dedup_bytes(index), 0);
+    return index;
+}
+
+void agency_dedup_destroy(agency_dedup_index* index) {
+    if (index == NULL) {
+        return;
+    }
+
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, -(int64_t)dedup_bytes(index), -(int64_t)index->num_entries);
+    pthread_rwlock_destroy(&index->lock);
+    agency_free(index->buckets);
+    agency_free(index->next);
+    agency_free(index->entries);
+    agency_free(index->ids);
+    agency_free(index);
+}
+
+int agency_dedup_add(agency_dedup_index* index, const char* issue_json, char* canonical_id,
+                     size_t capacity) {
+    if (index == NULL || issue_json == NULL) {
+        return -1;
+    }
+
+    return resolve(index, issue_json, canonical_id, capacity);
+}
+
+void agency_get_dedup_stats(agency_dedup_index* index, agency_dedup_stats* stats) {
+    if (index == NULL || stats == NULL) {
+        return;
+    }
+
+    pthread_rwlock_rdlock(&index->lock);
+    stats->issues = index->num_entries;
+    pthread_rwlock_unlock(&index->lock);
+    stats->bands = (uint32_t)index->num_bands;
+    stats->rows = (uint32_t)index->rows;
+    stats->lookups = atomic_load(&index->lookups);
+    stats->duplicates = atomic_load(&index->duplicates);
+    stats->candidates = atomic_load(&index->candidates);
+}
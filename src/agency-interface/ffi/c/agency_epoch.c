@@ -0,0 +1,209 @@
+/**
+ * @file agency_epoch.c
+ * @brief Epoch-based reclamation of objects readers may still hold.
+ *
+ * A reader announces the global epoch in a record of its own on entry and
+ * clears it on exit; each record sits on its own cache line and only its
+ * thread writes it, so entering and leaving touch no shared line. A writer
+ * that replaces an object retires it stamped with the epoch current at the
+ * time, and advances the epoch. Readers that announce a later epoch entered
+ * after the replacement was published and cannot reach the old object, so
+ * it is freed once no reader still announces its epoch or an earlier one.
+ *
+ * Retired objects are reclaimed when the next one is retired, or by
+ * agency_epoch_reclaim(); a reader that stays inside holds back only the
+ * objects retired while it was there.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "agency_internal.h"
+
+// Cache line size, so records of different threads never share one
+#define EPOCH_LINE_SIZE 64
+
+/**
+ * @brief A reader thread's announcement. Records are reused, never freed.
+ */
+struct agency_epoch_record {
+    _Alignas(EPOCH_LINE_SIZE) _Atomic(uint64_t) epoch;  // announced epoch, 0 while outside
+    unsigned depth;                                     // nested entries, owner only
+    atomic_int in_use;
+    struct agency_epoch_record* next;
+};
+
+/**
+ * @brief An object waiting for the readers of its epoch to leave.
+ */
+typedef struct retired_object {
+    void* object;
+    void (*destroy)(void*);
+    uint64_t epoch;
+    struct retired_object* next;
+} retired_object;
+
+static struct {
+    pthread_mutex_t lock;  // registration and the retired list
+    _Atomic(uint64_t) epoch;
+    _Atomic(agency_epoch_record*) records;
+    atomic_int unregistered;  // readers inside without a record
+    retired_object* retired;
+    _Atomic(uint64_t) num_retired;
+    _Atomic(uint64_t) num_reclaimed;
+} g_epoch = {.lock = PTHREAD_MUTEX_INITIALIZER, .epoch = 1};
+
+static pthread_key_t g_record_key;
+static pthread_once_t g_record_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Release a thread's record for reuse when the thread exits.
+ */
+static void record_release(void* ptr) {
+    agency_epoch_record* record = (agency_epoch_record*)ptr;
+    record->depth = 0;
+    atomic_store(&record->epoch, 0);
+    atomic_store(&record->in_use, 0);
+}
+
+static void record_key_create(void) {
+    pthread_key_create(&g_record_key, record_release);
+}
+
+/**
+ * @brief Get the calling thread's record, claiming or allocating one on first use.
+ *
+ * @return The record, or NULL on allocation failure.
+ */
+static agency_epoch_record* get_record(void) {
+    pthread_once(&g_record_key_once, record_key_create);
+
+    agency_epoch_record* record = (agency_epoch_record*)pthread_getspecific(g_record_key);
+    if (record != NULL) {
+        return record;
+    }
+
+    pthread_mutex_lock(&g_epoch.lock);
+    for (record = atomic_load(&g_epoch.records); record != NULL; record = record->next) {
+        int unused = 0;
+        if (atomic_compare_exchange_strong(&record->in_use, &unused, 1)) {
+            break;
+        }
+    }
+    if (record == NULL) {
+        // The allocator only promises ordinary alignment; records are never
+        // freed, so round up within a larger block
+        char* memory = (char*)agency_malloc(sizeof(agency_epoch_record) + EPOCH_LINE_SIZE - 1);
+        if (memory != NULL) {
+            record = (agency_epoch_record*)(((uintptr_t)memory + EPOCH_LINE_SIZE - 1) &
+                                            ~(uintptr_t)(EPOCH_LINE_SIZE - 1));
+            atomic_init(&record->epoch, 0);
+            record->depth = 0;
+            atomic_init(&record->in_use, 1);
+            record->next = atomic_load(&g_epoch.records);
+            atomic_store(&g_epoch.records, record);
+        }
+    }
+    pthread_mutex_unlock(&g_epoch.lock);
+
+    if (record != NULL && pthread_setspecific(g_record_key, record) != 0) {
+        atomic_store(&record->in_use, 0);
+        record = NULL;
+    }
+    return record;
+}
+
+agency_epoch_record* agency_epoch_enter(void) {
+    agency_epoch_record* record = get_record();
+    if (record == NULL) {
+        // Without a record, hold back every reclamation until this reader leaves
+        fprintf(stderr, "Error registering epoch reader\n");
+        atomic_fetch_add(&g_epoch.unregistered, 1);
+        return NULL;
+    }
+
+    // Sequentially consistent, so the announcement is visible before the
+    // reader loads anything a writer may retire
+    if (record->depth++ == 0) {
+        atomic_store(&record->epoch, atomic_load(&g_epoch.epoch));
+    }
+    return record;
+}
+
+void agency_epoch_leave(agency_epoch_record* record) {
+    if (record == NULL) {
+        atomic_fetch_sub(&g_epoch.unregistered, 1);
+        return;
+    }
+
+    if (--record->depth == 0) {
+        atomic_store_explicit(&record->epoch, 0, memory_order_release);
+    }
+}
+
+/**
+ * @brief Free the retired objects no reader can reach. Called under the lock.
+ */
+static void reclaim(void) {
+    if (atomic_load(&g_epoch.unregistered) > 0) {
+        return;
+    }
+
+    uint64_t oldest = UINT64_MAX;
+    for (agency_epoch_record* record = atomic_load(&g_epoch.records); record != NULL; record = record->next) {
+        uint64_t epoch = atomic_load(&record->epoch);
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    retired_object** link = &g_epoch.retired;
+    while (*link != NULL) {
+        retired_object* retired = *link;
+        if (retired->epoch < oldest) {
+            *link = retired->next;
+            retired->destroy(retired->object);
+            agency_free(retired);
+            atomic_fetch_add(&g_epoch.num_reclaimed, 1);
+        } else {
+            link = &retired->next;
+        }
+    }
+}
+
+void agency_epoch_retire(void* object, void (*destroy)(void*)) {
+    if (object == NULL) {
+        return;
+    }
+
+    retired_object* retired = (retired_object*)agency_malloc(sizeof(retired_object));
+    pthread_mutex_lock(&g_epoch.lock);
+    if (retired == NULL) {
+        // Better to leak one object than to free it under a reader
+        fprintf(stderr, "Error allocating retired object record\n");
+    } else {
+        // Readers announcing a later epoch entered after the object was replaced
+        retired->object = object;
+        retired->destroy = destroy;
+        retired->epoch = atomic_fetch_add(&g_epoch.epoch, 1);
+        retired->next = g_epoch.retired;
+        g_epoch.retired = retired;
+        atomic_fetch_add(&g_epoch.num_retired, 1);
+    }
+    reclaim();
+    pthread_mutex_unlock(&g_epoch.lock);
+}
+
+void agency_epoch_reclaim(void) {
+    pthread_mutex_lock(&g_epoch.lock);
+    reclaim();
+    pthread_mutex_unlock(&g_epoch.lock);
+}
+
+void agency_epoch_get_stats(uint64_t* epoch, uint64_t* retired, uint64_t* reclaimed) {
+    *epoch = atomic_load(&g_epoch.epoch);
+    *retired = atomic_load(&g_epoch.num_retired);
+    *reclaimed = atomic_load(&g_epoch.num_reclaimed);
+}
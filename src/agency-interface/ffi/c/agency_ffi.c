@@ -3,83 +3,128 @@
  * @brief C implementation of the agency FFI interface.
  */
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <json-c/json.h>
-#include "../agency_ffi.h"
-
-// Configuration file path
-#define CONFIG_FILE "../config/agency_data.json"
-#define TEMPLATES_DIR "../templates"
-#define ISSUE_FINDER_DIR "../agency_issue_finder/agencies"
-#define CONNECTOR_DIR "../agencies"
+#include "agency_internal.h"
 
 // Global configuration cache
-static json_object* g_config = NULL;
+static _Atomic(json_object*) g_config = NULL;
+static pthread_mutex_t g_config_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Bumped whenever the configuration or theorem models are loaded
+static _Atomic(uint64_t) g_generation = 0;
+
+// Successful agency_reload_config() calls
+static _Atomic(uint64_t) g_reloads = 0;
 
 /**
- * @brief Load the configuration file.
+ * @brief Read and parse the configuration file.
  *
- * @return A pointer to the configuration object, or NULL if an error occurs.
+ * @return The parsed configuration, or NULL if an error occurs.
  */
-static json_object* load_config(void) {
-    if (g_config != NULL) {
-        return g_config;
-    }
-
-    json_object* config = json_object_from_file(CONFIG_FILE);
+static json_object* parse_config(void) {
+    // The structural scan locates syntax errors, which json-c only reports as failure
+    json_object* config = NULL;
+    size_t length = 0;
+    size_t error_offset = 0;
+    char* text = agency_read_file(CONFIG_FILE, &length);
+    if (text != NULL && agency_json_check(text, length, &error_offset) != 0) {
+        fprintf(stderr, "Error in configuration file %s at byte %zu\n", CONFIG_FILE, error_offset);
+    } else if (text != NULL) {
+        config = json_tokener_parse(text);
+    }
+    agency_free(text);
     if (config == NULL) {
         fprintf(stderr, "Error loading configuration file: %s\n", CONFIG_FILE);
-        return NULL;
     }
-
-    g_config = config;
     return config;
 }
 
 /**
- * @brief Find an agency in the configuration.
- *
- * @param agency The agency acronym.
- * @return A pointer to the agency object, or NULL if not found.
+ * @brief Destroy a retired snapshot.
  */
-static json_object* find_agency(const char* agency) {
-    json_object* config = load_config();
-    if (config == NULL) {
-        return NULL;
-    }
+static void snapshot_destroy(void* snapshot) {
+    agency_snapshot_free((agency_snapshot*)snapshot);
+}
 
-    json_object* agencies;
-    if (!json_object_object_get_ex(config, "agencies", &agencies)) {
-        fprintf(stderr, "Error: 'agencies' key not found in configuration\n");
-        return NULL;
+json_object* agency_load_config(void) {
+    json_object* config = atomic_load_explicit(&g_config, memory_order_acquire);
+    if (config != NULL) {
+        return config;
     }
 
-    int num_agencies = json_object_array_length(agencies);
-    for (int i = 0; i < num_agencies; i++) {
-        json_object* agency_obj = json_object_array_get_idx(agencies, i);
-        json_object* acronym;
-        if (json_object_object_get_ex(agency_obj, "acronym", &acronym)) {
-            const char* acronym_str = json_object_get_string(acronym);
-            if (strcmp(acronym_str, agency) == 0) {
-                return agency_obj;
-            }
+    // Callers may now arrive from several threads; only one of them loads
+    pthread_mutex_lock(&g_config_lock);
+    config = atomic_load_explicit(&g_config, memory_order_relaxed);
+    if (config == NULL) {
+        config = parse_config();
+        if (config != NULL) {
+            // Readers only ever see the snapshot; the tree stays private to the builders
+            agency_snapshot_exchange(agency_snapshot_build(config));
+            atomic_store_explicit(&g_config, config, memory_order_release);
+            agency_generation_bump();
         }
     }
+    pthread_mutex_unlock(&g_config_lock);
 
-    return NULL;
+    return config;
 }
 
-/**
- * @brief Read a file into a string.
- *
- * @param file_path The path to the file.
- * @return A pointer to a null-terminated string containing the file contents,
- *         or NULL if an error occurs. The caller is responsible for freeing
- *         the returned string.
- */
-static char* read_file(const char* file_path) {
+int agency_reload_config(void) {
+    if (agency_load_config() == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+
+    pthread_mutex_lock(&g_config_lock);
+    json_object* config = parse_config();
+    agency_snapshot* snapshot = config != NULL ? agency_snapshot_build(config) : NULL;
+    agency_matcher_set* matchers = snapshot != NULL ? agency_matcher_build(config) : NULL;
+    // The manifest goes last, as it is swapped in as soon as it is built
+    if (snapshot != NULL && (matchers == NULL || agency_manifest_reload(config) != 0)) {
+        agency_matcher_discard(matchers);
+        agency_snapshot_free(snapshot);
+        snapshot = NULL;
+    }
+    json_object_put(config);
+    if (snapshot == NULL) {
+        // Readers keep the snapshot and manifest they have
+        pthread_mutex_unlock(&g_config_lock);
+        return AGENCY_STATUS_ERROR;
+    }
+
+    // The generation moves after the snapshot, so a reader that sees the new
+    // generation also sees the new snapshot and never caches a stale verdict
+    agency_snapshot* old = agency_snapshot_exchange(snapshot);
+    agency_matcher_publish(matchers);
+    agency_generation_bump();
+    pthread_mutex_unlock(&g_config_lock);
+
+    agency_epoch_retire(old, snapshot_destroy);
+    atomic_fetch_add(&g_reloads, 1);
+    return AGENCY_STATUS_OK;
+}
+
+void agency_get_reload_stats(agency_reload_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->reloads = atomic_load(&g_reloads);
+    agency_epoch_get_stats(&stats->epoch, &stats->retired, &stats->reclaimed);
+}
+
+uint64_t agency_generation(void) {
+    return atomic_load_explicit(&g_generation, memory_order_acquire);
+}
+
+void agency_generation_bump(void) {
+    atomic_fetch_add_explicit(&g_generation, 1, memory_order_acq_rel);
+}
+
+char* agency_read_file(const char* file_path, size_t* length) {
     FILE* file = fopen(file_path, "r");
     if (file == NULL) {
         fprintf(stderr, "Error opening file: %s\n", file_path);
@@ -92,7 +137,7 @@ static char* read_file(const char* file_path) {
     fseek(file, 0, SEEK_SET);
 
     // Allocate memory for the file contents
-    char* buffer = (char*)malloc(file_size + 1);
+    char* buffer = (char*)agency_malloc(file_size + 1);
     if (buffer == NULL) {
         fprintf(stderr, "Error allocating memory for file contents\n");
         fclose(file);
@@ -103,7 +148,7 @@ static char* read_file(const char* file_path) {
     size_t bytes_read = fread(buffer, 1, file_size, file);
     if (bytes_read != (size_t)file_size) {
         fprintf(stderr, "Error reading file: %s\n", file_path);
-        free(buffer);
+        agency_free(buffer);
         fclose(file);
         return NULL;
     }
@@ -111,273 +156,220 @@ static char* read_file(const char* file_path) {
     // Null-terminate the string
     buffer[file_size] = '\0';
 
+    if (length != NULL) {
+        *length = (size_t)file_size;
+    }
+
     fclose(file);
     return buffer;
 }
 
 char* agency_get_context(const char* agency) {
-    json_object* agency_obj = find_agency(agency);
-    if (agency_obj == NULL) {
-        return NULL;
-    }
-
-    // Create a string from the agency object
-    const char* json_str = json_object_to_json_string_ext(agency_obj, JSON_C_TO_STRING_PRETTY);
-    if (json_str == NULL) {
-        return NULL;
-    }
-
-    // Copy the string to a new buffer
-    char* context = strdup(json_str);
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    const agency_snapshot_entry* entry = agency_snapshot_find(snapshot, agency);
+
+    // Copy the rendered context to a new buffer
+    char* context = entry != NULL ?
+        agency_strndup(agency_snapshot_string(snapshot, entry->context), entry->context_length) : NULL;
+    agency_epoch_leave(epoch);
     return context;
 }
 
-char* agency_get_issue_finder(const char* agency) {
-    // Convert agency to lowercase
-    size_t len = strlen(agency);
-    char* agency_lower = (char*)malloc(len + 1);
-    if (agency_lower == NULL) {
-        return NULL;
-    }
-
-    for (size_t i = 0; i < len; i++) {
-        agency_lower[i] = tolower(agency[i]);
+int agency_get_context_conditional(const char* agency, uint64_t known_hash,
+                                   char** context, uint64_t* current_hash) {
+    if (context == NULL) {
+        return AGENCY_STATUS_ERROR;
     }
-    agency_lower[len] = '\0';
+    *context = NULL;
 
-    // Build the issue finder file path
-    char file_path[512];
-    snprintf(file_path, sizeof(file_path), "%s/%s_finder.py", ISSUE_FINDER_DIR, agency_lower);
-
-    // Free the lowercase agency string
-    free(agency_lower);
-
-    // Read the issue finder file
-    return read_file(file_path);
-}
-
-char* agency_get_research_connector(const char* agency) {
-    // Convert agency to lowercase
-    size_t len = strlen(agency);
-    char* agency_lower = (char*)malloc(len + 1);
-    if (agency_lower == NULL) {
-        return NULL;
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    const agency_snapshot_entry* entry = agency_snapshot_find(snapshot, agency);
+    int status;
+    if (entry == NULL) {
+        status = AGENCY_STATUS_NOT_FOUND;
+    } else if (entry->context_hash == known_hash) {
+        // The hash is computed with the snapshot, so a poll never serializes
+        status = AGENCY_STATUS_NOT_MODIFIED;
+    } else {
+        *context = agency_strndup(agency_snapshot_string(snapshot, entry->context), entry->context_length);
+        status = *context != NULL ? AGENCY_STATUS_OK : AGENCY_STATUS_ERROR;
     }
-
-    for (size_t i = 0; i < len; i++) {
-        agency_lower[i] = tolower(agency[i]);
+    if (entry != NULL && current_hash != NULL) {
+        *current_hash = entry->context_hash;
     }
-    agency_lower[len] = '\0';
-
-    // Build the research connector file path
-    char file_path[512];
-    snprintf(file_path, sizeof(file_path), "%s/%s_connector.py", CONNECTOR_DIR, agency_lower);
+    agency_epoch_leave(epoch);
 
-    // Free the lowercase agency string
-    free(agency_lower);
-
-    // Read the research connector file
-    return read_file(file_path);
+    return status;
 }
 
-char* agency_get_ascii_art(const char* agency) {
-    // Convert agency to lowercase
-    size_t len = strlen(agency);
-    char* agency_lower = (char*)malloc(len + 1);
-    if (agency_lower == NULL) {
-        return NULL;
+/**
+ * @brief Answer a conditional fetch for a manifest record. Call inside an epoch.
+ */
+static int read_if_modified(agency_resource* resource, uint64_t known_hash, char** data,
+                            size_t* length, uint64_t* current_hash) {
+    // A cached hash answers a match without reading, but only for the bytes it
+    // was computed from: a file's size, mtime or inode changing invalidates it
+    uint64_t stamp = agency_resource_stamp(resource);
+    uint64_t cached_stamp;
+    uint64_t hash = agency_resource_cached_hash(resource, &cached_stamp);
+    if (stamp != 0 && cached_stamp == stamp && hash != 0 && hash == known_hash) {
+        if (current_hash != NULL) {
+            *current_hash = hash;
+        }
+        return AGENCY_STATUS_NOT_MODIFIED;
     }
 
-    for (size_t i = 0; i < len; i++) {
-        agency_lower[i] = tolower(agency[i]);
+    size_t file_len;
+    char* contents = agency_resource_read(resource, &file_len);
+    if (contents == NULL) {
+        return AGENCY_STATUS_ERROR;
     }
-    agency_lower[len] = '\0';
-
-    // Build the ASCII art file path
-    char file_path[512];
-    snprintf(file_path, sizeof(file_path), "%s/%s_ascii.txt", TEMPLATES_DIR, agency_lower);
-
-    // Free the lowercase agency string
-    free(agency_lower);
 
-    // Read the ASCII art file
-    return read_file(file_path);
-}
-
-void agency_free_context(char* context) {
-    free(context);
-}
-
-char* agency_get_all_agencies() {
-    json_object* config = load_config();
-    if (config == NULL) {
-        return NULL;
+    // The hash always describes the bytes served, even if the file changed since the stat
+    uint64_t served_hash = agency_content_hash(contents, file_len);
+    if (stamp != 0 && (cached_stamp != stamp || hash != served_hash)) {
+        agency_resource_cache_hash(resource, stamp, served_hash);
     }
-
-    json_object* agencies;
-    if (!json_object_object_get_ex(config, "agencies", &agencies)) {
-        fprintf(stderr, "Error: 'agencies' key not found in configuration\n");
-        return NULL;
+    if (current_hash != NULL) {
+        *current_hash = served_hash;
     }
-
-    // Create a new JSON array for the agency acronyms
-    json_object* agency_list = json_object_new_array();
-    if (agency_list == NULL) {
-        return NULL;
+    if (served_hash == known_hash) {
+        agency_free(contents);
+        return AGENCY_STATUS_NOT_MODIFIED;
     }
 
-    int num_agencies = json_object_array_length(agencies);
-    for (int i = 0; i < num_agencies; i++) {
-        json_object* agency_obj = json_object_array_get_idx(agencies, i);
-        json_object* acronym;
-        if (json_object_object_get_ex(agency_obj, "acronym", &acronym)) {
-            // Add the acronym to the list
-            json_object_array_add(agency_list, json_object_get(acronym));
-        }
+    *data = contents;
+    if (length != NULL) {
+        *length = file_len;
     }
+    return AGENCY_STATUS_OK;
+}
 
-    // Create a string from the agency list
-    const char* json_str = json_object_to_json_string_ext(agency_list, JSON_C_TO_STRING_PRETTY);
-    if (json_str == NULL) {
-        json_object_put(agency_list);
-        return NULL;
+int agency_get_resource_conditional(const char* agency, agency_resource_kind kind,
+                                    uint64_t known_hash, char** data, size_t* length,
+                                    uint64_t* current_hash) {
+    if (data == NULL) {
+        return AGENCY_STATUS_ERROR;
     }
+    *data = NULL;
 
-    // Copy the string to a new buffer
-    char* result = strdup(json_str);
-
-    // Free the agency list
-    json_object_put(agency_list);
-
-    return result;
+    agency_epoch_record* epoch = agency_epoch_enter();
+    agency_resource* resource = agency_manifest_lookup(agency, kind);
+    int status = resource != NULL ? read_if_modified(resource, known_hash, data, length, current_hash)
+                                  : AGENCY_STATUS_NOT_FOUND;
+    agency_epoch_leave(epoch);
+    return status;
 }
 
-char* agency_get_agencies_by_tier(int tier) {
-    json_object* config = load_config();
-    if (config == NULL) {
-        return NULL;
-    }
+/**
+ * @brief Read a file-backed resource, from the store if it has been preloaded.
+ *
+ * @return A copy the caller frees, or NULL if the agency has no such resource
+ *         or it could not be read.
+ */
+static char* read_resource(const char* agency, agency_resource_kind kind) {
+    agency_epoch_record* epoch = agency_epoch_enter();
+    agency_resource* resource = agency_manifest_lookup(agency, kind);
+    char* contents = resource != NULL ? agency_resource_read(resource, NULL) : NULL;
+    agency_epoch_leave(epoch);
+    return contents;
+}
 
-    json_object* agencies;
-    if (!json_object_object_get_ex(config, "agencies", &agencies)) {
-        fprintf(stderr, "Error: 'agencies' key not found in configuration\n");
-        return NULL;
-    }
+char* agency_get_issue_finder(const char* agency) {
+    return read_resource(agency, AGENCY_RESOURCE_ISSUE_FINDER);
+}
 
-    // Create a new JSON array for the agency acronyms
-    json_object* agency_list = json_object_new_array();
-    if (agency_list == NULL) {
-        return NULL;
-    }
+char* agency_get_research_connector(const char* agency) {
+    return read_resource(agency, AGENCY_RESOURCE_RESEARCH_CONNECTOR);
+}
 
-    int num_agencies = json_object_array_length(agencies);
-    for (int i = 0; i < num_agencies; i++) {
-        json_object* agency_obj = json_object_array_get_idx(agencies, i);
-        
-        // Check if the agency is in the specified tier
-        json_object* agency_tier;
-        if (json_object_object_get_ex(agency_obj, "tier", &agency_tier)) {
-            int tier_value = json_object_get_int(agency_tier);
-            if (tier_value == tier) {
-                // Add the agency acronym to the list
-                json_object* acronym;
-                if (json_object_object_get_ex(agency_obj, "acronym", &acronym)) {
-                    json_object_array_add(agency_list, json_object_get(acronym));
-                }
-            }
-        }
-    }
+char* agency_get_ascii_art(const char* agency) {
+    return read_resource(agency, AGENCY_RESOURCE_ASCII_ART);
+}
 
-    // Create a string from the agency list
-    const char* json_str = json_object_to_json_string_ext(agency_list, JSON_C_TO_STRING_PRETTY);
-    if (json_str == NULL) {
-        json_object_put(agency_list);
-        return NULL;
-    }
+void agency_free_context(char* context) {
+    agency_free(context);
+}
 
-    // Copy the string to a new buffer
-    char* result = strdup(json_str);
+/**
+ * @brief Copy a rendered list of a snapshot to a new buffer.
+ */
+static char* copy_list(const agency_snapshot* snapshot, const agency_snapshot_list* list) {
+    return agency_strndup(agency_snapshot_string(snapshot, list->json), list->length);
+}
 
-    // Free the agency list
-    json_object_put(agency_list);
+char* agency_get_all_agencies() {
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    char* result = snapshot != NULL ? copy_list(snapshot, &snapshot->all) : NULL;
+    agency_epoch_leave(epoch);
+    return result;
+}
 
+char* agency_get_agencies_by_tier(int tier) {
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    char* result = snapshot != NULL ? copy_list(snapshot, agency_snapshot_tier(snapshot, tier)) : NULL;
+    agency_epoch_leave(epoch);
     return result;
 }
 
 char* agency_get_agencies_by_domain(const char* domain) {
-    json_object* config = load_config();
-    if (config == NULL) {
-        return NULL;
-    }
-
-    json_object* agencies;
-    if (!json_object_object_get_ex(config, "agencies", &agencies)) {
-        fprintf(stderr, "Error: 'agencies' key not found in configuration\n");
+    if (domain == NULL) {
         return NULL;
     }
 
-    // Create a new JSON array for the agency acronyms
-    json_object* agency_list = json_object_new_array();
-    if (agency_list == NULL) {
-        return NULL;
-    }
-
-    int num_agencies = json_object_array_length(agencies);
-    for (int i = 0; i < num_agencies; i++) {
-        json_object* agency_obj = json_object_array_get_idx(agencies, i);
-        
-        // Check if the agency is in the specified domain
-        json_object* agency_domain;
-        if (json_object_object_get_ex(agency_obj, "domain", &agency_domain)) {
-            const char* domain_value = json_object_get_string(agency_domain);
-            if (strcmp(domain_value, domain) == 0) {
-                // Add the agency acronym to the list
-                json_object* acronym;
-                if (json_object_object_get_ex(agency_obj, "acronym", &acronym)) {
-                    json_object_array_add(agency_list, json_object_get(acronym));
-                }
-            }
-        }
-    }
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    char* result = snapshot != NULL ? copy_list(snapshot, agency_snapshot_domain(snapshot, domain)) : NULL;
+    agency_epoch_leave(epoch);
+    return result;
+}
 
-    // Create a string from the agency list
-    const char* json_str = json_object_to_json_string_ext(agency_list, JSON_C_TO_STRING_PRETTY);
-    if (json_str == NULL) {
-        json_object_put(agency_list);
+/**
+ * @brief Get the domain of an agency, as prover_integration.py resolves it.
+ *
+ * @return The domain name, "general" if the agency has none, or NULL if the
+ *         agency is not in the configuration.
+ */
+static const char* find_agency_domain(const char* agency) {
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    const agency_snapshot_entry* entry = agency_snapshot_find(snapshot, agency);
+    if (entry == NULL) {
         return NULL;
     }
 
-    // Copy the string to a new buffer
-    char* result = strdup(json_str);
+    return entry->domain != AGENCY_STRTAB_NONE ? agency_snapshot_string(snapshot, entry->domain) : "general";
+}
 
-    // Free the agency list
-    json_object_put(agency_list);
+const agency_theorem_domain* agency_theorems_for_agency(const char* agency) {
+    // The theorems outlive any snapshot; only the domain name is borrowed
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const char* domain = find_agency_domain(agency);
+    const agency_theorem_domain* theorems = domain != NULL ? agency_theorems_for_domain(domain) : NULL;
+    agency_epoch_leave(epoch);
+    return theorems;
+}
 
-    return result;
+const agency_schema* agency_schema_for_agency(const char* agency) {
+    const agency_snapshot* snapshot = agency_snapshot_current();
+    const agency_snapshot_entry* entry = agency_snapshot_find(snapshot, agency);
+    return agency_schema_at(snapshot != NULL ? &snapshot->schemas : NULL, entry != NULL ? entry->position : -1);
 }
 
 int agency_verify_issue(const char* agency, const char* issue_json) {
-    // This is a simplified implementation that just checks if the issue JSON is valid
-    // A real implementation would use the agency prover integration to verify the issue
-    
-    json_object* issue = json_tokener_parse(issue_json);
-    if (issue == NULL) {
-        return -1; // Invalid JSON
-    }
-    
-    // Check if the issue has the required fields
-    int valid = 1;
-    const char* required_fields[] = {"id", "title", "description", "affected_areas"};
-    int num_fields = sizeof(required_fields) / sizeof(required_fields[0]);
-    
-    for (int i = 0; i < num_fields; i++) {
-        json_object* field;
-        if (!json_object_object_get_ex(issue, required_fields[i], &field)) {
-            valid = 0;
-            break;
-        }
-    }
-    
-    json_object_put(issue);
-    return valid;
-}
\ No newline at end of file
+    if (agency == NULL || issue_json == NULL) {
+        return -1;
+    }
+
+    // The scope is read first: a reload moves the generation after the snapshot
+    uint64_t scope = agency_verdict_scope(agency);
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const agency_schema* schema = agency_schema_for_agency(agency);
+    const agency_theorem_domain* theorems = agency_theorems_for_agency(agency);
+    int verdict = agency_verify_cached(scope, schema, theorems, issue_json, strlen(issue_json));
+    agency_epoch_leave(epoch);
+    return verdict;
+}
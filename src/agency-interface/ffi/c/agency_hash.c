@@ -0,0 +1,109 @@
+/**
+ * @file agency_hash.c
+ * @brief Fast 64-bit content hashing (XXH64).
+ *
+ * Used for resource ETags and anywhere else the library needs to identify
+ * content by value. The algorithm is the public XXH64 specification, so
+ * clients can reproduce the hashes with any xxHash implementation.
+ */
+
+#include <string.h>
+#include "agency_internal.h"
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t rotl64(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static inline uint64_t merge_round64(uint64_t acc, uint64_t value) {
+    acc ^= round64(0, value);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t agency_hash64(const void* data, size_t length, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* end = p + length;
+    uint64_t hash;
+
+    if (length >= 32) {
+        const unsigned char* limit = end - 32;
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        hash = merge_round64(hash, v1);
+        hash = merge_round64(hash, v2);
+        hash = merge_round64(hash, v3);
+        hash = merge_round64(hash, v4);
+    } else {
+        hash = seed + PRIME64_5;
+    }
+
+    hash += (uint64_t)length;
+
+    while (p + 8 <= end) {
+        hash ^= round64(0, read64(p));
+        hash = rotl64(hash, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+
+    if (p + 4 <= end) {
+        hash ^= (uint64_t)read32(p) * PRIME64_1;
+        hash = rotl64(hash, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+
+    while (p < end) {
+        hash ^= (*p) * PRIME64_5;
+        hash = rotl64(hash, 11) * PRIME64_1;
+        p++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+uint64_t agency_content_hash(const void* data, size_t length) {
+    uint64_t hash = agency_hash64(data, length, 0);
+
+    // Zero is reserved for "no hash known yet"
+    return hash != 0 ? hash : 1;
+}
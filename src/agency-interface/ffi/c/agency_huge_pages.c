@@ -0,0 +1,151 @@
+/**
+ * @file agency_huge_pages.c
+ * @brief Huge-page backing for the large read-only regions.
+ *
+ * The snapshot, the indexes and the preloaded resources each lie in a few
+ * large regions that queries walk end to end. In small pages, a walk
+ * through a large region takes a TLB miss every 4 KiB; backed by huge pages
+ * it takes one per 2 MiB. When a huge-page mode is set, those regions are
+ * mapped directly rather than taken from the allocator: from reserved
+ * hugetlbfs pages if asked and available, else as an aligned anonymous
+ * mapping advised with MADV_HUGEPAGE, which the kernel backs with
+ * transparent huge pages when it can. A region that cannot be mapped
+ * either way comes from the allocator in small pages, as with the mode off.
+ *
+ * Regions are rounded up to whole huge pages, so the mode pays off for
+ * large configurations and resource sets, and costs up to a huge page per
+ * region for small ones.
+ */
+
+#define _GNU_SOURCE  // MAP_ANONYMOUS, madvise
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "agency_internal.h"
+
+#define HUGE_PAGES_PMD_SIZE "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size"
+
+// Used when the kernel does not say
+#define HUGE_PAGES_DEFAULT_SIZE (2u << 20)
+
+static atomic_int g_mode = AGENCY_HUGE_PAGES_OFF;
+static atomic_size_t g_huge_bytes = 0;
+static _Atomic(uint64_t) g_fallbacks = 0;
+
+/**
+ * @brief Read the huge page size once.
+ */
+static size_t huge_page_size(void) {
+    static atomic_size_t size = 0;
+    size_t cached = atomic_load_explicit(&size, memory_order_relaxed);
+    if (cached != 0) {
+        return cached;
+    }
+
+    cached = HUGE_PAGES_DEFAULT_SIZE;
+    FILE* file = fopen(HUGE_PAGES_PMD_SIZE, "r");
+    if (file != NULL) {
+        unsigned long value = 0;
+        // Only a power of two is a usable page size
+        if (fscanf(file, "%lu", &value) == 1 && value != 0 && (value & (value - 1)) == 0) {
+            cached = value;
+        }
+        fclose(file);
+    }
+    atomic_store_explicit(&size, cached, memory_order_relaxed);
+    return cached;
+}
+
+/**
+ * @brief Map a region advised for transparent huge pages, starting on a huge page.
+ */
+static void* map_transparent(size_t size, size_t huge) {
+    // Mapped one huge page over, then trimmed to the aligned part
+    char* mapping = (char*)mmap(NULL, size + huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    char* start = (char*)(((uintptr_t)mapping + huge - 1) & ~(uintptr_t)(huge - 1));
+    if (start > mapping) {
+        munmap(mapping, (size_t)(start - mapping));
+    }
+    if (start + size < mapping + size + huge) {
+        munmap(start + size, (size_t)(mapping + size + huge - (start + size)));
+    }
+
+    if (madvise(start, size, MADV_HUGEPAGE) != 0) {
+        // A kernel without transparent huge pages
+        munmap(start, size);
+        return NULL;
+    }
+    return start;
+}
+
+int agency_huge_pages_on(void) {
+    return atomic_load_explicit(&g_mode, memory_order_relaxed) != AGENCY_HUGE_PAGES_OFF;
+}
+
+void* agency_huge_alloc(size_t size, size_t* mapped) {
+    int mode = atomic_load_explicit(&g_mode, memory_order_relaxed);
+    if (mode == AGENCY_HUGE_PAGES_OFF || size == 0) {
+        return NULL;
+    }
+
+    size_t huge = huge_page_size();
+    size = (size + huge - 1) & ~(huge - 1);
+
+    void* pages = NULL;
+    if (mode == AGENCY_HUGE_PAGES_HUGETLB) {
+        pages = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (pages == MAP_FAILED) {
+            // No reserved pages left; transparent ones may still do
+            atomic_fetch_add(&g_fallbacks, 1);
+            pages = NULL;
+        }
+    }
+    if (pages == NULL) {
+        pages = map_transparent(size, huge);
+        if (pages == NULL) {
+            if (mode != AGENCY_HUGE_PAGES_HUGETLB) {
+                atomic_fetch_add(&g_fallbacks, 1);
+            }
+            return NULL;
+        }
+    }
+
+    atomic_fetch_add(&g_huge_bytes, size);
+    *mapped = size;
+    return pages;
+}
+
+void agency_huge_free(void* pages, size_t mapped) {
+    if (pages == NULL) {
+        return;
+    }
+    munmap(pages, mapped);
+    atomic_fetch_sub(&g_huge_bytes, mapped);
+}
+
+int agency_set_huge_pages(int mode) {
+    if (mode != AGENCY_HUGE_PAGES_OFF && mode != AGENCY_HUGE_PAGES_THP && mode != AGENCY_HUGE_PAGES_HUGETLB) {
+        fprintf(stderr, "Error: unknown huge page mode %d\n", mode);
+        return AGENCY_STATUS_ERROR;
+    }
+
+    atomic_store(&g_mode, mode);
+    return AGENCY_STATUS_OK;
+}
+
+void agency_get_huge_page_stats(agency_huge_page_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->mode = atomic_load(&g_mode);
+    stats->page_size = huge_page_size();
+    stats->huge_bytes = atomic_load(&g_huge_bytes);
+    stats->fallbacks = atomic_load(&g_fallbacks);
+}
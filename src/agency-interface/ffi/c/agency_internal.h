@@ -0,0 +1,1131 @@
+/**
+ * @file agency_internal.h
+ * @brief Internal declarations shared by the agency FFI translation units.
+ *
+ * Nothing in this header is part of the public FFI surface; it exists so
+ * that the loader, the resource manifest and the public getters can be kept
+ * in separate translation units.
+ */
+
+#ifndef AGENCY_INTERNAL_H
+#define AGENCY_INTERNAL_H
+
+#include <stdatomic.h>
+#include <json-c/json.h>
+#include "../agency_ffi.h"
+
+// Configuration file path
+#define CONFIG_FILE "../config/agency_data.json"
+#define TEMPLATES_DIR "../templates"
+#define ISSUE_FINDER_DIR "../agency_issue_finder/agencies"
+#define CONNECTOR_DIR "../agencies"
+#define THEOREM_MODELS_DIR "../prover_integration/theorem_models"
+
+// Longest agency name (including the terminator) the manifest will index
+#define AGENCY_NAME_MAX 64
+
+/**
+ * @brief A resource held compressed (LZ4 block format) in the resource store.
+ */
+typedef struct {
+    const unsigned char* data;
+    uint32_t compressed_length;
+    uint32_t raw_length;
+} agency_blob;
+
+/**
+ * @brief A file-backed resource recorded in the manifest.
+ */
+typedef struct {
+    char* path;
+    _Atomic(uint64_t) hash;              // content hash, 0 until first computed
+    _Atomic(uint64_t) hash_stamp;        // version of the bytes the hash was computed from
+    atomic_uint hash_seq;                // odd while hash and hash_stamp are being written
+    _Atomic(const agency_blob*) blob;    // set once the store has preloaded it
+} agency_resource;
+
+// Stamp of a resource served from the store, whose bytes never change
+#define AGENCY_STAMP_STORED 1
+
+// Decoded bytes an incremental blob decode needs in front of its output
+#define AGENCY_BLOB_WINDOW 65535
+
+/**
+ * @brief Position of an incremental decode of a stored blob.
+ */
+typedef struct {
+    const agency_blob* blob;
+    uint32_t in;         // next compressed byte
+    uint32_t out;        // bytes decoded so far
+    uint32_t literals;   // literal bytes of the current sequence still to copy
+    uint32_t match;      // match bytes of the current sequence still to copy
+    uint32_t offset;     // distance back of the current match
+    unsigned token;      // token of the current sequence
+    int has_match;       // the current sequence's match is still to be read
+} agency_blob_reader;
+
+/**
+ * @brief Visitor for agency_manifest_foreach().
+ */
+typedef void (*agency_manifest_visitor)(const char* name, agency_resource_kind kind,
+                                        agency_resource* resource, void* user_data);
+
+/**
+ * @brief A theorem keyword: a lowercase word in the domain's string pool.
+ */
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} agency_theorem_keyword;
+
+/**
+ * @brief A compiled theorem: its name and a run of keywords that must all match.
+ *
+ * The theorem's components, as declared in its model, are kept for issue
+ * matching; they play no part in verification.
+ */
+typedef struct {
+    uint32_t name_offset;
+    uint32_t first_keyword;
+    uint32_t num_keywords;
+    uint32_t first_component;
+    uint32_t num_components;
+} agency_theorem_rule;
+
+/**
+ * @brief The compiled theorems of one domain.
+ */
+typedef struct {
+    char* name;
+    char* pool;  // rule names, keywords and components, each null-terminated
+    size_t pool_size;
+    agency_theorem_keyword* keywords;
+    size_t num_keywords;
+    size_t max_keyword_length;
+    agency_theorem_keyword* components;  // as declared, not case-folded
+    size_t num_components;
+    agency_theorem_rule* rules;
+    size_t num_rules;
+} agency_theorem_domain;
+
+/**
+ * @brief Every compiled theorem model, one entry per domain.
+ */
+typedef struct {
+    agency_theorem_domain* domains;
+    size_t num_domains;
+    size_t bytes;  // memory the set holds
+} agency_theorem_set;
+
+// Most fields an issue schema may declare (one bit each in a 64-bit mask)
+#define AGENCY_SCHEMA_MAX_FIELDS 64
+
+// Longest field name or enum value an issue schema may declare
+#define AGENCY_SCHEMA_NAME_MAX 64
+
+/**
+ * @brief JSON value types, as bits of a schema field's accepted-type mask.
+ */
+enum {
+    AGENCY_JSON_NULL = 1 << 0,
+    AGENCY_JSON_BOOLEAN = 1 << 1,
+    AGENCY_JSON_INTEGER = 1 << 2,
+    AGENCY_JSON_FRACTION = 1 << 3,  // a number with a fraction or exponent
+    AGENCY_JSON_STRING = 1 << 4,
+    AGENCY_JSON_ARRAY = 1 << 5,
+    AGENCY_JSON_OBJECT = 1 << 6,
+    AGENCY_JSON_ANY = (1 << 7) - 1
+};
+
+/**
+ * @brief A string in a schema's pool.
+ */
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} agency_schema_string;
+
+/**
+ * @brief One compiled top-level field check.
+ *
+ * Limits left unset are 0 for minimums and UINT32_MAX for maximums. String
+ * lengths count code points; item counts apply to arrays.
+ */
+typedef struct {
+    agency_schema_string name;
+    uint32_t types;
+    uint32_t min_length;
+    uint32_t max_length;
+    uint32_t min_items;
+    uint32_t max_items;
+    uint32_t first_enum;
+    uint32_t num_enums;
+} agency_schema_field;
+
+/**
+ * @brief A compiled issue schema: the checks for every declared field.
+ *
+ * Field i owns bit i of @c required and @c all. The theorem text field is
+ * always present so the validator can capture it.
+ */
+typedef struct {
+    char* pool;  // field names and enum values
+    size_t pool_size;
+    agency_schema_field* fields;
+    size_t num_fields;
+    agency_schema_string* enums;
+    size_t num_enums;
+    uint64_t required;
+    uint64_t all;
+    int description_field;
+    size_t bytes;  // memory the schema holds
+} agency_schema;
+
+/**
+ * @brief The compiled issue schemas of one configuration.
+ */
+typedef struct {
+    const agency_schema** by_agency;  // by position in the configuration
+    size_t num_agencies;
+    const agency_schema* fallback;    // for agencies that are not configured
+    agency_schema** owned;            // every schema compiled, each listed once
+    size_t num_owned;
+} agency_schema_table;
+
+/**
+ * @brief Allocate through the library's allocator; see agency_set_allocator().
+ *
+ * Every block the library allocates or frees goes through these, so that a
+ * host allocator sees all of them; they behave as their C library namesakes.
+ */
+void* agency_malloc(size_t size);
+void* agency_calloc(size_t count, size_t size);
+void* agency_realloc(void* ptr, size_t size);
+void agency_free(void* ptr);
+char* agency_strdup(const char* str);
+char* agency_strndup(const char* str, size_t length);
+
+/**
+ * @brief Count memory taken (positive) or given back (negative) in a category.
+ *
+ * Feeds agency_get_memory_stats(); call it wherever a counted structure
+ * allocates or frees.
+ */
+void agency_memory_charge(agency_memory_category category, int64_t bytes, int64_t objects);
+
+/**
+ * @brief Count objects dropped to bring a category under its ceiling.
+ */
+void agency_memory_evicted(agency_memory_category category, uint64_t objects);
+
+/**
+ * @brief Check whether a category holds more than its ceiling, if it has one.
+ */
+int agency_memory_over_limit(agency_memory_category category);
+
+/**
+ * @brief Set the pressure monitor's ceiling on a cache category, 0 for none.
+ *
+ * Applies alongside the caller's agency_set_memory_limit(); the lower wins.
+ */
+void agency_memory_set_pressure_limit(agency_memory_category category, uint64_t bytes);
+
+/**
+ * @brief Hand memory freed back to the system, where the allocator allows it.
+ */
+void agency_release_free_memory(void);
+
+/**
+ * @brief A thread's bump arena for the temporary state of a call.
+ */
+typedef struct agency_arena agency_arena;
+
+/**
+ * @brief Take the calling thread's arena for the duration of a call.
+ *
+ * Calls nest; what is allocated is released when the outermost one ends.
+ *
+ * @return The arena, or NULL on allocation failure.
+ */
+agency_arena* agency_arena_begin(void);
+
+/**
+ * @brief End a call begun with agency_arena_begin(). Accepts NULL.
+ */
+void agency_arena_end(agency_arena* arena);
+
+/**
+ * @brief Allocate from the arena, aligned to 8 bytes; never freed on its own.
+ *
+ * @return The block, or NULL on allocation failure.
+ */
+void* agency_arena_alloc(agency_arena* arena, size_t size);
+
+/**
+ * @brief Resize an arena block, in place when it is the latest one.
+ *
+ * @return The resized block, or NULL on allocation failure.
+ */
+void* agency_arena_grow(agency_arena* arena, void* ptr, size_t old_size, size_t new_size);
+
+// Deepest nesting agency_json_writer supports
+#define AGENCY_JSON_MAX_DEPTH 64
+
+/**
+ * @brief Writes JSON text into an arena, formatted as json-c formats it.
+ */
+typedef struct {
+    agency_arena* arena;
+    char* data;
+    size_t length;
+    size_t capacity;
+    uint64_t has_items;  // bit per open container that has a member
+    unsigned depth;
+    int pretty;          // JSON_C_TO_STRING_PRETTY rather than _PLAIN
+    int after_key;
+    int failed;          // allocation failed or the nesting is wrong
+} agency_json_writer;
+
+void agency_json_writer_init(agency_json_writer* writer, agency_arena* arena, int pretty);
+void agency_json_begin_object(agency_json_writer* writer);
+void agency_json_end_object(agency_json_writer* writer);
+void agency_json_begin_array(agency_json_writer* writer);
+void agency_json_end_array(agency_json_writer* writer);
+void agency_json_key(agency_json_writer* writer, const char* key);
+void agency_json_string(agency_json_writer* writer, const char* text, size_t length);
+void agency_json_int(agency_json_writer* writer, int64_t value);
+void agency_json_null(agency_json_writer* writer);
+
+/**
+ * @brief Terminate the text written.
+ *
+ * @return The text, valid until the arena's call ends, or NULL if writing
+ *         failed.
+ */
+const char* agency_json_writer_finish(agency_json_writer* writer, size_t* length);
+
+// Offset of no string in an agency_strtab
+#define AGENCY_STRTAB_NONE UINT32_MAX
+
+/**
+ * @brief A slot of the string table's hash index.
+ */
+typedef struct {
+    uint32_t offset;  // offset + 1 of the string, 0 marks an empty slot
+    uint32_t hash;
+} agency_strtab_slot;
+
+/**
+ * @brief Distinct strings stored once each, back to back, named by offset.
+ */
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+    agency_strtab_slot* slots;
+    size_t num_slots;
+    size_t num_strings;
+} agency_strtab;
+
+/**
+ * @brief Add a string to the table unless it is there already.
+ *
+ * May move the table's data, so hold offsets, not pointers, while building.
+ *
+ * @return The string's offset, or AGENCY_STRTAB_NONE on allocation failure.
+ */
+uint32_t agency_strtab_intern(agency_strtab* table, const char* str, size_t length);
+
+/**
+ * @brief Find a null-terminated string in the table.
+ *
+ * @return The string's offset, or AGENCY_STRTAB_NONE if it was never interned.
+ */
+uint32_t agency_strtab_find(const agency_strtab* table, const char* str);
+
+/**
+ * @brief Release the room the table no longer needs once building ends.
+ *
+ * @param keep_index Keep the index agency_strtab_find() needs; without it
+ *        the table can no longer be searched or added to.
+ */
+void agency_strtab_seal(agency_strtab* table, int keep_index);
+
+void agency_strtab_free(agency_strtab* table);
+
+/**
+ * @brief The string at an offset the table returned.
+ */
+static inline const char* agency_strtab_at(const agency_strtab* table, uint32_t offset) {
+    return table->data + offset;
+}
+
+// Most copies of the read-only structures replication keeps, one per node
+#define AGENCY_NUMA_MAX_REPLICAS 16
+
+/**
+ * @brief Get how many copies of the read-only structures readers spread over.
+ *
+ * @return At least 1; 1 when replication is off.
+ */
+unsigned agency_numa_replicas(void);
+
+/**
+ * @brief Get the copy the calling thread should read, by the node it runs on.
+ *
+ * @return A replica below agency_numa_replicas(); 0, the original, when
+ *         replication is off.
+ */
+unsigned agency_numa_replica(void);
+
+/**
+ * @brief Move whole pages to the node a replica belongs on. Does nothing on a
+ *        single-node machine.
+ */
+void agency_numa_place(void* pages, size_t size, unsigned replica);
+
+/**
+ * @brief Whether a huge-page mode is set.
+ */
+int agency_huge_pages_on(void);
+
+/**
+ * @brief Map a region of huge pages, as the huge-page mode asks.
+ *
+ * @param mapped Receives the size mapped, in whole huge pages.
+ * @return The region, or NULL if the mode is off or no huge pages could be
+ *         had; the caller then takes small pages from the allocator.
+ */
+void* agency_huge_alloc(size_t size, size_t* mapped);
+
+/**
+ * @brief Unmap a region agency_huge_alloc() returned.
+ */
+void agency_huge_free(void* pages, size_t mapped);
+
+/**
+ * @brief A block of whole pages, filled piece by piece with a read-only structure.
+ *
+ * No other allocation shares the block's pages, so once sealed they are
+ * never written, and stay shared with any process forked afterwards.
+ */
+typedef struct {
+    void* block;  // as the allocator returned it
+    char* base;   // first whole page, where the structure starts
+    size_t size;  // whole pages
+    char* next;   // where the next piece goes
+    unsigned replica;
+    int huge;  // mapped by agency_huge_alloc(), in huge pages
+} agency_pack;
+
+/**
+ * @brief Room a piece takes in a pack, padded for the next one.
+ */
+size_t agency_pack_size(size_t size);
+
+/**
+ * @brief Allocate a pack with room for @p size bytes of pieces, on the node
+ *        of @p replica.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int agency_pack_begin(agency_pack* pack, size_t size, unsigned replica);
+
+/**
+ * @brief Copy a piece into a pack.
+ *
+ * @return The copy, or NULL if the piece is empty.
+ */
+void* agency_pack_copy(agency_pack* pack, const void* data, size_t size);
+
+/**
+ * @brief Make a filled pack read-only, so a stray write faults at once.
+ */
+void agency_pack_seal(const agency_pack* pack);
+
+/**
+ * @brief Free a pack. Takes a copy, since the pack often lies in its own pages.
+ */
+void agency_pack_free(agency_pack pack);
+
+/**
+ * @brief Get the bytes of the packs held for replicas other than the original.
+ */
+size_t agency_pack_replica_bytes(void);
+
+/**
+ * @brief Load the configuration file.
+ *
+ * @return A pointer to the configuration object, or NULL if an error occurs.
+ */
+json_object* agency_load_config(void);
+
+/**
+ * @brief One configured agency in the read snapshot.
+ *
+ * Strings are offsets into the snapshot's string table.
+ */
+typedef struct {
+    uint32_t acronym;
+    uint32_t domain;   // AGENCY_STRTAB_NONE if the agency declares none
+    uint32_t context;  // the agency object, pretty-printed
+    uint32_t context_length;
+    uint64_t context_hash;
+    int tier;
+    int has_tier;
+    int position;  // index in the configuration's "agencies" array
+} agency_snapshot_entry;
+
+/**
+ * @brief A rendered acronym list, as agency_get_agencies_by_*() return it.
+ */
+typedef struct {
+    int tier;
+    uint32_t domain;  // offset of the domain, AGENCY_STRTAB_NONE for a tier's list
+    uint32_t json;
+    uint32_t length;
+} agency_snapshot_list;
+
+/**
+ * @brief The immutable snapshot every configuration getter reads.
+ *
+ * A reload replaces the snapshot, so readers hold pointers into it only
+ * between agency_epoch_enter() and agency_epoch_leave(). Once built, the
+ * snapshot and everything it points to lie in one read-only pack, starting
+ * with this struct; with replication on, the published snapshot also owns
+ * a copy for each other node.
+ */
+typedef struct agency_snapshot {
+    agency_strtab strings;  // every string of the entries and lists, interned
+    agency_snapshot_entry* entries;
+    size_t num_entries;
+    uint32_t* index;  // entry position + 1 by acronym, 0 marks an empty slot
+    size_t index_size;
+    agency_snapshot_list all;
+    agency_snapshot_list empty;
+    agency_snapshot_list* tiers;
+    size_t num_tiers;
+    agency_snapshot_list* domains;
+    size_t num_domains;
+    agency_schema_table schemas;
+    agency_pack pack;  // where the snapshot lies once built; no block while building
+    const struct agency_snapshot* replicas[AGENCY_NUMA_MAX_REPLICAS];  // by replica; [0] unused
+    unsigned num_replicas;
+} agency_snapshot;
+
+/**
+ * @brief A string of a snapshot, by its offset.
+ */
+static inline const char* agency_snapshot_string(const agency_snapshot* snapshot, uint32_t offset) {
+    return agency_strtab_at(&snapshot->strings, offset);
+}
+
+/**
+ * @brief Build the read snapshot of a parsed configuration.
+ *
+ * Renders the getters' answers and compiles the issue schemas. Reads the
+ * configuration tree, which must not be shared with other threads while
+ * this runs; the snapshot keeps no reference to it.
+ *
+ * @return The snapshot, or NULL if an error occurs.
+ */
+agency_snapshot* agency_snapshot_build(json_object* config);
+
+/**
+ * @brief Free a snapshot that no reader can still hold.
+ */
+void agency_snapshot_free(agency_snapshot* snapshot);
+
+/**
+ * @brief Make a snapshot the one readers get. Called under the configuration lock.
+ *
+ * @return The snapshot it replaces, for the caller to retire.
+ */
+agency_snapshot* agency_snapshot_exchange(agency_snapshot* snapshot);
+
+/**
+ * @brief Get the published snapshot, loading the configuration on first use.
+ *
+ * Call inside an epoch; the snapshot may be freed once the caller leaves.
+ *
+ * @return The snapshot, or NULL if the configuration could not be loaded.
+ */
+const agency_snapshot* agency_snapshot_current(void);
+
+/**
+ * @brief Find an agency in a snapshot by its exact acronym.
+ *
+ * @return The entry, or NULL if the agency is not configured.
+ */
+const agency_snapshot_entry* agency_snapshot_find(const agency_snapshot* snapshot, const char* acronym);
+
+/**
+ * @brief Get the acronym list of a tier; an unknown tier's list is empty.
+ */
+const agency_snapshot_list* agency_snapshot_tier(const agency_snapshot* snapshot, int tier);
+
+/**
+ * @brief Get the acronym list of a domain; an unknown domain's list is empty.
+ */
+const agency_snapshot_list* agency_snapshot_domain(const agency_snapshot* snapshot, const char* domain);
+
+/**
+ * @brief A reader thread's epoch announcement.
+ */
+typedef struct agency_epoch_record agency_epoch_record;
+
+/**
+ * @brief Enter an epoch, keeping every object reachable now from being freed.
+ *
+ * Entries nest. Only the calling thread's own record is written.
+ *
+ * @return The record to pass to agency_epoch_leave().
+ */
+agency_epoch_record* agency_epoch_enter(void);
+
+/**
+ * @brief Leave the epoch entered by the matching agency_epoch_enter().
+ */
+void agency_epoch_leave(agency_epoch_record* record);
+
+/**
+ * @brief Hand over an object that has been replaced, to be destroyed once
+ *        no reader that could have reached it is still inside.
+ */
+void agency_epoch_retire(void* object, void (*destroy)(void*));
+
+/**
+ * @brief Destroy the retired objects no reader can still reach.
+ */
+void agency_epoch_reclaim(void);
+
+/**
+ * @brief Read the current epoch and the counts of objects retired and reclaimed.
+ */
+void agency_epoch_get_stats(uint64_t* epoch, uint64_t* retired, uint64_t* reclaimed);
+
+/**
+ * @brief Rebuild the resource manifest from a reloaded configuration.
+ *
+ * The new manifest replaces the current one, which is retired through the
+ * epoch. Call with reloads serialized.
+ *
+ * @param config The configuration tree the new snapshot was built from.
+ * @return 0 on success, -1 if it could not be built; the current manifest
+ *         then stays in place.
+ */
+int agency_manifest_reload(json_object* config);
+
+/**
+ * @brief The issue matcher and its NUMA copies, as one published unit.
+ */
+typedef struct agency_matcher_set agency_matcher_set;
+
+/**
+ * @brief Build an issue matcher from a reloaded configuration, for
+ *        agency_matcher_publish().
+ *
+ * @param config The configuration tree the new snapshot was built from.
+ * @return The matcher, or NULL if it could not be built.
+ */
+agency_matcher_set* agency_matcher_build(json_object* config);
+
+/**
+ * @brief Replace the current issue matcher, which is retired through the
+ *        epoch. Call with reloads serialized.
+ */
+void agency_matcher_publish(agency_matcher_set* set);
+
+/**
+ * @brief Free a matcher that was built but not published. May be NULL.
+ */
+void agency_matcher_discard(agency_matcher_set* set);
+
+/**
+ * @brief Look up an agency resource in the manifest.
+ *
+ * Served entirely from memory, like agency_manifest_path(). Call inside an
+ * epoch; the record may be freed by a reload once the caller leaves it.
+ *
+ * @param agency The agency acronym (matched case-insensitively).
+ * @param kind The resource kind.
+ * @return The manifest record, or NULL if the agency has no such resource.
+ */
+agency_resource* agency_manifest_lookup(const char* agency, agency_resource_kind kind);
+
+/**
+ * @brief Visit every resource present in the manifest.
+ *
+ * Call inside an epoch, as for agency_manifest_lookup().
+ *
+ * @param visitor Called once per (agency, kind) pair that has a resource.
+ * @param user_data Opaque pointer passed to @p visitor.
+ */
+void agency_manifest_foreach(agency_manifest_visitor visitor, void* user_data);
+
+/**
+ * @brief Resolve the on-disk path of an agency resource.
+ *
+ * The lookup is served entirely from the resource manifest, so a miss costs
+ * no allocation, no system call and no log output. Call inside an epoch, as
+ * for agency_manifest_lookup().
+ *
+ * @param agency The agency acronym (matched case-insensitively).
+ * @param kind The resource kind.
+ * @return The resource path, or NULL if the agency has no such resource.
+ *         The string is owned by the manifest.
+ */
+const char* agency_manifest_path(const char* agency, agency_resource_kind kind);
+
+/**
+ * @brief Read a file into a string.
+ *
+ * @param file_path The path to the file.
+ * @param length If not NULL, receives the file length in bytes.
+ * @return A pointer to a null-terminated string containing the file contents,
+ *         or NULL if an error occurs. The caller is responsible for freeing
+ *         the returned string.
+ */
+char* agency_read_file(const char* file_path, size_t* length);
+
+/**
+ * @brief Load a resource's contents, from the store if preloaded, else from disk.
+ *
+ * @param resource The manifest record.
+ * @param length If not NULL, receives the length in bytes.
+ * @return A null-terminated copy the caller frees, or NULL if an error occurs.
+ */
+char* agency_resource_read(agency_resource* resource, size_t* length);
+
+/**
+ * @brief Start decoding a stored blob from its first byte.
+ */
+void agency_blob_reader_init(agency_blob_reader* reader, const agency_blob* blob);
+
+/**
+ * @brief Decode the next bytes of a stored blob.
+ *
+ * Matches refer back into earlier output, so the decoded bytes that came
+ * before @p out, up to AGENCY_BLOB_WINDOW of them, must sit right in front
+ * of it.
+ *
+ * @param capacity Bytes to decode; fewer are decoded only at the end.
+ * @param length Receives the bytes written, 0 at the end.
+ * @return 0 on success, -1 if the blob is corrupt.
+ */
+int agency_blob_read(agency_blob_reader* reader, char* out, size_t capacity, size_t* length);
+
+/**
+ * @brief Identify the version of the bytes a resource would be served from.
+ *
+ * AGENCY_STAMP_STORED once the resource is in the store; otherwise derived
+ * from the file's size, modification time and inode.
+ *
+ * @return The stamp, or 0 if the file cannot be examined.
+ */
+uint64_t agency_resource_stamp(agency_resource* resource);
+
+/**
+ * @brief Read a resource's cached content hash and the stamp it was computed for.
+ *
+ * @param stamp Receives the stamp, or 0 if no consistent pair could be read.
+ * @return The hash, or 0 if none is cached or a writer was mid-update.
+ */
+uint64_t agency_resource_cached_hash(const agency_resource* resource, uint64_t* stamp);
+
+/**
+ * @brief Cache the content hash of a resource's bytes of version @p stamp.
+ *
+ * If another thread is updating the pair, the hash is simply not cached.
+ */
+void agency_resource_cache_hash(agency_resource* resource, uint64_t stamp, uint64_t hash);
+
+/**
+ * @brief Build the issue matcher unless it is built already.
+ *
+ * @return 0 if the matcher is ready, -1 if it could not be built.
+ */
+int agency_load_matcher(void);
+
+/**
+ * @brief Get the compiled theorem models, compiling them on first use.
+ *
+ * @return The theorem set, or NULL if it could not be built.
+ */
+const agency_theorem_set* agency_load_theorems(void);
+
+/**
+ * @brief Get the theorems a replica reads: its copy, or the original if it has none.
+ */
+const agency_theorem_set* agency_theorems_replica(unsigned replica);
+
+/**
+ * @brief Copy the compiled theorems onto the node of each replica below
+ *        @p replicas that has no copy yet. Copies last as long as the process.
+ */
+void agency_theorems_replicate(unsigned replicas);
+
+/**
+ * @brief Copy the issue matcher onto the node of each replica below
+ *        @p replicas that has no copy yet, after agency_theorems_replicate().
+ */
+void agency_matcher_replicate(unsigned replicas);
+
+/**
+ * @brief Find the compiled theorems for a domain.
+ *
+ * @param domain The domain name (e.g., "healthcare").
+ * @return The domain's theorems, or NULL if it has no theorem model.
+ */
+const agency_theorem_domain* agency_theorems_for_domain(const char* domain);
+
+/**
+ * @brief Check whether one theorem keyword occurs in lowercased text.
+ */
+int agency_theorem_keyword_found(const agency_theorem_domain* domain, uint32_t keyword,
+                                 const char* text, size_t length);
+
+/**
+ * @brief Check whether a theorem holds for lowercased issue text.
+ *
+ * @return 1 if every keyword of the theorem occurs in @p text, 0 otherwise.
+ */
+int agency_theorem_holds(const agency_theorem_domain* domain, size_t rule_index,
+                         const char* text, size_t length);
+
+/**
+ * @brief Apply a domain's theorems to an issue description.
+ *
+ * @param domain The domain's theorems, or NULL if it has none.
+ * @param text The description, lowercased.
+ * @param length Length of @p text in bytes.
+ * @return 1 if every theorem holds, 0 if any fails or the domain has no
+ *         theorems.
+ */
+int agency_theorems_verify(const agency_theorem_domain* domain, const char* text, size_t length);
+
+/**
+ * @brief Most threads, the submitting one included, that take part in a pool job.
+ */
+#define AGENCY_POOL_MAX_THREADS 64
+
+/**
+ * @brief Work on one item of a pool job.
+ */
+typedef void (*agency_pool_task)(void* context, size_t item);
+
+/**
+ * @brief Run @p task on every item in [0, @p count) across the pool.
+ *
+ * The calling thread takes part, and idle workers join and steal items from
+ * it and from each other. Items run in no particular order and may run
+ * concurrently. Returns once every item has run.
+ */
+void agency_pool_run(size_t count, agency_pool_task task, void* context);
+
+/**
+ * @brief Set how many threads, the caller included, take part in pool jobs.
+ *
+ * @param num_threads Thread count, or 0 for one per online CPU.
+ */
+void agency_pool_set_threads(size_t num_threads);
+
+/**
+ * @brief Get how many threads, the caller included, take part in pool jobs.
+ */
+size_t agency_pool_threads(void);
+
+/**
+ * @brief Read the pool's counters: items run by parallel jobs, and ranges stolen.
+ */
+void agency_pool_get_stats(uint64_t* items, uint64_t* steals);
+
+/**
+ * @brief Find the compiled theorems for an agency's domain.
+ *
+ * @param agency The agency acronym.
+ * @return The theorems, or NULL if the agency is unknown or its domain has
+ *         no theorem model.
+ */
+const agency_theorem_domain* agency_theorems_for_agency(const char* agency);
+
+/**
+ * @brief Compile the issue schemas declared in the configuration.
+ *
+ * Called by agency_snapshot_build() for each configuration loaded. Each
+ * agency gets the default schema overlaid with its domain's and then its
+ * own field declarations; agencies that declare nothing share a program.
+ *
+ * @param config The parsed configuration.
+ * @param table Receives the schemas; left empty on failure.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int agency_schemas_compile(json_object* config, agency_schema_table* table);
+
+/**
+ * @brief Free the schemas of a table and empty it.
+ */
+void agency_schemas_free(agency_schema_table* table);
+
+/**
+ * @brief Get the compiled issue schema for an agency.
+ *
+ * @param table The schemas, or NULL before any configuration has loaded.
+ * @param index The agency's position in the configuration, or -1 for an
+ *        agency that is not configured.
+ * @return The schema. Never NULL; the built-in schema when @p table has none.
+ */
+const agency_schema* agency_schema_at(const agency_schema_table* table, int index);
+
+/**
+ * @brief Find the compiled issue schema for an agency.
+ *
+ * The schema belongs to the current snapshot, so call this and use the
+ * schema inside an epoch.
+ *
+ * @param agency The agency acronym.
+ * @return The schema. Never NULL.
+ */
+const agency_schema* agency_schema_for_agency(const char* agency);
+
+/**
+ * @brief Verify issue JSON in one streaming pass, without building a tree.
+ *
+ * The issue must be an object that satisfies @p schema; then every theorem
+ * must hold for its description.
+ *
+ * @param schema The agency's issue schema, as from agency_schema_for_agency().
+ * @param theorems The agency's theorems, as from agency_theorems_for_agency().
+ * @param json The issue JSON. Need not be null-terminated.
+ * @param length Length of @p json in bytes.
+ * @return 1 if the issue is valid, 0 if it is invalid, -1 if the JSON is
+ *         malformed or the description is not a string.
+ */
+int agency_verify_json(const agency_schema* schema, const agency_theorem_domain* theorems,
+                       const char* json, size_t length);
+
+/**
+ * @brief Outcome of one rule evaluated by agency_verify_json_traced().
+ */
+typedef struct {
+    uint16_t kind;     // agency_rule_kind
+    uint16_t outcome;  // agency_rule_outcome
+    uint32_t index;    // the schema field or theorem rule
+    uint32_t keyword;  // first keyword not found, for a failed theorem
+    uint64_t ns;
+} agency_rule_trace;
+
+/**
+ * @brief Rules evaluated by agency_verify_json_traced(), in evaluation order.
+ *
+ * @c rules must have room for the schema's fields plus the domain's rules.
+ */
+typedef struct {
+    agency_rule_trace* rules;
+    size_t num_rules;
+    size_t error_offset;  // where the JSON stops being valid, or SIZE_MAX
+} agency_verify_trace;
+
+/**
+ * @brief Verify issue JSON as agency_verify_json() does, recording each rule.
+ *
+ * Field checks are recorded as the scan reaches them, with the time spent
+ * skipping and checking the value, followed by the required fields that
+ * never appeared. Unlike agency_verify_json(), every theorem is evaluated
+ * and timed even after one fails; the verdict is unaffected.
+ */
+int agency_verify_json_traced(const agency_schema* schema, const agency_theorem_domain* theorems,
+                              const char* json, size_t length, agency_verify_trace* trace);
+
+/**
+ * @brief Get the calling thread's scratch buffer with room for @p size bytes.
+ *
+ * The buffer is reused by every call on the thread that needs scratch
+ * space, including agency_verify_json(); its contents do not survive them.
+ *
+ * @return The buffer, or NULL on allocation failure.
+ */
+char* agency_scratch(size_t size);
+
+/**
+ * @brief Get the generation of the loaded configuration and theorem models.
+ *
+ * The generation changes whenever either is loaded or reloaded, so results
+ * derived from them can be tagged with it and discarded when it moves on.
+ */
+uint64_t agency_generation(void);
+
+/**
+ * @brief Start a new generation after loading the configuration or theorems.
+ */
+void agency_generation_bump(void);
+
+/**
+ * @brief Get the bytes of the verdict cache table in use.
+ */
+size_t agency_verdict_cache_bytes(void);
+
+/**
+ * @brief Shrink the verdict cache to at most @p bytes, or restore its full
+ *        size for 0, dropping the verdicts that no longer fit.
+ */
+void agency_verdict_cache_limit(uint64_t bytes);
+
+/**
+ * @brief Derive the verdict cache scope of an agency in the current generation.
+ *
+ * Loads the configuration and theorems first if they are not loaded yet.
+ */
+uint64_t agency_verdict_scope(const char* agency);
+
+/**
+ * @brief Verify issue JSON through the verdict cache.
+ *
+ * Same as agency_verify_json(), but an issue whose canonical text was
+ * verified before in the same scope gets the cached verdict.
+ *
+ * @param scope The agency's scope, from agency_verdict_scope().
+ */
+int agency_verify_cached(uint64_t scope, const agency_schema* schema,
+                         const agency_theorem_domain* theorems, const char* json, size_t length);
+
+/**
+ * @brief Check that a buffer holds exactly one well-formed JSON value.
+ *
+ * @param json The text. Need not be null-terminated.
+ * @param length Length of @p json in bytes.
+ * @param error_offset If not NULL, receives the offset at which the text
+ *        stops being valid JSON.
+ * @return 0 if the text is well-formed, -1 otherwise.
+ */
+int agency_json_check(const char* json, size_t length, size_t* error_offset);
+
+/**
+ * @brief Decode the body of an already-validated JSON string.
+ *
+ * Decoding never grows the text, so @p out needs at most end - start bytes.
+ *
+ * @param start First byte after the opening quote.
+ * @param end The closing quote.
+ * @param fold_case Whether to fold ASCII letters to lowercase.
+ * @param out Receives the decoded text.
+ * @return The decoded length.
+ */
+size_t agency_json_decode_string(const char* start, const char* end, int fold_case, char* out);
+
+/**
+ * @brief Issue fields passed to an agency_issue_text_visitor.
+ */
+typedef enum {
+    AGENCY_ISSUE_ID,             // a string id decoded, any other scalar as written
+    AGENCY_ISSUE_TITLE,
+    AGENCY_ISSUE_DESCRIPTION,
+    AGENCY_ISSUE_AFFECTED_AREA   // each string in "affected_areas"
+} agency_issue_field;
+
+/**
+ * @brief Receives the text of one issue field, decoded, not null-terminated.
+ *
+ * @return 0 to continue, any other value to stop and return it.
+ */
+typedef int (*agency_issue_text_visitor)(agency_issue_field field, const char* text,
+                                         size_t length, void* user_data);
+
+/**
+ * @brief Pass an issue's id, title, description and affected areas to a visitor.
+ *
+ * Fields are visited in document order; other fields and values of other
+ * types are skipped. Decoded text may live in the thread's scratch buffer.
+ *
+ * @param json The issue JSON. Need not be null-terminated.
+ * @param length Length of @p json in bytes.
+ * @return 0 once every field was visited, -1 if the JSON is malformed or
+ *         memory runs out, or the visitor's non-zero result.
+ */
+int agency_issue_visit_text(const char* json, size_t length, agency_issue_text_visitor visitor,
+                            void* user_data);
+
+/**
+ * @brief Incremental structural index over a JSON buffer.
+ *
+ * Tokens are the offsets of structural characters outside strings, of both
+ * quotes of each string, and of the first byte of each number or literal.
+ * They are produced one 64-byte block at a time, only as the caller asks
+ * for them. A malformed escape ends the token stream inside its string.
+ */
+typedef struct {
+    const char* data;
+    size_t length;
+    size_t block;           // Offset of the block @c tokens belongs to
+    size_t next;            // Offset of the next block to index
+    uint64_t tokens;        // Unconsumed tokens of the current block
+    uint64_t in_string;     // All ones if the last block ended inside a string
+    uint64_t escape_carry;  // 1 if the last block ended on an escaping backslash
+    uint64_t scalar_carry;  // 1 if the last block ended inside a scalar
+    size_t last;            // Offset of the token taken last
+    int stopped;
+} agency_scanner;
+
+/**
+ * @brief Start indexing a buffer.
+ */
+void agency_scanner_init(agency_scanner* scanner, const char* data, size_t length);
+
+/**
+ * @brief Index blocks up to the next one that holds a token.
+ *
+ * @return 1 if tokens are available, 0 at the end of the input.
+ */
+int agency_scanner_advance(agency_scanner* scanner);
+
+/**
+ * @brief Take the next token.
+ *
+ * @return The token's offset, or the buffer length when there are no more.
+ */
+static inline size_t agency_scanner_next(agency_scanner* scanner) {
+    while (scanner->tokens == 0) {
+        if (!agency_scanner_advance(scanner)) {
+            scanner->last = scanner->length;
+            return scanner->length;
+        }
+    }
+    scanner->last = scanner->block + (size_t)__builtin_ctzll(scanner->tokens);
+    scanner->tokens &= scanner->tokens - 1;
+    return scanner->last;
+}
+
+/**
+ * @brief Name the block classifier in use: "avx2", "sse4.2" or "scalar".
+ */
+const char* agency_scan_isa(void);
+
+/**
+ * @brief Switch the block classifier, for benchmarks and tests.
+ *
+ * Not safe while other threads are scanning.
+ *
+ * @param isa "avx2", "sse4.2" or "scalar".
+ * @return 0 on success, -1 if the name is unknown or the CPU lacks it.
+ */
+int agency_scan_select(const char* isa);
+
+/**
+ * @brief Hash a buffer with XXH64.
+ *
+ * @param data The bytes to hash.
+ * @param length Number of bytes.
+ * @param seed Hash seed.
+ * @return The 64-bit hash.
+ */
+uint64_t agency_hash64(const void* data, size_t length, uint64_t seed);
+
+/**
+ * @brief Compute the content hash used for resource ETags.
+ *
+ * Same as agency_hash64() with seed 0, except that it never returns 0, which
+ * callers use to mean "no hash known".
+ */
+uint64_t agency_content_hash(const void* data, size_t length);
+
+#endif /* AGENCY_INTERNAL_H */
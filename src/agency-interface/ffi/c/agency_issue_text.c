@@ -0,0 +1,145 @@
+/**
+ * @file agency_issue_text.c
+ * @brief Locating the free-text fields of an issue without parsing it.
+ *
+ * The matcher and the near-duplicate index both read only an issue's id,
+ * title, description and affected areas. They are found over the structural
+ * index of agency_scan.c after one well-formedness check, so other fields
+ * are skipped by structure alone, and strings are decoded only when they
+ * contain escapes.
+ */
+
+#include <string.h>
+#include "agency_internal.h"
+
+/**
+ * @brief Pass a string value whose opening quote was the last token to the visitor.
+ *
+ * @return The visitor's result, or -1 on allocation failure.
+ */
+static int visit_string(agency_scanner* scanner, size_t open, agency_issue_field field,
+                        agency_issue_text_visitor visitor, void* user_data) {
+    const char* start = scanner->data + open + 1;
+    const char* end = scanner->data + agency_scanner_next(scanner);
+
+    if (memchr(start, '\\', (size_t)(end - start)) == NULL) {
+        return visitor(field, start, (size_t)(end - start), user_data);
+    }
+
+    char* decoded = agency_scratch((size_t)(end - start));
+    if (decoded == NULL) {
+        return -1;
+    }
+    return visitor(field, decoded, agency_json_decode_string(start, end, 0, decoded), user_data);
+}
+
+/**
+ * @brief Skip a well-formed value whose first token was the last one taken.
+ */
+static void skip_value(agency_scanner* scanner, size_t first) {
+    char c = scanner->data[first];
+    if (c == '"') {
+        agency_scanner_next(scanner);
+        return;
+    }
+    if (c != '{' && c != '[') {
+        return;
+    }
+
+    int depth = 1;
+    while (depth > 0) {
+        size_t token = agency_scanner_next(scanner);
+        c = scanner->data[token];
+        if (c == '"') {
+            agency_scanner_next(scanner);
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            depth--;
+        }
+    }
+}
+
+/**
+ * @brief Identify a top-level key whose value is visited.
+ *
+ * @return The field, or -1 for any other key.
+ */
+static int find_key(const char* start, const char* end) {
+    static const char* const keys[] = {"id", "title", "description", "affected_areas"};
+    char decoded[64];
+    size_t length = (size_t)(end - start);
+
+    if (memchr(start, '\\', length) != NULL) {
+        if (length > sizeof(decoded)) {
+            return -1;
+        }
+        length = agency_json_decode_string(start, end, 0, decoded);
+        start = decoded;
+    }
+
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        if (strlen(keys[i]) == length && memcmp(keys[i], start, length) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int agency_issue_visit_text(const char* json, size_t length, agency_issue_text_visitor visitor,
+                            void* user_data) {
+    if (agency_json_check(json, length, NULL) != 0) {
+        return -1;
+    }
+
+    agency_scanner scanner;
+    agency_scanner_init(&scanner, json, length);
+
+    size_t token = agency_scanner_next(&scanner);
+    if (json[token] != '{') {
+        return 0;
+    }
+
+    for (token = agency_scanner_next(&scanner); json[token] == '"';) {
+        size_t key_end = agency_scanner_next(&scanner);
+        int field = find_key(json + token + 1, json + key_end);
+
+        agency_scanner_next(&scanner);  // ':'
+        size_t value = agency_scanner_next(&scanner);
+        int status = 0;
+        if (field >= 0 && json[value] == '"') {
+            status = visit_string(&scanner, value, (agency_issue_field)field, visitor, user_data);
+        } else if (field == AGENCY_ISSUE_ID && json[value] != '{' && json[value] != '[') {
+            // A number or literal id is passed as written
+            size_t end = value + 1;
+            while (end < length && memchr(" \t\n\r,}", json[end], 6) == NULL) {
+                end++;
+            }
+            status = visitor(AGENCY_ISSUE_ID, json + value, end - value, user_data);
+        } else if (field == AGENCY_ISSUE_AFFECTED_AREA && json[value] == '[') {
+            // Strings directly in the list are areas; anything else is skipped
+            size_t item = agency_scanner_next(&scanner);
+            while (status == 0 && json[item] != ']') {
+                if (json[item] == '"') {
+                    status = visit_string(&scanner, item, AGENCY_ISSUE_AFFECTED_AREA, visitor, user_data);
+                } else if (json[item] != ',') {
+                    skip_value(&scanner, item);
+                }
+                item = agency_scanner_next(&scanner);
+            }
+        } else {
+            skip_value(&scanner, value);
+        }
+        if (status != 0) {
+            return status;
+        }
+
+        // ',' then the next key, or '}'
+        token = agency_scanner_next(&scanner);
+        if (json[token] == ',') {
+            token = agency_scanner_next(&scanner);
+        }
+    }
+
+    return 0;
+}
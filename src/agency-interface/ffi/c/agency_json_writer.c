@@ -0,0 +1,196 @@
+/**
+ * @file agency_json_writer.c
+ * @brief Streaming JSON output into a response arena.
+ *
+ * Responses are written straight to text rather than built as a json-c tree
+ * and serialized. The output is byte for byte what json-c produces with
+ * JSON_C_TO_STRING_PLAIN or JSON_C_TO_STRING_PRETTY, escaping included, so
+ * clients see the same responses as before.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "agency_internal.h"
+
+static void reserve(agency_json_writer* writer, size_t extra) {
+    if (writer->failed || writer->capacity - writer->length > extra) {
+        return;
+    }
+
+    size_t capacity = writer->capacity ? writer->capacity * 2 : 1024;
+    while (capacity - writer->length <= extra) {
+        capacity *= 2;
+    }
+    char* data = (char*)agency_arena_grow(writer->arena, writer->data, writer->capacity, capacity);
+    if (data == NULL) {
+        writer->failed = 1;
+        return;
+    }
+    writer->data = data;
+    writer->capacity = capacity;
+}
+
+static void put(agency_json_writer* writer, const char* text, size_t length) {
+    reserve(writer, length);
+    if (!writer->failed) {
+        memcpy(writer->data + writer->length, text, length);
+        writer->length += length;
+    }
+}
+
+static void put_indent(agency_json_writer* writer, unsigned depth) {
+    reserve(writer, (size_t)depth * 2);
+    if (!writer->failed) {
+        memset(writer->data + writer->length, ' ', (size_t)depth * 2);
+        writer->length += (size_t)depth * 2;
+    }
+}
+
+/**
+ * @brief Separate a new member or element from the previous one.
+ */
+static void before_item(agency_json_writer* writer) {
+    if (writer->after_key) {
+        writer->after_key = 0;
+        return;
+    }
+    if (writer->depth == 0) {
+        return;
+    }
+
+    uint64_t bit = 1ULL << (writer->depth - 1);
+    if (writer->has_items & bit) {
+        put(writer, writer->pretty ? ",\n" : ",", writer->pretty ? 2 : 1);
+    }
+    writer->has_items |= bit;
+    if (writer->pretty) {
+        put_indent(writer, writer->depth);
+    }
+}
+
+static void open_container(agency_json_writer* writer, char bracket) {
+    before_item(writer);
+    if (writer->depth >= AGENCY_JSON_MAX_DEPTH) {
+        writer->failed = 1;
+        return;
+    }
+    put(writer, &bracket, 1);
+    if (writer->pretty) {
+        put(writer, "\n", 1);
+    }
+    writer->depth++;
+    writer->has_items &= ~(1ULL << (writer->depth - 1));
+}
+
+static void close_container(agency_json_writer* writer, char bracket) {
+    if (writer->depth == 0) {
+        writer->failed = 1;
+        return;
+    }
+    int had_items = (writer->has_items & (1ULL << (writer->depth - 1))) != 0;
+    writer->depth--;
+    if (writer->pretty) {
+        if (had_items) {
+            put(writer, "\n", 1);
+        }
+        put_indent(writer, writer->depth);
+    }
+    put(writer, &bracket, 1);
+}
+
+/**
+ * @brief Write a quoted string, escaped as json-c escapes it.
+ */
+static void put_quoted(agency_json_writer* writer, const char* text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+
+    put(writer, "\"", 1);
+    size_t start = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        const char* escape = NULL;
+        switch (c) {
+        case '\b': escape = "\\b"; break;
+        case '\n': escape = "\\n"; break;
+        case '\r': escape = "\\r"; break;
+        case '\t': escape = "\\t"; break;
+        case '\f': escape = "\\f"; break;
+        case '"': escape = "\\\""; break;
+        case '\\': escape = "\\\\"; break;
+        case '/': escape = "\\/"; break;
+        default: break;
+        }
+        if (escape == NULL && c >= 0x20) {
+            continue;
+        }
+
+        put(writer, text + start, i - start);
+        if (escape != NULL) {
+            put(writer, escape, 2);
+        } else {
+            char unicode[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+            put(writer, unicode, sizeof(unicode));
+        }
+        start = i + 1;
+    }
+    put(writer, text + start, length - start);
+    put(writer, "\"", 1);
+}
+
+void agency_json_writer_init(agency_json_writer* writer, agency_arena* arena, int pretty) {
+    memset(writer, 0, sizeof(*writer));
+    writer->arena = arena;
+    writer->pretty = pretty;
+    writer->failed = arena == NULL;
+}
+
+void agency_json_begin_object(agency_json_writer* writer) {
+    open_container(writer, '{');
+}
+
+void agency_json_end_object(agency_json_writer* writer) {
+    close_container(writer, '}');
+}
+
+void agency_json_begin_array(agency_json_writer* writer) {
+    open_container(writer, '[');
+}
+
+void agency_json_end_array(agency_json_writer* writer) {
+    close_container(writer, ']');
+}
+
+void agency_json_key(agency_json_writer* writer, const char* key) {
+    before_item(writer);
+    put_quoted(writer, key, strlen(key));
+    put(writer, ":", 1);
+    writer->after_key = 1;
+}
+
+void agency_json_string(agency_json_writer* writer, const char* text, size_t length) {
+    before_item(writer);
+    put_quoted(writer, text, length);
+}
+
+void agency_json_int(agency_json_writer* writer, int64_t value) {
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%" PRId64, value);
+    before_item(writer);
+    put(writer, digits, (size_t)length);
+}
+
+void agency_json_null(agency_json_writer* writer) {
+    before_item(writer);
+    put(writer, "null", 4);
+}
+
+const char* agency_json_writer_finish(agency_json_writer* writer, size_t* length) {
+    reserve(writer, 1);
+    if (writer->failed || writer->depth != 0) {
+        return NULL;
+    }
+    writer->data[writer->length] = '\0';
+    *length = writer->length;
+    return writer->data;
+}
@@ -0,0 +1,484 @@
+/**
+ * @file agency_manifest.c
+ * @brief Resource manifest for the file-backed agency resources.
+ *
+ * The manifest is built from the configuration and from the contents of the
+ * finder, connector and template directories, on first use and again on
+ * every configuration reload. Every lookup, hit or miss, is answered from
+ * memory: the hot path performs no path formatting, no allocation and no
+ * failed fopen() for agencies that simply do not ship a given resource.
+ *
+ * A reload swaps in a new manifest and retires the old one through the
+ * epoch, so a record returned by a lookup stays valid until the caller
+ * leaves the epoch it looked it up in. Resources whose path is unchanged
+ * keep their content hash and stored blob across the swap.
+ */
+
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "agency_internal.h"
+
+/**
+ * @brief One manifest entry, keyed by the lowercase agency name.
+ */
+typedef struct {
+    char* name;
+    agency_resource resources[AGENCY_RESOURCE_COUNT];
+} manifest_entry;
+
+/**
+ * @brief The resource manifest: an entry array plus an open-addressed index.
+ */
+typedef struct {
+    manifest_entry* entries;
+    size_t count;
+    size_t capacity;
+    uint32_t* index;    // entry position + 1, 0 marks an empty slot
+    size_t index_size;  // always a power of two
+} resource_manifest;
+
+// Global manifest, built on first use and replaced on reload
+static _Atomic(resource_manifest*) g_manifest = NULL;
+static pthread_once_t g_manifest_once = PTHREAD_ONCE_INIT;
+
+// Directory and file name suffix for each resource kind
+static const struct {
+    const char* dir;
+    const char* suffix;
+} g_resource_layout[AGENCY_RESOURCE_COUNT] = {
+    [AGENCY_RESOURCE_ISSUE_FINDER] = {ISSUE_FINDER_DIR, "_finder.py"},
+    [AGENCY_RESOURCE_RESEARCH_CONNECTOR] = {CONNECTOR_DIR, "_connector.py"},
+    [AGENCY_RESOURCE_ASCII_ART] = {TEMPLATES_DIR, "_ascii.txt"},
+};
+
+/**
+ * @brief Hash a name with FNV-1a.
+ */
+static uint32_t hash_name(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Copy a name into a buffer, lowercased.
+ *
+ * @return 0 on success, -1 if the name does not fit in AGENCY_NAME_MAX.
+ */
+static int lowercase_name(const char* name, size_t len, char out[AGENCY_NAME_MAX]) {
+    if (len >= AGENCY_NAME_MAX) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        out[i] = (char)tolower((unsigned char)name[i]);
+    }
+    out[len] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Find the index slot for a lowercase name.
+ *
+ * @return The slot holding the name, or the empty slot where it belongs.
+ */
+static size_t manifest_slot(const resource_manifest* manifest, const char* name) {
+    size_t mask = manifest->index_size - 1;
+    size_t slot = hash_name(name) & mask;
+
+    while (manifest->index[slot] != 0) {
+        const manifest_entry* entry = &manifest->entries[manifest->index[slot] - 1];
+        if (strcmp(entry->name, name) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Double the size of the manifest index and reinsert every entry.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int manifest_grow_index(resource_manifest* manifest) {
+    size_t new_size = manifest->index_size ? manifest->index_size * 2 : 64;
+    uint32_t* new_index = (uint32_t*)agency_calloc(new_size, sizeof(uint32_t));
+    if (new_index == NULL) {
+        return -1;
+    }
+
+    agency_free(manifest->index);
+    manifest->index = new_index;
+    manifest->index_size = new_size;
+
+    for (size_t i = 0; i < manifest->count; i++) {
+        size_t slot = manifest_slot(manifest, manifest->entries[i].name);
+        manifest->index[slot] = (uint32_t)(i + 1);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Find or create the entry for a lowercase name.
+ *
+ * @return A pointer to the entry, or NULL on allocation failure.
+ */
+static manifest_entry* manifest_intern(resource_manifest* manifest, const char* name) {
+    // Keep the index at most half full
+    if ((manifest->count + 1) * 2 > manifest->index_size) {
+        if (manifest_grow_index(manifest) != 0) {
+            return NULL;
+        }
+    }
+
+    size_t slot = manifest_slot(manifest, name);
+    if (manifest->index[slot] != 0) {
+        return &manifest->entries[manifest->index[slot] - 1];
+    }
+
+    if (manifest->count == manifest->capacity) {
+        size_t new_capacity = manifest->capacity ? manifest->capacity * 2 : 64;
+        manifest_entry* entries = (manifest_entry*)agency_realloc(manifest->entries,
+                                                           new_capacity * sizeof(manifest_entry));
+        if (entries == NULL) {
+            return NULL;
+        }
+        manifest->entries = entries;
+        manifest->capacity = new_capacity;
+    }
+
+    manifest_entry* entry = &manifest->entries[manifest->count];
+    memset(entry, 0, sizeof(*entry));
+    entry->name = agency_strdup(name);
+    if (entry->name == NULL) {
+        return NULL;
+    }
+
+    manifest->index[slot] = (uint32_t)(manifest->count + 1);
+    manifest->count++;
+    return entry;
+}
+
+/**
+ * @brief Record a resource path for an agency, keeping the first one seen.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int manifest_set_path(resource_manifest* manifest, const char* name,
+                             agency_resource_kind kind, const char* dir, const char* file) {
+    manifest_entry* entry = manifest_intern(manifest, name);
+    if (entry == NULL) {
+        return -1;
+    }
+
+    if (entry->resources[kind].path != NULL) {
+        return 0;
+    }
+
+    size_t path_len = strlen(dir) + 1 + strlen(file) + 1;
+    entry->resources[kind].path = (char*)agency_malloc(path_len);
+    if (entry->resources[kind].path == NULL) {
+        return -1;
+    }
+
+    snprintf(entry->resources[kind].path, path_len, "%s/%s", dir, file);
+    return 0;
+}
+
+/**
+ * @brief Index every resource file found in the directory for one kind.
+ *
+ * A missing directory is not an error; it simply contributes no entries.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int manifest_scan_dir(resource_manifest* manifest, agency_resource_kind kind) {
+    const char* dir_path = g_resource_layout[kind].dir;
+    const char* suffix = g_resource_layout[kind].suffix;
+    size_t suffix_len = strlen(suffix);
+
+    DIR* dir = opendir(dir_path);
+    if (dir == NULL) {
+        return 0;
+    }
+
+    int status = 0;
+    struct dirent* dirent;
+    while ((dirent = readdir(dir)) != NULL) {
+        size_t len = strlen(dirent->d_name);
+        if (len <= suffix_len || strcmp(dirent->d_name + len - suffix_len, suffix) != 0) {
+            continue;
+        }
+
+        char name[AGENCY_NAME_MAX];
+        if (lowercase_name(dirent->d_name, len - suffix_len, name) != 0) {
+            continue;
+        }
+
+        if (manifest_set_path(manifest, name, kind, dir_path, dirent->d_name) != 0) {
+            status = -1;
+            break;
+        }
+    }
+
+    closedir(dir);
+    return status;
+}
+
+/**
+ * @brief Apply the snapshot's `ascii_template` overrides to the manifest.
+ *
+ * Agencies that name their template explicitly use that file instead of the
+ * `<agency>_ascii.txt` convention, provided it exists.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int manifest_apply_snapshot(resource_manifest* manifest, json_object* config) {
+    json_object* agencies;
+    if (config == NULL || !json_object_object_get_ex(config, "agencies", &agencies)) {
+        return 0;
+    }
+
+    int num_agencies = json_object_array_length(agencies);
+    for (int i = 0; i < num_agencies; i++) {
+        json_object* agency_obj = json_object_array_get_idx(agencies, i);
+        json_object* acronym;
+        json_object* ascii_template;
+        if (!json_object_object_get_ex(agency_obj, "acronym", &acronym) ||
+            !json_object_object_get_ex(agency_obj, "ascii_template", &ascii_template)) {
+            continue;
+        }
+
+        const char* acronym_str = json_object_get_string(acronym);
+        const char* template_str = json_object_get_string(ascii_template);
+        char name[AGENCY_NAME_MAX];
+        if (lowercase_name(acronym_str, strlen(acronym_str), name) != 0) {
+            continue;
+        }
+
+        char path[512];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", TEMPLATES_DIR, template_str);
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+
+        manifest_entry* entry = manifest_intern(manifest, name);
+        if (entry == NULL) {
+            return -1;
+        }
+
+        char* override = agency_strdup(path);
+        if (override == NULL) {
+            return -1;
+        }
+        agency_free(entry->resources[AGENCY_RESOURCE_ASCII_ART].path);
+        entry->resources[AGENCY_RESOURCE_ASCII_ART].path = override;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Free a manifest and everything it owns.
+ */
+static void manifest_free(resource_manifest* manifest) {
+    if (manifest == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < manifest->count; i++) {
+        agency_free(manifest->entries[i].name);
+        for (int kind = 0; kind < AGENCY_RESOURCE_COUNT; kind++) {
+            agency_free(manifest->entries[i].resources[kind].path);
+        }
+    }
+
+    agency_free(manifest->entries);
+    agency_free(manifest->index);
+    agency_free(manifest);
+}
+
+/**
+ * @brief Add up the memory a manifest holds.
+ */
+static size_t manifest_bytes(const resource_manifest* manifest) {
+    size_t bytes = sizeof(resource_manifest) + manifest->capacity * sizeof(manifest_entry) +
+                   manifest->index_size * sizeof(uint32_t);
+    for (size_t i = 0; i < manifest->count; i++) {
+        bytes += strlen(manifest->entries[i].name) + 1;
+        for (int kind = 0; kind < AGENCY_RESOURCE_COUNT; kind++) {
+            const char* path = manifest->entries[i].resources[kind].path;
+            bytes += path != NULL ? strlen(path) + 1 : 0;
+        }
+    }
+    return bytes;
+}
+
+/**
+ * @brief Destroy a manifest retired by a reload, returning its accounted memory.
+ */
+static void manifest_destroy(void* object) {
+    resource_manifest* manifest = (resource_manifest*)object;
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, -(int64_t)manifest_bytes(manifest), -(int64_t)manifest->count);
+    manifest_free(manifest);
+}
+
+/**
+ * @brief Build a resource manifest from the directories and a configuration.
+ *
+ * @return The manifest, or NULL if it could not be built.
+ */
+static resource_manifest* build_manifest(json_object* config) {
+    resource_manifest* manifest = (resource_manifest*)agency_calloc(1, sizeof(resource_manifest));
+    if (manifest == NULL || manifest_grow_index(manifest) != 0) {
+        fprintf(stderr, "Error allocating resource manifest\n");
+        manifest_free(manifest);
+        return NULL;
+    }
+
+    int status = 0;
+    for (int kind = 0; kind < AGENCY_RESOURCE_COUNT && status == 0; kind++) {
+        status = manifest_scan_dir(manifest, (agency_resource_kind)kind);
+    }
+    if (status == 0) {
+        status = manifest_apply_snapshot(manifest, config);
+    }
+
+    if (status != 0) {
+        fprintf(stderr, "Error building resource manifest\n");
+        manifest_free(manifest);
+        return NULL;
+    }
+
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, (int64_t)manifest_bytes(manifest), (int64_t)manifest->count);
+    return manifest;
+}
+
+/**
+ * @brief Build the first resource manifest. Runs exactly once.
+ */
+static void build_first_manifest(void) {
+    atomic_store_explicit(&g_manifest, build_manifest(agency_load_config()), memory_order_release);
+}
+
+/**
+ * @brief Get the current resource manifest, building it on first use.
+ *
+ * Call inside an epoch; a reload may retire the manifest once the caller leaves.
+ *
+ * @return A pointer to the manifest, or NULL if it could not be built.
+ */
+static resource_manifest* load_manifest(void) {
+    pthread_once(&g_manifest_once, build_first_manifest);
+    return atomic_load_explicit(&g_manifest, memory_order_acquire);
+}
+
+/**
+ * @brief Carry content hashes and stored blobs over to a new manifest.
+ *
+ * Only resources that still resolve to the same path keep them; the
+ * store's blobs live in its arena, so they outlast the old manifest.
+ */
+static void manifest_inherit(resource_manifest* manifest, const resource_manifest* old) {
+    for (size_t i = 0; i < manifest->count; i++) {
+        manifest_entry* entry = &manifest->entries[i];
+        size_t slot = manifest_slot(old, entry->name);
+        if (old->index[slot] == 0) {
+            continue;
+        }
+
+        const manifest_entry* old_entry = &old->entries[old->index[slot] - 1];
+        for (int kind = 0; kind < AGENCY_RESOURCE_COUNT; kind++) {
+            agency_resource* resource = &entry->resources[kind];
+            const agency_resource* old_resource = &old_entry->resources[kind];
+            if (resource->path == NULL || old_resource->path == NULL ||
+                strcmp(resource->path, old_resource->path) != 0) {
+                continue;
+            }
+            uint64_t stamp;
+            uint64_t hash = agency_resource_cached_hash(old_resource, &stamp);
+            if (hash != 0) {
+                agency_resource_cache_hash(resource, stamp, hash);
+            }
+            atomic_store(&resource->blob, atomic_load(&old_resource->blob));
+        }
+    }
+}
+
+int agency_manifest_reload(json_object* config) {
+    // Reloads are serialized, so nothing else retires the old manifest meanwhile
+    resource_manifest* old = load_manifest();
+
+    resource_manifest* manifest = build_manifest(config);
+    if (manifest == NULL) {
+        return -1;
+    }
+    if (old != NULL) {
+        manifest_inherit(manifest, old);
+    }
+
+    atomic_store_explicit(&g_manifest, manifest, memory_order_release);
+    if (old != NULL) {
+        agency_epoch_retire(old, manifest_destroy);
+    }
+    return 0;
+}
+
+agency_resource* agency_manifest_lookup(const char* agency, agency_resource_kind kind) {
+    if (agency == NULL || kind < 0 || kind >= AGENCY_RESOURCE_COUNT) {
+        return NULL;
+    }
+
+    resource_manifest* manifest = load_manifest();
+    if (manifest == NULL) {
+        return NULL;
+    }
+
+    char name[AGENCY_NAME_MAX];
+    if (lowercase_name(agency, strlen(agency), name) != 0) {
+        return NULL;
+    }
+
+    size_t slot = manifest_slot(manifest, name);
+    if (manifest->index[slot] == 0) {
+        return NULL;
+    }
+
+    agency_resource* resource = &manifest->entries[manifest->index[slot] - 1].resources[kind];
+    return resource->path != NULL ? resource : NULL;
+}
+
+void agency_manifest_foreach(agency_manifest_visitor visitor, void* user_data) {
+    resource_manifest* manifest = load_manifest();
+    if (manifest == NULL || visitor == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < manifest->count; i++) {
+        manifest_entry* entry = &manifest->entries[i];
+        for (int kind = 0; kind < AGENCY_RESOURCE_COUNT; kind++) {
+            if (entry->resources[kind].path != NULL) {
+                visitor(entry->name, (agency_resource_kind)kind, &entry->resources[kind], user_data);
+            }
+        }
+    }
+}
+
+const char* agency_manifest_path(const char* agency, agency_resource_kind kind) {
+    agency_resource* resource = agency_manifest_lookup(agency, kind);
+    return resource != NULL ? resource->path : NULL;
+}
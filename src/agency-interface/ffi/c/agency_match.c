@@ -0,0 +1,649 @@
+/**
+ * @file agency_match.c
+ * @brief Matching issues to theorem components and domain topics.
+ *
+ * Every theorem component of every domain and every topic in the
+ * configuration's "topics" section go into one Aho-Corasick automaton,
+ * built on first use and again by each configuration reload, which retires
+ * the one it replaces through the epoch. An issue's title, description and affected areas, located by
+ * agency_issue_text.c, are then run through it in a single pass, so the
+ * cost of matching depends on the length of the issue and the number of
+ * matches, not on how many theorems are loaded.
+ *
+ * The automaton is a dense table over byte classes: bytes that occur in no
+ * pattern share class 0, and case and separators are folded by the class
+ * map itself, so the text needs no normalizing copy. Matching is
+ * case-insensitive for ASCII and treats '_' and ' ' alike, so the component
+ * "national_defense" matches "National Defense". As with the prover's
+ * keyword checks, a pattern matches anywhere, not only at word boundaries.
+ */
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agency_internal.h"
+
+/**
+ * @brief A topic from the configuration and the state that recognizes it.
+ *
+ * The domain and topic are offsets into the matcher's string table.
+ */
+typedef struct {
+    uint32_t domain;
+    uint32_t topic;
+    uint32_t state;
+} matcher_topic;
+
+/**
+ * @brief A string to insert into the automaton and where to note its state.
+ */
+typedef struct {
+    const char* text;
+    size_t length;
+    uint32_t* state;
+} matcher_pattern;
+
+/**
+ * @brief The compiled automaton. State 0 is the root and never reports.
+ */
+typedef struct {
+    uint16_t byte_class[256];
+    size_t num_classes;
+    size_t num_states;
+    uint32_t* next;         // num_states rows of num_classes transitions
+    uint32_t* report;       // first pattern-ending state on the state's suffix chain, or 0
+    uint32_t* report_next;  // for a pattern-ending state, the next one on its chain, or 0
+    const agency_theorem_set* theorems;
+    uint32_t* component_states;  // per domain, per component, in declaration order
+    size_t* component_base;      // index of each domain's first component state
+    matcher_topic* topics;
+    size_t num_topics;
+    agency_strtab strings;  // topic domains and topics, interned
+    size_t bytes;       // charged while built
+    agency_pack pack;   // where a packed matcher lies; no block while built
+} agency_matcher;
+
+/**
+ * @brief A published matcher and its copies on other NUMA nodes, which are
+ *        retired and freed together.
+ */
+struct agency_matcher_set {
+    const agency_matcher* original;
+    _Atomic(const agency_matcher*) replicas[AGENCY_NUMA_MAX_REPLICAS];  // [0] unused
+};
+
+// The published matchers, replaced by each reload
+static _Atomic(agency_matcher_set*) g_matchers = NULL;
+// Serializes the first build, publishing and replicating
+static pthread_mutex_t g_matcher_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief The byte a pattern or text byte is compared as.
+ */
+static unsigned char fold_byte(unsigned char c) {
+    return c == '_' ? ' ' : (unsigned char)tolower(c);
+}
+
+static void matcher_free(agency_matcher* matcher) {
+    if (matcher == NULL) {
+        return;
+    }
+
+    agency_strtab_free(&matcher->strings);
+    agency_free(matcher->topics);
+    agency_free(matcher->component_states);
+    agency_free(matcher->component_base);
+    agency_free(matcher->next);
+    agency_free(matcher->report);
+    agency_free(matcher->report_next);
+    agency_free(matcher);
+}
+
+/**
+ * @brief Free a built or packed matcher and return the memory it was charged.
+ *
+ * Only the original counts the states; its copies count their bytes.
+ */
+static void matcher_release(const agency_matcher* matcher, int original) {
+    int64_t objects = original ? -(int64_t)matcher->num_states : 0;
+    if (matcher->pack.block != NULL) {
+        agency_memory_charge(AGENCY_MEMORY_INDEXES, -(int64_t)matcher->pack.size, objects);
+        agency_pack_free(matcher->pack);
+    } else {
+        agency_memory_charge(AGENCY_MEMORY_INDEXES, -(int64_t)matcher->bytes, objects);
+        matcher_free((agency_matcher*)matcher);
+    }
+}
+
+/**
+ * @brief Copy the configuration's topics into the matcher.
+ *
+ * @return The number of topics, or -1 on allocation failure.
+ */
+static long collect_topics(agency_matcher* matcher, json_object* config) {
+    json_object* topics;
+    if (config == NULL || !json_object_object_get_ex(config, "topics", &topics) ||
+        !json_object_is_type(topics, json_type_object)) {
+        return 0;
+    }
+
+    size_t count = 0;
+    json_object_object_foreach(topics, domain, list) {
+        (void)domain;
+        if (json_object_is_type(list, json_type_array)) {
+            count += json_object_array_length(list);
+        }
+    }
+    matcher->topics = (matcher_topic*)agency_calloc(count + 1, sizeof(matcher_topic));
+    if (matcher->topics == NULL) {
+        return -1;
+    }
+
+    json_object_object_foreach(topics, topic_domain, topic_list) {
+        if (!json_object_is_type(topic_list, json_type_array)) {
+            continue;
+        }
+        for (size_t i = 0; i < json_object_array_length(topic_list); i++) {
+            json_object* topic = json_object_array_get_idx(topic_list, i);
+            if (!json_object_is_type(topic, json_type_string)) {
+                continue;
+            }
+            // Domains repeat for every topic, and topics across domains
+            matcher_topic* entry = &matcher->topics[matcher->num_topics++];
+            entry->domain = agency_strtab_intern(&matcher->strings, topic_domain, strlen(topic_domain));
+            const char* topic_str = json_object_get_string(topic);
+            entry->topic = agency_strtab_intern(&matcher->strings, topic_str, strlen(topic_str));
+            if (entry->domain == AGENCY_STRTAB_NONE || entry->topic == AGENCY_STRTAB_NONE) {
+                return -1;
+            }
+        }
+    }
+
+    agency_strtab_seal(&matcher->strings, 0);
+    return (long)matcher->num_topics;
+}
+
+/**
+ * @brief Build the goto/failure automaton as a dense transition table.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int build_automaton(agency_matcher* matcher, const matcher_pattern* patterns,
+                           size_t num_patterns) {
+    // Class 0 is every byte no pattern contains
+    uint16_t folded_class[256] = {0};
+    size_t max_states = 1;
+    matcher->num_classes = 1;
+    for (size_t i = 0; i < num_patterns; i++) {
+        for (size_t j = 0; j < patterns[i].length; j++) {
+            unsigned char c = fold_byte((unsigned char)patterns[i].text[j]);
+            if (folded_class[c] == 0) {
+                folded_class[c] = (uint16_t)matcher->num_classes++;
+            }
+        }
+        max_states += patterns[i].length;
+    }
+    for (int c = 0; c < 256; c++) {
+        matcher->byte_class[c] = folded_class[fold_byte((unsigned char)c)];
+    }
+
+    size_t classes = matcher->num_classes;
+    matcher->next = (uint32_t*)agency_calloc(max_states * classes, sizeof(uint32_t));
+    uint32_t* fail = (uint32_t*)agency_calloc(max_states, sizeof(uint32_t));
+    uint32_t* queue = (uint32_t*)agency_malloc(max_states * sizeof(uint32_t));
+    uint8_t* ends = (uint8_t*)agency_calloc(max_states, 1);
+    if (matcher->next == NULL || fail == NULL || queue == NULL || ends == NULL) {
+        agency_free(fail);
+        agency_free(queue);
+        agency_free(ends);
+        return -1;
+    }
+
+    // The trie; no edge leads back to the root yet, so 0 means "no child"
+    matcher->num_states = 1;
+    for (size_t i = 0; i < num_patterns; i++) {
+        uint32_t state = 0;
+        for (size_t j = 0; j < patterns[i].length; j++) {
+            uint32_t* edge = &matcher->next[state * classes +
+                                            matcher->byte_class[(unsigned char)patterns[i].text[j]]];
+            if (*edge == 0) {
+                *edge = (uint32_t)matcher->num_states++;
+            }
+            state = *edge;
+        }
+        if (state != 0) {
+            ends[state] = 1;
+        }
+        *patterns[i].state = state;
+    }
+
+    // Breadth first, each state's missing edges are its failure state's,
+    // which is shallower and so already complete
+    size_t head = 0;
+    size_t tail = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+        uint32_t state = queue[head++];
+        uint32_t* row = &matcher->next[state * classes];
+        const uint32_t* fail_row = &matcher->next[fail[state] * classes];
+        for (size_t c = 0; c < classes; c++) {
+            if (row[c] != 0) {
+                fail[row[c]] = state == 0 ? 0 : fail_row[c];
+                queue[tail++] = row[c];
+            } else if (state != 0) {
+                row[c] = fail_row[c];
+            }
+        }
+    }
+
+    matcher->report = (uint32_t*)agency_calloc(matcher->num_states, sizeof(uint32_t));
+    matcher->report_next = (uint32_t*)agency_calloc(matcher->num_states, sizeof(uint32_t));
+    if (matcher->report == NULL || matcher->report_next == NULL) {
+        agency_free(fail);
+        agency_free(queue);
+        agency_free(ends);
+        return -1;
+    }
+    for (size_t i = 1; i < tail; i++) {
+        uint32_t state = queue[i];
+        uint32_t below = matcher->report[fail[state]];
+        matcher->report[state] = ends[state] ? state : below;
+        matcher->report_next[state] = ends[state] ? below : 0;
+    }
+
+    agency_free(fail);
+    agency_free(queue);
+    agency_free(ends);
+
+    uint32_t* next = (uint32_t*)agency_realloc(matcher->next, matcher->num_states * classes * sizeof(uint32_t));
+    if (next != NULL) {
+        matcher->next = next;
+    }
+    return 0;
+}
+
+/**
+ * @brief Copy the matcher into a sealed pack on the node of a replica,
+ *        pointing at that replica's theorems.
+ *
+ * @return The copy, or NULL on allocation failure.
+ */
+static const agency_matcher* matcher_pack(const agency_matcher* matcher, unsigned replica) {
+    const agency_theorem_set* set = agency_theorems_replica(replica);
+    size_t num_domains = set != NULL ? set->num_domains : 0;
+    size_t num_components = 0;
+    for (size_t d = 0; d < num_domains; d++) {
+        num_components += set->domains[d].num_components;
+    }
+    size_t table_size = matcher->num_states * matcher->num_classes * sizeof(uint32_t);
+    size_t state_size = matcher->num_states * sizeof(uint32_t);
+    size_t size = agency_pack_size(sizeof(*matcher)) + agency_pack_size(table_size) + 2 * agency_pack_size(state_size) +
+                  agency_pack_size((num_components + 1) * sizeof(uint32_t)) +
+                  agency_pack_size((num_domains + 1) * sizeof(size_t)) +
+                  agency_pack_size(matcher->num_topics * sizeof(matcher_topic)) +
+                  agency_pack_size(matcher->strings.size);
+
+    agency_pack pack;
+    if (agency_pack_begin(&pack, size, replica) != 0) {
+        return NULL;
+    }
+    agency_matcher* copy = (agency_matcher*)agency_pack_copy(&pack, matcher, sizeof(*matcher));
+    copy->next = (uint32_t*)agency_pack_copy(&pack, matcher->next, table_size);
+    copy->report = (uint32_t*)agency_pack_copy(&pack, matcher->report, state_size);
+    copy->report_next = (uint32_t*)agency_pack_copy(&pack, matcher->report_next, state_size);
+    copy->theorems = set;
+    copy->component_states = (uint32_t*)agency_pack_copy(&pack, matcher->component_states,
+                                                         (num_components + 1) * sizeof(uint32_t));
+    copy->component_base = (size_t*)agency_pack_copy(&pack, matcher->component_base,
+                                                     (num_domains + 1) * sizeof(size_t));
+    copy->topics = (matcher_topic*)agency_pack_copy(&pack, matcher->topics, matcher->num_topics * sizeof(matcher_topic));
+    // Sealed without its index, the table is only read by offset
+    copy->strings.data = (char*)agency_pack_copy(&pack, matcher->strings.data, matcher->strings.size);
+    copy->strings.capacity = matcher->strings.size;
+    copy->pack = pack;
+    agency_pack_seal(&pack);
+
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, (int64_t)pack.size, 0);
+    return copy;
+}
+
+/**
+ * @brief Build the matcher from the theorem models and a configuration.
+ *
+ * @return The matcher, packed in huge pages if they are on, or NULL on failure.
+ */
+static const agency_matcher* build_matcher(json_object* config) {
+    // The original theorems, whichever node's copy this thread would read
+    const agency_theorem_set* set = agency_load_theorems() != NULL ? agency_theorems_replica(0) : NULL;
+
+    agency_matcher* matcher = (agency_matcher*)agency_calloc(1, sizeof(agency_matcher));
+    if (matcher == NULL) {
+        fprintf(stderr, "Error allocating issue matcher\n");
+        return NULL;
+    }
+    matcher->theorems = set;
+
+    size_t num_domains = set != NULL ? set->num_domains : 0;
+    size_t num_components = 0;
+    matcher->component_base = (size_t*)agency_calloc(num_domains + 1, sizeof(size_t));
+    for (size_t d = 0; d < num_domains && matcher->component_base != NULL; d++) {
+        matcher->component_base[d] = num_components;
+        num_components += set->domains[d].num_components;
+    }
+    matcher->component_states = (uint32_t*)agency_calloc(num_components + 1, sizeof(uint32_t));
+
+    long num_topics = collect_topics(matcher, config);
+    matcher_pattern* patterns = num_topics < 0 ? NULL :
+        (matcher_pattern*)agency_malloc((num_components + (size_t)num_topics + 1) * sizeof(matcher_pattern));
+    if (matcher->component_base == NULL || matcher->component_states == NULL || patterns == NULL) {
+        fprintf(stderr, "Error allocating issue matcher\n");
+        agency_free(patterns);
+        matcher_free(matcher);
+        return NULL;
+    }
+
+    size_t num_patterns = 0;
+    for (size_t d = 0; d < num_domains; d++) {
+        const agency_theorem_domain* domain = &set->domains[d];
+        for (size_t i = 0; i < domain->num_components; i++) {
+            matcher_pattern* pattern = &patterns[num_patterns++];
+            pattern->text = domain->pool + domain->components[i].offset;
+            pattern->length = domain->components[i].length;
+            pattern->state = &matcher->component_states[matcher->component_base[d] + i];
+        }
+    }
+    for (size_t i = 0; i < matcher->num_topics; i++) {
+        matcher_pattern* pattern = &patterns[num_patterns++];
+        pattern->text = agency_strtab_at(&matcher->strings, matcher->topics[i].topic);
+        pattern->length = strlen(pattern->text);
+        pattern->state = &matcher->topics[i].state;
+    }
+
+    int status = build_automaton(matcher, patterns, num_patterns);
+    agency_free(patterns);
+    if (status != 0) {
+        fprintf(stderr, "Error building issue matcher\n");
+        matcher_free(matcher);
+        return NULL;
+    }
+
+    size_t bytes = sizeof(agency_matcher) + matcher->strings.capacity +
+                   matcher->num_states * (matcher->num_classes + 2) * sizeof(uint32_t) +
+                   (num_components + 1) * sizeof(uint32_t) + (num_domains + 1) * sizeof(size_t) +
+                   (matcher->num_topics + 1) * sizeof(matcher_topic);
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, (int64_t)bytes, (int64_t)matcher->num_states);
+    matcher->bytes = bytes;
+
+    // In huge pages the matcher is packed, as its NUMA copies are
+    const agency_matcher* packed = agency_huge_pages_on() ? matcher_pack(matcher, 0) : NULL;
+    if (packed == NULL) {
+        return matcher;
+    }
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, -(int64_t)bytes, 0);
+    matcher_free(matcher);
+    return packed;
+}
+
+agency_matcher_set* agency_matcher_build(json_object* config) {
+    const agency_matcher* original = build_matcher(config);
+    if (original == NULL) {
+        return NULL;
+    }
+    agency_matcher_set* set = (agency_matcher_set*)agency_calloc(1, sizeof(agency_matcher_set));
+    if (set == NULL) {
+        fprintf(stderr, "Error allocating issue matcher\n");
+        matcher_release(original, 1);
+        return NULL;
+    }
+    set->original = original;
+
+    // A copy that cannot be made leaves its node's readers on the original
+    unsigned replicas = agency_numa_replicas();
+    for (unsigned r = 1; r < replicas && r < AGENCY_NUMA_MAX_REPLICAS; r++) {
+        atomic_store(&set->replicas[r], matcher_pack(original, r));
+    }
+    return set;
+}
+
+void agency_matcher_discard(agency_matcher_set* set) {
+    if (set == NULL) {
+        return;
+    }
+
+    for (unsigned r = 1; r < AGENCY_NUMA_MAX_REPLICAS; r++) {
+        const agency_matcher* copy = atomic_load(&set->replicas[r]);
+        if (copy != NULL) {
+            matcher_release(copy, 0);
+        }
+    }
+    matcher_release(set->original, 1);
+    agency_free(set);
+}
+
+/**
+ * @brief Destroy a retired matcher set.
+ */
+static void matcher_set_destroy(void* set) {
+    agency_matcher_discard((agency_matcher_set*)set);
+}
+
+void agency_matcher_publish(agency_matcher_set* set) {
+    pthread_mutex_lock(&g_matcher_lock);
+    agency_matcher_set* old = atomic_exchange(&g_matchers, set);
+    pthread_mutex_unlock(&g_matcher_lock);
+
+    if (old != NULL) {
+        agency_epoch_retire(old, matcher_set_destroy);
+    }
+}
+
+/**
+ * @brief Get the published matchers, building them on first use.
+ *
+ * Call inside an epoch; a reload may retire them once the caller leaves.
+ *
+ * @return The matchers, or NULL if they could not be built.
+ */
+static agency_matcher_set* load_matchers(void) {
+    // Sequentially consistent, so the load is ordered after the epoch announcement
+    agency_matcher_set* set = atomic_load(&g_matchers);
+    if (set != NULL) {
+        return set;
+    }
+
+    // Only built from the first configuration: every reload publishes its
+    // own. Loaded before the lock, which a reload takes inside its own
+    json_object* config = agency_load_config();
+    pthread_mutex_lock(&g_matcher_lock);
+    set = atomic_load(&g_matchers);
+    if (set == NULL && config != NULL) {
+        set = agency_matcher_build(config);
+        atomic_store(&g_matchers, set);
+    }
+    pthread_mutex_unlock(&g_matcher_lock);
+    return set;
+}
+
+/**
+ * @brief Run one string through the automaton, marking every pattern it contains.
+ */
+static void match_text(const agency_matcher* matcher, const char* text, size_t length,
+                       uint64_t* hits) {
+    const uint32_t* next = matcher->next;
+    size_t classes = matcher->num_classes;
+    uint32_t state = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        state = next[state * classes + matcher->byte_class[(unsigned char)text[i]]];
+        // A marked state's whole chain was marked with it
+        for (uint32_t hit = matcher->report[state]; hit != 0 && !(hits[hit / 64] & (1ULL << (hit % 64)));
+             hit = matcher->report_next[hit]) {
+            hits[hit / 64] |= 1ULL << (hit % 64);
+        }
+    }
+}
+
+/**
+ * @brief The automaton and the patterns found so far in one issue.
+ */
+typedef struct {
+    const agency_matcher* matcher;
+    uint64_t* hits;
+} match_run;
+
+static int match_field(agency_issue_field field, const char* text, size_t length, void* user_data) {
+    match_run* run = (match_run*)user_data;
+    if (field != AGENCY_ISSUE_ID) {
+        match_text(run->matcher, text, length, run->hits);
+    }
+    return 0;
+}
+
+static int is_hit(const uint64_t* hits, uint32_t state) {
+    return state != 0 && (hits[state / 64] & (1ULL << (state % 64))) != 0;
+}
+
+/**
+ * @brief Describe the matched theorems and topics as JSON.
+ */
+static void describe_matches(agency_json_writer* writer, const agency_matcher* matcher, const uint64_t* hits) {
+    agency_json_begin_object(writer);
+    agency_json_key(writer, "theorems");
+    agency_json_begin_array(writer);
+
+    const agency_theorem_set* set = matcher->theorems;
+    for (size_t d = 0; set != NULL && d < set->num_domains; d++) {
+        const agency_theorem_domain* domain = &set->domains[d];
+        const uint32_t* states = &matcher->component_states[matcher->component_base[d]];
+        for (size_t r = 0; r < domain->num_rules; r++) {
+            const agency_theorem_rule* rule = &domain->rules[r];
+            int matched = 0;
+            for (uint32_t i = rule->first_component; i < rule->first_component + rule->num_components; i++) {
+                if (!is_hit(hits, states[i])) {
+                    continue;
+                }
+                if (!matched) {
+                    const char* name = domain->pool + rule->name_offset;
+                    agency_json_begin_object(writer);
+                    agency_json_key(writer, "domain");
+                    agency_json_string(writer, domain->name, strlen(domain->name));
+                    agency_json_key(writer, "name");
+                    agency_json_string(writer, name, strlen(name));
+                    agency_json_key(writer, "components");
+                    agency_json_begin_array(writer);
+                    matched = 1;
+                }
+                agency_json_string(writer, domain->pool + domain->components[i].offset,
+                                   domain->components[i].length);
+            }
+            if (matched) {
+                agency_json_end_array(writer);
+                agency_json_end_object(writer);
+            }
+        }
+    }
+    agency_json_end_array(writer);
+
+    agency_json_key(writer, "topics");
+    agency_json_begin_array(writer);
+    for (size_t i = 0; i < matcher->num_topics; i++) {
+        if (!is_hit(hits, matcher->topics[i].state)) {
+            continue;
+        }
+        agency_json_begin_object(writer);
+        const char* domain = agency_strtab_at(&matcher->strings, matcher->topics[i].domain);
+        const char* topic = agency_strtab_at(&matcher->strings, matcher->topics[i].topic);
+        agency_json_key(writer, "domain");
+        agency_json_string(writer, domain, strlen(domain));
+        agency_json_key(writer, "topic");
+        agency_json_string(writer, topic, strlen(topic));
+        agency_json_end_object(writer);
+    }
+    agency_json_end_array(writer);
+    agency_json_end_object(writer);
+}
+
+/**
+ * @brief Get the matcher the calling thread reads: its node's copy, or the original.
+ *
+ * Call inside an epoch, as for load_matchers().
+ */
+static const agency_matcher* local_matcher(void) {
+    agency_matcher_set* set = load_matchers();
+    if (set == NULL) {
+        return NULL;
+    }
+    unsigned replica = agency_numa_replica();
+    const agency_matcher* copy = replica != 0 ? atomic_load(&set->replicas[replica]) : NULL;
+    return copy != NULL ? copy : set->original;
+}
+
+void agency_matcher_replicate(unsigned replicas) {
+    agency_epoch_record* epoch = agency_epoch_enter();
+    int loaded = load_matchers() != NULL;
+    agency_epoch_leave(epoch);
+    if (!loaded) {
+        return;
+    }
+
+    // Under the lock, so the set is still the published one and not retired
+    pthread_mutex_lock(&g_matcher_lock);
+    agency_matcher_set* set = atomic_load(&g_matchers);
+    for (unsigned r = 1; r < replicas && r < AGENCY_NUMA_MAX_REPLICAS; r++) {
+        if (atomic_load(&set->replicas[r]) == NULL) {
+            atomic_store(&set->replicas[r], matcher_pack(set->original, r));
+        }
+    }
+    pthread_mutex_unlock(&g_matcher_lock);
+}
+
+int agency_load_matcher(void) {
+    agency_epoch_record* epoch = agency_epoch_enter();
+    int status = load_matchers() != NULL ? 0 : -1;
+    agency_epoch_leave(epoch);
+    return status;
+}
+
+char* agency_match_issue(const char* issue_json) {
+    if (issue_json == NULL) {
+        return NULL;
+    }
+
+    // A reload may retire the matcher once we leave
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const agency_matcher* matcher = local_matcher();
+    if (matcher == NULL) {
+        agency_epoch_leave(epoch);
+        return NULL;
+    }
+
+    // The hit bits and the text are temporary; only the result leaves the arena
+    agency_arena* arena = agency_arena_begin();
+    size_t hits_size = (matcher->num_states / 64 + 1) * sizeof(uint64_t);
+    uint64_t* hits = arena != NULL ? (uint64_t*)agency_arena_alloc(arena, hits_size) : NULL;
+    if (hits == NULL) {
+        agency_arena_end(arena);
+        agency_epoch_leave(epoch);
+        return NULL;
+    }
+    memset(hits, 0, hits_size);
+
+    // Each string is matched on its own, so no match spans two of them
+    match_run run = {matcher, hits};
+    char* result = NULL;
+    if (agency_issue_visit_text(issue_json, strlen(issue_json), match_field, &run) == 0) {
+        agency_json_writer writer;
+        agency_json_writer_init(&writer, arena, 1);
+        describe_matches(&writer, matcher, hits);
+        size_t length = 0;
+        const char* json_str = agency_json_writer_finish(&writer, &length);
+        result = json_str != NULL ? agency_strndup(json_str, length) : NULL;
+    }
+
+    agency_arena_end(arena);
+    agency_epoch_leave(epoch);
+    return result;
+}
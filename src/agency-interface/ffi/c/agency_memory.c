@@ -0,0 +1,131 @@
+/**
+ * @file agency_memory.c
+ * @brief Accounting of the memory the library holds, and cache ceilings.
+ *
+ * Each structure the library keeps charges its category as it allocates and
+ * frees, so a report is a handful of counter reads rather than a walk over
+ * the structures. Charges happen when memory is taken or given back, never
+ * per call on a warm path.
+ *
+ * A category with a ceiling is brought back under it by its owner: the
+ * verdict cache shrinks when the ceiling is set, and threads drop resource
+ * copies and arena blocks at their next call that finds the category over
+ * it. Snapshots and indexes are in use for as long as they are held, so
+ * they take no ceiling.
+ *
+ * The pressure monitor sets ceilings of its own; the lower of the two
+ * applies, so neither overrides the other.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include "agency_internal.h"
+
+/**
+ * @brief Counters of one category, on a cache line of their own.
+ */
+typedef struct {
+    _Atomic(int64_t) bytes;
+    _Atomic(int64_t) objects;
+    _Atomic(uint64_t) limit;           // from agency_set_memory_limit()
+    _Atomic(uint64_t) pressure_limit;  // from the pressure monitor
+    _Atomic(uint64_t) evictions;
+} __attribute__((aligned(64))) memory_counters;
+
+static memory_counters g_memory[AGENCY_MEMORY_CATEGORIES];
+
+// Serializes ceiling changes, so the verdict cache is sized for the latest
+static pthread_mutex_t g_limit_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief The ceiling in force: the lower of the caller's and the monitor's.
+ */
+static uint64_t effective_limit(const memory_counters* counters) {
+    uint64_t limit = atomic_load_explicit(&counters->limit, memory_order_relaxed);
+    uint64_t pressure = atomic_load_explicit(&counters->pressure_limit, memory_order_relaxed);
+    if (limit == 0 || (pressure != 0 && pressure < limit)) {
+        return pressure;
+    }
+    return limit;
+}
+
+void agency_memory_charge(agency_memory_category category, int64_t bytes, int64_t objects) {
+    memory_counters* counters = &g_memory[category];
+    if (bytes != 0) {
+        atomic_fetch_add_explicit(&counters->bytes, bytes, memory_order_relaxed);
+    }
+    if (objects != 0) {
+        atomic_fetch_add_explicit(&counters->objects, objects, memory_order_relaxed);
+    }
+}
+
+void agency_memory_evicted(agency_memory_category category, uint64_t objects) {
+    atomic_fetch_add_explicit(&g_memory[category].evictions, objects, memory_order_relaxed);
+}
+
+int agency_memory_over_limit(agency_memory_category category) {
+    const memory_counters* counters = &g_memory[category];
+    uint64_t limit = effective_limit(counters);
+    int64_t bytes = atomic_load_explicit(&counters->bytes, memory_order_relaxed);
+    return limit != 0 && bytes > 0 && (uint64_t)bytes > limit;
+}
+
+/**
+ * @brief Read a counter that concurrent charges may briefly take below zero.
+ */
+static uint64_t read_count(_Atomic(int64_t)* counter) {
+    int64_t value = atomic_load_explicit(counter, memory_order_relaxed);
+    return value > 0 ? (uint64_t)value : 0;
+}
+
+void agency_get_memory_stats(agency_memory_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->total_bytes = 0;
+    for (int i = 0; i < AGENCY_MEMORY_CATEGORIES; i++) {
+        agency_memory_usage* usage = &stats->categories[i];
+        usage->bytes = read_count(&g_memory[i].bytes);
+        usage->objects = read_count(&g_memory[i].objects);
+        usage->limit = effective_limit(&g_memory[i]);
+        usage->evictions = atomic_load_explicit(&g_memory[i].evictions, memory_order_relaxed);
+    }
+
+    // The verdict table is static; only the part in use counts
+    stats->categories[AGENCY_MEMORY_VERIFICATION_CACHE].bytes += agency_verdict_cache_bytes();
+
+    for (int i = 0; i < AGENCY_MEMORY_CATEGORIES; i++) {
+        stats->total_bytes += stats->categories[i].bytes;
+    }
+}
+
+/**
+ * @brief Store one of a category's two ceilings and apply the result.
+ */
+static void set_limit(agency_memory_category category, _Atomic(uint64_t)* limit, uint64_t bytes) {
+    pthread_mutex_lock(&g_limit_lock);
+    atomic_store(limit, bytes);
+    if (category == AGENCY_MEMORY_VERIFICATION_CACHE) {
+        agency_verdict_cache_limit(effective_limit(&g_memory[category]));
+    }
+    pthread_mutex_unlock(&g_limit_lock);
+}
+
+int agency_set_memory_limit(agency_memory_category category, uint64_t bytes) {
+    switch (category) {
+    case AGENCY_MEMORY_RESOURCE_CACHE:
+    case AGENCY_MEMORY_VERIFICATION_CACHE:
+    case AGENCY_MEMORY_ARENAS:
+        set_limit(category, &g_memory[category].limit, bytes);
+        return AGENCY_STATUS_OK;
+    default:
+        fprintf(stderr, "Error setting memory limit: category %d cannot be evicted\n", (int)category);
+        return AGENCY_STATUS_ERROR;
+    }
+}
+
+void agency_memory_set_pressure_limit(agency_memory_category category, uint64_t bytes) {
+    set_limit(category, &g_memory[category].pressure_limit, bytes);
+}
@@ -0,0 +1,221 @@
+/**
+ * @file agency_numa.c
+ * @brief Replication of the read-only structures across NUMA nodes.
+ *
+ * On a host with several memory nodes, every read of the snapshot or the
+ * indexes from a thread on another node than their pages crosses the
+ * interconnect. With replication on, each of them is copied once per node,
+ * onto that node's memory, and a reader takes the copy of the node its CPU
+ * belongs to. The copies are made from the original and never written, so
+ * they stay identical to it; the manifest and the resource store change at
+ * run time and are not copied.
+ *
+ * Nodes and their CPUs are read from sysfs, and pages are moved with the
+ * mbind() system call, so the library needs no libnuma. A replica count
+ * above the number of nodes is accepted for testing on smaller machines:
+ * readers are then dealt over the copies by CPU, and the copies past the
+ * last node share memory with the others.
+ */
+
+#define _GNU_SOURCE  // sched_getcpu
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+#define NUMA_SYSFS "/sys/devices/system/node"
+
+// Most nodes and CPUs the topology table covers
+#define NUMA_MAX_NODES 64
+#define NUMA_MAX_CPUS 4096
+
+// mbind() arguments, as <numaif.h> defines them
+#define NUMA_MPOL_PREFERRED 1
+#define NUMA_MPOL_MF_MOVE (1u << 1)
+
+static struct {
+    pthread_once_t once;
+    unsigned nodes;
+    uint8_t cpu_node[NUMA_MAX_CPUS];
+} g_topology = {
+    .once = PTHREAD_ONCE_INIT,
+    .nodes = 1,
+};
+
+static atomic_uint g_replicas = 1;
+
+// Per-thread node the caller asked for, plus one; 0 follows the CPU
+static pthread_key_t g_thread_node_key;
+static pthread_once_t g_thread_node_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Parse a sysfs list such as "0-3,8,10-11", calling back for each number.
+ */
+static void parse_list(const char* list, void (*visit)(unsigned value, void* user_data), void* user_data) {
+    const char* p = list;
+    while (*p >= '0' && *p <= '9') {
+        char* end;
+        unsigned long first = strtoul(p, &end, 10);
+        unsigned long last = first;
+        if (*end == '-') {
+            last = strtoul(end + 1, &end, 10);
+        }
+        for (unsigned long value = first; value <= last && value < NUMA_MAX_CPUS; value++) {
+            visit((unsigned)value, user_data);
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+}
+
+/**
+ * @brief Read a one-line sysfs file. Returns 0 on success.
+ */
+static int read_line(const char* path, char* line, size_t size) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    int status = fgets(line, (int)size, file) != NULL ? 0 : -1;
+    fclose(file);
+    return status;
+}
+
+static void note_node(unsigned node, void* user_data) {
+    unsigned* nodes = (unsigned*)user_data;
+    if (node < NUMA_MAX_NODES && node + 1 > *nodes) {
+        *nodes = node + 1;
+    }
+}
+
+static void note_cpu(unsigned cpu, void* user_data) {
+    g_topology.cpu_node[cpu] = (uint8_t)(uintptr_t)user_data;
+}
+
+/**
+ * @brief Read the nodes and which CPUs belong to each. Runs once.
+ */
+static void read_topology(void) {
+    char line[4096];
+    unsigned nodes = 0;
+    if (read_line(NUMA_SYSFS "/online", line, sizeof(line)) == 0) {
+        parse_list(line, note_node, &nodes);
+    }
+    if (nodes <= 1) {
+        // Not NUMA, or no sysfs; every CPU stays on node 0
+        return;
+    }
+
+    for (unsigned node = 0; node < nodes; node++) {
+        char path[128];
+        snprintf(path, sizeof(path), NUMA_SYSFS "/node%u/cpulist", node);
+        if (read_line(path, line, sizeof(line)) == 0) {
+            parse_list(line, note_cpu, (void*)(uintptr_t)node);
+        }
+    }
+    g_topology.nodes = nodes;
+}
+
+static unsigned numa_nodes(void) {
+    pthread_once(&g_topology.once, read_topology);
+    return g_topology.nodes;
+}
+
+static void create_thread_node_key(void) {
+    pthread_key_create(&g_thread_node_key, NULL);
+}
+
+unsigned agency_numa_replicas(void) {
+    return atomic_load_explicit(&g_replicas, memory_order_relaxed);
+}
+
+unsigned agency_numa_replica(void) {
+    unsigned replicas = agency_numa_replicas();
+    if (replicas <= 1) {
+        return 0;
+    }
+
+    pthread_once(&g_thread_node_once, create_thread_node_key);
+    uintptr_t pinned = (uintptr_t)pthread_getspecific(g_thread_node_key);
+    if (pinned != 0) {
+        return (unsigned)(pinned - 1) % replicas;
+    }
+
+    int cpu = sched_getcpu();
+    if (cpu < 0) {
+        return 0;
+    }
+    // With more copies than nodes, readers are dealt over them by CPU
+    if (replicas > numa_nodes()) {
+        return (unsigned)cpu % replicas;
+    }
+    return cpu < NUMA_MAX_CPUS ? g_topology.cpu_node[cpu] % replicas : 0;
+}
+
+void agency_numa_place(void* pages, size_t size, unsigned replica) {
+    unsigned nodes = numa_nodes();
+    if (nodes <= 1 || size == 0) {
+        return;
+    }
+
+    // Preferred rather than bound, so a full node spills instead of failing
+    unsigned long mask = 1ul << (replica % nodes);
+    if (syscall(SYS_mbind, pages, size, NUMA_MPOL_PREFERRED, &mask, (unsigned long)NUMA_MAX_NODES + 1,
+                NUMA_MPOL_MF_MOVE) != 0) {
+        // The copy still works, only from farther away
+        fprintf(stderr, "Error placing %zu bytes on NUMA node %u\n", size, replica % nodes);
+    }
+}
+
+int agency_numa_replicate(unsigned replicas) {
+    if (replicas == 0) {
+        replicas = numa_nodes();
+    }
+    if (replicas > AGENCY_NUMA_MAX_REPLICAS) {
+        fprintf(stderr, "Error: at most %d NUMA replicas are supported\n", AGENCY_NUMA_MAX_REPLICAS);
+        return AGENCY_STATUS_ERROR;
+    }
+
+    atomic_store(&g_replicas, replicas);
+    int status = AGENCY_STATUS_OK;
+    if (replicas > 1) {
+        // Copies made now spare the first reader on each node the wait
+        if (agency_load_theorems() == NULL || agency_load_matcher() != 0) {
+            status = AGENCY_STATUS_ERROR;
+        }
+        agency_theorems_replicate(replicas);
+        agency_matcher_replicate(replicas);
+    }
+
+    // The published snapshot is rebuilt with the new number of copies
+    if (agency_reload_config() != AGENCY_STATUS_OK) {
+        status = AGENCY_STATUS_ERROR;
+    }
+    return status;
+}
+
+int agency_numa_set_thread_node(int node) {
+    if (node < -1 || node >= NUMA_MAX_NODES) {
+        return AGENCY_STATUS_ERROR;
+    }
+
+    pthread_once(&g_thread_node_once, create_thread_node_key);
+    return pthread_setspecific(g_thread_node_key, (void*)(uintptr_t)(node + 1)) == 0 ? AGENCY_STATUS_OK
+                                                                                    : AGENCY_STATUS_ERROR;
+}
+
+void agency_get_numa_stats(agency_numa_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->nodes = numa_nodes();
+    stats->replicas = agency_numa_replicas();
+    stats->replica = agency_numa_replica();
+    stats->replica_bytes = agency_pack_replica_bytes();
+}
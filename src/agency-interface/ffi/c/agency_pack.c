@@ -0,0 +1,100 @@
+/**
+ * @file agency_pack.c
+ * @brief Blocks of whole pages for the structures readers never write.
+ *
+ * A structure built once and then only read (a configuration snapshot, a
+ * compiled index) is copied piece by piece into a pack: one allocation,
+ * rounded out to whole pages that no other allocation shares, and sealed
+ * read-only once filled. Its pages are then never written, not even by the
+ * allocator tending a neighbouring block, so they stay shared with forked
+ * workers, and a copy placed on another NUMA node stays intact there.
+ *
+ * Packs are taken from the library's allocator like everything else; the
+ * allocator only promises ordinary alignment, so each is rounded up within
+ * a block one page larger. With a huge-page mode set, packs are mapped in
+ * huge pages instead (agency_huge_pages.c).
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+// Alignment of each piece in a pack
+#define PACK_ALIGN 16
+
+// Bytes of the packs placed for replicas other than the original
+static atomic_size_t g_replica_bytes = 0;
+
+size_t agency_pack_size(size_t size) {
+    return (size + PACK_ALIGN - 1) & ~(size_t)(PACK_ALIGN - 1);
+}
+
+int agency_pack_begin(agency_pack* pack, size_t size, unsigned replica) {
+    size_t mapped = 0;
+    void* block = agency_huge_alloc(size, &mapped);
+    if (block != NULL) {
+        pack->block = block;
+        pack->base = (char*)block;
+        pack->size = mapped;
+        pack->huge = 1;
+    } else {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size = (size + page - 1) & ~(page - 1);
+        block = agency_malloc(size + page - 1);
+        if (block == NULL) {
+            return -1;
+        }
+        pack->block = block;
+        pack->base = (char*)(((uintptr_t)block + page - 1) & ~(uintptr_t)(page - 1));
+        pack->size = size;
+        pack->huge = 0;
+    }
+    pack->next = pack->base;
+    pack->replica = replica;
+    if (replica != 0) {
+        atomic_fetch_add(&g_replica_bytes, pack->size);
+    }
+
+    // Before the pieces are copied in, so they are written where they will be read
+    agency_numa_place(pack->base, pack->size, replica);
+    return 0;
+}
+
+void* agency_pack_copy(agency_pack* pack, const void* data, size_t size) {
+    if (data == NULL || size == 0) {
+        return NULL;
+    }
+    void* copy = pack->next;
+    memcpy(copy, data, size);
+    pack->next += agency_pack_size(size);
+    return copy;
+}
+
+void agency_pack_seal(const agency_pack* pack) {
+    // Sealing only turns a stray write into a fault; a pack that cannot be
+    // sealed reads the same
+    mprotect(pack->base, pack->size, PROT_READ);
+}
+
+void agency_pack_free(agency_pack pack) {
+    if (pack.block == NULL) {
+        return;
+    }
+    if (pack.replica != 0) {
+        atomic_fetch_sub(&g_replica_bytes, pack.size);
+    }
+    if (pack.huge) {
+        agency_huge_free(pack.block, pack.size);
+        return;
+    }
+    // The allocator may write to the block once it is freed
+    mprotect(pack.base, pack.size, PROT_READ | PROT_WRITE);
+    agency_free(pack.block);
+}
+
+size_t agency_pack_replica_bytes(void) {
+    return atomic_load(&g_replica_bytes);
+}
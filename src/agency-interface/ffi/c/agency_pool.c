@@ -0,0 +1,272 @@
+/**
+ * @file agency_pool.c
+ * @brief Work-stealing pool for splitting one request across cores.
+ *
+ * A job is a range of independent items. The thread that submits it starts
+ * out owning the whole range; idle pool workers join and steal the back half
+ * of the largest range left, then work through their half from the front,
+ * stealing again when it runs out. Each participant's range is one 64-bit
+ * word (begin in the low half, end in the high half) updated by compare and
+ * swap, so taking an item and stealing need no lock, and an item is only
+ * ever in one range.
+ *
+ * Workers are started on first use and sleep while no job is open. The
+ * submitting thread always takes part, so a busy or empty pool only makes
+ * a job run serially, never wait.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+/**
+ * @brief A job open for workers to join.
+ */
+typedef struct pool_job {
+    agency_pool_task task;
+    void* context;
+    _Atomic(uint64_t) ranges[AGENCY_POOL_MAX_THREADS];  // per participant; slot 0 is the submitter
+    atomic_int slots;                                   // participants so far
+    atomic_int exhausted;                               // set once a steal found nothing left
+    int active;                                         // workers inside the job, under the lock
+    struct pool_job* next;                              // open jobs, under the lock
+} pool_job;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;  // a job was opened or the pool resized
+    pthread_cond_t done;  // a worker left a job
+    pool_job* jobs;
+    size_t started;  // worker threads started
+    size_t wanted;   // workers allowed to join jobs
+    int configured;
+    _Atomic(uint64_t) items;
+    _Atomic(uint64_t) steals;
+} g_pool = {.lock = PTHREAD_MUTEX_INITIALIZER, .work = PTHREAD_COND_INITIALIZER, .done = PTHREAD_COND_INITIALIZER};
+
+static uint64_t pack_range(uint64_t begin, uint64_t end) {
+    return begin | (end << 32);
+}
+
+/**
+ * @brief Take the first item of a participant's own range.
+ *
+ * @return 1 and the item, or 0 if the range is empty.
+ */
+static int take_item(pool_job* job, int slot, size_t* item) {
+    uint64_t range = atomic_load_explicit(&job->ranges[slot], memory_order_acquire);
+    for (;;) {
+        uint64_t begin = range & 0xFFFFFFFFu;
+        uint64_t end = range >> 32;
+        if (begin >= end) {
+            return 0;
+        }
+        if (atomic_compare_exchange_weak_explicit(&job->ranges[slot], &range, pack_range(begin + 1, end),
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            *item = (size_t)begin;
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief Move the back half of the largest other range into an empty slot.
+ *
+ * @return 1 if something was stolen, 0 if every range is empty.
+ */
+static int steal(pool_job* job, int slot) {
+    for (;;) {
+        int victim = -1;
+        uint64_t victim_range = 0;
+        uint64_t largest = 0;
+        int slots = atomic_load_explicit(&job->slots, memory_order_acquire);
+        for (int i = 0; i < slots; i++) {
+            uint64_t range = atomic_load_explicit(&job->ranges[i], memory_order_acquire);
+            uint64_t begin = range & 0xFFFFFFFFu;
+            uint64_t end = range >> 32;
+            if (i != slot && end > begin && end - begin > largest) {
+                victim = i;
+                victim_range = range;
+                largest = end - begin;
+            }
+        }
+        if (victim < 0) {
+            atomic_store_explicit(&job->exhausted, 1, memory_order_relaxed);
+            return 0;
+        }
+
+        uint64_t begin = victim_range & 0xFFFFFFFFu;
+        uint64_t end = victim_range >> 32;
+        uint64_t middle = begin + (end - begin) / 2;
+        if (atomic_compare_exchange_strong_explicit(&job->ranges[victim], &victim_range,
+                                                    pack_range(begin, middle),
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            atomic_store_explicit(&job->ranges[slot], pack_range(middle, end), memory_order_release);
+            atomic_fetch_add_explicit(&g_pool.steals, 1, memory_order_relaxed);
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief Run items until no participant has any left.
+ */
+static void participate(pool_job* job, int slot) {
+    uint64_t items = 0;
+    do {
+        size_t item;
+        while (take_item(job, slot, &item)) {
+            job->task(job->context, item);
+            items++;
+        }
+    } while (steal(job, slot));
+    atomic_fetch_add_explicit(&g_pool.items, items, memory_order_relaxed);
+}
+
+/**
+ * @brief Find an open job a worker can still help with. Called under the lock.
+ */
+static pool_job* open_job(void) {
+    for (pool_job* job = g_pool.jobs; job != NULL; job = job->next) {
+        if (!atomic_load_explicit(&job->exhausted, memory_order_relaxed) &&
+            atomic_load_explicit(&job->slots, memory_order_relaxed) < AGENCY_POOL_MAX_THREADS) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Body of each worker thread.
+ */
+static void* worker_main(void* arg) {
+    size_t id = (size_t)(uintptr_t)arg;
+
+    pthread_mutex_lock(&g_pool.lock);
+    for (;;) {
+        pool_job* job;
+        while (id >= g_pool.wanted || (job = open_job()) == NULL) {
+            pthread_cond_wait(&g_pool.work, &g_pool.lock);
+        }
+        int slot = atomic_fetch_add_explicit(&job->slots, 1, memory_order_acq_rel);
+        job->active++;
+        pthread_mutex_unlock(&g_pool.lock);
+
+        participate(job, slot);
+
+        pthread_mutex_lock(&g_pool.lock);
+        if (--job->active == 0) {
+            pthread_cond_broadcast(&g_pool.done);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Set the number of workers, starting threads as needed. Called under the lock.
+ *
+ * Workers beyond the number wanted are kept, asleep.
+ */
+static void resize(size_t workers) {
+    if (workers > AGENCY_POOL_MAX_THREADS - 1) {
+        workers = AGENCY_POOL_MAX_THREADS - 1;
+    }
+    g_pool.configured = 1;
+    g_pool.wanted = workers;
+
+    while (g_pool.started < workers) {
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        int status = pthread_create(&thread, &attr, worker_main, (void*)(uintptr_t)g_pool.started);
+        pthread_attr_destroy(&attr);
+        if (status != 0) {
+            // Fewer workers only means less parallelism
+            fprintf(stderr, "Error starting agency pool thread\n");
+            g_pool.wanted = g_pool.started;
+            break;
+        }
+        g_pool.started++;
+    }
+    pthread_cond_broadcast(&g_pool.work);
+}
+
+void agency_pool_set_threads(size_t num_threads) {
+    if (num_threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+
+    pthread_mutex_lock(&g_pool.lock);
+    resize(num_threads - 1);
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+size_t agency_pool_threads(void) {
+    pthread_mutex_lock(&g_pool.lock);
+    int configured = g_pool.configured;
+    size_t workers = g_pool.wanted;
+    pthread_mutex_unlock(&g_pool.lock);
+
+    if (!configured) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        return cpus > 0 ? (size_t)cpus : 1;
+    }
+    return workers + 1;
+}
+
+void agency_pool_run(size_t count, agency_pool_task task, void* context) {
+    pthread_mutex_lock(&g_pool.lock);
+    if (!g_pool.configured) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        resize(cpus > 1 ? (size_t)cpus - 1 : 0);
+    }
+    int serial = g_pool.wanted == 0 || count < 2 || count > UINT32_MAX;
+    pthread_mutex_unlock(&g_pool.lock);
+
+    if (serial) {
+        for (size_t i = 0; i < count; i++) {
+            task(context, i);
+        }
+        return;
+    }
+
+    pool_job job;
+    memset(&job, 0, sizeof(job));
+    job.task = task;
+    job.context = context;
+    atomic_store_explicit(&job.ranges[0], pack_range(0, count), memory_order_relaxed);
+    atomic_store_explicit(&job.slots, 1, memory_order_relaxed);
+
+    pthread_mutex_lock(&g_pool.lock);
+    job.next = g_pool.jobs;
+    g_pool.jobs = &job;
+    pthread_cond_broadcast(&g_pool.work);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    participate(&job, 0);
+
+    // Close the job, then wait for workers still finishing an item
+    pthread_mutex_lock(&g_pool.lock);
+    for (pool_job** link = &g_pool.jobs; *link != NULL; link = &(*link)->next) {
+        if (*link == &job) {
+            *link = job.next;
+            break;
+        }
+    }
+    while (job.active > 0) {
+        pthread_cond_wait(&g_pool.done, &g_pool.lock);
+    }
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+void agency_pool_get_stats(uint64_t* items, uint64_t* steals) {
+    *items = atomic_load(&g_pool.items);
+    *steals = atomic_load(&g_pool.steals);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file agency_prefork.c
+ * @brief Preparation of a process that forks workers after loading the library.
+ *
+ * A forked child shares every page of its parent until either writes to
+ * it. The library's read-only structures are built on first use, so a
+ * parent that forks before using them leaves each child to build and hold
+ * a private copy; the configuration tree json-c parses would be no better,
+ * since reading it takes references that write its objects. Building
+ * everything beforehand leaves the children only their own working memory:
+ * the snapshot is sealed in pages of its own, and the indexes are never
+ * written once built.
+ */
+
+#include <stdio.h>
+#include "agency_internal.h"
+
+int agency_prefork_prepare(void) {
+    int status = AGENCY_STATUS_OK;
+
+    if (agency_load_config() == NULL) {
+        status = AGENCY_STATUS_ERROR;
+    }
+    if (agency_load_matcher() != 0) {
+        fprintf(stderr, "Error building issue matcher before fork\n");
+        status = AGENCY_STATUS_ERROR;
+    }
+    if (agency_load_theorems() == NULL) {
+        fprintf(stderr, "Error compiling theorem models before fork\n");
+        status = AGENCY_STATUS_ERROR;
+    }
+
+    // Builds the manifest on the way
+    if (agency_store_preload() != AGENCY_STATUS_OK) {
+        status = AGENCY_STATUS_ERROR;
+    }
+
+    // The scanner picks its instruction set once, and would do so in each child
+    agency_scan_isa();
+
+    // Replaced snapshots would otherwise be freed, and so written, by every child
+    agency_epoch_reclaim();
+    agency_release_free_memory();
+    return status;
+}
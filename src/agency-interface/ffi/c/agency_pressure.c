@@ -0,0 +1,325 @@
+/**
+ * @file agency_pressure.c
+ * @brief Cache eviction driven by the cgroup's memory pressure.
+ *
+ * An optional background thread reads the cgroup v2 pressure stall
+ * information (memory.pressure) and usage (memory.current against
+ * memory.max) and grades them into a pressure level. Each level sets
+ * ceilings on the caches through agency_memory_set_pressure_limit(), so
+ * the library gives memory back progressively as the cgroup fills, and the
+ * kernel's reclaim and the OOM killer find less of it to contend with.
+ *
+ * A rising level applies at once; a falling one lifts one level per check,
+ * so a brief lull does not refill the caches only to shrink them again.
+ * The files are polled rather than armed as PSI triggers, which lets any
+ * directory holding files in the same format stand in for the cgroup.
+ */
+
+#define _GNU_SOURCE  // O_CLOEXEC, pthread_condattr_setclock
+
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+#define PRESSURE_CGROUP_ROOT "/sys/fs/cgroup"
+
+// Default time between checks
+#define PRESSURE_INTERVAL_MS 1000
+
+// Thresholds of each level: stall percentages (some, full) over the last 10 s,
+// and memory.current as a percentage of memory.max; any one reached suffices
+static const struct {
+    unsigned some_avg10;
+    unsigned full_avg10;
+    unsigned usage;
+} g_thresholds[] = {
+    [AGENCY_PRESSURE_MODERATE] = {10, 2, 80},
+    [AGENCY_PRESSURE_HIGH] = {25, 5, 90},
+    [AGENCY_PRESSURE_CRITICAL] = {50, 20, 95},
+};
+
+// Ceilings of each level, in bytes; 0 leaves a cache alone, and 1 keeps
+// only what a call is using
+static const struct {
+    uint64_t verification_cache;
+    uint64_t resource_cache;
+    uint64_t arenas;
+} g_level_limits[] = {
+    [AGENCY_PRESSURE_NONE] = {0, 0, 0},
+    [AGENCY_PRESSURE_MODERATE] = {256 * 1024, 0, 4 * 1024 * 1024},
+    [AGENCY_PRESSURE_HIGH] = {16 * 1024, 1, 1},
+    [AGENCY_PRESSURE_CRITICAL] = {1, 1, 1},
+};
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t thread;
+    int running;
+    int stopping;
+    unsigned interval_ms;
+    char dir[PATH_MAX];
+} g_monitor = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+// The last reading, for agency_get_pressure_stats(); percentages in hundredths
+static atomic_int g_level;
+static _Atomic(uint64_t) g_some_avg10;
+static _Atomic(uint64_t) g_full_avg10;
+static _Atomic(uint64_t) g_current_bytes;
+static _Atomic(uint64_t) g_max_bytes;
+static _Atomic(uint64_t) g_checks;
+static _Atomic(uint64_t) g_escalations;
+
+/**
+ * @brief Read a small file of the cgroup directory into a buffer.
+ *
+ * @return 0 on success, -1 if the file cannot be read.
+ */
+static int read_cgroup_file(const char* dir, const char* name, char* buffer, size_t size) {
+    char path[PATH_MAX + 32];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t length = read(fd, buffer, size - 1);
+    close(fd);
+    if (length < 0) {
+        return -1;
+    }
+    buffer[length] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Find avg10 on a memory.pressure line ("some ..." or "full ...").
+ *
+ * @return The stall percentage in hundredths, or 0 if the line is absent.
+ */
+static uint64_t stall_avg10(const char* pressure, const char* kind) {
+    for (const char* line = pressure; line != NULL && *line != '\0';) {
+        if (strncmp(line, kind, strlen(kind)) == 0) {
+            const char* avg10 = strstr(line, "avg10=");
+            const char* eol = strchr(line, '\n');
+            if (avg10 != NULL && (eol == NULL || avg10 < eol)) {
+                return (uint64_t)(strtod(avg10 + 6, NULL) * 100.0 + 0.5);
+            }
+        }
+        line = strchr(line, '\n');
+        line = line != NULL ? line + 1 : NULL;
+    }
+    return 0;
+}
+
+/**
+ * @brief Grade a reading into a pressure level.
+ */
+static int grade(uint64_t some, uint64_t full, uint64_t current, uint64_t max) {
+    int level = AGENCY_PRESSURE_NONE;
+    for (int l = AGENCY_PRESSURE_MODERATE; l <= AGENCY_PRESSURE_CRITICAL; l++) {
+        if (some >= g_thresholds[l].some_avg10 * 100ULL || full >= g_thresholds[l].full_avg10 * 100ULL ||
+            (max != 0 && current >= max / 100 * g_thresholds[l].usage)) {
+            level = l;
+        }
+    }
+    return level;
+}
+
+/**
+ * @brief Set the caches' ceilings for a level.
+ */
+static void apply_level(int level) {
+    agency_memory_set_pressure_limit(AGENCY_MEMORY_VERIFICATION_CACHE, g_level_limits[level].verification_cache);
+    agency_memory_set_pressure_limit(AGENCY_MEMORY_RESOURCE_CACHE, g_level_limits[level].resource_cache);
+    agency_memory_set_pressure_limit(AGENCY_MEMORY_ARENAS, g_level_limits[level].arenas);
+}
+
+/**
+ * @brief Read the cgroup once and move the level toward what it shows.
+ */
+static void check_pressure(const char* dir) {
+    char buffer[512];
+    uint64_t some = 0;
+    uint64_t full = 0;
+    if (read_cgroup_file(dir, "memory.pressure", buffer, sizeof(buffer)) == 0) {
+        some = stall_avg10(buffer, "some");
+        full = stall_avg10(buffer, "full");
+    }
+
+    uint64_t current = 0;
+    uint64_t max = 0;
+    if (read_cgroup_file(dir, "memory.current", buffer, sizeof(buffer)) == 0) {
+        current = strtoull(buffer, NULL, 10);
+    }
+    // "max" means no limit, and parses as 0
+    if (read_cgroup_file(dir, "memory.max", buffer, sizeof(buffer)) == 0) {
+        max = strtoull(buffer, NULL, 10);
+    }
+
+    atomic_store(&g_some_avg10, some);
+    atomic_store(&g_full_avg10, full);
+    atomic_store(&g_current_bytes, current);
+    atomic_store(&g_max_bytes, max);
+    atomic_fetch_add(&g_checks, 1);
+
+    int level = atomic_load(&g_level);
+    int graded = grade(some, full, current, max);
+    if (graded > level) {
+        apply_level(graded);
+        atomic_store(&g_level, graded);
+        atomic_fetch_add(&g_escalations, 1);
+        agency_release_free_memory();
+    } else if (graded < level) {
+        apply_level(level - 1);
+        atomic_store(&g_level, level - 1);
+    }
+}
+
+static void* monitor_main(void* arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&g_monitor.lock);
+    while (!g_monitor.stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += g_monitor.interval_ms / 1000;
+        deadline.tv_nsec += (long)(g_monitor.interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (!g_monitor.stopping &&
+               pthread_cond_timedwait(&g_monitor.wake, &g_monitor.lock, &deadline) == 0) {
+        }
+        if (!g_monitor.stopping) {
+            pthread_mutex_unlock(&g_monitor.lock);
+            check_pressure(g_monitor.dir);
+            pthread_mutex_lock(&g_monitor.lock);
+        }
+    }
+    pthread_mutex_unlock(&g_monitor.lock);
+    return NULL;
+}
+
+/**
+ * @brief Find the calling process's cgroup v2 directory.
+ *
+ * @return 0 on success, -1 if the process is not in a cgroup v2 hierarchy.
+ */
+static int own_cgroup_dir(char* dir, size_t size) {
+    char buffer[4096];
+    if (read_cgroup_file("/proc/self", "cgroup", buffer, sizeof(buffer)) != 0) {
+        return -1;
+    }
+
+    // The unified hierarchy's line reads "0::/path"
+    for (char* line = buffer; line != NULL && *line != '\0';) {
+        char* eol = strchr(line, '\n');
+        if (eol != NULL) {
+            *eol = '\0';
+        }
+        if (strncmp(line, "0::", 3) == 0) {
+            snprintf(dir, size, "%s%s", PRESSURE_CGROUP_ROOT, strcmp(line + 3, "/") == 0 ? "" : line + 3);
+            return 0;
+        }
+        line = eol != NULL ? eol + 1 : NULL;
+    }
+    return -1;
+}
+
+int agency_pressure_monitor_start(const char* cgroup_dir, unsigned interval_ms) {
+    pthread_mutex_lock(&g_monitor.lock);
+    if (g_monitor.running) {
+        pthread_mutex_unlock(&g_monitor.lock);
+        fprintf(stderr, "Error starting pressure monitor: already running\n");
+        return AGENCY_STATUS_ERROR;
+    }
+
+    if (cgroup_dir != NULL) {
+        snprintf(g_monitor.dir, sizeof(g_monitor.dir), "%s", cgroup_dir);
+    } else if (own_cgroup_dir(g_monitor.dir, sizeof(g_monitor.dir)) != 0) {
+        pthread_mutex_unlock(&g_monitor.lock);
+        fprintf(stderr, "Error starting pressure monitor: no cgroup v2 hierarchy\n");
+        return AGENCY_STATUS_ERROR;
+    }
+
+    char probe[512];
+    if (read_cgroup_file(g_monitor.dir, "memory.pressure", probe, sizeof(probe)) != 0 &&
+        read_cgroup_file(g_monitor.dir, "memory.current", probe, sizeof(probe)) != 0) {
+        pthread_mutex_unlock(&g_monitor.lock);
+        fprintf(stderr, "Error starting pressure monitor: no memory.pressure or memory.current in %s\n",
+                g_monitor.dir);
+        return AGENCY_STATUS_ERROR;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_monitor.wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    g_monitor.interval_ms = interval_ms != 0 ? interval_ms : PRESSURE_INTERVAL_MS;
+    g_monitor.stopping = 0;
+
+    // The first reading applies before the call returns
+    check_pressure(g_monitor.dir);
+
+    if (pthread_create(&g_monitor.thread, NULL, monitor_main, NULL) != 0) {
+        apply_level(AGENCY_PRESSURE_NONE);
+        atomic_store(&g_level, AGENCY_PRESSURE_NONE);
+        pthread_cond_destroy(&g_monitor.wake);
+        pthread_mutex_unlock(&g_monitor.lock);
+        fprintf(stderr, "Error starting pressure monitor thread\n");
+        return AGENCY_STATUS_ERROR;
+    }
+    g_monitor.running = 1;
+    pthread_mutex_unlock(&g_monitor.lock);
+    return AGENCY_STATUS_OK;
+}
+
+void agency_pressure_monitor_stop(void) {
+    pthread_mutex_lock(&g_monitor.lock);
+    if (!g_monitor.running) {
+        pthread_mutex_unlock(&g_monitor.lock);
+        return;
+    }
+    g_monitor.stopping = 1;
+    pthread_cond_signal(&g_monitor.wake);
+    pthread_mutex_unlock(&g_monitor.lock);
+
+    pthread_join(g_monitor.thread, NULL);
+
+    pthread_mutex_lock(&g_monitor.lock);
+    apply_level(AGENCY_PRESSURE_NONE);
+    atomic_store(&g_level, AGENCY_PRESSURE_NONE);
+    pthread_cond_destroy(&g_monitor.wake);
+    g_monitor.running = 0;
+    pthread_mutex_unlock(&g_monitor.lock);
+}
+
+void agency_get_pressure_stats(agency_pressure_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_monitor.lock);
+    stats->running = g_monitor.running;
+    pthread_mutex_unlock(&g_monitor.lock);
+    stats->level = atomic_load(&g_level);
+    stats->some_avg10 = (double)atomic_load(&g_some_avg10) / 100.0;
+    stats->full_avg10 = (double)atomic_load(&g_full_avg10) / 100.0;
+    stats->current_bytes = atomic_load(&g_current_bytes);
+    stats->max_bytes = atomic_load(&g_max_bytes);
+    stats->checks = atomic_load(&g_checks);
+    stats->escalations = atomic_load(&g_escalations);
+}
@@ -0,0 +1,252 @@
+/**
+ * @file agency_report.c
+ * @brief Verification reports: every rule evaluated, its outcome and cost.
+ *
+ * A report runs the streaming validator with a trace, then encodes the
+ * trace into the caller's buffer, either as a fixed binary layout
+ * (agency_report_header and agency_report_rule, followed by their strings)
+ * or as a JSON object. Reports bypass the verdict cache, since a cached
+ * verdict carries no rules.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "agency_internal.h"
+
+static const char* const g_kind_names[] = {"field", "theorem"};
+
+static const char* const g_outcome_names[] = {
+    "passed", "missing", "wrong_type", "bad_length", "not_in_enum", "bad_items", "keyword_missing",
+};
+
+/**
+ * @brief A string a reported rule refers to.
+ */
+typedef struct {
+    const char* text;
+    size_t length;
+} report_string;
+
+/**
+ * @brief Appends to the caller's buffer, counting what does not fit.
+ */
+typedef struct {
+    char* buffer;
+    size_t capacity;
+    size_t used;
+} report_writer;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static report_string field_name(const agency_schema* schema, size_t index) {
+    const agency_schema_string* name = &schema->fields[index].name;
+    report_string string = {schema->pool + name->offset, name->length};
+    return string;
+}
+
+/**
+ * @brief Resolve the name, checked field and detail of a traced rule.
+ */
+static void describe_rule(const agency_schema* schema, const agency_theorem_domain* theorems,
+                          const agency_rule_trace* rule, report_string* name,
+                          report_string* field, report_string* detail) {
+    detail->text = "";
+    detail->length = 0;
+
+    if (rule->kind == AGENCY_RULE_FIELD) {
+        *name = field_name(schema, rule->index);
+        *field = *name;
+        return;
+    }
+
+    name->text = theorems->pool + theorems->rules[rule->index].name_offset;
+    name->length = strlen(name->text);
+    // A schema full without a description field checks theorems against ""
+    if (schema->description_field >= 0) {
+        *field = field_name(schema, (size_t)schema->description_field);
+    } else {
+        field->text = "";
+        field->length = 0;
+    }
+    if (rule->keyword != UINT32_MAX) {
+        const agency_theorem_keyword* keyword = &theorems->keywords[rule->keyword];
+        detail->text = theorems->pool + keyword->offset;
+        detail->length = keyword->length;
+    }
+}
+
+/**
+ * @brief Append bytes, copying them only while they fit.
+ *
+ * @return The offset they were appended at.
+ */
+static size_t put_bytes(report_writer* writer, const void* data, size_t length) {
+    size_t offset = writer->used;
+    if (offset + length <= writer->capacity) {
+        memcpy(writer->buffer + offset, data, length);
+    }
+    writer->used += length;
+    return offset;
+}
+
+/**
+ * @brief Append a null-terminated copy of a string.
+ */
+static void put_string(report_writer* writer, report_string string, uint32_t* offset,
+                       uint32_t* length) {
+    *offset = (uint32_t)put_bytes(writer, string.text, string.length);
+    *length = (uint32_t)string.length;
+    put_bytes(writer, "", 1);
+}
+
+static void encode_binary(report_writer* writer, const agency_schema* schema,
+                          const agency_theorem_domain* theorems, const agency_verify_trace* trace,
+                          int verdict, uint64_t total_ns) {
+    agency_report_header header;
+    memset(&header, 0, sizeof(header));
+    header.verdict = verdict;
+    header.num_rules = (uint32_t)trace->num_rules;
+    header.total_ns = total_ns;
+    header.error_offset = trace->error_offset == SIZE_MAX ? UINT64_MAX : trace->error_offset;
+    put_bytes(writer, &header, sizeof(header));
+
+    // Strings go after the rule table
+    size_t table = writer->used;
+    writer->used += trace->num_rules * sizeof(agency_report_rule);
+
+    for (size_t i = 0; i < trace->num_rules; i++) {
+        const agency_rule_trace* traced = &trace->rules[i];
+        report_string name, field, detail;
+        describe_rule(schema, theorems, traced, &name, &field, &detail);
+
+        agency_report_rule rule;
+        memset(&rule, 0, sizeof(rule));
+        rule.kind = traced->kind;
+        rule.outcome = traced->outcome;
+        rule.ns = traced->ns;
+        put_string(writer, name, &rule.name_offset, &rule.name_length);
+        put_string(writer, field, &rule.field_offset, &rule.field_length);
+        put_string(writer, detail, &rule.detail_offset, &rule.detail_length);
+
+        size_t slot = table + i * sizeof(rule);
+        if (slot + sizeof(rule) <= writer->capacity) {
+            memcpy(writer->buffer + slot, &rule, sizeof(rule));
+        }
+    }
+}
+
+/**
+ * @brief Encode a report as JSON.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int encode_json(report_writer* writer, agency_arena* arena, const agency_schema* schema,
+                       const agency_theorem_domain* theorems, const agency_verify_trace* trace,
+                       int verdict, uint64_t total_ns) {
+    agency_json_writer json;
+    agency_json_writer_init(&json, arena, 0);
+    agency_json_begin_object(&json);
+    agency_json_key(&json, "verdict");
+    agency_json_int(&json, verdict);
+    agency_json_key(&json, "total_ns");
+    agency_json_int(&json, (int64_t)total_ns);
+    agency_json_key(&json, "error_offset");
+    if (trace->error_offset == SIZE_MAX) {
+        agency_json_null(&json);
+    } else {
+        agency_json_int(&json, (int64_t)trace->error_offset);
+    }
+
+    agency_json_key(&json, "rules");
+    agency_json_begin_array(&json);
+    for (size_t i = 0; i < trace->num_rules; i++) {
+        const agency_rule_trace* traced = &trace->rules[i];
+        report_string name, field, detail;
+        describe_rule(schema, theorems, traced, &name, &field, &detail);
+
+        const char* kind = g_kind_names[traced->kind];
+        const char* outcome = g_outcome_names[traced->outcome];
+        agency_json_begin_object(&json);
+        agency_json_key(&json, "kind");
+        agency_json_string(&json, kind, strlen(kind));
+        agency_json_key(&json, "name");
+        agency_json_string(&json, name.text, name.length);
+        agency_json_key(&json, "field");
+        agency_json_string(&json, field.text, field.length);
+        agency_json_key(&json, "outcome");
+        agency_json_string(&json, outcome, strlen(outcome));
+        if (traced->outcome == AGENCY_RULE_KEYWORD_MISSING) {
+            agency_json_key(&json, "missing");
+            agency_json_string(&json, detail.text, detail.length);
+        }
+        agency_json_key(&json, "ns");
+        agency_json_int(&json, (int64_t)traced->ns);
+        agency_json_end_object(&json);
+    }
+    agency_json_end_array(&json);
+    agency_json_end_object(&json);
+
+    size_t length = 0;
+    const char* text = agency_json_writer_finish(&json, &length);
+    if (text == NULL) {
+        return -1;
+    }
+    put_bytes(writer, text, length + 1);
+    writer->used--;  // the terminator is not part of the length
+    return 0;
+}
+
+int agency_verify_issue_report(const char* agency, const char* issue_json,
+                               agency_report_format format, char* buffer, size_t capacity,
+                               size_t* length) {
+    if (agency == NULL || issue_json == NULL || length == NULL || (buffer == NULL && capacity > 0) ||
+        (format != AGENCY_REPORT_BINARY && format != AGENCY_REPORT_JSON)) {
+        return AGENCY_STATUS_ERROR;
+    }
+
+    // The schema belongs to the snapshot, which must outlive the report
+    agency_epoch_record* epoch = agency_epoch_enter();
+    const agency_schema* schema = agency_schema_for_agency(agency);
+    const agency_theorem_domain* theorems = agency_theorems_for_agency(agency);
+    size_t max_rules = (schema != NULL ? schema->num_fields : 0) +
+                       (theorems != NULL ? theorems->num_rules : 0);
+
+    // The trace and the JSON text live in the arena; the report goes to the caller's buffer
+    agency_arena* arena = agency_arena_begin();
+    agency_verify_trace trace;
+    trace.rules = arena != NULL ?
+        (agency_rule_trace*)agency_arena_alloc(arena, (max_rules + 1) * sizeof(agency_rule_trace)) : NULL;
+    if (trace.rules == NULL) {
+        agency_arena_end(arena);
+        agency_epoch_leave(epoch);
+        return AGENCY_STATUS_ERROR;
+    }
+
+    uint64_t start = monotonic_ns();
+    int verdict = agency_verify_json_traced(schema, theorems, issue_json, strlen(issue_json), &trace);
+    uint64_t total_ns = monotonic_ns() - start;
+
+    report_writer writer = {buffer, capacity, 0};
+    int status = AGENCY_STATUS_OK;
+    if (format == AGENCY_REPORT_BINARY) {
+        encode_binary(&writer, schema, theorems, &trace, verdict, total_ns);
+    } else if (encode_json(&writer, arena, schema, theorems, &trace, verdict, total_ns) != 0) {
+        status = AGENCY_STATUS_ERROR;
+    }
+    agency_arena_end(arena);
+    agency_epoch_leave(epoch);
+
+    if (status != AGENCY_STATUS_OK) {
+        return status;
+    }
+
+    // JSON needs room for its terminator as well
+    size_t required = writer.used + (format == AGENCY_REPORT_JSON);
+    *length = required > capacity ? required : writer.used;
+    return required > capacity ? AGENCY_STATUS_ERROR : AGENCY_STATUS_OK;
+}
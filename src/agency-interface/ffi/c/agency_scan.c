@@ -0,0 +1,385 @@
+/**
+ * @file agency_scan.c
+ * @brief Vectorized structural indexing of JSON text.
+ *
+ * Input is classified 64 bytes at a time into bitmasks of quotes,
+ * backslashes, structural characters and whitespace. From those the scanner
+ * derives, without branching per byte, which quotes are escaped, which bytes
+ * lie inside strings and where each number or literal starts. The positions
+ * left over are the document's tokens: every structural character outside a
+ * string, both quotes of every string, and the first byte of every scalar.
+ * A parser walking tokens never looks at string contents or whitespace.
+ *
+ * Classification has AVX2, SSE4.2 and scalar implementations, picked once
+ * from the CPU's features. AGENCY_SCAN_ISA ("avx2", "sse4.2" or "scalar")
+ * forces one, which is how the implementations are tested against each other.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agency_internal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_X86 1
+#endif
+
+/**
+ * @brief Character classes of one 64-byte block, one bit per byte.
+ */
+typedef struct {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;     // { } [ ] : ,
+    uint64_t space;  // space, tab, newline, carriage return
+} scan_masks;
+
+typedef void (*scan_classify_fn)(const unsigned char* block, scan_masks* masks);
+
+static int advance_scalar(agency_scanner* scanner);
+#ifdef SCAN_X86
+static int advance_sse42(agency_scanner* scanner);
+static int advance_avx2(agency_scanner* scanner);
+#endif
+
+static int (*g_advance)(agency_scanner* scanner) = NULL;
+static const char* g_isa = "scalar";
+static pthread_once_t g_select_once = PTHREAD_ONCE_INIT;
+
+enum {
+    CLASS_QUOTE = 1,
+    CLASS_BACKSLASH = 2,
+    CLASS_OP = 4,
+    CLASS_SPACE = 8
+};
+
+static unsigned char g_classes[256];
+
+static inline __attribute__((always_inline))
+void classify_scalar(const unsigned char* block, scan_masks* masks) {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t op = 0;
+    uint64_t space = 0;
+
+    for (int i = 0; i < 64; i++) {
+        uint64_t c = g_classes[block[i]];
+        quote |= (c & 1) << i;
+        backslash |= ((c >> 1) & 1) << i;
+        op |= ((c >> 2) & 1) << i;
+        space |= ((c >> 3) & 1) << i;
+    }
+
+    masks->quote = quote;
+    masks->backslash = backslash;
+    masks->op = op;
+    masks->space = space;
+}
+
+#ifdef SCAN_X86
+
+/*
+ * Structural characters and whitespace are found with two 16-entry table
+ * lookups, one on each nibble of the byte: a byte is in a class when both
+ * of its nibbles' entries share that class's bit.
+ *
+ *   bit 0 ','  bit 1 ':'  bit 2 [ ] { }  bit 3 ' '  bit 4 \t \n \r
+ */
+#define SCAN_LOW_NIBBLES 8, 0, 0, 0, 0, 0, 0, 0, 0, 16, 18, 4, 1, 20, 0, 0
+#define SCAN_HIGH_NIBBLES 16, 0, 9, 2, 0, 4, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0
+#define SCAN_OP_BITS 7
+#define SCAN_SPACE_BITS 24
+
+static inline __attribute__((always_inline, target("sse4.2")))
+uint64_t mask_sse42(__m128i v0, __m128i v1, __m128i v2, __m128i v3) {
+    return (uint64_t)(uint16_t)_mm_movemask_epi8(v0) |
+           (uint64_t)(uint16_t)_mm_movemask_epi8(v1) << 16 |
+           (uint64_t)(uint16_t)_mm_movemask_epi8(v2) << 32 |
+           (uint64_t)(uint16_t)_mm_movemask_epi8(v3) << 48;
+}
+
+static inline __attribute__((always_inline, target("sse4.2")))
+void classify_sse42(const unsigned char* block, scan_masks* masks) {
+    const __m128i low_table = _mm_setr_epi8(SCAN_LOW_NIBBLES);
+    const __m128i high_table = _mm_setr_epi8(SCAN_HIGH_NIBBLES);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v[4], quote[4], backslash[4], op[4], space[4];
+
+    for (int i = 0; i < 4; i++) {
+        v[i] = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+        __m128i classes = _mm_and_si128(
+            _mm_shuffle_epi8(low_table, _mm_and_si128(v[i], nibble)),
+            _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(v[i], 4), nibble)));
+        quote[i] = _mm_cmpeq_epi8(v[i], _mm_set1_epi8('"'));
+        backslash[i] = _mm_cmpeq_epi8(v[i], _mm_set1_epi8('\\'));
+        op[i] = _mm_cmpeq_epi8(_mm_and_si128(classes, _mm_set1_epi8(SCAN_OP_BITS)), zero);
+        space[i] = _mm_cmpeq_epi8(_mm_and_si128(classes, _mm_set1_epi8(SCAN_SPACE_BITS)), zero);
+    }
+
+    masks->quote = mask_sse42(quote[0], quote[1], quote[2], quote[3]);
+    masks->backslash = mask_sse42(backslash[0], backslash[1], backslash[2], backslash[3]);
+    masks->op = ~mask_sse42(op[0], op[1], op[2], op[3]);
+    masks->space = ~mask_sse42(space[0], space[1], space[2], space[3]);
+}
+
+static inline __attribute__((always_inline, target("avx2")))
+uint64_t mask_avx2(__m256i lo, __m256i hi) {
+    uint32_t low = (uint32_t)_mm256_movemask_epi8(lo);
+    uint32_t high = (uint32_t)_mm256_movemask_epi8(hi);
+    return (uint64_t)low | ((uint64_t)high << 32);
+}
+
+static inline __attribute__((always_inline, target("avx2")))
+__m256i classes_avx2(__m256i v) {
+    const __m256i low_table = _mm256_setr_epi8(SCAN_LOW_NIBBLES, SCAN_LOW_NIBBLES);
+    const __m256i high_table = _mm256_setr_epi8(SCAN_HIGH_NIBBLES, SCAN_HIGH_NIBBLES);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    return _mm256_and_si256(
+        _mm256_shuffle_epi8(low_table, _mm256_and_si256(v, nibble)),
+        _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+}
+
+static inline __attribute__((always_inline, target("avx2")))
+__m256i lacks_avx2(__m256i classes, char bits) {
+    return _mm256_cmpeq_epi8(_mm256_and_si256(classes, _mm256_set1_epi8(bits)), _mm256_setzero_si256());
+}
+
+static inline __attribute__((always_inline, target("avx2")))
+void classify_avx2(const unsigned char* block, scan_masks* masks) {
+    __m256i lo = _mm256_loadu_si256((const __m256i*)block);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)(block + 32));
+    __m256i lo_classes = classes_avx2(lo);
+    __m256i hi_classes = classes_avx2(hi);
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+
+    masks->quote = mask_avx2(_mm256_cmpeq_epi8(lo, quote), _mm256_cmpeq_epi8(hi, quote));
+    masks->backslash = mask_avx2(_mm256_cmpeq_epi8(lo, backslash), _mm256_cmpeq_epi8(hi, backslash));
+    masks->op = ~mask_avx2(lacks_avx2(lo_classes, SCAN_OP_BITS), lacks_avx2(hi_classes, SCAN_OP_BITS));
+    masks->space = ~mask_avx2(lacks_avx2(lo_classes, SCAN_SPACE_BITS),
+                              lacks_avx2(hi_classes, SCAN_SPACE_BITS));
+}
+
+#endif
+
+/**
+ * @brief Install the classifier named @p isa if the CPU supports it.
+ */
+static int select_isa(const char* isa) {
+    if (strcmp(isa, "scalar") == 0) {
+        g_advance = advance_scalar;
+        g_isa = "scalar";
+        return 0;
+    }
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    if (strcmp(isa, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        g_advance = advance_avx2;
+        g_isa = "avx2";
+        return 0;
+    }
+    if (strcmp(isa, "sse4.2") == 0 && __builtin_cpu_supports("sse4.2")) {
+        g_advance = advance_sse42;
+        g_isa = "sse4.2";
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+static void select_classifier(void) {
+    g_classes['"'] = CLASS_QUOTE;
+    g_classes['\\'] = CLASS_BACKSLASH;
+    for (const char* c = "{}[]:,"; *c; c++) {
+        g_classes[(unsigned char)*c] = CLASS_OP;
+    }
+    for (const char* c = " \t\n\r"; *c; c++) {
+        g_classes[(unsigned char)*c] = CLASS_SPACE;
+    }
+
+    const char* forced = getenv("AGENCY_SCAN_ISA");
+    if (forced != NULL && select_isa(forced) == 0) {
+        return;
+    }
+    if (forced != NULL) {
+        fprintf(stderr, "Error: unsupported AGENCY_SCAN_ISA '%s'\n", forced);
+    }
+    if (select_isa("avx2") != 0 && select_isa("sse4.2") != 0) {
+        select_isa("scalar");
+    }
+}
+
+int agency_scan_select(const char* isa) {
+    pthread_once(&g_select_once, select_classifier);
+    return select_isa(isa);
+}
+
+const char* agency_scan_isa(void) {
+    pthread_once(&g_select_once, select_classifier);
+    return g_isa;
+}
+
+/**
+ * @brief Find the bytes that follow an escaping backslash.
+ *
+ * Backslashes are rare, so runs are resolved one at a time rather than
+ * with carry arithmetic.
+ *
+ * @param carry Set on entry if the first byte is escaped by the previous
+ *        block; set on return if the last byte escapes the next block.
+ */
+static uint64_t find_escaped(uint64_t backslash, uint64_t* carry) {
+    uint64_t escaped = *carry;
+    *carry = 0;
+
+    backslash &= ~escaped;
+    while (backslash != 0) {
+        int i = __builtin_ctzll(backslash);
+        backslash &= backslash - 1;
+        if (i == 63) {
+            *carry = 1;
+            break;
+        }
+        uint64_t next = 1ULL << (i + 1);
+        escaped |= next;
+        backslash &= ~next;
+    }
+    return escaped;
+}
+
+/**
+ * @brief Set every bit from each quote up to, not including, the next one.
+ */
+static uint64_t prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/**
+ * @brief Check the escape sequence whose letter is at @p pos.
+ */
+static int valid_escape(const char* data, size_t length, size_t pos) {
+    if (pos >= length) {
+        return 0;
+    }
+    if (data[pos] != 'u') {
+        return memchr("\"\\/bfnrt", data[pos], 8) != NULL;
+    }
+    if (length - pos < 5) {
+        return 0;
+    }
+    for (size_t i = 1; i <= 4; i++) {
+        char c = data[pos + i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void agency_scanner_init(agency_scanner* scanner, const char* data, size_t length) {
+    pthread_once(&g_select_once, select_classifier);
+    memset(scanner, 0, sizeof(*scanner));
+    scanner->data = data;
+    scanner->length = length;
+}
+
+/**
+ * @brief Index blocks until one holds a token or the input ends.
+ *
+ * Inlined into one entry point per instruction set, so the classifier is
+ * inlined too and long string bodies are crossed without returning.
+ */
+static inline __attribute__((always_inline))
+int scan_advance(agency_scanner* scanner, scan_classify_fn classify) {
+    // Work on locals; the input is bytes, which may alias the scanner
+    const char* data = scanner->data;
+    size_t length = scanner->length;
+    size_t next = scanner->next;
+    uint64_t in_string = scanner->in_string;
+    uint64_t escape_carry = scanner->escape_carry;
+    uint64_t scalar_carry = scanner->scalar_carry;
+    uint64_t tokens = 0;
+
+    while (!scanner->stopped && next < length) {
+        const unsigned char* block = (const unsigned char*)data + next;
+        unsigned char padded[64];
+        if (length - next < 64) {
+            // Pad the tail with whitespace, which never produces a token
+            memcpy(padded, block, length - next);
+            memset(padded + (length - next), ' ', 64 - (length - next));
+            block = padded;
+        }
+
+        scan_masks masks;
+        classify(block, &masks);
+
+        uint64_t escaped = 0;
+        if (masks.backslash != 0 || escape_carry != 0) {
+            escaped = find_escaped(masks.backslash, &escape_carry);
+        }
+        uint64_t quote = masks.quote & ~escaped;
+        uint64_t inside = prefix_xor(quote) ^ in_string;
+        in_string = (uint64_t)((int64_t)inside >> 63);
+
+        // Bytes outside strings that are not structural belong to scalars
+        uint64_t scalar = ~(masks.op | masks.space | quote | inside);
+        uint64_t scalar_starts = scalar & ~((scalar << 1) | scalar_carry);
+        scalar_carry = scalar >> 63;
+
+        tokens = (masks.op & ~inside) | quote | scalar_starts;
+
+        // Tokens past a malformed escape are withheld, so the string never closes
+        for (uint64_t check = escaped & inside; check != 0; check &= check - 1) {
+            int i = __builtin_ctzll(check);
+            if (!valid_escape(data, length, next + (size_t)i)) {
+                tokens &= (1ULL << i) - 1;
+                scanner->stopped = 1;
+                break;
+            }
+        }
+
+        next += 64;
+        if (tokens != 0) {
+            break;
+        }
+    }
+
+    scanner->block = next - 64;
+    scanner->next = next;
+    scanner->in_string = in_string;
+    scanner->escape_carry = escape_carry;
+    scanner->scalar_carry = scalar_carry;
+    scanner->tokens = tokens;
+    return tokens != 0;
+}
+
+static int advance_scalar(agency_scanner* scanner) {
+    return scan_advance(scanner, classify_scalar);
+}
+
+#ifdef SCAN_X86
+
+__attribute__((target("sse4.2")))
+static int advance_sse42(agency_scanner* scanner) {
+    return scan_advance(scanner, classify_sse42);
+}
+
+__attribute__((target("avx2")))
+static int advance_avx2(agency_scanner* scanner) {
+    return scan_advance(scanner, classify_avx2);
+}
+
+#endif
+
+int agency_scanner_advance(agency_scanner* scanner) {
+    return g_advance(scanner);
+}
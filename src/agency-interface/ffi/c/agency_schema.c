@@ -0,0 +1,468 @@
+/**
+ * @file agency_schema.c
+ * @brief Compilation of the per-agency issue schemas declared in the configuration.
+ *
+ * The configuration may carry an "issue_schemas" object:
+ *
+ *     "issue_schemas": {
+ *       "default":  { "<field>": <spec>, ... },
+ *       "domains":  { "<domain>": { "<field>": <spec>, ... } },
+ *       "agencies": { "<acronym>": { "<field>": <spec>, ... } }
+ *     }
+ *
+ * where each spec may hold "type" (a type name or a list of them: "string",
+ * "integer", "number", "boolean", "array", "object", "null", "any"),
+ * "required", "enum" (a list of strings), "min_length" and "max_length"
+ * (strings, in characters) and "min_items" and "max_items" (arrays).
+ *
+ * An agency's schema is the default overlaid with its domain's fields, then
+ * with its own; a field declared at a narrower scope replaces the wider
+ * declaration. Without a "default", issues need id, title, description and
+ * affected_areas, as before schemas existed. Each distinct schema is
+ * compiled once into a flat field table that agency_verify_json() applies
+ * while it scans the issue.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agency_internal.h"
+
+#define SCHEMA_CONFIG_KEY "issue_schemas"
+
+// The field whose text the domain theorems are applied to
+#define SCHEMA_TEXT_FIELD "description"
+
+/**
+ * @brief A field declaration awaiting compilation.
+ */
+typedef struct {
+    const char* name;
+    json_object* spec;  // NULL for a built-in required field of any type
+} field_decl;
+
+/**
+ * @brief The declarations in force for one scope, after overlaying.
+ */
+typedef struct {
+    field_decl decls[AGENCY_SCHEMA_MAX_FIELDS];
+    size_t count;
+} decl_list;
+
+/**
+ * @brief A compiled domain schema, kept so agencies of a domain share it.
+ */
+typedef struct {
+    const char* domain;
+    const agency_schema* schema;
+} domain_schema;
+
+// Built-in schema, used until the configuration has loaded or if it compiled none
+static char g_builtin_pool[] = "id\0title\0description\0affected_areas";
+static agency_schema_field g_builtin_fields[] = {
+    {{0, 2}, AGENCY_JSON_ANY, 0, UINT32_MAX, 0, UINT32_MAX, 0, 0},
+    {{3, 5}, AGENCY_JSON_ANY, 0, UINT32_MAX, 0, UINT32_MAX, 0, 0},
+    {{9, 11}, AGENCY_JSON_ANY, 0, UINT32_MAX, 0, UINT32_MAX, 0, 0},
+    {{21, 14}, AGENCY_JSON_ANY, 0, UINT32_MAX, 0, UINT32_MAX, 0, 0},
+};
+static const agency_schema g_builtin_schema = {
+    g_builtin_pool, sizeof(g_builtin_pool), g_builtin_fields, 4, NULL, 0, 0xF, 0xF, 2, 0,
+};
+
+// Compiled schemas, one per configured agency, plus the default
+
+/**
+ * @brief Apply a scope's field declarations on top of a list.
+ */
+static void overlay(decl_list* list, json_object* fields, const char* scope) {
+    if (fields == NULL) {
+        return;
+    }
+    if (!json_object_is_type(fields, json_type_object)) {
+        fprintf(stderr, "Error: issue schema for %s is not an object\n", scope);
+        return;
+    }
+
+    json_object_object_foreach(fields, name, spec) {
+        if (strlen(name) > AGENCY_SCHEMA_NAME_MAX) {
+            fprintf(stderr, "Error: issue schema field name too long in %s: %s\n", scope, name);
+            continue;
+        }
+
+        size_t i = 0;
+        while (i < list->count && strcmp(list->decls[i].name, name) != 0) {
+            i++;
+        }
+        if (i == list->count) {
+            if (list->count == AGENCY_SCHEMA_MAX_FIELDS) {
+                fprintf(stderr, "Error: too many issue schema fields in %s\n", scope);
+                continue;
+            }
+            list->count++;
+        }
+        list->decls[i].name = name;
+        list->decls[i].spec = spec;
+    }
+}
+
+/**
+ * @brief Append a string to a schema's pool.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int pool_append(agency_schema* schema, size_t* size, size_t* capacity,
+                       const char* text, agency_schema_string* out) {
+    size_t length = strlen(text);
+    if (*size + length + 1 > *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 256;
+        while (new_capacity < *size + length + 1) {
+            new_capacity *= 2;
+        }
+        char* pool = (char*)agency_realloc(schema->pool, new_capacity);
+        if (pool == NULL) {
+            return -1;
+        }
+        schema->pool = pool;
+        *capacity = new_capacity;
+    }
+
+    memcpy(schema->pool + *size, text, length + 1);
+    out->offset = (uint32_t)*size;
+    out->length = (uint32_t)length;
+    *size += length + 1;
+    return 0;
+}
+
+/**
+ * @brief Map a type name to its type bits.
+ *
+ * @return The bits, or 0 if the name is unknown.
+ */
+static uint32_t type_bits(const char* name) {
+    static const struct {
+        const char* name;
+        uint32_t bits;
+    } types[] = {
+        {"null", AGENCY_JSON_NULL},
+        {"boolean", AGENCY_JSON_BOOLEAN},
+        {"integer", AGENCY_JSON_INTEGER},
+        {"number", AGENCY_JSON_INTEGER | AGENCY_JSON_FRACTION},
+        {"string", AGENCY_JSON_STRING},
+        {"array", AGENCY_JSON_ARRAY},
+        {"object", AGENCY_JSON_OBJECT},
+        {"any", AGENCY_JSON_ANY},
+    };
+
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if (strcmp(types[i].name, name) == 0) {
+            return types[i].bits;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Read a non-negative integer limit from a field spec.
+ *
+ * @return 1 if the limit is present and valid, 0 otherwise.
+ */
+static int read_limit(json_object* spec, const char* key, const char* field, uint32_t* limit) {
+    json_object* value;
+    if (!json_object_object_get_ex(spec, key, &value)) {
+        return 0;
+    }
+
+    int64_t number = json_object_get_int64(value);
+    if (!json_object_is_type(value, json_type_int) || number < 0 || number >= UINT32_MAX) {
+        fprintf(stderr, "Error: issue schema field %s has an invalid %s\n", field, key);
+        return 0;
+    }
+
+    *limit = (uint32_t)number;
+    return 1;
+}
+
+/**
+ * @brief Compile one field declaration into the schema's next slot.
+ *
+ * Invalid attributes are reported and ignored, leaving the field less strict.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int compile_field(agency_schema* schema, const field_decl* decl,
+                         size_t* pool_size, size_t* pool_capacity, size_t* enum_capacity) {
+    size_t index = schema->num_fields;
+    agency_schema_field* field = &schema->fields[index];
+    field->types = AGENCY_JSON_ANY;
+    field->min_length = 0;
+    field->max_length = UINT32_MAX;
+    field->min_items = 0;
+    field->max_items = UINT32_MAX;
+    field->first_enum = (uint32_t)schema->num_enums;
+    field->num_enums = 0;
+
+    if (pool_append(schema, pool_size, pool_capacity, decl->name, &field->name) != 0) {
+        return -1;
+    }
+    schema->num_fields++;
+    schema->all |= 1ULL << index;
+    if (strcmp(decl->name, SCHEMA_TEXT_FIELD) == 0) {
+        schema->description_field = (int)index;
+    }
+
+    json_object* spec = decl->spec;
+    if (spec == NULL) {
+        schema->required |= 1ULL << index;
+        return 0;
+    }
+    if (!json_object_is_type(spec, json_type_object)) {
+        fprintf(stderr, "Error: issue schema field %s is not an object\n", decl->name);
+        return 0;
+    }
+
+    json_object* value;
+    if (json_object_object_get_ex(spec, "required", &value) && json_object_get_boolean(value)) {
+        schema->required |= 1ULL << index;
+    }
+
+    if (json_object_object_get_ex(spec, "type", &value)) {
+        uint32_t types = 0;
+        if (json_object_is_type(value, json_type_array)) {
+            for (size_t i = 0; i < json_object_array_length(value); i++) {
+                uint32_t bits = type_bits(json_object_get_string(json_object_array_get_idx(value, i)));
+                types |= bits != 0 ? bits : AGENCY_JSON_ANY;
+            }
+        } else {
+            types = type_bits(json_object_get_string(value));
+        }
+        if (types == 0) {
+            fprintf(stderr, "Error: issue schema field %s has an unknown type\n", decl->name);
+            types = AGENCY_JSON_ANY;
+        }
+        field->types = types;
+    }
+
+    read_limit(spec, "min_length", decl->name, &field->min_length);
+    read_limit(spec, "max_length", decl->name, &field->max_length);
+    read_limit(spec, "min_items", decl->name, &field->min_items);
+    read_limit(spec, "max_items", decl->name, &field->max_items);
+
+    if (json_object_object_get_ex(spec, "enum", &value)) {
+        if (!json_object_is_type(value, json_type_array)) {
+            fprintf(stderr, "Error: issue schema field %s has an invalid enum\n", decl->name);
+            return 0;
+        }
+        for (size_t i = 0; i < json_object_array_length(value); i++) {
+            json_object* item = json_object_array_get_idx(value, i);
+            if (!json_object_is_type(item, json_type_string) ||
+                json_object_get_string_len(item) > AGENCY_SCHEMA_NAME_MAX) {
+                fprintf(stderr, "Error: issue schema field %s has an invalid enum value\n", decl->name);
+                continue;
+            }
+
+            if (schema->num_enums == *enum_capacity) {
+                size_t new_capacity = *enum_capacity ? *enum_capacity * 2 : 16;
+                agency_schema_string* enums = (agency_schema_string*)agency_realloc(
+                    schema->enums, new_capacity * sizeof(agency_schema_string));
+                if (enums == NULL) {
+                    return -1;
+                }
+                schema->enums = enums;
+                *enum_capacity = new_capacity;
+            }
+            if (pool_append(schema, pool_size, pool_capacity, json_object_get_string(item),
+                            &schema->enums[schema->num_enums]) != 0) {
+                return -1;
+            }
+            schema->num_enums++;
+            field->num_enums++;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Free a partly or fully compiled schema.
+ */
+static void schema_free(agency_schema* schema) {
+    if (schema != NULL) {
+        agency_free(schema->pool);
+        agency_free(schema->fields);
+        agency_free(schema->enums);
+        agency_free(schema);
+    }
+}
+
+/**
+ * @brief Compile a list of declarations into a schema.
+ *
+ * @return The schema, or NULL on allocation failure.
+ */
+static agency_schema* compile_schema(const decl_list* list) {
+    agency_schema* schema = (agency_schema*)agency_calloc(1, sizeof(agency_schema));
+    if (schema == NULL) {
+        return NULL;
+    }
+    schema->description_field = -1;
+
+    // One extra slot for the theorem text field if the list lacks it
+    schema->fields = (agency_schema_field*)agency_calloc(list->count + 1, sizeof(agency_schema_field));
+    if (schema->fields == NULL) {
+        schema_free(schema);
+        return NULL;
+    }
+
+    size_t pool_size = 0;
+    size_t pool_capacity = 0;
+    size_t enum_capacity = 0;
+    for (size_t i = 0; i < list->count; i++) {
+        if (compile_field(schema, &list->decls[i], &pool_size, &pool_capacity, &enum_capacity) != 0) {
+            schema_free(schema);
+            return NULL;
+        }
+    }
+
+    // The validator captures the theorem text through its field entry
+    if (schema->description_field < 0 && schema->num_fields < AGENCY_SCHEMA_MAX_FIELDS) {
+        field_decl text_decl = {SCHEMA_TEXT_FIELD, NULL};
+        if (compile_field(schema, &text_decl, &pool_size, &pool_capacity, &enum_capacity) != 0) {
+            schema_free(schema);
+            return NULL;
+        }
+
+        // Captured for the theorems, not demanded of the issue
+        schema->required &= ~(1ULL << schema->description_field);
+    }
+
+    schema->pool_size = pool_size;
+    schema->bytes = sizeof(agency_schema) + (list->count + 1) * sizeof(agency_schema_field) +
+                    pool_capacity + enum_capacity * sizeof(agency_schema_string);
+    return schema;
+}
+
+void agency_schemas_free(agency_schema_table* table) {
+    for (size_t i = 0; i < table->num_owned; i++) {
+        schema_free(table->owned[i]);
+    }
+    agency_free(table->owned);
+    agency_free(table->by_agency);
+    memset(table, 0, sizeof(*table));
+}
+
+int agency_schemas_compile(json_object* config, agency_schema_table* table) {
+    memset(table, 0, sizeof(*table));
+
+    json_object* schemas = NULL;
+    json_object_object_get_ex(config, SCHEMA_CONFIG_KEY, &schemas);
+
+    json_object* default_fields = NULL;
+    json_object* domain_fields = NULL;
+    json_object* agency_fields = NULL;
+    if (schemas != NULL) {
+        json_object_object_get_ex(schemas, "default", &default_fields);
+        json_object_object_get_ex(schemas, "domains", &domain_fields);
+        json_object_object_get_ex(schemas, "agencies", &agency_fields);
+    }
+
+    decl_list base = {0};
+    if (default_fields != NULL) {
+        overlay(&base, default_fields, "default");
+    } else {
+        for (size_t i = 0; i < g_builtin_schema.num_fields; i++) {
+            base.decls[base.count].name = g_builtin_pool + g_builtin_fields[i].name.offset;
+            base.decls[base.count].spec = NULL;
+            base.count++;
+        }
+    }
+
+    json_object* agencies;
+    size_t num_agencies = 0;
+    if (json_object_object_get_ex(config, "agencies", &agencies)) {
+        num_agencies = json_object_array_length(agencies);
+    }
+
+    // Every schema compiled is owned once, however many agencies share it
+    const agency_schema** by_agency = (const agency_schema**)agency_calloc(num_agencies + 1, sizeof(*by_agency));
+    table->owned = (agency_schema**)agency_calloc(num_agencies + 1, sizeof(agency_schema*));
+    domain_schema* domains = (domain_schema*)agency_calloc(num_agencies + 1, sizeof(domain_schema));
+    agency_schema* fallback = by_agency != NULL && table->owned != NULL && domains != NULL
+                                  ? compile_schema(&base) : NULL;
+    if (fallback == NULL) {
+        agency_free(by_agency);
+        agency_free(domains);
+        agency_schemas_free(table);
+        return -1;
+    }
+    table->owned[table->num_owned++] = fallback;
+    size_t num_domains = 0;
+
+    int status = 0;
+    for (size_t i = 0; i < num_agencies && status == 0; i++) {
+        json_object* agency_obj = json_object_array_get_idx(agencies, i);
+        json_object* value;
+        const char* acronym = json_object_object_get_ex(agency_obj, "acronym", &value)
+                                  ? json_object_get_string(value) : "";
+        const char* domain = json_object_object_get_ex(agency_obj, "domain", &value)
+                                 ? json_object_get_string(value) : "general";
+
+        json_object* own = NULL;
+        json_object* shared = NULL;
+        if (agency_fields != NULL) {
+            json_object_object_get_ex(agency_fields, acronym, &own);
+        }
+        if (domain_fields != NULL) {
+            json_object_object_get_ex(domain_fields, domain, &shared);
+        }
+
+        // Agencies that declare nothing share their domain's program, or the default
+        if (own == NULL) {
+            if (shared == NULL) {
+                by_agency[i] = fallback;
+                continue;
+            }
+            size_t d = 0;
+            while (d < num_domains && strcmp(domains[d].domain, domain) != 0) {
+                d++;
+            }
+            if (d < num_domains) {
+                by_agency[i] = domains[d].schema;
+                continue;
+            }
+        }
+
+        decl_list list = base;
+        overlay(&list, shared, domain);
+        overlay(&list, own, acronym);
+        agency_schema* schema = compile_schema(&list);
+        if (schema == NULL) {
+            status = -1;
+            break;
+        }
+        table->owned[table->num_owned++] = schema;
+        by_agency[i] = schema;
+        if (own == NULL) {
+            domains[num_domains].domain = domain;
+            domains[num_domains].schema = schema;
+            num_domains++;
+        }
+    }
+
+    agency_free(domains);
+    table->by_agency = by_agency;
+    table->num_agencies = num_agencies;
+    table->fallback = fallback;
+    if (status != 0) {
+        agency_schemas_free(table);
+        return -1;
+    }
+    return 0;
+}
+
+const agency_schema* agency_schema_at(const agency_schema_table* table, int index) {
+    if (table != NULL && index >= 0 && (size_t)index < table->num_agencies) {
+        return table->by_agency[index];
+    }
+    return table != NULL && table->fallback != NULL ? table->fallback : &g_builtin_schema;
+}
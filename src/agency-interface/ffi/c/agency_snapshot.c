@@ -0,0 +1,443 @@
+/**
+ * @file agency_snapshot.c
+ * @brief Immutable snapshot of the configuration for the read path.
+ *
+ * json-c objects are not safe to share between reader threads: taking a
+ * reference writes the object's refcount, and serializing one writes the
+ * print buffer it keeps inside the object. The snapshot is therefore built
+ * once, under the configuration lock, with every answer a getter can give
+ * already rendered: each agency's pretty-printed context and its content
+ * hash, and the acronym list for all agencies, each tier and each domain.
+ * Every string the snapshot holds is interned into its one string table, so
+ * the strings lie together and a domain is compared by its offset.
+ *
+ * Once built, the snapshot is packed into one block of whole pages and
+ * sealed read-only. A getter finds its answer with one atomic load and a
+ * lookup, and copies it into a string of its own, so any number of threads
+ * can read with no shared writes and no locks. Nor do other allocations
+ * share the snapshot's pages, so a process that forks after loading keeps
+ * them shared with its children however much the children allocate and
+ * free. A reload publishes a new snapshot and retires the old one, which
+ * epoch-based reclamation frees once the readers inside it have left.
+ *
+ * With NUMA replication on, the snapshot is packed once more for each other
+ * node, onto that node's memory, and a reader takes the copy of the node it
+ * runs on. The copies are published, retired and freed with the original.
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agency_internal.h"
+
+// The published snapshot, built with the configuration
+static _Atomic(agency_snapshot*) g_snapshot = NULL;
+
+/**
+ * @brief Hash an acronym with FNV-1a.
+ */
+static uint32_t hash_acronym(const char* acronym) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)acronym; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Find the index slot for an acronym.
+ *
+ * @return The slot holding the acronym, or the empty slot where it belongs.
+ */
+static size_t snapshot_slot(const agency_snapshot* snapshot, const char* acronym) {
+    size_t mask = snapshot->index_size - 1;
+    size_t slot = hash_acronym(acronym) & mask;
+
+    while (snapshot->index[slot] != 0) {
+        const agency_snapshot_entry* entry = &snapshot->entries[snapshot->index[slot] - 1];
+        if (strcmp(agency_snapshot_string(snapshot, entry->acronym), acronym) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Render a list of acronyms as the getters return it.
+ *
+ * @param agencies The configuration's "agencies" array.
+ * @param snapshot The snapshot whose entries are filtered.
+ * @param tier Only entries in this tier, if @p by_tier is set.
+ * @param domain Only entries in the domain at this offset, unless AGENCY_STRTAB_NONE.
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int render_list(json_object* agencies, agency_snapshot* snapshot, int by_tier,
+                       int tier, uint32_t domain, agency_snapshot_list* list) {
+    json_object* array = json_object_new_array();
+    if (array == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < snapshot->num_entries; i++) {
+        const agency_snapshot_entry* entry = &snapshot->entries[i];
+        if (by_tier && (!entry->has_tier || entry->tier != tier)) {
+            continue;
+        }
+        if (domain != AGENCY_STRTAB_NONE && entry->domain != domain) {
+            continue;
+        }
+        json_object* acronym;
+        json_object_object_get_ex(json_object_array_get_idx(agencies, entry->position), "acronym", &acronym);
+        json_object_array_add(array, json_object_get(acronym));
+    }
+
+    size_t length = 0;
+    const char* json = json_object_to_json_string_length(array, JSON_C_TO_STRING_PRETTY, &length);
+    list->tier = tier;
+    list->domain = domain;
+    list->json = json != NULL ? agency_strtab_intern(&snapshot->strings, json, length) : AGENCY_STRTAB_NONE;
+    list->length = (uint32_t)length;
+    json_object_put(array);
+    return list->json != AGENCY_STRTAB_NONE ? 0 : -1;
+}
+
+/**
+ * @brief Get the acronym list of the domain at an offset, or the empty list.
+ */
+static const agency_snapshot_list* domain_list(const agency_snapshot* snapshot, uint32_t domain) {
+    for (size_t i = 0; i < snapshot->num_domains; i++) {
+        if (snapshot->domains[i].domain == domain) {
+            return &snapshot->domains[i];
+        }
+    }
+    return &snapshot->empty;
+}
+
+/**
+ * @brief Fill the snapshot entry of one configured agency.
+ *
+ * @return 1 if the agency was added, 0 if it has no acronym or repeats an
+ *         earlier one, -1 on allocation failure.
+ */
+static int add_entry(agency_snapshot* snapshot, json_object* agency_obj, int position) {
+    json_object* acronym;
+    if (!json_object_object_get_ex(agency_obj, "acronym", &acronym)) {
+        return 0;
+    }
+
+    // The first agency with an acronym answers for it, as the linear search did
+    const char* acronym_str = json_object_get_string(acronym);
+    size_t slot = snapshot_slot(snapshot, acronym_str);
+    if (snapshot->index[slot] != 0) {
+        return 0;
+    }
+
+    // Counted before it is filled, so a failure below still frees it
+    agency_snapshot_entry* entry = &snapshot->entries[snapshot->num_entries++];
+    entry->position = position;
+    entry->acronym = agency_strtab_intern(&snapshot->strings, acronym_str, strlen(acronym_str));
+    entry->domain = AGENCY_STRTAB_NONE;
+
+    json_object* field;
+    if (json_object_object_get_ex(agency_obj, "tier", &field)) {
+        entry->tier = json_object_get_int(field);
+        entry->has_tier = 1;
+    }
+    if (json_object_object_get_ex(agency_obj, "domain", &field)) {
+        const char* domain = json_object_get_string(field);
+        entry->domain = agency_strtab_intern(&snapshot->strings, domain, strlen(domain));
+        if (entry->domain == AGENCY_STRTAB_NONE) {
+            return -1;
+        }
+    }
+
+    size_t context_length = 0;
+    const char* context = json_object_to_json_string_length(agency_obj, JSON_C_TO_STRING_PRETTY,
+                                                            &context_length);
+    if (entry->acronym == AGENCY_STRTAB_NONE || context == NULL) {
+        return -1;
+    }
+    entry->context = agency_strtab_intern(&snapshot->strings, context, context_length);
+    entry->context_length = (uint32_t)context_length;
+    if (entry->context == AGENCY_STRTAB_NONE) {
+        return -1;
+    }
+    entry->context_hash = agency_content_hash(context, context_length);
+
+    snapshot->index[slot] = (uint32_t)snapshot->num_entries;
+    return 1;
+}
+
+/**
+ * @brief Render the acronym list of every distinct tier and domain.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int render_lists(agency_snapshot* snapshot, json_object* agencies) {
+    if (render_list(agencies, snapshot, 0, 0, AGENCY_STRTAB_NONE, &snapshot->all) != 0) {
+        return -1;
+    }
+
+    // An unknown tier or domain still gets an (empty) list
+    json_object* empty = json_object_new_array();
+    const char* json = empty != NULL ? json_object_to_json_string_ext(empty, JSON_C_TO_STRING_PRETTY) : NULL;
+    snapshot->empty.domain = AGENCY_STRTAB_NONE;
+    snapshot->empty.json = json != NULL ? agency_strtab_intern(&snapshot->strings, json, strlen(json)) :
+                                          AGENCY_STRTAB_NONE;
+    snapshot->empty.length = json != NULL ? (uint32_t)strlen(json) : 0;
+    json_object_put(empty);
+    if (snapshot->empty.json == AGENCY_STRTAB_NONE) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < snapshot->num_entries; i++) {
+        const agency_snapshot_entry* entry = &snapshot->entries[i];
+        if (entry->has_tier && agency_snapshot_tier(snapshot, entry->tier) == &snapshot->empty) {
+            if (render_list(agencies, snapshot, 1, entry->tier, AGENCY_STRTAB_NONE,
+                            &snapshot->tiers[snapshot->num_tiers++]) != 0) {
+                return -1;
+            }
+        }
+        if (entry->domain != AGENCY_STRTAB_NONE && domain_list(snapshot, entry->domain) == &snapshot->empty) {
+            if (render_list(agencies, snapshot, 0, 0, entry->domain,
+                            &snapshot->domains[snapshot->num_domains++]) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Room a schema takes in a packed snapshot.
+ */
+static size_t schema_pack_size(const agency_schema* schema) {
+    return agency_pack_size(sizeof(agency_schema)) + agency_pack_size(schema->pool_size) +
+           agency_pack_size(schema->num_fields * sizeof(agency_schema_field)) +
+           agency_pack_size(schema->num_enums * sizeof(agency_schema_string));
+}
+
+/**
+ * @brief Copy a schema into a packed snapshot.
+ */
+static agency_schema* pack_schema(agency_pack* pack, const agency_schema* schema) {
+    agency_schema* copy = (agency_schema*)agency_pack_copy(pack, schema, sizeof(*schema));
+    copy->pool = (char*)agency_pack_copy(pack, schema->pool, schema->pool_size);
+    copy->fields = (agency_schema_field*)agency_pack_copy(pack, schema->fields,
+                                                          schema->num_fields * sizeof(agency_schema_field));
+    copy->enums = (agency_schema_string*)agency_pack_copy(pack, schema->enums,
+                                                          schema->num_enums * sizeof(agency_schema_string));
+    return copy;
+}
+
+/**
+ * @brief Find the packed copy of a schema the built table owns.
+ */
+static const agency_schema* packed_schema(const agency_schema_table* built, const agency_schema_table* packed,
+                                          const agency_schema* schema) {
+    for (size_t i = 0; i < built->num_owned; i++) {
+        if (built->owned[i] == schema) {
+            return packed->owned[i];
+        }
+    }
+    return schema;
+}
+
+/**
+ * @brief Copy a built snapshot into a pack on the node of a replica.
+ *
+ * The snapshot struct comes first, so the snapshot is also the start of
+ * its pack. The pack is left for the caller to seal.
+ *
+ * @return The packed snapshot, or NULL on allocation failure.
+ */
+static agency_snapshot* snapshot_pack(const agency_snapshot* built, unsigned replica) {
+    const agency_schema_table* schemas = &built->schemas;
+    size_t size = agency_pack_size(sizeof(agency_snapshot)) + agency_pack_size(built->strings.size) +
+                  agency_pack_size(built->strings.num_slots * sizeof(agency_strtab_slot)) +
+                  agency_pack_size(built->num_entries * sizeof(agency_snapshot_entry)) +
+                  agency_pack_size(built->index_size * sizeof(uint32_t)) +
+                  agency_pack_size(built->num_tiers * sizeof(agency_snapshot_list)) +
+                  agency_pack_size(built->num_domains * sizeof(agency_snapshot_list)) +
+                  agency_pack_size(schemas->num_agencies * sizeof(*schemas->by_agency)) +
+                  agency_pack_size(schemas->num_owned * sizeof(*schemas->owned));
+    for (size_t i = 0; i < schemas->num_owned; i++) {
+        size += schema_pack_size(schemas->owned[i]);
+    }
+
+    agency_pack pack;
+    if (agency_pack_begin(&pack, size, replica) != 0) {
+        return NULL;
+    }
+
+    agency_snapshot* snapshot = (agency_snapshot*)agency_pack_copy(&pack, built, sizeof(*built));
+    snapshot->strings.data = (char*)agency_pack_copy(&pack, built->strings.data, built->strings.size);
+    snapshot->strings.capacity = built->strings.size;
+    snapshot->strings.slots = (agency_strtab_slot*)agency_pack_copy(
+        &pack, built->strings.slots, built->strings.num_slots * sizeof(agency_strtab_slot));
+    snapshot->entries = (agency_snapshot_entry*)agency_pack_copy(
+        &pack, built->entries, built->num_entries * sizeof(agency_snapshot_entry));
+    snapshot->index = (uint32_t*)agency_pack_copy(&pack, built->index, built->index_size * sizeof(uint32_t));
+    snapshot->tiers = (agency_snapshot_list*)agency_pack_copy(
+        &pack, built->tiers, built->num_tiers * sizeof(agency_snapshot_list));
+    snapshot->domains = (agency_snapshot_list*)agency_pack_copy(
+        &pack, built->domains, built->num_domains * sizeof(agency_snapshot_list));
+
+    // Agencies share schemas, so their pointers are redirected to the copies
+    agency_schema_table* table = &snapshot->schemas;
+    table->owned = (agency_schema**)agency_pack_copy(&pack, schemas->owned,
+                                                     schemas->num_owned * sizeof(*schemas->owned));
+    for (size_t i = 0; i < schemas->num_owned; i++) {
+        table->owned[i] = pack_schema(&pack, schemas->owned[i]);
+    }
+    table->by_agency = (const agency_schema**)agency_pack_copy(&pack, schemas->by_agency,
+                                                               schemas->num_agencies * sizeof(*schemas->by_agency));
+    for (size_t i = 0; i < schemas->num_agencies; i++) {
+        table->by_agency[i] = packed_schema(schemas, table, schemas->by_agency[i]);
+    }
+    table->fallback = packed_schema(schemas, table, schemas->fallback);
+
+    snapshot->pack = pack;
+    return snapshot;
+}
+
+void agency_snapshot_free(agency_snapshot* snapshot) {
+    if (snapshot == NULL) {
+        return;
+    }
+
+    // Only the original counts the agencies; its copies count their bytes
+    if (snapshot->pack.block != NULL) {
+        for (unsigned r = 1; r < snapshot->num_replicas; r++) {
+            if (snapshot->replicas[r] != NULL) {
+                agency_memory_charge(AGENCY_MEMORY_SNAPSHOT, -(int64_t)snapshot->replicas[r]->pack.size, 0);
+                agency_pack_free(snapshot->replicas[r]->pack);
+            }
+        }
+        agency_memory_charge(AGENCY_MEMORY_SNAPSHOT, -(int64_t)snapshot->pack.size, -(int64_t)snapshot->num_entries);
+        agency_pack_free(snapshot->pack);
+        return;
+    }
+
+    agency_schemas_free(&snapshot->schemas);
+    agency_strtab_free(&snapshot->strings);
+    agency_free(snapshot->entries);
+    agency_free(snapshot->index);
+    agency_free(snapshot->tiers);
+    agency_free(snapshot->domains);
+    agency_free(snapshot);
+}
+
+agency_snapshot* agency_snapshot_build(json_object* config) {
+    json_object* agencies;
+    if (!json_object_object_get_ex(config, "agencies", &agencies)) {
+        fprintf(stderr, "Error: 'agencies' key not found in configuration\n");
+        return NULL;
+    }
+
+    size_t num_agencies = json_object_array_length(agencies);
+    agency_snapshot* snapshot = (agency_snapshot*)agency_calloc(1, sizeof(agency_snapshot));
+    if (snapshot == NULL) {
+        fprintf(stderr, "Error allocating configuration snapshot\n");
+        return NULL;
+    }
+
+    // Keep the index at most half full
+    snapshot->index_size = 16;
+    while (snapshot->index_size < num_agencies * 2) {
+        snapshot->index_size *= 2;
+    }
+    snapshot->index = (uint32_t*)agency_calloc(snapshot->index_size, sizeof(uint32_t));
+    snapshot->entries = (agency_snapshot_entry*)agency_calloc(num_agencies + 1, sizeof(agency_snapshot_entry));
+    snapshot->tiers = (agency_snapshot_list*)agency_calloc(num_agencies + 1, sizeof(agency_snapshot_list));
+    snapshot->domains = (agency_snapshot_list*)agency_calloc(num_agencies + 1, sizeof(agency_snapshot_list));
+
+    int status = snapshot->index != NULL && snapshot->entries != NULL &&
+                 snapshot->tiers != NULL && snapshot->domains != NULL ? 0 : -1;
+    for (size_t i = 0; i < num_agencies && status == 0; i++) {
+        if (add_entry(snapshot, json_object_array_get_idx(agencies, i), (int)i) < 0) {
+            status = -1;
+        }
+    }
+    if (status == 0) {
+        status = render_lists(snapshot, agencies);
+    }
+    agency_strtab_seal(&snapshot->strings, 1);
+    // Without schemas, issues are held to the built-in one
+    if (status == 0 && agency_schemas_compile(config, &snapshot->schemas) != 0) {
+        fprintf(stderr, "Error compiling issue schemas\n");
+    }
+
+    agency_snapshot* packed = status == 0 ? snapshot_pack(snapshot, 0) : NULL;
+    if (packed == NULL) {
+        fprintf(stderr, "Error building configuration snapshot\n");
+        agency_snapshot_free(snapshot);
+        return NULL;
+    }
+    agency_memory_charge(AGENCY_MEMORY_SNAPSHOT, (int64_t)packed->pack.size, (int64_t)packed->num_entries);
+
+    // A copy that cannot be made leaves its node's readers on the original
+    packed->num_replicas = agency_numa_replicas();
+    for (unsigned r = 1; r < packed->num_replicas; r++) {
+        agency_snapshot* replica = snapshot_pack(snapshot, r);
+        if (replica != NULL) {
+            agency_memory_charge(AGENCY_MEMORY_SNAPSHOT, (int64_t)replica->pack.size, 0);
+            agency_pack_seal(&replica->pack);
+        }
+        packed->replicas[r] = replica;
+    }
+    agency_pack_seal(&packed->pack);
+
+    agency_snapshot_free(snapshot);
+    return packed;
+}
+
+agency_snapshot* agency_snapshot_exchange(agency_snapshot* snapshot) {
+    return atomic_exchange(&g_snapshot, snapshot);
+}
+
+const agency_snapshot* agency_snapshot_current(void) {
+    // Sequentially consistent, so the load is ordered after the epoch announcement
+    agency_snapshot* snapshot = atomic_load(&g_snapshot);
+    if (snapshot == NULL && agency_load_config() != NULL) {
+        snapshot = atomic_load(&g_snapshot);
+    }
+    if (snapshot == NULL || snapshot->num_replicas <= 1) {
+        return snapshot;
+    }
+
+    // The replica count may have changed since this snapshot was built
+    unsigned replica = agency_numa_replica();
+    return replica < snapshot->num_replicas && snapshot->replicas[replica] != NULL ? snapshot->replicas[replica]
+                                                                                  : snapshot;
+}
+
+const agency_snapshot_entry* agency_snapshot_find(const agency_snapshot* snapshot, const char* acronym) {
+    if (snapshot == NULL || acronym == NULL) {
+        return NULL;
+    }
+
+    uint32_t position = snapshot->index[snapshot_slot(snapshot, acronym)];
+    return position != 0 ? &snapshot->entries[position - 1] : NULL;
+}
+
+const agency_snapshot_list* agency_snapshot_tier(const agency_snapshot* snapshot, int tier) {
+    for (size_t i = 0; i < snapshot->num_tiers; i++) {
+        if (snapshot->tiers[i].tier == tier) {
+            return &snapshot->tiers[i];
+        }
+    }
+    return &snapshot->empty;
+}
+
+const agency_snapshot_list* agency_snapshot_domain(const agency_snapshot* snapshot, const char* domain) {
+    // A domain no agency declares was never interned
+    uint32_t offset = agency_strtab_find(&snapshot->strings, domain);
+    return offset != AGENCY_STRTAB_NONE ? domain_list(snapshot, offset) : &snapshot->empty;
+}
@@ -0,0 +1,812 @@
+/**
+ * @file agency_store.c
+ * @brief Optional compressed in-memory store for file-backed agency resources.
+ *
+ * agency_store_preload() reads every resource in the manifest once and keeps
+ * it LZ4-compressed (block format) in an append-only arena. From then on
+ * resources are served without touching the filesystem: callers either take
+ * the compressed bytes as they are, or read a decompressed copy out of a
+ * small per-thread cache of recently used resources. Over the resource
+ * cache's memory ceiling, a thread reading a resource drops its other copies.
+ * With a huge-page mode set, the arena's blocks are whole huge pages.
+ */
+
+#define _GNU_SOURCE  // clock_gettime, st_mtim
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "agency_internal.h"
+
+// LZ4 block format parameters
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MFLIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_LOG 12
+
+// Size of each arena block; larger resources get a block of their own
+#define STORE_ARENA_BLOCK_SIZE (1024 * 1024)
+
+// Decompressed resources kept per thread
+#define STORE_HOT_SLOTS 4
+
+/**
+ * @brief One block of the append-only store arena.
+ */
+typedef struct arena_block {
+    struct arena_block* next;
+    size_t used;
+    size_t size;
+    unsigned char data[];
+} arena_block;
+
+// Store state; the arena is only written under g_store.lock
+static struct {
+    pthread_mutex_t lock;
+    arena_block* blocks;
+    size_t resources;
+    size_t raw_bytes;
+    size_t compressed_bytes;
+    size_t arena_bytes;
+} g_store = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/**
+ * @brief Hot-cache counters of one thread.
+ *
+ * Only the owning thread writes them, so readers never contend for a
+ * shared counter; agency_get_store_stats() sums them.
+ */
+typedef struct {
+    _Atomic(uint64_t) hot_hits;
+    _Atomic(uint64_t) hot_misses;
+    _Atomic(uint64_t) decompress_ns;
+} store_counters;
+
+/**
+ * @brief A decompressed resource cached by one thread.
+ */
+typedef struct {
+    const agency_blob* blob;
+    char* data;
+    size_t capacity;
+    uint64_t last_used;
+} hot_slot;
+
+/**
+ * @brief The per-thread cache of decompressed resources.
+ */
+typedef struct hot_cache {
+    hot_slot slots[STORE_HOT_SLOTS];
+    uint64_t clock;
+    store_counters counters;
+    struct hot_cache* next;  // every live thread's cache, under g_hot_lock
+} hot_cache;
+
+static pthread_key_t g_hot_key;
+static pthread_once_t g_hot_key_once = PTHREAD_ONCE_INIT;
+
+// Live threads' caches, and the counters of threads that have exited
+static pthread_mutex_t g_hot_lock = PTHREAD_MUTEX_INITIALIZER;
+static hot_cache* g_hot_caches = NULL;
+static store_counters g_retired_counters;
+
+static inline uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Worst-case compressed size for @p length input bytes.
+ */
+static size_t lz4_bound(size_t length) {
+    return length + length / 255 + 16;
+}
+
+/**
+ * @brief Write an LZ4 length continuation (the part beyond the 4-bit token field).
+ */
+static unsigned char* lz4_write_length(unsigned char* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (unsigned char)length;
+    return op;
+}
+
+/**
+ * @brief Compress a buffer into the LZ4 block format.
+ *
+ * @param src The input.
+ * @param length Input length.
+ * @param dst Output buffer of at least lz4_bound(length) bytes.
+ * @return The compressed length.
+ */
+static size_t lz4_compress(const unsigned char* src, size_t length, unsigned char* dst) {
+    uint32_t table[1 << LZ4_HASH_LOG] = {0};
+    const unsigned char* ip = src;
+    const unsigned char* anchor = src;
+    const unsigned char* end = src + length;
+    unsigned char* op = dst;
+
+    if (length > LZ4_MFLIMIT) {
+        const unsigned char* mflimit = end - LZ4_MFLIMIT;
+        const unsigned char* matchlimit = end - LZ4_LAST_LITERALS;
+
+        while (ip < mflimit) {
+            uint32_t sequence = read32(ip);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_LOG);
+            const unsigned char* ref = src + table[hash];
+            table[hash] = (uint32_t)(ip - src);
+
+            if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || read32(ref) != sequence) {
+                ip++;
+                continue;
+            }
+
+            const unsigned char* match_end = ip + LZ4_MIN_MATCH;
+            const unsigned char* ref_end = ref + LZ4_MIN_MATCH;
+            while (match_end < matchlimit && *match_end == *ref_end) {
+                match_end++;
+                ref_end++;
+            }
+
+            size_t literals = (size_t)(ip - anchor);
+            size_t match_length = (size_t)(match_end - ip) - LZ4_MIN_MATCH;
+            size_t offset = (size_t)(ip - ref);
+
+            unsigned char* token = op++;
+            *token = (unsigned char)(((literals >= 15 ? 15 : literals) << 4) |
+                                     (match_length >= 15 ? 15 : match_length));
+            if (literals >= 15) {
+                op = lz4_write_length(op, literals - 15);
+            }
+            memcpy(op, anchor, literals);
+            op += literals;
+            *op++ = (unsigned char)(offset & 0xff);
+            *op++ = (unsigned char)(offset >> 8);
+            if (match_length >= 15) {
+                op = lz4_write_length(op, match_length - 15);
+            }
+
+            ip = match_end;
+            anchor = ip;
+        }
+    }
+
+    // The block always ends with a literals-only sequence
+    size_t literals = (size_t)(end - anchor);
+    *op++ = (unsigned char)((literals >= 15 ? 15 : literals) << 4);
+    if (literals >= 15) {
+        op = lz4_write_length(op, literals - 15);
+    }
+    memcpy(op, anchor, literals);
+    op += literals;
+
+    return (size_t)(op - dst);
+}
+
+/**
+ * @brief Decompress an LZ4 block, validating every length and offset.
+ *
+ * @return 0 on success, -1 if the input is malformed or does not decode to
+ *         exactly @p raw_length bytes.
+ */
+static int lz4_decompress(const unsigned char* src, size_t length,
+                          unsigned char* dst, size_t raw_length) {
+    const unsigned char* ip = src;
+    const unsigned char* iend = src + length;
+    unsigned char* op = dst;
+    unsigned char* oend = dst + raw_length;
+
+    while (ip < iend) {
+        unsigned int token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            unsigned int byte;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                byte = *ip++;
+                literals += byte;
+            } while (byte == 255);
+        }
+        if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op)) {
+            return -1;
+        }
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+
+        // The final sequence carries literals only
+        if (ip >= iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) {
+            return -1;
+        }
+
+        size_t match_length = token & 15;
+        if (match_length == 15) {
+            unsigned int byte;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                byte = *ip++;
+                match_length += byte;
+            } while (byte == 255);
+        }
+        match_length += LZ4_MIN_MATCH;
+        if (match_length > (size_t)(oend - op)) {
+            return -1;
+        }
+
+        const unsigned char* match = op - offset;
+        if (offset >= match_length) {
+            memcpy(op, match, match_length);
+        } else {
+            // Overlapping copy repeats the last `offset` bytes
+            for (size_t i = 0; i < match_length; i++) {
+                op[i] = match[i];
+            }
+        }
+        op += match_length;
+    }
+
+    return op == oend ? 0 : -1;
+}
+
+void agency_blob_reader_init(agency_blob_reader* reader, const agency_blob* blob) {
+    memset(reader, 0, sizeof(*reader));
+    reader->blob = blob;
+}
+
+/**
+ * @brief Read an LZ4 length continuation onto @p length.
+ *
+ * @return 0 on success, -1 if the input ends first.
+ */
+static int lz4_read_length(const unsigned char* src, size_t end, uint32_t* in, size_t* length) {
+    unsigned int byte;
+    do {
+        if (*in >= end) {
+            return -1;
+        }
+        byte = src[(*in)++];
+        *length += byte;
+    } while (byte == 255);
+    return 0;
+}
+
+int agency_blob_read(agency_blob_reader* reader, char* out, size_t capacity, size_t* length) {
+    const unsigned char* src = reader->blob->data;
+    size_t iend = reader->blob->compressed_length;
+    size_t raw_length = reader->blob->raw_length;
+    unsigned char* op = (unsigned char*)out;
+    unsigned char* oend = op + capacity;
+    *length = 0;
+
+    while (op < oend) {
+        size_t produced = reader->out + (size_t)(op - (unsigned char*)out);
+
+        if (reader->literals > 0) {
+            size_t n = reader->literals < (size_t)(oend - op) ? reader->literals : (size_t)(oend - op);
+            memcpy(op, src + reader->in, n);
+            op += n;
+            reader->in += (uint32_t)n;
+            reader->literals -= (uint32_t)n;
+            continue;
+        }
+
+        if (reader->match > 0) {
+            size_t n = reader->match < (size_t)(oend - op) ? reader->match : (size_t)(oend - op);
+            // Overlapping copy repeats the last `offset` bytes
+            const unsigned char* match = op - reader->offset;
+            for (size_t i = 0; i < n; i++) {
+                op[i] = match[i];
+            }
+            op += n;
+            reader->match -= (uint32_t)n;
+            continue;
+        }
+
+        // The final sequence carries literals only
+        if (reader->in >= iend) {
+            break;
+        }
+
+        if (reader->has_match) {
+            if (iend - reader->in < 2) {
+                return -1;
+            }
+            size_t offset = (size_t)src[reader->in] | ((size_t)src[reader->in + 1] << 8);
+            reader->in += 2;
+            if (offset == 0 || offset > produced) {
+                return -1;
+            }
+
+            size_t match_length = reader->token & 15;
+            if (match_length == 15 && lz4_read_length(src, iend, &reader->in, &match_length) != 0) {
+                return -1;
+            }
+            match_length += LZ4_MIN_MATCH;
+            if (match_length > raw_length - produced) {
+                return -1;
+            }
+            reader->offset = (uint32_t)offset;
+            reader->match = (uint32_t)match_length;
+            reader->has_match = 0;
+            continue;
+        }
+
+        reader->token = src[reader->in++];
+        size_t literals = reader->token >> 4;
+        if (literals == 15 && lz4_read_length(src, iend, &reader->in, &literals) != 0) {
+            return -1;
+        }
+        if (literals > iend - reader->in || literals > raw_length - produced) {
+            return -1;
+        }
+        reader->literals = (uint32_t)literals;
+        reader->has_match = 1;
+    }
+
+    *length = (size_t)(op - (unsigned char*)out);
+    reader->out += (uint32_t)*length;
+
+    // Only a block that decodes to exactly raw_length bytes is whole
+    if (*length < capacity && reader->out != raw_length) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Allocate from the store arena. Must be called with g_store.lock held.
+ *
+ * @return A pointer aligned to 8 bytes, or NULL on allocation failure.
+ */
+static void* arena_alloc_locked(size_t size) {
+    size = (size + 7) & ~(size_t)7;
+
+    arena_block* block = g_store.blocks;
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = size > STORE_ARENA_BLOCK_SIZE ? size : STORE_ARENA_BLOCK_SIZE;
+        size_t mapped = 0;
+        block = (arena_block*)agency_huge_alloc(sizeof(arena_block) + block_size, &mapped);
+        if (block != NULL) {
+            // The arena is never freed, so the mapping need not be told apart
+            block_size = mapped - sizeof(arena_block);
+        } else {
+            block = (arena_block*)agency_malloc(sizeof(arena_block) + block_size);
+        }
+        if (block == NULL) {
+            return NULL;
+        }
+        block->used = 0;
+        block->size = block_size;
+        block->next = g_store.blocks;
+        g_store.blocks = block;
+        g_store.arena_bytes += sizeof(arena_block) + block_size;
+        agency_memory_charge(AGENCY_MEMORY_RESOURCE_CACHE, (int64_t)(sizeof(arena_block) + block_size), 0);
+    }
+
+    void* ptr = block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+/**
+ * @brief Manifest visitor that compresses one resource into the store.
+ */
+static void preload_resource(const char* name, agency_resource_kind kind,
+                             agency_resource* resource, void* user_data) {
+    (void)name;
+    (void)kind;
+    int* status = (int*)user_data;
+
+    if (atomic_load(&resource->blob) != NULL) {
+        return;
+    }
+
+    size_t raw_length;
+    char* contents = agency_read_file(resource->path, &raw_length);
+    if (contents == NULL || raw_length > UINT32_MAX) {
+        agency_free(contents);
+        *status = AGENCY_STATUS_ERROR;
+        return;
+    }
+
+    unsigned char* scratch = (unsigned char*)agency_malloc(lz4_bound(raw_length));
+    if (scratch == NULL) {
+        agency_free(contents);
+        *status = AGENCY_STATUS_ERROR;
+        return;
+    }
+    size_t compressed_length = lz4_compress((const unsigned char*)contents, raw_length, scratch);
+
+    agency_blob* blob = (agency_blob*)arena_alloc_locked(sizeof(agency_blob));
+    unsigned char* data = (unsigned char*)arena_alloc_locked(compressed_length);
+    if (blob == NULL || data == NULL) {
+        agency_free(scratch);
+        agency_free(contents);
+        *status = AGENCY_STATUS_ERROR;
+        return;
+    }
+    memcpy(data, scratch, compressed_length);
+    blob->data = data;
+    blob->compressed_length = (uint32_t)compressed_length;
+    blob->raw_length = (uint32_t)raw_length;
+
+    // The contents are in hand, so the ETag comes for free; the file's hash may be stale
+    agency_resource_cache_hash(resource, AGENCY_STAMP_STORED, agency_content_hash(contents, raw_length));
+    atomic_store(&resource->blob, blob);
+
+    g_store.resources++;
+    agency_memory_charge(AGENCY_MEMORY_RESOURCE_CACHE, 0, 1);
+    g_store.raw_bytes += raw_length;
+    g_store.compressed_bytes += compressed_length;
+
+    agency_free(scratch);
+    agency_free(contents);
+}
+
+int agency_store_preload(void) {
+    int status = AGENCY_STATUS_OK;
+
+    agency_epoch_record* epoch = agency_epoch_enter();
+    pthread_mutex_lock(&g_store.lock);
+    agency_manifest_foreach(preload_resource, &status);
+    pthread_mutex_unlock(&g_store.lock);
+    agency_epoch_leave(epoch);
+
+    if (status != AGENCY_STATUS_OK) {
+        fprintf(stderr, "Error preloading one or more agency resources\n");
+    }
+    return status;
+}
+
+/**
+ * @brief Free a thread's hot cache when the thread exits.
+ */
+static void hot_cache_destroy(void* ptr) {
+    hot_cache* cache = (hot_cache*)ptr;
+
+    // Keep the thread's counts in the totals
+    pthread_mutex_lock(&g_hot_lock);
+    for (hot_cache** link = &g_hot_caches; *link != NULL; link = &(*link)->next) {
+        if (*link == cache) {
+            *link = cache->next;
+            break;
+        }
+    }
+    atomic_fetch_add(&g_retired_counters.hot_hits, atomic_load(&cache->counters.hot_hits));
+    atomic_fetch_add(&g_retired_counters.hot_misses, atomic_load(&cache->counters.hot_misses));
+    atomic_fetch_add(&g_retired_counters.decompress_ns, atomic_load(&cache->counters.decompress_ns));
+    pthread_mutex_unlock(&g_hot_lock);
+
+    int64_t bytes = (int64_t)sizeof(hot_cache);
+    int64_t copies = 0;
+    for (int i = 0; i < STORE_HOT_SLOTS; i++) {
+        bytes += (int64_t)cache->slots[i].capacity;
+        copies += cache->slots[i].data != NULL;
+        agency_free(cache->slots[i].data);
+    }
+    agency_free(cache);
+    agency_memory_charge(AGENCY_MEMORY_RESOURCE_CACHE, -bytes, -copies);
+}
+
+static void hot_key_create(void) {
+    pthread_key_create(&g_hot_key, hot_cache_destroy);
+}
+
+/**
+ * @brief Get the calling thread's hot cache, creating it on first use.
+ */
+static hot_cache* get_hot_cache(void) {
+    pthread_once(&g_hot_key_once, hot_key_create);
+
+    hot_cache* cache = (hot_cache*)pthread_getspecific(g_hot_key);
+    if (cache == NULL) {
+        cache = (hot_cache*)agency_calloc(1, sizeof(hot_cache));
+        if (cache != NULL && pthread_setspecific(g_hot_key, cache) != 0) {
+            agency_free(cache);
+            cache = NULL;
+        } else if (cache != NULL) {
+            pthread_mutex_lock(&g_hot_lock);
+            cache->next = g_hot_caches;
+            g_hot_caches = cache;
+            pthread_mutex_unlock(&g_hot_lock);
+            agency_memory_charge(AGENCY_MEMORY_RESOURCE_CACHE, (int64_t)sizeof(hot_cache), 0);
+        }
+    }
+    return cache;
+}
+
+/**
+ * @brief Add to a counter only the calling thread writes.
+ *
+ * A plain load and store, since no other thread can race the update; the
+ * atomics only make the concurrent reads in agency_get_store_stats() safe.
+ */
+static void counter_add(_Atomic(uint64_t)* counter, uint64_t value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Decompress a blob into a buffer, recording the time spent.
+ *
+ * @param out Buffer of at least raw_length + 1 bytes.
+ * @param counters The calling thread's counters, or NULL to record nothing.
+ * @return 0 on success, -1 if the blob is corrupt.
+ */
+static int decompress_blob(const agency_blob* blob, char* out, store_counters* counters) {
+    uint64_t start = monotonic_ns();
+    int status = lz4_decompress(blob->data, blob->compressed_length,
+                                (unsigned char*)out, blob->raw_length);
+    if (counters != NULL) {
+        counter_add(&counters->decompress_ns, monotonic_ns() - start);
+    }
+
+    out[blob->raw_length] = '\0';
+    return status;
+}
+
+/**
+ * @brief Free every decompressed copy a thread holds but @p keep.
+ */
+static void drop_copies(hot_cache* cache, const hot_slot* keep) {
+    int64_t bytes = 0;
+    uint64_t copies = 0;
+    for (int i = 0; i < STORE_HOT_SLOTS; i++) {
+        hot_slot* slot = &cache->slots[i];
+        if (slot == keep || slot->data == NULL) {
+            continue;
+        }
+        bytes += (int64_t)slot->capacity;
+        copies++;
+        agency_free(slot->data);
+        memset(slot, 0, sizeof(*slot));
+    }
+    agency_memory_charge(AGENCY_MEMORY_RESOURCE_CACHE, -bytes, -(int64_t)copies);
+    agency_memory_evicted(AGENCY_MEMORY_RESOURCE_CACHE, copies);
+}
+
+/**
+ * @brief Get a decompressed view of a blob from the calling thread's hot cache.
+ *
+ * @return The decompressed, null-terminated contents, or NULL on error.
+ */
+static const char* hot_cache_get(const agency_blob* blob) {
+    hot_cache* cache = get_hot_cache();
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    cache->clock++;
+
+    hot_slot* victim = &cache->slots[0];
+    for (int i = 0; i < STORE_HOT_SLOTS; i++) {
+        hot_slot* slot = &cache->slots[i];
+        if (slot->blob == blob) {
+            slot->last_used = cache->clock;
+            counter_add(&cache->counters.hot_hits, 1);
+            if (agency_memory_over_limit(AGENCY_MEMORY_RESOURCE_CACHE)) {
+                drop_copies(cache, slot);
+            }
+            return slot->data;
+        }
+        if (slot->last_used < victim->last_used) {
+            victim = slot;
+        }
+    }
+
+    counter_add(&cache->counters.hot_misses, 1);
+
+    if (victim->capacity < (size_t)blob->raw_length + 1) {
+        char* data = (char*)agency_realloc(victim->data, (size_t)blob->raw_length + 1);
+        if (data == NULL) {
+            return NULL;
+        }
+        agency_memory_charge(AGENCY_MEMORY_RESOURCE_CACHE,
+                             (int64_t)blob->raw_length + 1 - (int64_t)victim->capacity, victim->data == NULL);
+        victim->data = data;
+        victim->capacity = (size_t)blob->raw_length + 1;
+    }
+
+    victim->blob = NULL;
+    if (decompress_blob(blob, victim->data, &cache->counters) != 0) {
+        fprintf(stderr, "Error decompressing stored agency resource\n");
+        return NULL;
+    }
+
+    victim->blob = blob;
+    victim->last_used = cache->clock;
+    if (agency_memory_over_limit(AGENCY_MEMORY_RESOURCE_CACHE)) {
+        drop_copies(cache, victim);
+    }
+    return victim->data;
+}
+
+/**
+ * @brief Look up the stored blob for an agency resource.
+ */
+static const agency_blob* find_blob(const char* agency, agency_resource_kind kind, int* status) {
+    // Blobs live in the arena, so they outlast the manifest record
+    agency_epoch_record* epoch = agency_epoch_enter();
+    agency_resource* resource = agency_manifest_lookup(agency, kind);
+    const agency_blob* blob = resource != NULL ? atomic_load(&resource->blob) : NULL;
+    agency_epoch_leave(epoch);
+
+    if (resource == NULL) {
+        *status = AGENCY_STATUS_NOT_FOUND;
+        return NULL;
+    }
+    *status = blob != NULL ? AGENCY_STATUS_OK : AGENCY_STATUS_ERROR;
+    return blob;
+}
+
+int agency_store_get_compressed(const char* agency, agency_resource_kind kind,
+                                const void** data, size_t* compressed_length,
+                                size_t* raw_length) {
+    if (data == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+    *data = NULL;
+
+    int status;
+    const agency_blob* blob = find_blob(agency, kind, &status);
+    if (blob == NULL) {
+        return status;
+    }
+
+    *data = blob->data;
+    if (compressed_length != NULL) {
+        *compressed_length = blob->compressed_length;
+    }
+    if (raw_length != NULL) {
+        *raw_length = blob->raw_length;
+    }
+    return AGENCY_STATUS_OK;
+}
+
+int agency_store_get(const char* agency, agency_resource_kind kind,
+                     const char** data, size_t* length) {
+    if (data == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+    *data = NULL;
+
+    int status;
+    const agency_blob* blob = find_blob(agency, kind, &status);
+    if (blob == NULL) {
+        return status;
+    }
+
+    *data = hot_cache_get(blob);
+    if (*data == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+    if (length != NULL) {
+        *length = blob->raw_length;
+    }
+    return AGENCY_STATUS_OK;
+}
+
+void agency_get_store_stats(agency_store_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_store.lock);
+    stats->resources = g_store.resources;
+    stats->raw_bytes = g_store.raw_bytes;
+    stats->compressed_bytes = g_store.compressed_bytes;
+    stats->arena_bytes = g_store.arena_bytes;
+    pthread_mutex_unlock(&g_store.lock);
+
+    pthread_mutex_lock(&g_hot_lock);
+    stats->hot_hits = atomic_load(&g_retired_counters.hot_hits);
+    stats->hot_misses = atomic_load(&g_retired_counters.hot_misses);
+    stats->decompress_ns = atomic_load(&g_retired_counters.decompress_ns);
+    for (hot_cache* cache = g_hot_caches; cache != NULL; cache = cache->next) {
+        stats->hot_hits += atomic_load_explicit(&cache->counters.hot_hits, memory_order_relaxed);
+        stats->hot_misses += atomic_load_explicit(&cache->counters.hot_misses, memory_order_relaxed);
+        stats->decompress_ns += atomic_load_explicit(&cache->counters.decompress_ns, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&g_hot_lock);
+}
+
+uint64_t agency_resource_stamp(agency_resource* resource) {
+    if (atomic_load(&resource->blob) != NULL) {
+        return AGENCY_STAMP_STORED;
+    }
+
+    struct stat st;
+    if (stat(resource->path, &st) != 0) {
+        return 0;
+    }
+
+    uint64_t fields[4] = {(uint64_t)st.st_size, (uint64_t)st.st_mtim.tv_sec,
+                          (uint64_t)st.st_mtim.tv_nsec, (uint64_t)st.st_ino};
+    uint64_t stamp = agency_hash64(fields, sizeof(fields), 0);
+
+    // 0 and AGENCY_STAMP_STORED mean something else
+    return stamp > AGENCY_STAMP_STORED ? stamp : stamp + 2;
+}
+
+uint64_t agency_resource_cached_hash(const agency_resource* resource, uint64_t* stamp) {
+    unsigned seq = atomic_load_explicit(&resource->hash_seq, memory_order_acquire);
+    uint64_t hash = atomic_load_explicit(&resource->hash, memory_order_relaxed);
+    *stamp = atomic_load_explicit(&resource->hash_stamp, memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+
+    if ((seq & 1) != 0 || atomic_load_explicit(&resource->hash_seq, memory_order_relaxed) != seq) {
+        *stamp = 0;
+        return 0;
+    }
+    return hash;
+}
+
+void agency_resource_cache_hash(agency_resource* resource, uint64_t stamp, uint64_t hash) {
+    unsigned seq = atomic_load_explicit(&resource->hash_seq, memory_order_relaxed);
+    if ((seq & 1) != 0 || !atomic_compare_exchange_strong_explicit(&resource->hash_seq, &seq, seq + 1,
+                                                                   memory_order_acquire,
+                                                                   memory_order_relaxed)) {
+        return;
+    }
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&resource->hash, hash, memory_order_relaxed);
+    atomic_store_explicit(&resource->hash_stamp, stamp, memory_order_relaxed);
+    atomic_store_explicit(&resource->hash_seq, seq + 2, memory_order_release);
+}
+
+char* agency_resource_read(agency_resource* resource, size_t* length) {
+    const agency_blob* blob = atomic_load(&resource->blob);
+    if (blob == NULL) {
+        return agency_read_file(resource->path, length);
+    }
+
+    char* contents = (char*)agency_malloc((size_t)blob->raw_length + 1);
+    if (contents == NULL) {
+        fprintf(stderr, "Error allocating memory for resource contents\n");
+        return NULL;
+    }
+
+    hot_cache* cache = get_hot_cache();
+    if (decompress_blob(blob, contents, cache != NULL ? &cache->counters : NULL) != 0) {
+        fprintf(stderr, "Error decompressing stored agency resource\n");
+        agency_free(contents);
+        return NULL;
+    }
+
+    if (length != NULL) {
+        *length = blob->raw_length;
+    }
+    return contents;
+}
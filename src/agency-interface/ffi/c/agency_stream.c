@@ -0,0 +1,191 @@
+/**
+ * @file agency_stream.c
+ * @brief Chunked streaming reads of file-backed agency resources.
+ *
+ * A stream holds one open descriptor and one chunk-sized buffer, so memory
+ * per reader stays constant however large the connector or finder module
+ * is, and the first chunk can be forwarded before the rest is read. Once a
+ * resource is in the store, it is streamed from there instead, decoded a
+ * chunk at a time behind a window of the bytes already decoded, so a
+ * stream returns the same bytes as the getters.
+ */
+
+#define _GNU_SOURCE  // O_CLOEXEC
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "agency_internal.h"
+
+struct agency_stream {
+    int fd;                      // -1 when streaming from the store
+    agency_blob_reader reader;   // the stored blob's decode, when fd is -1
+    size_t window;               // decoded bytes kept in front of the chunk
+    size_t last_length;          // length of the chunk last returned
+    size_t chunk_size;
+    char buffer[];               // [window space][chunk] for the store, [chunk] for a file
+};
+
+/**
+ * @brief Open a stream, telling a missing resource apart from a failure.
+ *
+ * The manifest record is looked up and its blob or file opened within one
+ * epoch, so a reload in between cannot turn one into the other.
+ */
+static agency_stream* open_stream(const char* agency, agency_resource_kind kind,
+                                  size_t chunk_size, int* status) {
+    if (chunk_size == 0) {
+        chunk_size = AGENCY_STREAM_CHUNK_SIZE;
+    }
+    // Also keeps the buffer size from wrapping around
+    if (chunk_size > AGENCY_STREAM_MAX_CHUNK_SIZE) {
+        chunk_size = AGENCY_STREAM_MAX_CHUNK_SIZE;
+    }
+
+    // The record belongs to the manifest, which a reload may retire once we
+    // leave; a blob lives in the store arena, which is never freed
+    agency_epoch_record* epoch = agency_epoch_enter();
+    agency_resource* resource = agency_manifest_lookup(agency, kind);
+    if (resource == NULL) {
+        agency_epoch_leave(epoch);
+        *status = AGENCY_STATUS_NOT_FOUND;
+        return NULL;
+    }
+
+    const agency_blob* blob = atomic_load(&resource->blob);
+    int fd = -1;
+    if (blob == NULL) {
+        fd = open(resource->path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            fprintf(stderr, "Error opening file: %s\n", resource->path);
+            agency_epoch_leave(epoch);
+            *status = AGENCY_STATUS_ERROR;
+            return NULL;
+        }
+    }
+    agency_epoch_leave(epoch);
+
+    size_t window = blob != NULL ? AGENCY_BLOB_WINDOW : 0;
+    agency_stream* stream = (agency_stream*)agency_malloc(sizeof(agency_stream) + window + chunk_size);
+    if (stream == NULL) {
+        fprintf(stderr, "Error allocating stream buffer\n");
+        if (fd >= 0) {
+            close(fd);
+        }
+        *status = AGENCY_STATUS_ERROR;
+        return NULL;
+    }
+
+    stream->fd = fd;
+    if (blob != NULL) {
+        agency_blob_reader_init(&stream->reader, blob);
+    }
+    stream->window = 0;
+    stream->last_length = 0;
+    stream->chunk_size = chunk_size;
+    *status = AGENCY_STATUS_OK;
+    return stream;
+}
+
+agency_stream* agency_stream_open(const char* agency, agency_resource_kind kind,
+                                  size_t chunk_size) {
+    int status;
+    return open_stream(agency, kind, chunk_size, &status);
+}
+
+/**
+ * @brief Decode the next chunk of a stored resource.
+ */
+static int next_stored_chunk(agency_stream* stream, const char** chunk, size_t* length) {
+    // Keep the tail of what was decoded in front of the chunk, for matches to refer back to
+    char* out = stream->buffer + AGENCY_BLOB_WINDOW;
+    size_t decoded = stream->window + stream->last_length;
+    size_t keep = decoded < AGENCY_BLOB_WINDOW ? decoded : AGENCY_BLOB_WINDOW;
+    memmove(out - keep, out + stream->last_length - keep, keep);
+    stream->window = keep;
+    stream->last_length = 0;
+
+    size_t filled;
+    if (agency_blob_read(&stream->reader, out, stream->chunk_size, &filled) != 0) {
+        fprintf(stderr, "Error decompressing stored agency resource\n");
+        return -1;
+    }
+    stream->last_length = filled;
+
+    *chunk = out;
+    *length = filled;
+    return filled > 0 ? 1 : 0;
+}
+
+int agency_stream_next(agency_stream* stream, const char** chunk, size_t* length) {
+    if (stream == NULL || chunk == NULL || length == NULL) {
+        return -1;
+    }
+    if (stream->fd < 0) {
+        return next_stored_chunk(stream, chunk, length);
+    }
+
+    // Fill the buffer as far as possible so chunks are full-sized except the last
+    size_t filled = 0;
+    while (filled < stream->chunk_size) {
+        ssize_t bytes_read = read(stream->fd, stream->buffer + filled, stream->chunk_size - filled);
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (bytes_read == 0) {
+            break;
+        }
+        filled += (size_t)bytes_read;
+    }
+
+    *chunk = stream->buffer;
+    *length = filled;
+    return filled > 0 ? 1 : 0;
+}
+
+void agency_stream_close(agency_stream* stream) {
+    if (stream == NULL) {
+        return;
+    }
+
+    if (stream->fd >= 0) {
+        close(stream->fd);
+    }
+    agency_free(stream);
+}
+
+int agency_stream_resource(const char* agency, agency_resource_kind kind, size_t chunk_size,
+                           agency_chunk_writer writer, void* user_data) {
+    if (writer == NULL) {
+        return AGENCY_STATUS_ERROR;
+    }
+
+    int status;
+    agency_stream* stream = open_stream(agency, kind, chunk_size, &status);
+    if (stream == NULL) {
+        return status;
+    }
+
+    const char* chunk;
+    size_t length;
+    int more;
+    while ((more = agency_stream_next(stream, &chunk, &length)) > 0) {
+        if (writer(chunk, length, user_data) != 0) {
+            status = AGENCY_STATUS_ERROR;
+            break;
+        }
+    }
+    if (more < 0) {
+        fprintf(stderr, "Error reading stream for agency: %s\n", agency);
+        status = AGENCY_STATUS_ERROR;
+    }
+
+    agency_stream_close(stream);
+    return status;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file agency_strtab.c
+ * @brief Interned strings in one contiguous table.
+ *
+ * Each distinct string is stored once, null-terminated, in a single buffer,
+ * and named by its 32-bit offset into it. Structures built from the
+ * configuration hold offsets rather than pointers to strings of their own,
+ * so a repeated string costs four bytes instead of an allocation, the
+ * strings sit together in memory, and two interned strings are equal
+ * exactly when their offsets are.
+ *
+ * A table is written while the structure that owns it is built and only
+ * read afterwards; agency_strtab_seal() trims the buffer once building ends.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "agency_internal.h"
+
+/**
+ * @brief Find the slot of a string.
+ *
+ * @return The slot holding the string, or the empty slot where it belongs.
+ */
+static size_t strtab_slot(const agency_strtab* table, const char* str, size_t length, uint32_t hash) {
+    size_t mask = table->num_slots - 1;
+    size_t slot = hash & mask;
+
+    while (table->slots[slot].offset != 0) {
+        const agency_strtab_slot* entry = &table->slots[slot];
+        const char* stored = table->data + entry->offset - 1;
+        if (entry->hash == hash && memcmp(stored, str, length) == 0 && stored[length] == '\0') {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Double the slots, keeping them at most half full.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int strtab_grow_slots(agency_strtab* table) {
+    size_t num_slots = table->num_slots ? table->num_slots * 2 : 64;
+    agency_strtab_slot* slots = (agency_strtab_slot*)agency_calloc(num_slots, sizeof(agency_strtab_slot));
+    if (slots == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < table->num_slots; i++) {
+        if (table->slots[i].offset == 0) {
+            continue;
+        }
+        size_t slot = table->slots[i].hash & (num_slots - 1);
+        while (slots[slot].offset != 0) {
+            slot = (slot + 1) & (num_slots - 1);
+        }
+        slots[slot] = table->slots[i];
+    }
+
+    agency_free(table->slots);
+    table->slots = slots;
+    table->num_slots = num_slots;
+    return 0;
+}
+
+uint32_t agency_strtab_intern(agency_strtab* table, const char* str, size_t length) {
+    if ((table->num_strings + 1) * 2 > table->num_slots && strtab_grow_slots(table) != 0) {
+        return AGENCY_STRTAB_NONE;
+    }
+
+    uint32_t hash = (uint32_t)agency_hash64(str, length, 0);
+    size_t slot = strtab_slot(table, str, length, hash);
+    if (table->slots[slot].offset != 0) {
+        return table->slots[slot].offset - 1;
+    }
+
+    // Offsets are 32 bits, and AGENCY_STRTAB_NONE is never one
+    if (length >= UINT32_MAX - 1 - table->size) {
+        fprintf(stderr, "Error interning string: string table is full\n");
+        return AGENCY_STRTAB_NONE;
+    }
+    if (table->size + length + 1 > table->capacity) {
+        size_t capacity = table->capacity ? table->capacity : 4096;
+        while (capacity < table->size + length + 1) {
+            capacity *= 2;
+        }
+        char* data = (char*)agency_realloc(table->data, capacity);
+        if (data == NULL) {
+            return AGENCY_STRTAB_NONE;
+        }
+        table->data = data;
+        table->capacity = capacity;
+    }
+
+    uint32_t offset = (uint32_t)table->size;
+    memcpy(table->data + offset, str, length);
+    table->data[offset + length] = '\0';
+    table->size += length + 1;
+    table->slots[slot].offset = offset + 1;
+    table->slots[slot].hash = hash;
+    table->num_strings++;
+    return offset;
+}
+
+uint32_t agency_strtab_find(const agency_strtab* table, const char* str) {
+    if (table->num_slots == 0 || str == NULL) {
+        return AGENCY_STRTAB_NONE;
+    }
+
+    size_t length = strlen(str);
+    size_t slot = strtab_slot(table, str, length, (uint32_t)agency_hash64(str, length, 0));
+    return table->slots[slot].offset != 0 ? table->slots[slot].offset - 1 : AGENCY_STRTAB_NONE;
+}
+
+void agency_strtab_seal(agency_strtab* table, int keep_index) {
+    if (!keep_index) {
+        agency_free(table->slots);
+        table->slots = NULL;
+        table->num_slots = 0;
+    }
+    if (table->capacity > table->size && table->size > 0) {
+        char* data = (char*)agency_realloc(table->data, table->size);
+        if (data != NULL) {
+            table->data = data;
+            table->capacity = table->size;
+        }
+    }
+}
+
+void agency_strtab_free(agency_strtab* table) {
+    agency_free(table->data);
+    agency_free(table->slots);
+    memset(table, 0, sizeof(*table));
+}
@@ -0,0 +1,562 @@
+/**
+ * @file agency_theorems.c
+ * @brief Native evaluation of the domain theorem models.
+ *
+ * The theorem models in prover_integration/theorem_models/<domain>_theorems.json
+ * are compiled once into a flat rule table per domain: each theorem becomes a
+ * run of lowercase keywords in a shared string pool. Evaluation reproduces
+ * AgencyProverIntegration.verify_issue() / _apply_theorem() from
+ * prover_integration.py: a theorem holds when every word of its statement
+ * longer than four characters occurs in the lowercased issue description,
+ * and an issue is valid when every theorem of its agency's domain holds.
+ * Each theorem's declared components are compiled alongside, for matching
+ * issues to theorems (agency_match.c).
+ *
+ * Case folding is ASCII-only, where Python's str.lower() folds all of
+ * Unicode; lengths are counted in code points as Python does.
+ *
+ * A long description is searched on the work-stealing pool (agency_pool.c)
+ * when the bytes to scan, its length times the domain's keyword count, pass
+ * a cutoff: each keyword is looked for in overlapping segments of the text
+ * as separate items, and the theorems are then decided from which keywords
+ * were found. Shorter descriptions stay on the calling thread, where the
+ * pool's wake-up would cost more than it saves.
+ */
+
+#define _GNU_SOURCE  // memmem
+
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agency_internal.h"
+
+// Statement words must be longer than this to become keywords
+#define THEOREM_MIN_KEYWORD_CHARS 4
+
+// Bytes of description each parallel search item covers, besides the overlap
+#define THEOREM_SEGMENT_BYTES (32u << 10)
+
+// Global theorem set, compiled once on first use
+static const agency_theorem_set* g_theorems = NULL;
+static pthread_once_t g_theorems_once = PTHREAD_ONCE_INIT;
+
+// Copies on other NUMA nodes, by replica; [0] unused
+static _Atomic(const agency_theorem_set*) g_theorem_replicas[AGENCY_NUMA_MAX_REPLICAS];
+static pthread_mutex_t g_replicate_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Bytes to scan above which a description is searched in parallel
+static atomic_size_t g_parallel_cutoff = AGENCY_THEOREM_CUTOFF_DEFAULT;
+static _Atomic(uint64_t) g_parallel_verifications = 0;
+
+/**
+ * @brief One description searched for every keyword of a domain in parallel.
+ */
+typedef struct {
+    const agency_theorem_domain* domain;
+    const char* text;
+    size_t length;
+    size_t num_segments;
+    atomic_uchar* found;  // per keyword
+} keyword_search;
+
+/**
+ * @brief Whitespace as understood by Python's str.split() for ASCII input.
+ */
+static int is_split_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r') || (c >= 0x1c && c <= 0x1f);
+}
+
+/**
+ * @brief Count UTF-8 code points in a byte range.
+ */
+static size_t count_code_points(const char* text, size_t length) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (((unsigned char)text[i] & 0xC0) != 0x80) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Append bytes plus a terminator to a domain's string pool.
+ *
+ * @return The offset of the copy, or -1 on allocation failure.
+ */
+static long pool_append(agency_theorem_domain* domain, size_t* capacity,
+                        const char* text, size_t length) {
+    if (domain->pool_size + length + 1 > *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 1024;
+        while (new_capacity < domain->pool_size + length + 1) {
+            new_capacity *= 2;
+        }
+        char* pool = (char*)agency_realloc(domain->pool, new_capacity);
+        if (pool == NULL) {
+            return -1;
+        }
+        domain->pool = pool;
+        *capacity = new_capacity;
+    }
+
+    long offset = (long)domain->pool_size;
+    memcpy(domain->pool + domain->pool_size, text, length);
+    domain->pool[domain->pool_size + length] = '\0';
+    domain->pool_size += length + 1;
+    return offset;
+}
+
+/**
+ * @brief Append an entry to a domain's keyword or component array.
+ *
+ * @return The new entry, or NULL on allocation failure.
+ */
+static agency_theorem_keyword* keyword_append(agency_theorem_keyword** keywords, size_t* count,
+                                              size_t* capacity) {
+    if (*count == *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 32;
+        agency_theorem_keyword* grown = (agency_theorem_keyword*)agency_realloc(
+            *keywords, new_capacity * sizeof(agency_theorem_keyword));
+        if (grown == NULL) {
+            return NULL;
+        }
+        *keywords = grown;
+        *capacity = new_capacity;
+    }
+    return &(*keywords)[(*count)++];
+}
+
+/**
+ * @brief Record a theorem's declared components.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int compile_components(agency_theorem_domain* domain, agency_theorem_rule* rule,
+                              json_object* theorem, size_t* pool_capacity,
+                              size_t* component_capacity) {
+    rule->first_component = (uint32_t)domain->num_components;
+    rule->num_components = 0;
+
+    json_object* components;
+    if (!json_object_object_get_ex(theorem, "components", &components) ||
+        !json_object_is_type(components, json_type_array)) {
+        return 0;
+    }
+
+    size_t count = json_object_array_length(components);
+    for (size_t i = 0; i < count; i++) {
+        json_object* component = json_object_array_get_idx(components, i);
+        if (!json_object_is_type(component, json_type_string) ||
+            json_object_get_string_len(component) == 0) {
+            continue;
+        }
+
+        long offset = pool_append(domain, pool_capacity, json_object_get_string(component),
+                                  (size_t)json_object_get_string_len(component));
+        agency_theorem_keyword* entry = offset < 0 ? NULL :
+            keyword_append(&domain->components, &domain->num_components, component_capacity);
+        if (entry == NULL) {
+            return -1;
+        }
+        entry->offset = (uint32_t)offset;
+        entry->length = (uint32_t)json_object_get_string_len(component);
+        rule->num_components++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Compile one theorem into a rule, its keywords and its components.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int compile_theorem(agency_theorem_domain* domain, json_object* theorem,
+                           size_t* pool_capacity, size_t* keyword_capacity,
+                           size_t* component_capacity) {
+    json_object* field;
+    const char* name = "unknown";
+    const char* statement = "";
+    if (json_object_object_get_ex(theorem, "name", &field) &&
+        json_object_is_type(field, json_type_string)) {
+        name = json_object_get_string(field);
+    }
+    if (json_object_object_get_ex(theorem, "statement", &field) &&
+        json_object_is_type(field, json_type_string)) {
+        statement = json_object_get_string(field);
+    }
+
+    agency_theorem_rule* rule = &domain->rules[domain->num_rules];
+    long name_offset = pool_append(domain, pool_capacity, name, strlen(name));
+    if (name_offset < 0) {
+        return -1;
+    }
+    rule->name_offset = (uint32_t)name_offset;
+    rule->first_keyword = (uint32_t)domain->num_keywords;
+    rule->num_keywords = 0;
+
+    const char* p = statement;
+    while (*p != '\0') {
+        while (*p != '\0' && is_split_space((unsigned char)*p)) {
+            p++;
+        }
+        const char* word = p;
+        while (*p != '\0' && !is_split_space((unsigned char)*p)) {
+            p++;
+        }
+        size_t length = (size_t)(p - word);
+        if (count_code_points(word, length) <= THEOREM_MIN_KEYWORD_CHARS) {
+            continue;
+        }
+
+        long offset = pool_append(domain, pool_capacity, word, length);
+        if (offset < 0) {
+            return -1;
+        }
+        for (size_t i = 0; i < length; i++) {
+            domain->pool[offset + i] = (char)tolower((unsigned char)domain->pool[offset + i]);
+        }
+
+        agency_theorem_keyword* keyword =
+            keyword_append(&domain->keywords, &domain->num_keywords, keyword_capacity);
+        if (keyword == NULL) {
+            return -1;
+        }
+        keyword->offset = (uint32_t)offset;
+        keyword->length = (uint32_t)length;
+        rule->num_keywords++;
+        if (length > domain->max_keyword_length) {
+            domain->max_keyword_length = length;
+        }
+    }
+
+    if (compile_components(domain, rule, theorem, pool_capacity, component_capacity) != 0) {
+        return -1;
+    }
+
+    domain->num_rules++;
+    return 0;
+}
+
+/**
+ * @brief Compile one domain's theorem model file.
+ *
+ * @return 0 on success or if the file is unusable (it is skipped, as the
+ *         Python loader does), -1 on allocation failure.
+ */
+static int compile_domain_file(agency_theorem_set* set, const char* file_name, size_t domain_len) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", THEOREM_MODELS_DIR, file_name);
+
+    json_object* theorems = json_object_from_file(path);
+    if (theorems == NULL || !json_object_is_type(theorems, json_type_array)) {
+        fprintf(stderr, "Error loading theorem model: %s\n", path);
+        if (theorems != NULL) {
+            json_object_put(theorems);
+        }
+        return 0;
+    }
+
+    agency_theorem_domain* domains = (agency_theorem_domain*)agency_realloc(
+        set->domains, (set->num_domains + 1) * sizeof(agency_theorem_domain));
+    if (domains == NULL) {
+        json_object_put(theorems);
+        return -1;
+    }
+    set->domains = domains;
+
+    agency_theorem_domain* domain = &set->domains[set->num_domains];
+    memset(domain, 0, sizeof(*domain));
+    domain->name = agency_strndup(file_name, domain_len);
+    size_t num_theorems = json_object_array_length(theorems);
+    domain->rules = (agency_theorem_rule*)agency_calloc(num_theorems + 1, sizeof(agency_theorem_rule));
+    if (domain->name == NULL || domain->rules == NULL) {
+        agency_free(domain->name);
+        agency_free(domain->rules);
+        json_object_put(theorems);
+        return -1;
+    }
+    set->num_domains++;
+
+    size_t pool_capacity = 0;
+    size_t keyword_capacity = 0;
+    size_t component_capacity = 0;
+    int status = 0;
+    for (size_t i = 0; i < num_theorems && status == 0; i++) {
+        status = compile_theorem(domain, json_object_array_get_idx(theorems, i),
+                                 &pool_capacity, &keyword_capacity, &component_capacity);
+    }
+    set->bytes += sizeof(agency_theorem_domain) + domain_len + 1 + pool_capacity +
+                  (keyword_capacity + component_capacity) * sizeof(agency_theorem_keyword) +
+                  (num_theorems + 1) * sizeof(agency_theorem_rule);
+
+    json_object_put(theorems);
+    return status;
+}
+
+/**
+ * @brief Free a compiled theorem set.
+ */
+static void theorem_set_free(agency_theorem_set* set) {
+    if (set == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < set->num_domains; i++) {
+        agency_free(set->domains[i].name);
+        agency_free(set->domains[i].pool);
+        agency_free(set->domains[i].keywords);
+        agency_free(set->domains[i].components);
+        agency_free(set->domains[i].rules);
+    }
+    agency_free(set->domains);
+    agency_free(set);
+}
+
+/**
+ * @brief Copy a theorem set into a sealed pack on the node of a replica.
+ *
+ * @return The copy, or NULL on allocation failure.
+ */
+static const agency_theorem_set* theorem_set_pack(const agency_theorem_set* set, unsigned replica) {
+    size_t size = agency_pack_size(sizeof(*set)) + agency_pack_size(set->num_domains * sizeof(*set->domains));
+    for (size_t i = 0; i < set->num_domains; i++) {
+        const agency_theorem_domain* domain = &set->domains[i];
+        size += agency_pack_size(strlen(domain->name) + 1) + agency_pack_size(domain->pool_size) +
+                agency_pack_size(domain->num_keywords * sizeof(agency_theorem_keyword)) +
+                agency_pack_size(domain->num_components * sizeof(agency_theorem_keyword)) +
+                agency_pack_size(domain->num_rules * sizeof(agency_theorem_rule));
+    }
+
+    agency_pack pack;
+    if (agency_pack_begin(&pack, size, replica) != 0) {
+        return NULL;
+    }
+    agency_theorem_set* copy = (agency_theorem_set*)agency_pack_copy(&pack, set, sizeof(*set));
+    copy->domains = (agency_theorem_domain*)agency_pack_copy(&pack, set->domains,
+                                                             set->num_domains * sizeof(*set->domains));
+    for (size_t i = 0; i < set->num_domains; i++) {
+        const agency_theorem_domain* domain = &set->domains[i];
+        agency_theorem_domain* domain_copy = &copy->domains[i];
+        domain_copy->name = (char*)agency_pack_copy(&pack, domain->name, strlen(domain->name) + 1);
+        domain_copy->pool = (char*)agency_pack_copy(&pack, domain->pool, domain->pool_size);
+        domain_copy->keywords = (agency_theorem_keyword*)agency_pack_copy(
+            &pack, domain->keywords, domain->num_keywords * sizeof(agency_theorem_keyword));
+        domain_copy->components = (agency_theorem_keyword*)agency_pack_copy(
+            &pack, domain->components, domain->num_components * sizeof(agency_theorem_keyword));
+        domain_copy->rules = (agency_theorem_rule*)agency_pack_copy(
+            &pack, domain->rules, domain->num_rules * sizeof(agency_theorem_rule));
+    }
+    copy->bytes = pack.size;
+    agency_pack_seal(&pack);
+
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, (int64_t)pack.size, 0);
+    return copy;
+}
+
+/**
+ * @brief Compile every theorem model in THEOREM_MODELS_DIR. Runs exactly once.
+ */
+static void compile_theorems(void) {
+    static const char suffix[] = "_theorems.json";
+    const size_t suffix_len = sizeof(suffix) - 1;
+
+    agency_theorem_set* set = (agency_theorem_set*)agency_calloc(1, sizeof(agency_theorem_set));
+    if (set == NULL) {
+        fprintf(stderr, "Error allocating theorem set\n");
+        return;
+    }
+
+    DIR* dir = opendir(THEOREM_MODELS_DIR);
+    if (dir == NULL) {
+        fprintf(stderr, "Error opening theorem models directory: %s\n", THEOREM_MODELS_DIR);
+        g_theorems = set;
+        return;
+    }
+
+    int status = 0;
+    struct dirent* dirent;
+    while (status == 0 && (dirent = readdir(dir)) != NULL) {
+        size_t len = strlen(dirent->d_name);
+        if (len > suffix_len && strcmp(dirent->d_name + len - suffix_len, suffix) == 0) {
+            status = compile_domain_file(set, dirent->d_name, len - suffix_len);
+        }
+    }
+    closedir(dir);
+
+    if (status != 0) {
+        fprintf(stderr, "Error compiling theorem models\n");
+        theorem_set_free(set);
+        return;
+    }
+
+    set->bytes += sizeof(agency_theorem_set);
+    for (size_t i = 0; i < set->num_domains; i++) {
+        agency_memory_charge(AGENCY_MEMORY_INDEXES, 0, (int64_t)set->domains[i].num_rules);
+    }
+    agency_memory_charge(AGENCY_MEMORY_INDEXES, (int64_t)set->bytes, 0);
+
+    // In huge pages the set is packed, as its NUMA copies are
+    const agency_theorem_set* packed = agency_huge_pages_on() ? theorem_set_pack(set, 0) : NULL;
+    if (packed != NULL) {
+        agency_memory_charge(AGENCY_MEMORY_INDEXES, -(int64_t)set->bytes, 0);
+        theorem_set_free(set);
+        g_theorems = packed;
+    } else {
+        g_theorems = set;
+    }
+    agency_generation_bump();
+}
+
+const agency_theorem_set* agency_load_theorems(void) {
+    pthread_once(&g_theorems_once, compile_theorems);
+    unsigned replica = agency_numa_replica();
+    return replica != 0 ? agency_theorems_replica(replica) : g_theorems;
+}
+
+const agency_theorem_set* agency_theorems_replica(unsigned replica) {
+    const agency_theorem_set* copy = replica != 0 ? atomic_load(&g_theorem_replicas[replica]) : NULL;
+    return copy != NULL ? copy : g_theorems;
+}
+
+void agency_theorems_replicate(unsigned replicas) {
+    pthread_once(&g_theorems_once, compile_theorems);
+    if (g_theorems == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_replicate_lock);
+    for (unsigned r = 1; r < replicas && r < AGENCY_NUMA_MAX_REPLICAS; r++) {
+        if (atomic_load(&g_theorem_replicas[r]) == NULL) {
+            atomic_store(&g_theorem_replicas[r], theorem_set_pack(g_theorems, r));
+        }
+    }
+    pthread_mutex_unlock(&g_replicate_lock);
+}
+
+const agency_theorem_domain* agency_theorems_for_domain(const char* domain) {
+    const agency_theorem_set* set = agency_load_theorems();
+    if (set == NULL || domain == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < set->num_domains; i++) {
+        if (strcmp(set->domains[i].name, domain) == 0) {
+            return &set->domains[i];
+        }
+    }
+
+    return NULL;
+}
+
+int agency_theorem_keyword_found(const agency_theorem_domain* domain, uint32_t keyword,
+                                 const char* text, size_t length) {
+    const agency_theorem_keyword* entry = &domain->keywords[keyword];
+    return memmem(text, length, domain->pool + entry->offset, entry->length) != NULL;
+}
+
+int agency_theorem_holds(const agency_theorem_domain* domain, size_t rule_index,
+                         const char* text, size_t length) {
+    const agency_theorem_rule* rule = &domain->rules[rule_index];
+
+    for (uint32_t i = 0; i < rule->num_keywords; i++) {
+        if (!agency_theorem_keyword_found(domain, rule->first_keyword + i, text, length)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Search one segment of the description for one keyword.
+ */
+static void search_segment(void* context, size_t item) {
+    keyword_search* search = (keyword_search*)context;
+    uint32_t keyword = (uint32_t)(item / search->num_segments);
+    if (atomic_load_explicit(&search->found[keyword], memory_order_relaxed)) {
+        return;
+    }
+
+    // Segments overlap so that a keyword across a boundary is seen whole
+    size_t start = (item % search->num_segments) * THEOREM_SEGMENT_BYTES;
+    size_t end = start + THEOREM_SEGMENT_BYTES + search->domain->max_keyword_length - 1;
+    if (end > search->length) {
+        end = search->length;
+    }
+    if (agency_theorem_keyword_found(search->domain, keyword, search->text + start, end - start)) {
+        atomic_store_explicit(&search->found[keyword], 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Apply a domain's theorems by searching for all keywords on the pool.
+ *
+ * @return 1 if every theorem holds, 0 if any fails, -1 on allocation failure.
+ */
+static int verify_parallel(const agency_theorem_domain* domain, const char* text, size_t length) {
+    keyword_search search;
+    search.domain = domain;
+    search.text = text;
+    search.length = length;
+    search.num_segments = (length + THEOREM_SEGMENT_BYTES - 1) / THEOREM_SEGMENT_BYTES;
+    search.found = (atomic_uchar*)agency_calloc(domain->num_keywords, sizeof(atomic_uchar));
+    if (search.found == NULL) {
+        return -1;
+    }
+
+    agency_pool_run(domain->num_keywords * search.num_segments, search_segment, &search);
+    atomic_fetch_add_explicit(&g_parallel_verifications, 1, memory_order_relaxed);
+
+    int verdict = 1;
+    for (size_t i = 0; i < domain->num_keywords && verdict; i++) {
+        verdict = atomic_load_explicit(&search.found[i], memory_order_relaxed);
+    }
+    agency_free(search.found);
+    return verdict;
+}
+
+int agency_theorems_verify(const agency_theorem_domain* domain, const char* text, size_t length) {
+    // No theorems for the domain means the issue cannot be verified
+    if (domain == NULL || domain->num_rules == 0) {
+        return 0;
+    }
+
+    // A theorem holds when all its keywords occur, so the keywords can be searched in any order
+    size_t cutoff = atomic_load_explicit(&g_parallel_cutoff, memory_order_relaxed);
+    if (domain->num_keywords > 0 && length >= cutoff / domain->num_keywords &&
+        agency_pool_threads() > 1) {
+        int verdict = verify_parallel(domain, text, length);
+        if (verdict >= 0) {
+            return verdict;
+        }
+    }
+
+    for (size_t i = 0; i < domain->num_rules; i++) {
+        if (!agency_theorem_holds(domain, i, text, length)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void agency_set_theorem_parallelism(size_t num_threads, size_t cutoff) {
+    atomic_store(&g_parallel_cutoff, cutoff != 0 ? cutoff : AGENCY_THEOREM_CUTOFF_DEFAULT);
+    agency_pool_set_threads(num_threads);
+}
+
+void agency_get_theorem_pool_stats(agency_theorem_pool_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->threads = agency_pool_threads();
+    stats->cutoff = atomic_load(&g_parallel_cutoff);
+    stats->parallel_verifications = atomic_load(&g_parallel_verifications);
+    agency_pool_get_stats(&stats->items, &stats->steals);
+}
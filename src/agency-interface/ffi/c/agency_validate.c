@@ -0,0 +1,761 @@
+/**
+ * @file agency_validate.c
+ * @brief Streaming verification of issue JSON without building a tree.
+ *
+ * The issue is walked once, left to right, over the structural index built
+ * by agency_scan.c, so whitespace and skipped string contents are never read
+ * byte by byte. Only the top-level keys are examined: the value of each
+ * field the agency's compiled schema declares is checked in place as it is
+ * skipped, every other value is skipped by structure alone, and nothing is
+ * allocated per node. The only copy made is
+ * the lowercased, unescaped description, written into a per-thread scratch
+ * buffer that is reused across calls, and only when the agency's domain has
+ * theorems to apply.
+ *
+ * The whole document is scanned, as json.loads would parse it: a syntax
+ * error anywhere, or anything after the top-level value, makes the issue
+ * malformed even once a field has failed. A repeated top-level key is
+ * checked again and its last value decides, replacing the earlier rule in
+ * a trace.
+ *
+ * agency_verify_json_traced() runs the same pass and also records the
+ * outcome and time of each rule for verification reports. Both entry points
+ * inline one implementation, so untraced verification pays nothing for it.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "agency_internal.h"
+
+// Nesting limit, matching json-c's default tokener depth
+#define VALIDATE_MAX_DEPTH 32
+
+// Longest escaped form of a schema name (each character as \\uXXXX)
+#define VALIDATE_RAW_NAME_MAX (AGENCY_SCHEMA_NAME_MAX * 6)
+
+// Returned by the skip functions for malformed input
+#define SKIP_ERROR SIZE_MAX
+
+/**
+ * @brief Per-thread buffer receiving the decoded description.
+ */
+typedef struct {
+    char* data;
+    size_t capacity;
+} scratch_buffer;
+
+static pthread_key_t g_scratch_key;
+static pthread_once_t g_scratch_key_once = PTHREAD_ONCE_INIT;
+
+static void scratch_destroy(void* ptr) {
+    scratch_buffer* scratch = (scratch_buffer*)ptr;
+    agency_memory_charge(AGENCY_MEMORY_ARENAS, -(int64_t)(sizeof(scratch_buffer) + scratch->capacity), -1);
+    agency_free(scratch->data);
+    agency_free(scratch);
+}
+
+static void scratch_key_create(void) {
+    pthread_key_create(&g_scratch_key, scratch_destroy);
+}
+
+char* agency_scratch(size_t size) {
+    pthread_once(&g_scratch_key_once, scratch_key_create);
+
+    scratch_buffer* scratch = (scratch_buffer*)pthread_getspecific(g_scratch_key);
+    if (scratch == NULL) {
+        scratch = (scratch_buffer*)agency_calloc(1, sizeof(scratch_buffer));
+        if (scratch == NULL) {
+            return NULL;
+        }
+        if (pthread_setspecific(g_scratch_key, scratch) != 0) {
+            agency_free(scratch);
+            return NULL;
+        }
+        agency_memory_charge(AGENCY_MEMORY_ARENAS, (int64_t)sizeof(scratch_buffer), 1);
+    }
+
+    // Over the arenas' ceiling, a buffer grown by a large call shrinks back to this one's size
+    size_t capacity = scratch->capacity;
+    if (size > capacity || (capacity > 4096 && agency_memory_over_limit(AGENCY_MEMORY_ARENAS))) {
+        capacity = 4096;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+    }
+    if (capacity != scratch->capacity) {
+        char* data = (char*)agency_realloc(scratch->data, capacity);
+        if (data == NULL) {
+            return size <= scratch->capacity ? scratch->data : NULL;
+        }
+        if (capacity < scratch->capacity) {
+            agency_memory_evicted(AGENCY_MEMORY_ARENAS, 1);
+        }
+        agency_memory_charge(AGENCY_MEMORY_ARENAS, (int64_t)capacity - (int64_t)scratch->capacity, 0);
+        scratch->data = data;
+        scratch->capacity = capacity;
+    }
+
+    return scratch->data;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief Read the four hex digits of a \\u escape.
+ *
+ * @return The code unit, or -1 if the digits are malformed.
+ */
+static long read_hex4(const char* p, const char* end) {
+    if (end - p < 4) {
+        return -1;
+    }
+
+    long value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hex_value(p[i]);
+        if (digit < 0) {
+            return -1;
+        }
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+/**
+ * @brief Append a code point as UTF-8.
+ */
+static char* put_utf8(char* out, unsigned long cp) {
+    if (cp < 0x80) {
+        *out++ = (char)cp;
+    } else if (cp < 0x800) {
+        *out++ = (char)(0xC0 | (cp >> 6));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = (char)(0xE0 | (cp >> 12));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = (char)(0xF0 | (cp >> 18));
+        *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+size_t agency_json_decode_string(const char* start, const char* end, int fold_case, char* out) {
+    char* o = out;
+    const char* p = start;
+
+    while (p < end) {
+        char c = *p++;
+        if (c != '\\') {
+            *o++ = (fold_case && c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+            continue;
+        }
+
+        c = *p++;
+        switch (c) {
+        case 'b': *o++ = '\b'; break;
+        case 'f': *o++ = '\f'; break;
+        case 'n': *o++ = '\n'; break;
+        case 'r': *o++ = '\r'; break;
+        case 't': *o++ = '\t'; break;
+        case 'u': {
+            unsigned long cp = (unsigned long)read_hex4(p, end);
+            p += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                long low = read_hex4(p + 2, end);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + ((unsigned long)low - 0xDC00);
+                    p += 6;
+                }
+            }
+            if (cp >= 0xD800 && cp <= 0xDFFF) {
+                cp = 0xFFFD;  // unpaired surrogate
+            }
+            if (fold_case && cp >= 'A' && cp <= 'Z') {
+                cp += 'a' - 'A';
+            }
+            o = put_utf8(o, cp);
+            break;
+        }
+        default:
+            *o++ = c;  // '"', '\\' and '/'
+            break;
+        }
+    }
+
+    return (size_t)(o - out);
+}
+
+/**
+ * @brief Skip a number, true, false or null.
+ *
+ * @return The position after the literal, or NULL if it is malformed.
+ */
+static const char* skip_literal(const char* p, const char* end) {
+    static const char* const words[] = {"true", "false", "null"};
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        size_t length = strlen(words[i]);
+        if ((size_t)(end - p) >= length && memcmp(p, words[i], length) == 0) {
+            return p + length;
+        }
+    }
+
+    // -?digits(.digits)?([eE][+-]?digits)?
+    const char* q = p;
+    if (q < end && *q == '-') {
+        q++;
+    }
+    const char* digits = q;
+    while (q < end && *q >= '0' && *q <= '9') {
+        q++;
+    }
+    if (q == digits) {
+        return NULL;
+    }
+    if (q < end && *q == '.') {
+        digits = ++q;
+        while (q < end && *q >= '0' && *q <= '9') {
+            q++;
+        }
+        if (q == digits) {
+            return NULL;
+        }
+    }
+    if (q < end && (*q == 'e' || *q == 'E')) {
+        q++;
+        if (q < end && (*q == '+' || *q == '-')) {
+            q++;
+        }
+        digits = q;
+        while (q < end && *q >= '0' && *q <= '9') {
+            q++;
+        }
+        if (q == digits) {
+            return NULL;
+        }
+    }
+    return q;
+}
+
+/**
+ * @brief Check that a scalar ends where its run of non-structural bytes does.
+ *
+ * @param start Offset of the scalar's first byte.
+ * @return The offset after the scalar, or SKIP_ERROR if it is malformed.
+ */
+static size_t skip_scalar(const char* json, size_t length, size_t start) {
+    const char* end = json + length;
+    const char* q = skip_literal(json + start, end);
+    if (q == NULL || (q < end && memchr(" \t\n\r{}[]:,\"", *q, 11) == NULL)) {
+        return SKIP_ERROR;
+    }
+    return (size_t)(q - json);
+}
+
+/**
+ * @brief Skip the rest of a string whose opening quote was the last token.
+ *
+ * @return The offset after the closing quote, or SKIP_ERROR if there is none.
+ */
+static size_t skip_string(agency_scanner* scanner) {
+    size_t quote = agency_scanner_next(scanner);
+    return quote < scanner->length ? quote + 1 : SKIP_ERROR;
+}
+
+/**
+ * @brief What skip_value() accepts next.
+ */
+typedef enum {
+    EXPECT_VALUE,
+    EXPECT_VALUE_OR_CLOSE,
+    EXPECT_KEY_OR_CLOSE,
+    EXPECT_COLON,
+    EXPECT_COMMA_OR_CLOSE
+} skip_state;
+
+/**
+ * @brief Skip one value, checking its syntax without decoding anything.
+ *
+ * Only tokens are visited; string contents and whitespace are never read.
+ *
+ * @param first Offset of the value's first token, already taken.
+ * @param depth Nesting depth of the value's container.
+ * @param items If not NULL, receives the number of elements or members when
+ *        the value is an array or object.
+ * @return The offset after the value, or SKIP_ERROR if it is malformed.
+ */
+static size_t skip_value(agency_scanner* scanner, size_t first, int depth, size_t* items) {
+    const char* json = scanner->data;
+    size_t length = scanner->length;
+    char stack[VALIDATE_MAX_DEPTH];
+    int top = 0;
+    size_t count = 0;
+    skip_state expect = EXPECT_VALUE;
+    size_t token = first;
+
+    for (;;) {
+        if (token >= length) {
+            return SKIP_ERROR;
+        }
+
+        char c = json[token];
+        size_t after = token + 1;
+        int closed_value = 0;
+        switch (expect) {
+        case EXPECT_VALUE:
+        case EXPECT_VALUE_OR_CLOSE:
+        case EXPECT_KEY_OR_CLOSE:
+            if ((expect == EXPECT_VALUE_OR_CLOSE || expect == EXPECT_KEY_OR_CLOSE) &&
+                c == stack[top - 1]) {
+                top--;
+                closed_value = 1;
+            } else if (c == '"') {
+                after = skip_string(scanner);
+                closed_value = expect == EXPECT_VALUE || expect == EXPECT_VALUE_OR_CLOSE;
+                expect = EXPECT_COLON;
+            } else if (expect == EXPECT_KEY_OR_CLOSE) {
+                return SKIP_ERROR;
+            } else if (c == '{' || c == '[') {
+                if (depth + top >= VALIDATE_MAX_DEPTH) {
+                    return SKIP_ERROR;
+                }
+                stack[top++] = (char)(c == '{' ? '}' : ']');
+                expect = c == '{' ? EXPECT_KEY_OR_CLOSE : EXPECT_VALUE_OR_CLOSE;
+            } else {
+                after = skip_scalar(json, length, token);
+                closed_value = 1;
+            }
+            break;
+        case EXPECT_COLON:
+            if (c != ':') {
+                return SKIP_ERROR;
+            }
+            expect = EXPECT_VALUE;
+            break;
+        case EXPECT_COMMA_OR_CLOSE:
+            if (c == ',') {
+                // json-c accepts a trailing comma before the closing bracket
+                expect = stack[top - 1] == '}' ? EXPECT_KEY_OR_CLOSE : EXPECT_VALUE_OR_CLOSE;
+            } else if (c == stack[top - 1]) {
+                top--;
+                closed_value = 1;
+            } else {
+                return SKIP_ERROR;
+            }
+            break;
+        }
+
+        if (after == SKIP_ERROR) {
+            return SKIP_ERROR;
+        }
+        if (closed_value) {
+            if (top == 0) {
+                if (items != NULL) {
+                    *items = count;
+                }
+                return after;
+            }
+            if (top == 1) {
+                count++;
+            }
+            expect = EXPECT_COMMA_OR_CLOSE;
+        }
+
+        token = agency_scanner_next(scanner);
+    }
+}
+
+int agency_json_check(const char* json, size_t length, size_t* error_offset) {
+    agency_scanner scanner;
+    agency_scanner_init(&scanner, json, length);
+
+    size_t token = agency_scanner_next(&scanner);
+    if (skip_value(&scanner, token, 0, NULL) != SKIP_ERROR &&
+        agency_scanner_next(&scanner) >= length) {
+        return 0;
+    }
+
+    if (error_offset != NULL) {
+        *error_offset = scanner.last;
+    }
+    return -1;
+}
+
+/**
+ * @brief Find the schema field named by a top-level key.
+ *
+ * @param start First byte of the key after its opening quote.
+ * @param end The key's closing quote.
+ * @return The field index, or -1 if the schema does not declare the key.
+ */
+static int find_field(const agency_schema* schema, const char* start, const char* end) {
+    char decoded[VALIDATE_RAW_NAME_MAX];
+    const char* name = start;
+    size_t length = (size_t)(end - start);
+
+    // Keys are rarely escaped; decode only when they are
+    if (memchr(start, '\\', length) != NULL) {
+        if (length > sizeof(decoded)) {
+            return -1;
+        }
+        length = agency_json_decode_string(start, end, 0, decoded);
+        name = decoded;
+    }
+    if (length > AGENCY_SCHEMA_NAME_MAX) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < schema->num_fields; i++) {
+        const agency_schema_string* field_name = &schema->fields[i].name;
+        if (field_name->length == length &&
+            memcmp(schema->pool + field_name->offset, name, length) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Classify a well-formed value by its first bytes.
+ */
+static uint32_t value_type(const char* start, const char* end) {
+    switch (*start) {
+    case '"': return AGENCY_JSON_STRING;
+    case '{': return AGENCY_JSON_OBJECT;
+    case '[': return AGENCY_JSON_ARRAY;
+    case 't':
+    case 'f': return AGENCY_JSON_BOOLEAN;
+    case 'n': return AGENCY_JSON_NULL;
+    default:
+        for (const char* p = start; p < end; p++) {
+            if (*p == '.' || *p == 'e' || *p == 'E') {
+                return AGENCY_JSON_FRACTION;
+            }
+        }
+        return AGENCY_JSON_INTEGER;
+    }
+}
+
+/**
+ * @brief Count the code points of a validated string body once decoded.
+ */
+static size_t string_code_points(const char* start, const char* end) {
+    size_t count = 0;
+    const char* p = start;
+
+    while (p < end) {
+        if (*p != '\\') {
+            count += ((unsigned char)*p & 0xC0) != 0x80;
+            p++;
+            continue;
+        }
+        if (p[1] != 'u') {
+            count++;
+            p += 2;
+            continue;
+        }
+
+        // A surrogate pair is one code point
+        long unit = read_hex4(p + 2, end);
+        p += 6;
+        if (unit >= 0xD800 && unit <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+            long low = read_hex4(p + 2, end);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                p += 6;
+            }
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Check whether a validated string body equals one of a field's enum values.
+ */
+static int string_in_enum(const agency_schema* schema, const agency_schema_field* field,
+                          const char* start, const char* end) {
+    char decoded[VALIDATE_RAW_NAME_MAX];
+    const char* text = start;
+    size_t length = (size_t)(end - start);
+
+    if (memchr(start, '\\', length) != NULL) {
+        if (length > sizeof(decoded)) {
+            return 0;
+        }
+        length = agency_json_decode_string(start, end, 0, decoded);
+        text = decoded;
+    }
+
+    for (uint32_t i = 0; i < field->num_enums; i++) {
+        const agency_schema_string* value = &schema->enums[field->first_enum + i];
+        if (value->length == length && memcmp(schema->pool + value->offset, text, length) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Apply a field's checks to its value.
+ *
+ * @param items Elements or members of the value, if it is a container.
+ * @return AGENCY_RULE_PASSED, or the check the value fails.
+ */
+static agency_rule_outcome check_field(const agency_schema* schema, const agency_schema_field* field,
+                                       const char* start, const char* end, size_t items) {
+    uint32_t type = value_type(start, end);
+    if (!(field->types & type)) {
+        return AGENCY_RULE_WRONG_TYPE;
+    }
+
+    if (type == AGENCY_JSON_STRING) {
+        if (field->min_length > 0 || field->max_length < UINT32_MAX) {
+            size_t length = string_code_points(start + 1, end - 1);
+            if (length < field->min_length || length > field->max_length) {
+                return AGENCY_RULE_BAD_LENGTH;
+            }
+        }
+        if (field->num_enums > 0 && !string_in_enum(schema, field, start + 1, end - 1)) {
+            return AGENCY_RULE_NOT_IN_ENUM;
+        }
+    } else if (type == AGENCY_JSON_ARRAY) {
+        if (items < field->min_items || items > field->max_items) {
+            return AGENCY_RULE_BAD_ITEMS;
+        }
+    }
+
+    return AGENCY_RULE_PASSED;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Note where the JSON stops being valid.
+ *
+ * @return -1, the verdict for malformed JSON.
+ */
+static int malformed(agency_verify_trace* trace, const agency_scanner* scanner) {
+    if (trace != NULL) {
+        trace->error_offset = scanner->last;
+    }
+    return -1;
+}
+
+/**
+ * @brief Append a rule to a trace.
+ */
+static void trace_rule(agency_verify_trace* trace, agency_rule_kind kind, agency_rule_outcome outcome,
+                       size_t index, uint32_t keyword, uint64_t ns) {
+    agency_rule_trace* rule = &trace->rules[trace->num_rules++];
+    rule->kind = (uint16_t)kind;
+    rule->outcome = (uint16_t)outcome;
+    rule->index = (uint32_t)index;
+    rule->keyword = keyword;
+    rule->ns = ns;
+}
+
+/**
+ * @brief Evaluate and time every theorem, recording each in the trace.
+ *
+ * @return 1 if every theorem holds, 0 otherwise.
+ */
+static int trace_theorems(const agency_theorem_domain* theorems, const char* text, size_t length,
+                          agency_verify_trace* trace) {
+    int verdict = 1;
+
+    for (size_t i = 0; i < theorems->num_rules; i++) {
+        const agency_theorem_rule* rule = &theorems->rules[i];
+        uint64_t start = monotonic_ns();
+        uint32_t missing = UINT32_MAX;
+        for (uint32_t k = 0; k < rule->num_keywords && missing == UINT32_MAX; k++) {
+            if (!agency_theorem_keyword_found(theorems, rule->first_keyword + k, text, length)) {
+                missing = rule->first_keyword + k;
+            }
+        }
+        trace_rule(trace, AGENCY_RULE_THEOREM,
+                   missing == UINT32_MAX ? AGENCY_RULE_PASSED : AGENCY_RULE_KEYWORD_MISSING, i,
+                   missing, monotonic_ns() - start);
+        verdict &= missing == UINT32_MAX;
+    }
+
+    return verdict;
+}
+
+/**
+ * @brief Verify issue JSON, recording each rule in @p trace unless it is NULL.
+ *
+ * Inlined into both entry points, so the untraced one carries no tracing.
+ */
+static inline __attribute__((always_inline)) int verify_json(
+        const agency_schema* schema, const agency_theorem_domain* theorems, const char* json,
+        size_t length, agency_verify_trace* trace) {
+    int has_rules = theorems != NULL && theorems->num_rules > 0;
+
+    if (schema == NULL) {
+        return -1;
+    }
+
+    agency_scanner scanner;
+    agency_scanner_init(&scanner, json, length);
+
+    size_t token = agency_scanner_next(&scanner);
+    if (token >= length) {
+        return malformed(trace, &scanner);
+    }
+
+    // Any other well-formed value fails every schema
+    if (json[token] != '{') {
+        if (skip_value(&scanner, token, 0, NULL) == SKIP_ERROR || agency_scanner_next(&scanner) < length) {
+            return malformed(trace, &scanner);
+        }
+        return 0;
+    }
+
+    // As with json-c, a repeated key's last value is the one checked
+    uint64_t seen = 0;
+    uint64_t failed = 0;
+    uint8_t traced[AGENCY_SCHEMA_MAX_FIELDS];
+    const char* description = NULL;
+    const char* description_end = NULL;
+    int description_is_string = 1;
+
+    token = agency_scanner_next(&scanner);
+    int more = !(token < length && json[token] == '}');
+
+    while (more) {
+        uint64_t start = trace != NULL ? monotonic_ns() : 0;
+        if (token >= length || json[token] != '"') {
+            return malformed(trace, &scanner);
+        }
+        size_t key_end = skip_string(&scanner);
+        if (key_end == SKIP_ERROR) {
+            return malformed(trace, &scanner);
+        }
+        int index = find_field(schema, json + token + 1, json + key_end - 1);
+
+        token = agency_scanner_next(&scanner);
+        if (token >= length || json[token] != ':') {
+            return malformed(trace, &scanner);
+        }
+
+        const char* value = json + agency_scanner_next(&scanner);
+        size_t items = 0;
+        size_t value_end = skip_value(&scanner, (size_t)(value - json), 1, &items);
+        if (value_end == SKIP_ERROR) {
+            return malformed(trace, &scanner);
+        }
+
+        if (index >= 0) {
+            uint64_t bit = 1ULL << index;
+            agency_rule_outcome outcome =
+                check_field(schema, &schema->fields[index], value, json + value_end, items);
+            if (trace != NULL) {
+                // A repeated key replaces its earlier rule
+                size_t num_rules = trace->num_rules;
+                if (seen & bit) {
+                    trace->num_rules = traced[index];
+                }
+                traced[index] = (uint8_t)trace->num_rules;
+                trace_rule(trace, AGENCY_RULE_FIELD, outcome, (size_t)index, UINT32_MAX,
+                           monotonic_ns() - start);
+                if (seen & bit) {
+                    trace->num_rules = num_rules;
+                }
+            }
+            seen |= bit;
+            failed = outcome != AGENCY_RULE_PASSED ? failed | bit : failed & ~bit;
+            if (index == schema->description_field) {
+                description_is_string = *value == '"';
+                description = value;
+                description_end = json + value_end;
+            }
+        }
+
+        token = agency_scanner_next(&scanner);
+        if (token < length && json[token] == ',') {
+            token = agency_scanner_next(&scanner);
+            more = !(token < length && json[token] == '}');
+        } else if (token < length && json[token] == '}') {
+            more = 0;
+        } else {
+            return malformed(trace, &scanner);
+        }
+    }
+    if (agency_scanner_next(&scanner) < length) {
+        return malformed(trace, &scanner);
+    }
+
+    if (failed != 0) {
+        return 0;
+    }
+    if ((seen & schema->required) != schema->required) {
+        if (trace != NULL) {
+            for (size_t i = 0; i < schema->num_fields; i++) {
+                if ((schema->required & ~seen) & (1ULL << i)) {
+                    trace_rule(trace, AGENCY_RULE_FIELD, AGENCY_RULE_MISSING, i, UINT32_MAX, 0);
+                }
+            }
+        }
+        return 0;
+    }
+
+    // No theorems for the domain means the issue cannot be verified
+    if (!has_rules) {
+        return 0;
+    }
+    if (!description_is_string) {
+        // prover_integration.py raises on description.lower() here
+        return -1;
+    }
+
+    // prover_integration.py reads a missing description as ""
+    const char* text = "";
+    size_t text_length = 0;
+    if (description != NULL) {
+        char* decoded = agency_scratch((size_t)(description_end - description));
+        if (decoded == NULL) {
+            return -1;
+        }
+        text_length = agency_json_decode_string(description + 1, description_end - 1, 1, decoded);
+        text = decoded;
+    }
+
+    if (trace != NULL) {
+        return trace_theorems(theorems, text, text_length, trace);
+    }
+    return agency_theorems_verify(theorems, text, text_length);
+}
+
+int agency_verify_json(const agency_schema* schema, const agency_theorem_domain* theorems,
+                       const char* json, size_t length) {
+    return verify_json(schema, theorems, json, length, NULL);
+}
+
+int agency_verify_json_traced(const agency_schema* schema, const agency_theorem_domain* theorems,
+                              const char* json, size_t length, agency_verify_trace* trace) {
+    trace->num_rules = 0;
+    trace->error_offset = SIZE_MAX;
+    return verify_json(schema, theorems, json, length, trace);
+}
@@ -0,0 +1,263 @@
+/**
+ * @file agency_verdict_cache.c
+ * @brief Content-addressed cache of issue verdicts.
+ *
+ * A verdict is keyed by the agency, the generation of the loaded
+ * configuration and theorem models, and the hash of the issue's canonical
+ * text: the JSON with the whitespace between tokens removed. Canonicalizing
+ * takes one structural scan and no parsing, so a resubmitted issue costs a
+ * scan and two hashes instead of a full verification.
+ *
+ * The cache is a fixed set-associative table. Each entry holds two
+ * independent 64-bit hashes of the key, the second one carrying the
+ * verdict, and is read and written without locks: a reader only accepts an
+ * entry whose two halves both match its own key, so a half-written entry
+ * reads as a miss. A new generation empties the table on the next lookup.
+ *
+ * A memory ceiling shrinks the table to the largest power-of-two number of
+ * sets that fits under it. Lookups mask the key with the sets in use, so
+ * verdicts in sets beyond them are dropped and their pages given back.
+ */
+
+#define _GNU_SOURCE  // madvise
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "agency_internal.h"
+
+// Entries per set; a set fills one 64-byte cache line
+#define VERDICT_CACHE_WAYS 4
+
+// Sets in the table (a power of two), for 64Ki verdicts in 1 MiB
+#define VERDICT_CACHE_SETS 16384
+
+// Fewest sets a memory ceiling shrinks the table to: one 4 KiB page
+#define VERDICT_CACHE_MIN_SETS 64
+
+// Seed distinguishing the second key hash from the first
+#define VERDICT_CHECK_SEED 0x9E3779B97F4A7C15ULL
+
+// Low bits of the check word holding the verdict, as verdict + 2
+#define VERDICT_BITS 3ULL
+
+/**
+ * @brief One cached verdict.
+ */
+typedef struct {
+    _Atomic(uint64_t) key;    // first hash, 0 when the entry is empty
+    _Atomic(uint64_t) check;  // second hash, verdict in the low bits
+} verdict_entry;
+
+typedef struct {
+    verdict_entry ways[VERDICT_CACHE_WAYS];
+} __attribute__((aligned(64))) verdict_set;
+
+static verdict_set g_sets[VERDICT_CACHE_SETS] __attribute__((aligned(4096)));
+
+// Sets in use minus one, fewer than VERDICT_CACHE_SETS under a memory ceiling
+static _Atomic(size_t) g_set_mask = VERDICT_CACHE_SETS - 1;
+
+// Generation the table's entries were computed under
+static _Atomic(uint64_t) g_cache_generation = 0;
+static atomic_int g_cache_dirty = 0;
+static pthread_mutex_t g_clear_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static _Atomic(uint64_t) g_hits = 0;
+static _Atomic(uint64_t) g_misses = 0;
+static _Atomic(uint64_t) g_evictions = 0;
+static _Atomic(uint64_t) g_invalidations = 0;
+
+/**
+ * @brief Empty the sets in [@p first, @p end).
+ *
+ * Only occupied entries are written, so pages never filled stay untouched.
+ *
+ * @return The number of verdicts dropped.
+ */
+static uint64_t clear_sets(size_t first, size_t end) {
+    uint64_t cleared = 0;
+    for (size_t i = first; i < end; i++) {
+        for (int way = 0; way < VERDICT_CACHE_WAYS; way++) {
+            _Atomic(uint64_t)* key = &g_sets[i].ways[way].key;
+            if (atomic_load_explicit(key, memory_order_relaxed) != 0 &&
+                atomic_exchange_explicit(key, 0, memory_order_relaxed) != 0) {
+                cleared++;
+            }
+        }
+    }
+    agency_memory_charge(AGENCY_MEMORY_VERIFICATION_CACHE, 0, -(int64_t)cleared);
+    return cleared;
+}
+
+/**
+ * @brief Empty the table if the configuration was reloaded or the theorems loaded.
+ */
+static void check_generation(void) {
+    uint64_t generation = agency_generation();
+    if (atomic_load_explicit(&g_cache_generation, memory_order_acquire) == generation) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_clear_lock);
+    if (atomic_load_explicit(&g_cache_generation, memory_order_relaxed) != generation) {
+        if (atomic_exchange(&g_cache_dirty, 0)) {
+            clear_sets(0, VERDICT_CACHE_SETS);
+            atomic_fetch_add(&g_invalidations, 1);
+        }
+        atomic_store_explicit(&g_cache_generation, generation, memory_order_release);
+    }
+    pthread_mutex_unlock(&g_clear_lock);
+}
+
+static int ends_scalar(char c) {
+    return memchr(" \t\n\r{}[]:,\"", c, 11) != NULL;
+}
+
+/**
+ * @brief Copy JSON text without the whitespace between tokens.
+ *
+ * Two adjacent scalars keep one space between them, so "tr ue" and "true"
+ * stay distinct. Malformed text canonicalizes too; it only has to map
+ * inputs with different verdicts to different text.
+ *
+ * @param out Receives at most @p length bytes.
+ * @return The canonical length.
+ */
+static size_t canonicalize(const char* json, size_t length, char* out) {
+    agency_scanner scanner;
+    agency_scanner_init(&scanner, json, length);
+    char* o = out;
+    int after_scalar = 0;
+
+    size_t token = agency_scanner_next(&scanner);
+    while (token < length) {
+        char c = json[token];
+        size_t end;
+        if (c == '"') {
+            size_t quote = agency_scanner_next(&scanner);
+            end = quote < length ? quote + 1 : length;
+            after_scalar = 0;
+        } else if (ends_scalar(c)) {
+            end = token + 1;
+            after_scalar = 0;
+        } else {
+            if (after_scalar) {
+                *o++ = ' ';
+            }
+            end = token + 1;
+            while (end < length && !ends_scalar(json[end])) {
+                end++;
+            }
+            after_scalar = 1;
+        }
+
+        memcpy(o, json + token, end - token);
+        o += end - token;
+        token = end < length ? agency_scanner_next(&scanner) : length;
+    }
+
+    return (size_t)(o - out);
+}
+
+uint64_t agency_verdict_scope(const char* agency) {
+    // The first load of the configuration or theorems moves the generation;
+    // without it, the first verdicts would be cached under a scope no later
+    // lookup derives
+    agency_load_config();
+    agency_load_theorems();
+    return agency_hash64(agency, strlen(agency), agency_generation());
+}
+
+int agency_verify_cached(uint64_t scope, const agency_schema* schema,
+                         const agency_theorem_domain* theorems, const char* json, size_t length) {
+    check_generation();
+
+    char* canonical = agency_scratch(length + 1);
+    if (canonical == NULL) {
+        return agency_verify_json(schema, theorems, json, length);
+    }
+    size_t canonical_length = canonicalize(json, length, canonical);
+
+    uint64_t key = agency_hash64(canonical, canonical_length, scope);
+    uint64_t check = agency_hash64(canonical, canonical_length, scope ^ VERDICT_CHECK_SEED);
+    key += key == 0;
+    check &= ~VERDICT_BITS;
+
+    verdict_set* set = &g_sets[key & atomic_load_explicit(&g_set_mask, memory_order_relaxed)];
+    for (int way = 0; way < VERDICT_CACHE_WAYS; way++) {
+        verdict_entry* entry = &set->ways[way];
+        if (atomic_load_explicit(&entry->key, memory_order_acquire) != key) {
+            continue;
+        }
+        uint64_t stored = atomic_load_explicit(&entry->check, memory_order_relaxed);
+        if ((stored & ~VERDICT_BITS) == check && (stored & VERDICT_BITS) != 0) {
+            atomic_fetch_add_explicit(&g_hits, 1, memory_order_relaxed);
+            return (int)(stored & VERDICT_BITS) - 2;
+        }
+    }
+    atomic_fetch_add_explicit(&g_misses, 1, memory_order_relaxed);
+
+    // The scratch buffer is free again; verification may reuse it
+    int verdict = agency_verify_json(schema, theorems, json, length);
+
+    // Fill an empty way, else replace one picked by the check hash
+    verdict_entry* victim = &set->ways[(check >> 2) % VERDICT_CACHE_WAYS];
+    for (int way = 0; way < VERDICT_CACHE_WAYS; way++) {
+        if (atomic_load_explicit(&set->ways[way].key, memory_order_relaxed) == 0) {
+            victim = &set->ways[way];
+            break;
+        }
+    }
+    if (atomic_exchange_explicit(&victim->key, 0, memory_order_relaxed) != 0) {
+        atomic_fetch_add_explicit(&g_evictions, 1, memory_order_relaxed);
+    } else {
+        agency_memory_charge(AGENCY_MEMORY_VERIFICATION_CACHE, 0, 1);
+    }
+    atomic_store_explicit(&victim->check, check | (uint64_t)(verdict + 2), memory_order_relaxed);
+    atomic_store_explicit(&victim->key, key, memory_order_release);
+    atomic_store_explicit(&g_cache_dirty, 1, memory_order_relaxed);
+
+    return verdict;
+}
+
+void agency_verdict_cache_clear(void) {
+    pthread_mutex_lock(&g_clear_lock);
+    clear_sets(0, VERDICT_CACHE_SETS);
+    atomic_store(&g_cache_dirty, 0);
+    pthread_mutex_unlock(&g_clear_lock);
+}
+
+void agency_get_verdict_cache_stats(agency_verdict_cache_stats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->capacity = (atomic_load(&g_set_mask) + 1) * VERDICT_CACHE_WAYS;
+    stats->hits = atomic_load(&g_hits);
+    stats->misses = atomic_load(&g_misses);
+    stats->evictions = atomic_load(&g_evictions);
+    stats->invalidations = atomic_load(&g_invalidations);
+}
+
+size_t agency_verdict_cache_bytes(void) {
+    return (atomic_load_explicit(&g_set_mask, memory_order_relaxed) + 1) * sizeof(verdict_set);
+}
+
+void agency_verdict_cache_limit(uint64_t bytes) {
+    size_t sets = VERDICT_CACHE_SETS;
+    while (bytes != 0 && sets > VERDICT_CACHE_MIN_SETS && (uint64_t)sets * sizeof(verdict_set) > bytes) {
+        sets /= 2;
+    }
+
+    pthread_mutex_lock(&g_clear_lock);
+    size_t in_use = atomic_load(&g_set_mask) + 1;
+    atomic_store(&g_set_mask, sets - 1);
+    if (sets < in_use) {
+        // A lookup that read the old mask may still fill a dropped set; it reads as empty later
+        agency_memory_evicted(AGENCY_MEMORY_VERIFICATION_CACHE, clear_sets(sets, in_use));
+        madvise(&g_sets[sets], (in_use - sets) * sizeof(verdict_set), MADV_DONTNEED);
+    }
+    pthread_mutex_unlock(&g_clear_lock);
+}
@@ -5,8 +5,12 @@ package agency
 // #include "../agency_ffi.h"
 import "C"
 import (
+	"bytes"
 	"encoding/json"
 	"errors"
+	"os"
+	"sync"
+	"time"
 	"unsafe"
 )
 
@@ -51,6 +55,51 @@ func GetContext(agency string) (map[string]interface{}, error) {
 	return context, nil
 }
 
+// GetContextIfModified returns the context JSON for an agency together with
+// its content hash. When knownHash matches the current hash, it returns
+// modified == false and no data.
+func GetContextIfModified(agency string, knownHash uint64) (data string, hash uint64, modified bool, err error) {
+	cAgency := C.CString(agency)
+	defer C.free(unsafe.Pointer(cAgency))
+
+	var contextPtr *C.char
+	var cHash C.uint64_t
+	status := C.agency_get_context_conditional(cAgency, C.uint64_t(knownHash), &contextPtr, &cHash)
+	return conditionalResult(status, contextPtr, C.size_t(0), cHash, "context")
+}
+
+// GetResourceIfModified returns a file-backed agency resource together with
+// its content hash. When knownHash matches the current hash, it returns
+// modified == false and no data.
+func GetResourceIfModified(agency string, kind ResourceKind, knownHash uint64) (data string, hash uint64, modified bool, err error) {
+	cAgency := C.CString(agency)
+	defer C.free(unsafe.Pointer(cAgency))
+
+	var dataPtr *C.char
+	var length C.size_t
+	var cHash C.uint64_t
+	status := C.agency_get_resource_conditional(cAgency, C.agency_resource_kind(kind), C.uint64_t(knownHash), &dataPtr, &length, &cHash)
+	return conditionalResult(status, dataPtr, length, cHash, "resource")
+}
+
+// conditionalResult converts the outcome of a conditional fetch.
+func conditionalResult(status C.int, dataPtr *C.char, length C.size_t, cHash C.uint64_t, what string) (string, uint64, bool, error) {
+	switch status {
+	case C.AGENCY_STATUS_OK:
+		defer C.agency_free_context(dataPtr)
+		if length == 0 {
+			return C.GoString(dataPtr), uint64(cHash), true, nil
+		}
+		return C.GoStringN(dataPtr, C.int(length)), uint64(cHash), true, nil
+	case C.AGENCY_STATUS_NOT_MODIFIED:
+		return "", uint64(cHash), false, nil
+	case C.AGENCY_STATUS_NOT_FOUND:
+		return "", 0, false, AgencyError{"No " + what + " found for agency"}
+	default:
+		return "", 0, false, AgencyError{"Failed to get " + what + " for agency"}
+	}
+}
+
 // GetIssueFinder returns the issue finder data for an agency.
 func GetIssueFinder(agency string) (string, error) {
 	cAgency := C.CString(agency)
@@ -174,6 +223,740 @@ func VerifyIssue(agency string, issue map[string]interface{}) (bool, error) {
 	}
 }
 
+// ResourceKind identifies a file-backed agency resource.
+type ResourceKind int
+
+// Resource kinds accepted by FetchAsync.
+const (
+	ResourceIssueFinder       ResourceKind = C.AGENCY_RESOURCE_ISSUE_FINDER
+	ResourceResearchConnector ResourceKind = C.AGENCY_RESOURCE_RESEARCH_CONNECTOR
+	ResourceAsciiArt          ResourceKind = C.AGENCY_RESOURCE_ASCII_ART
+)
+
+// Completion is the result of an asynchronous fetch.
+type Completion struct {
+	Ticket uint64
+	Data   string
+	Err    error
+}
+
+// FetchAsync submits an asynchronous fetch of an agency resource and returns
+// its ticket. The read happens on the library's I/O threads, so this call
+// never blocks the calling OS thread on the filesystem.
+func FetchAsync(agency string, kind ResourceKind) (uint64, error) {
+	cAgency := C.CString(agency)
+	defer C.free(unsafe.Pointer(cAgency))
+
+	ticket := C.agency_fetch_async(cAgency, C.agency_resource_kind(kind), nil, nil)
+	if ticket == 0 {
+		return 0, AgencyError{"Failed to submit asynchronous fetch"}
+	}
+
+	return uint64(ticket), nil
+}
+
+// completionSignal wakes goroutines waiting for asynchronous fetches. A
+// single goroutine parks on the library's completion eventfd in the
+// netpoller and closes ready each time the descriptor becomes readable, so
+// waiting never holds an OS thread inside the library.
+var completionSignal struct {
+	once  sync.Once
+	mu    sync.Mutex
+	ready chan struct{}
+	err   error
+}
+
+// startCompletionSignal starts the goroutine behind completionSignal.
+func startCompletionSignal() {
+	completionSignal.ready = make(chan struct{})
+	fd := C.agency_completion_fd()
+	if fd < 0 {
+		completionSignal.err = AgencyError{"Failed to create completion descriptor"}
+		close(completionSignal.ready)
+		return
+	}
+
+	// The descriptor is non-blocking, so reads park in the netpoller. The
+	// library owns it; the goroutine keeps the file, and so the descriptor,
+	// alive for good.
+	file := os.NewFile(uintptr(fd), "agency-completions")
+	go func() {
+		var counter [8]byte
+		for {
+			_, err := file.Read(counter[:])
+			completionSignal.mu.Lock()
+			close(completionSignal.ready)
+			if err != nil {
+				completionSignal.err = AgencyError{"Failed to wait for completions: " + err.Error()}
+				completionSignal.mu.Unlock()
+				return
+			}
+			completionSignal.ready = make(chan struct{})
+			completionSignal.mu.Unlock()
+		}
+	}()
+}
+
+// completionReady returns a channel closed once completions may have been
+// queued after the call.
+func completionReady() (<-chan struct{}, error) {
+	completionSignal.once.Do(startCompletionSignal)
+	completionSignal.mu.Lock()
+	defer completionSignal.mu.Unlock()
+	return completionSignal.ready, completionSignal.err
+}
+
+// pollCompletions collects up to max completions that are ready now.
+func pollCompletions(max int) ([]Completion, error) {
+	buf := make([]C.agency_completion, max)
+	n := C.agency_poll_completions(&buf[0], C.size_t(max), 0)
+	if n < 0 {
+		return nil, AgencyError{"Failed to poll completions"}
+	}
+
+	completions := make([]Completion, 0, int(n))
+	for _, c := range buf[:int(n)] {
+		completion := Completion{Ticket: uint64(c.ticket)}
+		switch c.status {
+		case C.AGENCY_STATUS_OK:
+			completion.Data = C.GoStringN(c.data, C.int(c.length))
+			C.agency_free_context(c.data)
+		case C.AGENCY_STATUS_NOT_FOUND:
+			completion.Err = AgencyError{"Resource not found for agency"}
+		default:
+			completion.Err = AgencyError{"Failed to read resource"}
+		}
+		completions = append(completions, completion)
+	}
+
+	return completions, nil
+}
+
+// PollCompletions collects up to max finished fetches. A zero timeout returns
+// immediately; a negative timeout waits until at least one is ready. Waiting
+// parks only the calling goroutine: the library is always polled without a
+// timeout.
+func PollCompletions(max int, timeout time.Duration) ([]Completion, error) {
+	if max <= 0 {
+		return nil, AgencyError{"max must be positive"}
+	}
+
+	var expired <-chan time.Time
+	if timeout > 0 {
+		timer := time.NewTimer(timeout)
+		defer timer.Stop()
+		expired = timer.C
+	}
+
+	for {
+		// Taken before polling, so a completion queued in between still ends the wait
+		var ready <-chan struct{}
+		if timeout != 0 {
+			var err error
+			if ready, err = completionReady(); err != nil {
+				return nil, err
+			}
+		}
+
+		completions, err := pollCompletions(max)
+		if err != nil || len(completions) > 0 || timeout == 0 {
+			return completions, err
+		}
+
+		select {
+		case <-ready:
+		case <-expired:
+			return completions, nil
+		}
+	}
+}
+
+// StreamResource reads an agency resource in chunks of at most chunkSize
+// bytes (0 selects the library default) and passes each chunk to fn in
+// order. The slice is only valid for the duration of the call. Streaming
+// stops at the first error returned by fn.
+func StreamResource(agency string, kind ResourceKind, chunkSize int, fn func([]byte) error) error {
+	cAgency := C.CString(agency)
+	defer C.free(unsafe.Pointer(cAgency))
+
+	stream := C.agency_stream_open(cAgency, C.agency_resource_kind(kind), C.size_t(chunkSize))
+	if stream == nil {
+		return AgencyError{"Failed to open resource stream for agency"}
+	}
+	defer C.agency_stream_close(stream)
+
+	for {
+		var chunk *C.char
+		var length C.size_t
+		switch C.agency_stream_next(stream, &chunk, &length) {
+		case 0:
+			return nil
+		case 1:
+			if err := fn(unsafe.Slice((*byte)(unsafe.Pointer(chunk)), int(length))); err != nil {
+				return err
+			}
+		default:
+			return AgencyError{"Failed to read resource stream"}
+		}
+	}
+}
+
+// StoreStats reports the size and hit rates of the compressed resource store.
+type StoreStats struct {
+	Resources       int
+	RawBytes        int
+	CompressedBytes int
+	ArenaBytes      int
+	HotHits         uint64
+	HotMisses       uint64
+	DecompressNs    uint64
+}
+
+// StorePreload loads every finder, connector and ASCII art resource into the
+// library's compressed in-memory store. Afterwards the getters no longer
+// touch the filesystem for those resources.
+func StorePreload() error {
+	if C.agency_store_preload() != C.AGENCY_STATUS_OK {
+		return AgencyError{"Failed to preload one or more resources"}
+	}
+	return nil
+}
+
+// GetCompressedResource returns a stored resource as an LZ4 block, suitable
+// for forwarding as-is, together with its decompressed length.
+func GetCompressedResource(agency string, kind ResourceKind) ([]byte, int, error) {
+	cAgency := C.CString(agency)
+	defer C.free(unsafe.Pointer(cAgency))
+
+	var data unsafe.Pointer
+	var compressedLength, rawLength C.size_t
+	status := C.agency_store_get_compressed(cAgency, C.agency_resource_kind(kind), &data, &compressedLength, &rawLength)
+	switch status {
+	case C.AGENCY_STATUS_OK:
+		return C.GoBytes(data, C.int(compressedLength)), int(rawLength), nil
+	case C.AGENCY_STATUS_NOT_FOUND:
+		return nil, 0, AgencyError{"Resource not found for agency"}
+	default:
+		return nil, 0, AgencyError{"Resource is not in the store"}
+	}
+}
+
+// GetStoreStats returns the compressed store's statistics.
+func GetStoreStats() StoreStats {
+	var stats C.agency_store_stats
+	C.agency_get_store_stats(&stats)
+
+	return StoreStats{
+		Resources:       int(stats.resources),
+		RawBytes:        int(stats.raw_bytes),
+		CompressedBytes: int(stats.compressed_bytes),
+		ArenaBytes:      int(stats.arena_bytes),
+		HotHits:         uint64(stats.hot_hits),
+		HotMisses:       uint64(stats.hot_misses),
+		DecompressNs:    uint64(stats.decompress_ns),
+	}
+}
+
+// VerifyBatch verifies NDJSON issues, one per line, on the library's worker
+// threads (threads <= 0 uses one per online CPU). It returns one verdict per
+// issue in input order: 1 valid, 0 invalid, -1 not verifiable.
+func VerifyBatch(agency string, ndjson []byte, threads int) ([]int8, error) {
+	cAgency := C.CString(agency)
+	defer C.free(unsafe.Pointer(cAgency))
+
+	if threads < 0 {
+		threads = 0
+	}
+
+	// Every issue occupies at least one line
+	verdicts := make([]int8, bytes.Count(ndjson, []byte{'\n'})+1)
+
+	var data *C.char
+	if len(ndjson) > 0 {
+		data = (*C.char)(unsafe.Pointer(&ndjson[0]))
+	}
+	var summary C.agency_batch_summary
+	status := C.agency_verify_batch(cAgency, data, C.size_t(len(ndjson)), C.size_t(threads),
+		(*C.int8_t)(unsafe.Pointer(&verdicts[0])), C.size_t(len(verdicts)), &summary)
+	if status != C.AGENCY_STATUS_OK {
+		return nil, AgencyError{"Error verifying issue batch"}
+	}
+
+	return verdicts[:summary.issues], nil
+}
+
+// TheoremMatch is a theorem with at least one component found in an issue.
+type TheoremMatch struct {
+	Domain     string   `json:"domain"`
+	Name       string   `json:"name"`
+	Components []string `json:"components"`
+}
+
+// TopicMatch is a configured domain topic found in an issue.
+type TopicMatch struct {
+	Domain string `json:"domain"`
+	Topic  string `json:"topic"`
+}
+
+// IssueMatches lists the theorems and topics an issue touches.
+type IssueMatches struct {
+	Theorems []TheoremMatch `json:"theorems"`
+	Topics   []TopicMatch   `json:"topics"`
+}
+
+// MatchIssue finds the theorems and domain topics an issue touches. The
+// issue's title, description and affected areas are searched for every
+// theorem component and configured topic, ignoring ASCII case and treating
+// underscores as spaces.
+func MatchIssue(issueJSON string) (*IssueMatches, error) {
+	cIssue := C.CString(issueJSON)
+	defer C.free(unsafe.Pointer(cIssue))
+
+	matchesPtr := C.agency_match_issue(cIssue)
+	if matchesPtr == nil {
+		return nil, AgencyError{"Failed to match issue"}
+	}
+	defer C.agency_free_context(matchesPtr)
+
+	matches := &IssueMatches{}
+	if err := json.Unmarshal([]byte(C.GoString(matchesPtr)), matches); err != nil {
+		return nil, errors.New("failed to parse matches JSON: " + err.Error())
+	}
+	return matches, nil
+}
+
+// ReportRule is one schema check or theorem evaluated by VerifyIssueReport.
+type ReportRule struct {
+	Kind    string `json:"kind"`    // "field" or "theorem"
+	Name    string `json:"name"`    // the field or theorem name
+	Field   string `json:"field"`   // the field the rule checks
+	Outcome string `json:"outcome"` // "passed", or the check that failed
+	Missing string `json:"missing"` // the keyword a failed theorem lacks
+	Ns      uint64 `json:"ns"`
+}
+
+// VerificationReport is the outcome of every rule evaluated for an issue.
+type VerificationReport struct {
+	Verdict     int          `json:"verdict"` // 1 valid, 0 invalid, -1 not verifiable
+	TotalNs     uint64       `json:"total_ns"`
+	ErrorOffset *uint64      `json:"error_offset"` // set when the JSON is malformed
+	Rules       []ReportRule `json:"rules"`
+}
+
+// VerifyIssueReport verifies an issue and reports each schema check and
+// theorem evaluated, with its outcome and time. Every theorem is evaluated,
+// even after one fails.
+func VerifyIssueReport(agency string, issueJSON string) (*VerificationReport, error) {
+	cAgency := C.CString(agency)
+	defer C.free(unsafe.Pointer(cAgency))
+	cIssue := C.CString(issueJSON)
+	defer C.free(unsafe.Pointer(cIssue))
+
+	capacity := C.size_t(4096)
+	for {
+		buffer := (*C.char)(C.malloc(capacity))
+		var length C.size_t
+		status := C.agency_verify_issue_report(cAgency, cIssue, C.AGENCY_REPORT_JSON, buffer, capacity, &length)
+		if status == C.AGENCY_STATUS_OK {
+			report := &VerificationReport{}
+			err := json.Unmarshal(C.GoBytes(unsafe.Pointer(buffer), C.int(length)), report)
+			C.free(unsafe.Pointer(buffer))
+			if err != nil {
+				return nil, AgencyError{"Failed to parse verification report"}
+			}
+			return report, nil
+		}
+		C.free(unsafe.Pointer(buffer))
+		if length <= capacity {
+			return nil, AgencyError{"Error verifying issue"}
+		}
+		// Timings can lengthen the report on the next run
+		capacity = length + 256
+	}
+}
+
+// VerdictCacheStats reports the size and hit counts of the verdict cache.
+type VerdictCacheStats struct {
+	Capacity      int
+	Hits          uint64
+	Misses        uint64
+	Evictions     uint64
+	Invalidations uint64
+}
+
+// GetVerdictCacheStats returns the verdict cache's statistics.
+func GetVerdictCacheStats() VerdictCacheStats {
+	var stats C.agency_verdict_cache_stats
+	C.agency_get_verdict_cache_stats(&stats)
+
+	return VerdictCacheStats{
+		Capacity:      int(stats.capacity),
+		Hits:          uint64(stats.hits),
+		Misses:        uint64(stats.misses),
+		Evictions:     uint64(stats.evictions),
+		Invalidations: uint64(stats.invalidations),
+	}
+}
+
+// ClearVerdictCache drops every cached verdict; the statistics are kept.
+func ClearVerdictCache() {
+	C.agency_verdict_cache_clear()
+}
+
+// DefaultDedupSimilarity is the similarity threshold suiting most indexes.
+const DefaultDedupSimilarity = 0.8
+
+// dedupIDCapacity is the buffer size for canonical issue ids.
+const dedupIDCapacity = 256
+
+// DedupIndex finds near-duplicate issues: issues whose title, description
+// and affected areas share most of their three-word shingles resolve to
+// the first such issue indexed, their canonical issue. It only reports
+// near-duplicates; verify each issue on its own with VerifyIssue, whose
+// verdict cache already answers resubmitted issues. It is safe for
+// concurrent use.
+type DedupIndex struct {
+	index *C.agency_dedup_index
+}
+
+// DedupStats reports the size and lookup counts of a DedupIndex.
+type DedupStats struct {
+	Issues     int
+	Bands      uint32
+	Rows       uint32
+	Lookups    uint64
+	Duplicates uint64
+	Candidates uint64
+}
+
+// NewDedupIndex creates an empty index in which issues whose shingle sets
+// have at least minSimilarity Jaccard similarity are near-duplicates.
+func NewDedupIndex(minSimilarity float64) (*DedupIndex, error) {
+	index := C.agency_dedup_create(C.double(minSimilarity))
+	if index == nil {
+		return nil, AgencyError{"Failed to create near-duplicate index"}
+	}
+	return &DedupIndex{index: index}, nil
+}
+
+// Close releases the index.
+func (d *DedupIndex) Close() {
+	if d.index != nil {
+		C.agency_dedup_destroy(d.index)
+		d.index = nil
+	}
+}
+
+// Add looks an issue up, indexing it if no near-duplicate is indexed yet.
+// It reports whether one was, and the canonical issue's id.
+func (d *DedupIndex) Add(issueJSON string) (bool, string, error) {
+	cIssue := C.CString(issueJSON)
+	defer C.free(unsafe.Pointer(cIssue))
+
+	var canonical [dedupIDCapacity]C.char
+	result := C.agency_dedup_add(d.index, cIssue, &canonical[0], dedupIDCapacity)
+	if result < 0 {
+		return false, "", AgencyError{"Failed to index issue"}
+	}
+	return result == 1, C.GoString(&canonical[0]), nil
+}
+
+// Stats returns the index's statistics.
+func (d *DedupIndex) Stats() DedupStats {
+	var stats C.agency_dedup_stats
+	C.agency_get_dedup_stats(d.index, &stats)
+
+	return DedupStats{
+		Issues:     int(stats.issues),
+		Bands:      uint32(stats.bands),
+		Rows:       uint32(stats.rows),
+		Lookups:    uint64(stats.lookups),
+		Duplicates: uint64(stats.duplicates),
+		Candidates: uint64(stats.candidates),
+	}
+}
+
+// DefaultTheoremCutoff is the description length times the domain's
+// keyword count, in bytes, from which one issue's theorems are evaluated
+// on the pool.
+const DefaultTheoremCutoff = 1 << 20
+
+// TheoremPoolStats reports the configuration and work counts of the pool
+// that evaluates a large issue's theorems.
+type TheoremPoolStats struct {
+	Threads               int
+	Cutoff                int
+	ParallelVerifications uint64
+	Items                 uint64
+	Steals                uint64
+}
+
+// SetTheoremParallelism sets the threads that evaluate one large issue's
+// theorems (0 for one per online CPU, 1 to stay serial) and the cutoff
+// (0 for DefaultTheoremCutoff).
+func SetTheoremParallelism(threads, cutoff int) {
+	C.agency_set_theorem_parallelism(C.size_t(threads), C.size_t(cutoff))
+}
+
+// GetTheoremPoolStats returns the theorem pool's statistics.
+func GetTheoremPoolStats() TheoremPoolStats {
+	var stats C.agency_theorem_pool_stats
+	C.agency_get_theorem_pool_stats(&stats)
+
+	return TheoremPoolStats{
+		Threads:               int(stats.threads),
+		Cutoff:                int(stats.cutoff),
+		ParallelVerifications: uint64(stats.parallel_verifications),
+		Items:                 uint64(stats.items),
+		Steals:                uint64(stats.steals),
+	}
+}
+
+// ReloadStats reports configuration reloads and how many of the
+// configurations they replaced have been freed.
+type ReloadStats struct {
+	Reloads   uint64
+	Epoch     uint64
+	Retired   uint64
+	Reclaimed uint64
+}
+
+// ReloadConfig reloads the configuration file while other goroutines keep
+// reading. Calls in progress finish on the configuration they started
+// with; on error the current configuration stays in place.
+func ReloadConfig() error {
+	if C.agency_reload_config() != C.AGENCY_STATUS_OK {
+		return AgencyError{"Failed to reload configuration"}
+	}
+	return nil
+}
+
+// GetReloadStats returns the reload statistics.
+func GetReloadStats() ReloadStats {
+	var stats C.agency_reload_stats
+	C.agency_get_reload_stats(&stats)
+
+	return ReloadStats{
+		Reloads:   uint64(stats.reloads),
+		Epoch:     uint64(stats.epoch),
+		Retired:   uint64(stats.retired),
+		Reclaimed: uint64(stats.reclaimed),
+	}
+}
+
+// MemoryCategory identifies a kind of memory the library holds.
+type MemoryCategory int
+
+// Memory categories reported by GetMemoryStats.
+const (
+	MemorySnapshot          MemoryCategory = C.AGENCY_MEMORY_SNAPSHOT
+	MemoryIndexes           MemoryCategory = C.AGENCY_MEMORY_INDEXES
+	MemoryResourceCache     MemoryCategory = C.AGENCY_MEMORY_RESOURCE_CACHE
+	MemoryVerificationCache MemoryCategory = C.AGENCY_MEMORY_VERIFICATION_CACHE
+	MemoryArenas            MemoryCategory = C.AGENCY_MEMORY_ARENAS
+)
+
+// MemoryUsage reports the memory held in one category.
+type MemoryUsage struct {
+	Bytes     uint64
+	Objects   uint64
+	Limit     uint64
+	Evictions uint64
+}
+
+// MemoryStats reports the memory the library holds, indexed by
+// MemoryCategory.
+type MemoryStats struct {
+	Categories [C.AGENCY_MEMORY_CATEGORIES]MemoryUsage
+	TotalBytes uint64
+}
+
+// GetMemoryStats returns the memory statistics. It reads counters only, so
+// it is cheap enough for every metrics scrape.
+func GetMemoryStats() MemoryStats {
+	var stats C.agency_memory_stats
+	C.agency_get_memory_stats(&stats)
+
+	result := MemoryStats{TotalBytes: uint64(stats.total_bytes)}
+	for i := range result.Categories {
+		usage := stats.categories[i]
+		result.Categories[i] = MemoryUsage{
+			Bytes:     uint64(usage.bytes),
+			Objects:   uint64(usage.objects),
+			Limit:     uint64(usage.limit),
+			Evictions: uint64(usage.evictions),
+		}
+	}
+	return result
+}
+
+// SetMemoryLimit caps the memory a cache may hold; above it, the cache
+// evicts. A limit of 0 removes the cap. Only MemoryResourceCache,
+// MemoryVerificationCache and MemoryArenas take a limit.
+func SetMemoryLimit(category MemoryCategory, limit uint64) error {
+	if C.agency_set_memory_limit(C.agency_memory_category(category), C.uint64_t(limit)) != C.AGENCY_STATUS_OK {
+		return AgencyError{"Failed to set memory limit"}
+	}
+	return nil
+}
+
+// PressureLevel grades the memory pressure the monitor observes.
+type PressureLevel int
+
+// Pressure levels reported by GetPressureStats.
+const (
+	PressureNone     PressureLevel = C.AGENCY_PRESSURE_NONE
+	PressureModerate PressureLevel = C.AGENCY_PRESSURE_MODERATE
+	PressureHigh     PressureLevel = C.AGENCY_PRESSURE_HIGH
+	PressureCritical PressureLevel = C.AGENCY_PRESSURE_CRITICAL
+)
+
+// PressureStats reports the pressure monitor's last reading.
+type PressureStats struct {
+	Running      bool
+	Level        PressureLevel
+	SomeAvg10    float64
+	FullAvg10    float64
+	CurrentBytes uint64
+	MaxBytes     uint64
+	Checks       uint64
+	Escalations  uint64
+}
+
+// StartPressureMonitor starts a background monitor that reads the cgroup
+// v2 memory.pressure, memory.current and memory.max files in cgroupDir
+// every intervalMs milliseconds and shrinks the caches as pressure rises.
+// An empty cgroupDir selects the process's own cgroup, and an interval of
+// 0 one second.
+func StartPressureMonitor(cgroupDir string, intervalMs uint) error {
+	var cDir *C.char
+	if cgroupDir != "" {
+		cDir = C.CString(cgroupDir)
+		defer C.free(unsafe.Pointer(cDir))
+	}
+
+	if C.agency_pressure_monitor_start(cDir, C.unsigned(intervalMs)) != C.AGENCY_STATUS_OK {
+		return AgencyError{"Failed to start pressure monitor"}
+	}
+	return nil
+}
+
+// StopPressureMonitor stops the monitor and lifts the ceilings it set.
+func StopPressureMonitor() {
+	C.agency_pressure_monitor_stop()
+}
+
+// GetPressureStats returns the pressure monitor's statistics.
+func GetPressureStats() PressureStats {
+	var stats C.agency_pressure_stats
+	C.agency_get_pressure_stats(&stats)
+
+	return PressureStats{
+		Running:      stats.running != 0,
+		Level:        PressureLevel(stats.level),
+		SomeAvg10:    float64(stats.some_avg10),
+		FullAvg10:    float64(stats.full_avg10),
+		CurrentBytes: uint64(stats.current_bytes),
+		MaxBytes:     uint64(stats.max_bytes),
+		Checks:       uint64(stats.checks),
+		Escalations:  uint64(stats.escalations),
+	}
+}
+
+// PreforkPrepare builds everything the library would otherwise build on
+// first use, so that worker processes forked afterwards share it with the
+// parent instead of each building a private copy. Call it while no other
+// goroutine is using the library.
+func PreforkPrepare() error {
+	if C.agency_prefork_prepare() != C.AGENCY_STATUS_OK {
+		return AgencyError{"Failed to prepare for fork"}
+	}
+	return nil
+}
+
+// NumaStats reports the NUMA topology and replication.
+type NumaStats struct {
+	Nodes        uint
+	Replicas     uint
+	Replica      uint
+	ReplicaBytes uint64
+}
+
+// NumaReplicate keeps a copy of the configuration snapshot, theorem models
+// and issue matcher on each NUMA node, read by the threads running there.
+// A replicas of 0 keeps one per node and 1 turns replication off; more
+// than there are nodes is allowed, for testing.
+func NumaReplicate(replicas uint) error {
+	if C.agency_numa_replicate(C.unsigned(replicas)) != C.AGENCY_STATUS_OK {
+		return AgencyError{"Failed to replicate across NUMA nodes"}
+	}
+	return nil
+}
+
+// NumaSetThreadNode has the calling OS thread read the copy of a given
+// node, or follow its CPU again with -1. Lock the goroutine to its thread
+// with runtime.LockOSThread first.
+func NumaSetThreadNode(node int) error {
+	if C.agency_numa_set_thread_node(C.int(node)) != C.AGENCY_STATUS_OK {
+		return AgencyError{"Invalid NUMA node"}
+	}
+	return nil
+}
+
+// GetNumaStats returns the NUMA topology and replication statistics.
+func GetNumaStats() NumaStats {
+	var stats C.agency_numa_stats
+	C.agency_get_numa_stats(&stats)
+
+	return NumaStats{
+		Nodes:        uint(stats.nodes),
+		Replicas:     uint(stats.replicas),
+		Replica:      uint(stats.replica),
+		ReplicaBytes: uint64(stats.replica_bytes),
+	}
+}
+
+// HugePages selects what backs the snapshot, index and resource store regions.
+type HugePages int
+
+// Huge-page modes for SetHugePages.
+const (
+	HugePagesOff     HugePages = C.AGENCY_HUGE_PAGES_OFF
+	HugePagesTHP     HugePages = C.AGENCY_HUGE_PAGES_THP
+	HugePagesHugetlb HugePages = C.AGENCY_HUGE_PAGES_HUGETLB
+)
+
+// HugePageStats reports the huge-page mode and the memory it backs.
+type HugePageStats struct {
+	Mode      HugePages
+	PageSize  uint64
+	HugeBytes uint64
+	Fallbacks uint64
+}
+
+// SetHugePages backs the configuration snapshot, indexes and preloaded
+// resources built from now on with huge pages, falling back to smaller
+// ones where they cannot be had. ReloadConfig rebuilds the snapshot.
+func SetHugePages(mode HugePages) error {
+	if C.agency_set_huge_pages(C.int(mode)) != C.AGENCY_STATUS_OK {
+		return AgencyError{"Unknown huge page mode"}
+	}
+	return nil
+}
+
+// GetHugePageStats returns the huge-page statistics.
+func GetHugePageStats() HugePageStats {
+	var stats C.agency_huge_page_stats
+	C.agency_get_huge_page_stats(&stats)
+
+	return HugePageStats{
+		Mode:      HugePages(stats.mode),
+		PageSize:  uint64(stats.page_size),
+		HugeBytes: uint64(stats.huge_bytes),
+		Fallbacks: uint64(stats.fallbacks),
+	}
+}
+
 // GetAgencyInfo returns agency information as a struct.
 func GetAgencyInfo(agency string) (*Agency, error) {
 	context, err := GetContext(agency)
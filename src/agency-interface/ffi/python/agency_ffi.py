@@ -9,7 +9,7 @@ allowing Python code to interact with the agency system.
 import os
 import json
 import ctypes
-from typing import Dict, List, Any, Optional, Union, Tuple
+from typing import Callable, Dict, Iterable, List, Any, Optional, Union, Tuple
 
 # Load the agency FFI library
 _lib_path = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), 'c/libagency_ffi.so')
@@ -17,44 +17,344 @@ _lib = ctypes.CDLL(_lib_path)
 
 # Define argument and return types for FFI functions
 _lib.agency_get_context.argtypes = [ctypes.c_char_p]
-_lib.agency_get_context.restype = ctypes.c_char_p
+_lib.agency_get_context.restype = ctypes.c_void_p
 
 _lib.agency_get_issue_finder.argtypes = [ctypes.c_char_p]
-_lib.agency_get_issue_finder.restype = ctypes.c_char_p
+_lib.agency_get_issue_finder.restype = ctypes.c_void_p
 
 _lib.agency_get_research_connector.argtypes = [ctypes.c_char_p]
-_lib.agency_get_research_connector.restype = ctypes.c_char_p
+_lib.agency_get_research_connector.restype = ctypes.c_void_p
 
 _lib.agency_get_ascii_art.argtypes = [ctypes.c_char_p]
-_lib.agency_get_ascii_art.restype = ctypes.c_char_p
+_lib.agency_get_ascii_art.restype = ctypes.c_void_p
 
 _lib.agency_free_context.argtypes = [ctypes.c_char_p]
 _lib.agency_free_context.restype = None
 
 _lib.agency_get_all_agencies.argtypes = []
-_lib.agency_get_all_agencies.restype = ctypes.c_char_p
+_lib.agency_get_all_agencies.restype = ctypes.c_void_p
 
 _lib.agency_get_agencies_by_tier.argtypes = [ctypes.c_int]
-_lib.agency_get_agencies_by_tier.restype = ctypes.c_char_p
+_lib.agency_get_agencies_by_tier.restype = ctypes.c_void_p
 
 _lib.agency_get_agencies_by_domain.argtypes = [ctypes.c_char_p]
-_lib.agency_get_agencies_by_domain.restype = ctypes.c_char_p
+_lib.agency_get_agencies_by_domain.restype = ctypes.c_void_p
 
 _lib.agency_verify_issue.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
 _lib.agency_verify_issue.restype = ctypes.c_int
 
+# Resource kinds (agency_resource_kind)
+RESOURCE_ISSUE_FINDER = 0
+RESOURCE_RESEARCH_CONNECTOR = 1
+RESOURCE_ASCII_ART = 2
+
+# Status codes (agency_status)
+STATUS_OK = 0
+STATUS_NOT_FOUND = 1
+STATUS_NOT_MODIFIED = 2
+STATUS_ERROR = -1
+
+# Report encodings (mirror agency_report_format in agency_ffi.h)
+REPORT_BINARY = 0
+REPORT_JSON = 1
+
+# Default parallel theorem evaluation cutoff (AGENCY_THEOREM_CUTOFF_DEFAULT in agency_ffi.h)
+THEOREM_CUTOFF_DEFAULT = 1 << 20
+
+# Near-duplicate threshold (AGENCY_DEDUP_DEFAULT_SIMILARITY in agency_ffi.h)
+DEDUP_DEFAULT_SIMILARITY = 0.8
+
+# Memory categories (mirror agency_memory_category in agency_ffi.h)
+MEMORY_SNAPSHOT = 0
+MEMORY_INDEXES = 1
+MEMORY_RESOURCE_CACHE = 2
+MEMORY_VERIFICATION_CACHE = 3
+MEMORY_ARENAS = 4
+_MEMORY_CATEGORY_NAMES = ("snapshot", "indexes", "resource_cache", "verification_cache", "arenas")
+
+# Memory pressure levels (mirror agency_pressure_level in agency_ffi.h)
+PRESSURE_NONE = 0
+PRESSURE_MODERATE = 1
+PRESSURE_HIGH = 2
+PRESSURE_CRITICAL = 3
+
+# Huge-page modes (mirror agency_huge_pages in agency_ffi.h)
+HUGE_PAGES_OFF = 0
+HUGE_PAGES_THP = 1
+HUGE_PAGES_HUGETLB = 2
+
+
+class _Completion(ctypes.Structure):
+    """Mirror of the C agency_completion struct."""
+    _fields_ = [
+        ("ticket", ctypes.c_uint64),
+        ("status", ctypes.c_int),
+        ("data", ctypes.c_void_p),
+        ("length", ctypes.c_size_t),
+        ("user_data", ctypes.c_void_p),
+    ]
+
+
+class _StoreStats(ctypes.Structure):
+    """Mirror of the C agency_store_stats struct."""
+    _fields_ = [
+        ("resources", ctypes.c_size_t),
+        ("raw_bytes", ctypes.c_size_t),
+        ("compressed_bytes", ctypes.c_size_t),
+        ("arena_bytes", ctypes.c_size_t),
+        ("hot_hits", ctypes.c_uint64),
+        ("hot_misses", ctypes.c_uint64),
+        ("decompress_ns", ctypes.c_uint64),
+    ]
+
+
+class _VerdictCacheStats(ctypes.Structure):
+    """Mirror of the C agency_verdict_cache_stats struct."""
+    _fields_ = [
+        ("capacity", ctypes.c_size_t),
+        ("hits", ctypes.c_uint64),
+        ("misses", ctypes.c_uint64),
+        ("evictions", ctypes.c_uint64),
+        ("invalidations", ctypes.c_uint64),
+    ]
+
+
+class _TheoremPoolStats(ctypes.Structure):
+    """Mirror of the C agency_theorem_pool_stats struct."""
+    _fields_ = [
+        ("threads", ctypes.c_size_t),
+        ("cutoff", ctypes.c_size_t),
+        ("parallel_verifications", ctypes.c_uint64),
+        ("items", ctypes.c_uint64),
+        ("steals", ctypes.c_uint64),
+    ]
+
+
+class _ReloadStats(ctypes.Structure):
+    """Mirror of the C agency_reload_stats struct."""
+    _fields_ = [
+        ("reloads", ctypes.c_uint64),
+        ("epoch", ctypes.c_uint64),
+        ("retired", ctypes.c_uint64),
+        ("reclaimed", ctypes.c_uint64),
+    ]
+
+
+class _MemoryUsage(ctypes.Structure):
+    """Mirror of the C agency_memory_usage struct."""
+    _fields_ = [
+        ("bytes", ctypes.c_uint64),
+        ("objects", ctypes.c_uint64),
+        ("limit", ctypes.c_uint64),
+        ("evictions", ctypes.c_uint64),
+    ]
+
+
+class _MemoryStats(ctypes.Structure):
+    """Mirror of the C agency_memory_stats struct."""
+    _fields_ = [
+        ("categories", _MemoryUsage * 5),
+        ("total_bytes", ctypes.c_uint64),
+    ]
+
+
+class _PressureStats(ctypes.Structure):
+    """Mirror of the C agency_pressure_stats struct."""
+    _fields_ = [
+        ("running", ctypes.c_int),
+        ("level", ctypes.c_int),
+        ("some_avg10", ctypes.c_double),
+        ("full_avg10", ctypes.c_double),
+        ("current_bytes", ctypes.c_uint64),
+        ("max_bytes", ctypes.c_uint64),
+        ("checks", ctypes.c_uint64),
+        ("escalations", ctypes.c_uint64),
+    ]
+
+
+class _NumaStats(ctypes.Structure):
+    """Mirror of the C agency_numa_stats struct."""
+    _fields_ = [
+        ("nodes", ctypes.c_uint),
+        ("replicas", ctypes.c_uint),
+        ("replica", ctypes.c_uint),
+        ("replica_bytes", ctypes.c_size_t),
+    ]
+
+
+class _HugePageStats(ctypes.Structure):
+    """Mirror of the C agency_huge_page_stats struct."""
+    _fields_ = [
+        ("mode", ctypes.c_int),
+        ("page_size", ctypes.c_size_t),
+        ("huge_bytes", ctypes.c_size_t),
+        ("fallbacks", ctypes.c_uint64),
+    ]
+
+
+class _DedupStats(ctypes.Structure):
+    """Mirror of the C agency_dedup_stats struct."""
+    _fields_ = [
+        ("issues", ctypes.c_size_t),
+        ("bands", ctypes.c_uint32),
+        ("rows", ctypes.c_uint32),
+        ("lookups", ctypes.c_uint64),
+        ("duplicates", ctypes.c_uint64),
+        ("candidates", ctypes.c_uint64),
+    ]
+
+
+class _BatchSummary(ctypes.Structure):
+    """Mirror of the C agency_batch_summary struct."""
+    _fields_ = [
+        ("issues", ctypes.c_size_t),
+        ("valid", ctypes.c_size_t),
+        ("invalid", ctypes.c_size_t),
+        ("errors", ctypes.c_size_t),
+    ]
+
+
+_lib.agency_async_init.argtypes = [ctypes.c_size_t]
+_lib.agency_async_init.restype = ctypes.c_int
+
+_lib.agency_async_shutdown.argtypes = []
+_lib.agency_async_shutdown.restype = None
+
+_lib.agency_fetch_async.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+_lib.agency_fetch_async.restype = ctypes.c_uint64
+
+_lib.agency_poll_completions.argtypes = [ctypes.POINTER(_Completion), ctypes.c_size_t, ctypes.c_int]
+_lib.agency_poll_completions.restype = ctypes.c_int
+
+_lib.agency_completion_fd.argtypes = []
+_lib.agency_completion_fd.restype = ctypes.c_int
+
+_lib.agency_get_context_conditional.argtypes = [ctypes.c_char_p, ctypes.c_uint64, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_uint64)]
+_lib.agency_get_context_conditional.restype = ctypes.c_int
+
+_lib.agency_get_resource_conditional.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_uint64, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_size_t), ctypes.POINTER(ctypes.c_uint64)]
+_lib.agency_get_resource_conditional.restype = ctypes.c_int
+
+_lib.agency_store_preload.argtypes = []
+_lib.agency_store_preload.restype = ctypes.c_int
+
+_lib.agency_store_get_compressed.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_size_t), ctypes.POINTER(ctypes.c_size_t)]
+_lib.agency_store_get_compressed.restype = ctypes.c_int
+
+_lib.agency_get_store_stats.argtypes = [ctypes.POINTER(_StoreStats)]
+_lib.agency_get_store_stats.restype = None
+
+_lib.agency_stream_open.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_size_t]
+_lib.agency_stream_open.restype = ctypes.c_void_p
+
+_lib.agency_stream_next.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_size_t)]
+_lib.agency_stream_next.restype = ctypes.c_int
+
+_lib.agency_stream_close.argtypes = [ctypes.c_void_p]
+_lib.agency_stream_close.restype = None
+
+_lib.agency_verify_batch.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_size_t, ctypes.POINTER(ctypes.c_int8), ctypes.c_size_t, ctypes.POINTER(_BatchSummary)]
+_lib.agency_verify_batch.restype = ctypes.c_int
+
+# Mirrors agency_verdict_writer
+_VERDICT_WRITER = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.POINTER(ctypes.c_int8), ctypes.c_size_t, ctypes.c_void_p)
+
+_lib.agency_verify_batch_fd.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_size_t, _VERDICT_WRITER, ctypes.c_void_p, ctypes.POINTER(_BatchSummary)]
+_lib.agency_verify_batch_fd.restype = ctypes.c_int
+
+_lib.agency_get_verdict_cache_stats.argtypes = [ctypes.POINTER(_VerdictCacheStats)]
+_lib.agency_get_verdict_cache_stats.restype = None
+
+_lib.agency_verdict_cache_clear.argtypes = []
+_lib.agency_verdict_cache_clear.restype = None
+
+_lib.agency_verify_issue_report.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int, ctypes.c_char_p, ctypes.c_size_t, ctypes.POINTER(ctypes.c_size_t)]
+_lib.agency_verify_issue_report.restype = ctypes.c_int
+
+_lib.agency_match_issue.argtypes = [ctypes.c_char_p]
+_lib.agency_match_issue.restype = ctypes.c_void_p
+
+_lib.agency_set_theorem_parallelism.argtypes = [ctypes.c_size_t, ctypes.c_size_t]
+_lib.agency_set_theorem_parallelism.restype = None
+
+_lib.agency_get_theorem_pool_stats.argtypes = [ctypes.POINTER(_TheoremPoolStats)]
+_lib.agency_get_theorem_pool_stats.restype = None
+
+_lib.agency_reload_config.argtypes = []
+_lib.agency_reload_config.restype = ctypes.c_int
+
+_lib.agency_get_reload_stats.argtypes = [ctypes.POINTER(_ReloadStats)]
+_lib.agency_get_reload_stats.restype = None
+
+_lib.agency_get_memory_stats.argtypes = [ctypes.POINTER(_MemoryStats)]
+_lib.agency_get_memory_stats.restype = None
+
+_lib.agency_set_memory_limit.argtypes = [ctypes.c_int, ctypes.c_uint64]
+_lib.agency_set_memory_limit.restype = ctypes.c_int
+
+_lib.agency_pressure_monitor_start.argtypes = [ctypes.c_char_p, ctypes.c_uint]
+_lib.agency_pressure_monitor_start.restype = ctypes.c_int
+
+_lib.agency_pressure_monitor_stop.argtypes = []
+_lib.agency_pressure_monitor_stop.restype = None
+
+_lib.agency_get_pressure_stats.argtypes = [ctypes.POINTER(_PressureStats)]
+_lib.agency_get_pressure_stats.restype = None
+
+_lib.agency_prefork_prepare.argtypes = []
+_lib.agency_prefork_prepare.restype = ctypes.c_int
+
+_lib.agency_numa_replicate.argtypes = [ctypes.c_uint]
+_lib.agency_numa_replicate.restype = ctypes.c_int
+
+_lib.agency_numa_set_thread_node.argtypes = [ctypes.c_int]
+_lib.agency_numa_set_thread_node.restype = ctypes.c_int
+
+_lib.agency_get_numa_stats.argtypes = [ctypes.POINTER(_NumaStats)]
+_lib.agency_get_numa_stats.restype = None
+
+_lib.agency_set_huge_pages.argtypes = [ctypes.c_int]
+_lib.agency_set_huge_pages.restype = ctypes.c_int
+
+_lib.agency_get_huge_page_stats.argtypes = [ctypes.POINTER(_HugePageStats)]
+_lib.agency_get_huge_page_stats.restype = None
+
+# Allocator hooks (mirror agency_alloc_fn, agency_realloc_fn and agency_free_fn)
+_ALLOC_FN = ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p)
+_REALLOC_FN = ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p)
+_FREE_FN = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_void_p)
+
+_lib.agency_set_allocator.argtypes = [_ALLOC_FN, _REALLOC_FN, _FREE_FN, ctypes.c_void_p]
+_lib.agency_set_allocator.restype = ctypes.c_int
+
+# The installed hooks, kept alive for as long as the library may call them
+_allocator = None
+
+_lib.agency_dedup_create.argtypes = [ctypes.c_double]
+_lib.agency_dedup_create.restype = ctypes.c_void_p
+
+_lib.agency_dedup_destroy.argtypes = [ctypes.c_void_p]
+_lib.agency_dedup_destroy.restype = None
+
+_lib.agency_dedup_add.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_size_t]
+_lib.agency_dedup_add.restype = ctypes.c_int
+
+_lib.agency_get_dedup_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(_DedupStats)]
+_lib.agency_get_dedup_stats.restype = None
+
 
 class AgencyError(Exception):
     """Exception raised for errors in the agency FFI interface."""
     pass
 
 
-def _check_string_result(result: Optional[bytes]) -> str:
+def _check_string_result(result: Optional[int]) -> str:
     """
     Check and convert a string result from the FFI interface.
     
     Args:
-        result: The result from the FFI function call.
+        result: The result from the FFI function call, a pointer the
+            library allocated.
         
     Returns:
         The decoded string.
@@ -62,14 +362,14 @@ def _check_string_result(result: Optional[bytes]) -> str:
     Raises:
         AgencyError: If the result is None or empty.
     """
-    if result is None:
+    if not result:
         raise AgencyError("Operation failed")
     
     # Convert bytes to string
-    string_result = result.decode('utf-8')
+    string_result = ctypes.string_at(result).decode('utf-8')
     
     # Free the result
-    _lib.agency_free_context(result)
+    _lib.agency_free_context(ctypes.cast(result, ctypes.c_char_p))
     
     return string_result
 
@@ -247,6 +547,711 @@ def verify_issue(agency: str, issue: Dict[str, Any]) -> bool:
         raise AgencyError("Error verifying issue")
 
 
+def _conditional_result(status: int, data: ctypes.c_void_p, length: Optional[int], current_hash: int) -> Tuple[Optional[str], int]:
+    """
+    Convert the outcome of a conditional fetch.
+    
+    Returns:
+        A (data, hash) tuple; data is None when the caller's copy is current.
+        
+    Raises:
+        AgencyError: If the agency or resource is not found or an error occurs.
+    """
+    if status == STATUS_NOT_MODIFIED:
+        return None, current_hash
+    if status == STATUS_NOT_FOUND:
+        raise AgencyError("Not found")
+    if status != STATUS_OK:
+        raise AgencyError("Operation failed")
+    
+    if length is None:
+        text = ctypes.string_at(data).decode('utf-8')
+    else:
+        text = ctypes.string_at(data, length).decode('utf-8')
+    _lib.agency_free_context(ctypes.cast(data, ctypes.c_char_p))
+    return text, current_hash
+
+
+def get_context_if_modified(agency: str, known_hash: int = 0) -> Tuple[Optional[str], int]:
+    """
+    Get the context JSON for an agency unless the caller's copy is current.
+    
+    Args:
+        agency: The agency acronym (e.g., "HHS", "DOD").
+        known_hash: The hash returned by a previous call, or 0.
+        
+    Returns:
+        A (context, hash) tuple; context is None when known_hash is current.
+        
+    Raises:
+        AgencyError: If the agency is not found or an error occurs.
+    """
+    data = ctypes.c_void_p()
+    current_hash = ctypes.c_uint64()
+    status = _lib.agency_get_context_conditional(agency.encode('utf-8'), known_hash,
+                                                 ctypes.byref(data), ctypes.byref(current_hash))
+    return _conditional_result(status, data, None, current_hash.value)
+
+
+def get_resource_if_modified(agency: str, kind: int, known_hash: int = 0) -> Tuple[Optional[str], int]:
+    """
+    Get a file-backed agency resource unless the caller's copy is current.
+    
+    Args:
+        agency: The agency acronym (e.g., "HHS", "DOD").
+        kind: One of the RESOURCE_* constants.
+        known_hash: The hash returned by a previous call, or 0.
+        
+    Returns:
+        A (data, hash) tuple; data is None when known_hash is current.
+        
+    Raises:
+        AgencyError: If the resource is not found or an error occurs.
+    """
+    data = ctypes.c_void_p()
+    length = ctypes.c_size_t()
+    current_hash = ctypes.c_uint64()
+    status = _lib.agency_get_resource_conditional(agency.encode('utf-8'), kind, known_hash,
+                                                  ctypes.byref(data), ctypes.byref(length),
+                                                  ctypes.byref(current_hash))
+    return _conditional_result(status, data, length.value, current_hash.value)
+
+
+def store_preload() -> None:
+    """
+    Load every file-backed resource into the compressed in-memory store.
+    
+    Raises:
+        AgencyError: If any resource could not be stored.
+    """
+    if _lib.agency_store_preload() != STATUS_OK:
+        raise AgencyError("Error preloading resources")
+
+
+def get_compressed_resource(agency: str, kind: int) -> Tuple[bytes, int]:
+    """
+    Get a stored resource as an LZ4 block, suitable for forwarding as-is.
+    
+    Args:
+        agency: The agency acronym (e.g., "HHS", "DOD").
+        kind: One of the RESOURCE_* constants.
+        
+    Returns:
+        A (compressed_bytes, raw_length) tuple.
+        
+    Raises:
+        AgencyError: If the resource is not found or not stored.
+    """
+    data = ctypes.c_void_p()
+    compressed_length = ctypes.c_size_t()
+    raw_length = ctypes.c_size_t()
+    status = _lib.agency_store_get_compressed(agency.encode('utf-8'), kind, ctypes.byref(data),
+                                              ctypes.byref(compressed_length), ctypes.byref(raw_length))
+    if status == STATUS_NOT_FOUND:
+        raise AgencyError("Resource not found")
+    if status != STATUS_OK:
+        raise AgencyError("Resource is not in the store")
+    
+    return ctypes.string_at(data, compressed_length.value), raw_length.value
+
+
+def get_store_stats() -> Dict[str, int]:
+    """
+    Get the size and hit rates of the compressed resource store.
+    
+    Returns:
+        A dictionary of store statistics.
+    """
+    stats = _StoreStats()
+    _lib.agency_get_store_stats(ctypes.byref(stats))
+    return {name: getattr(stats, name) for name, _ in _StoreStats._fields_}
+
+
+def fetch_async(agency: str, kind: int) -> int:
+    """
+    Submit an asynchronous fetch of an agency resource.
+    
+    Args:
+        agency: The agency acronym (e.g., "HHS", "DOD").
+        kind: One of the RESOURCE_* constants.
+        
+    Returns:
+        The ticket identifying the request.
+        
+    Raises:
+        AgencyError: If the request could not be submitted.
+    """
+    ticket = _lib.agency_fetch_async(agency.encode('utf-8'), kind, None, None)
+    if ticket == 0:
+        raise AgencyError("Error submitting asynchronous fetch")
+    return ticket
+
+
+def poll_completions(max_completions: int = 16, timeout_ms: int = 0) -> List[Tuple[int, int, Optional[str]]]:
+    """
+    Collect finished asynchronous fetches.
+    
+    Args:
+        max_completions: Maximum number of results to return.
+        timeout_ms: How long to wait when none are ready (0 returns at once,
+            negative waits indefinitely).
+        
+    Returns:
+        A list of (ticket, status, data) tuples; data is None unless the
+        status is STATUS_OK.
+        
+    Raises:
+        AgencyError: If an error occurs.
+    """
+    buffer = (_Completion * max_completions)()
+    count = _lib.agency_poll_completions(buffer, max_completions, timeout_ms)
+    if count < 0:
+        raise AgencyError("Error polling completions")
+    
+    results = []
+    for completion in buffer[:count]:
+        data = None
+        if completion.status == STATUS_OK:
+            data = ctypes.string_at(completion.data, completion.length).decode('utf-8')
+            _lib.agency_free_context(ctypes.cast(completion.data, ctypes.c_char_p))
+        results.append((completion.ticket, completion.status, data))
+    
+    return results
+
+
+def completion_fd() -> int:
+    """
+    Get a descriptor that becomes readable when completions are queued.
+    
+    An event loop waits for it, reads it to clear it, then calls
+    poll_completions() with a zero timeout. The library owns the descriptor;
+    do not close it.
+    
+    Returns:
+        The descriptor.
+        
+    Raises:
+        AgencyError: If it could not be created.
+    """
+    fd = _lib.agency_completion_fd()
+    if fd < 0:
+        raise AgencyError("Error creating completion descriptor")
+    return fd
+
+
+def stream_resource(agency: str, kind: int, chunk_size: int = 0):
+    """
+    Stream an agency resource in fixed-size chunks.
+    
+    Args:
+        agency: The agency acronym (e.g., "HHS", "DOD").
+        kind: One of the RESOURCE_* constants.
+        chunk_size: Maximum bytes per chunk (0 selects the library default).
+        
+    Yields:
+        Successive chunks of the resource as bytes.
+        
+    Raises:
+        AgencyError: If the resource cannot be opened or read.
+    """
+    stream = _lib.agency_stream_open(agency.encode('utf-8'), kind, chunk_size)
+    if not stream:
+        raise AgencyError("Error opening resource stream")
+    
+    try:
+        chunk = ctypes.c_void_p()
+        length = ctypes.c_size_t()
+        while True:
+            result = _lib.agency_stream_next(stream, ctypes.byref(chunk), ctypes.byref(length))
+            if result == 0:
+                break
+            if result < 0:
+                raise AgencyError("Error reading resource stream")
+            yield ctypes.string_at(chunk, length.value)
+    finally:
+        _lib.agency_stream_close(stream)
+
+
+def match_issue(issue: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Find the theorems and domain topics an issue touches.
+    
+    The issue's title, description and affected areas are searched for every
+    theorem component and configured topic, ignoring ASCII case and treating
+    underscores as spaces.
+    
+    Args:
+        issue: The issue to match.
+        
+    Returns:
+        A dictionary with "theorems" (each with its domain, name and matching
+        components) and "topics" (each with its domain and topic).
+        
+    Raises:
+        AgencyError: If an error occurs.
+    """
+    try:
+        issue_bytes = json.dumps(issue).encode('utf-8')
+    except TypeError as e:
+        raise AgencyError(f"Error serializing issue: {e}")
+    
+    data = _lib.agency_match_issue(issue_bytes)
+    if not data:
+        raise AgencyError("Error matching issue")
+    text = ctypes.string_at(data).decode('utf-8')
+    _lib.agency_free_context(ctypes.cast(data, ctypes.c_char_p))
+    
+    return json.loads(text)
+
+
+def verify_issue_report(agency: str, issue: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Verify an issue and report every schema check and theorem evaluated.
+    
+    Args:
+        agency: The agency acronym (e.g., "HHS", "DOD").
+        issue: The issue to verify.
+        
+    Returns:
+        A dictionary with the verdict (1, 0 or -1), total_ns, error_offset
+        (None unless the JSON is malformed) and the rules evaluated, each with
+        its kind, name, checked field, outcome, time in ns and, for a failed
+        theorem, the missing keyword.
+        
+    Raises:
+        AgencyError: If an error occurs.
+    """
+    try:
+        issue_bytes = json.dumps(issue).encode('utf-8')
+    except TypeError as e:
+        raise AgencyError(f"Error serializing issue: {e}")
+    
+    capacity = 4096
+    while True:
+        buffer = ctypes.create_string_buffer(capacity)
+        length = ctypes.c_size_t()
+        status = _lib.agency_verify_issue_report(agency.encode('utf-8'), issue_bytes, REPORT_JSON,
+                                                 buffer, capacity, ctypes.byref(length))
+        if status == STATUS_OK:
+            return json.loads(buffer.raw[:length.value])
+        if length.value <= capacity:
+            raise AgencyError("Error verifying issue")
+        # Timings can lengthen the report on the next run
+        capacity = length.value + 256
+
+
+def verify_batch(agency: str, issues: Union[bytes, Iterable[Dict[str, Any]]], threads: int = 0) -> List[int]:
+    """
+    Verify many issues at once on the library's worker threads.
+    
+    Args:
+        agency: The agency acronym (e.g., "HHS", "DOD").
+        issues: NDJSON bytes (one issue per line) or an iterable of issues.
+        threads: Worker threads (0 uses one per online CPU).
+        
+    Returns:
+        One verdict per issue in input order: 1 if valid, 0 if invalid,
+        -1 if the issue could not be verified (e.g. malformed JSON).
+        
+    Raises:
+        AgencyError: If an error occurs.
+    """
+    if isinstance(issues, bytes):
+        ndjson = issues
+    else:
+        try:
+            ndjson = "".join(json.dumps(issue) + "\n" for issue in issues).encode('utf-8')
+        except TypeError as e:
+            raise AgencyError(f"Error serializing issue: {e}")
+    
+    # Every issue occupies at least one line
+    capacity = ndjson.count(b"\n") + 1
+    verdicts = (ctypes.c_int8 * capacity)()
+    summary = _BatchSummary()
+    result = _lib.agency_verify_batch(agency.encode('utf-8'), ndjson, len(ndjson), threads,
+                                      verdicts, capacity, ctypes.byref(summary))
+    if result != STATUS_OK:
+        raise AgencyError("Error verifying issue batch")
+    
+    return list(verdicts[:summary.issues])
+
+
+def verify_batch_fd(agency: str, fd: int, threads: int = 0) -> List[int]:
+    """
+    Verify NDJSON issues read from a file descriptor until end of file.
+    
+    The input is read and verified a window at a time, so it need not fit
+    in memory; the descriptor is not closed.
+    
+    Args:
+        agency: The agency acronym (e.g., "HHS", "DOD").
+        fd: Descriptor to read issues from, one per line.
+        threads: Worker threads (0 uses one per online CPU).
+        
+    Returns:
+        One verdict per issue in input order, as for verify_batch().
+        
+    Raises:
+        AgencyError: If an error occurs.
+    """
+    verdicts: List[int] = []
+    
+    def writer(run, count, user_data):
+        verdicts.extend(run[:count])
+        return 0
+    
+    summary = _BatchSummary()
+    result = _lib.agency_verify_batch_fd(agency.encode('utf-8'), fd, threads, _VERDICT_WRITER(writer),
+                                         None, ctypes.byref(summary))
+    if result != STATUS_OK or summary.issues != len(verdicts):
+        raise AgencyError("Error verifying issue batch")
+    
+    return verdicts
+
+
+def get_verdict_cache_stats() -> Dict[str, int]:
+    """
+    Get the size and hit counts of the verification verdict cache.
+    
+    Returns:
+        A dictionary of cache statistics.
+    """
+    stats = _VerdictCacheStats()
+    _lib.agency_get_verdict_cache_stats(ctypes.byref(stats))
+    return {name: getattr(stats, name) for name, _ in _VerdictCacheStats._fields_}
+
+
+def clear_verdict_cache() -> None:
+    """
+    Drop every cached verdict; the statistics are kept.
+    """
+    _lib.agency_verdict_cache_clear()
+
+
+def set_theorem_parallelism(threads: int = 0, cutoff: int = 0) -> None:
+    """
+    Configure parallel theorem evaluation within one issue.
+    
+    Args:
+        threads: Threads, the caller included, that may evaluate one issue
+            (0 uses one per online CPU, 1 always evaluates serially).
+        cutoff: Description length times keyword count, in bytes, from which
+            evaluation is parallel (0 uses THEOREM_CUTOFF_DEFAULT).
+    """
+    _lib.agency_set_theorem_parallelism(threads, cutoff)
+
+
+def get_theorem_pool_stats() -> Dict[str, int]:
+    """
+    Get the configuration and activity of parallel theorem evaluation.
+    
+    Returns:
+        A dictionary of pool statistics.
+    """
+    stats = _TheoremPoolStats()
+    _lib.agency_get_theorem_pool_stats(ctypes.byref(stats))
+    return {name: getattr(stats, name) for name, _ in _TheoremPoolStats._fields_}
+
+
+def reload_config() -> None:
+    """
+    Reload the configuration file while other threads keep reading.
+    
+    Calls in progress finish on the configuration they started with.
+    
+    Raises:
+        AgencyError: If the file could not be loaded; the current
+            configuration stays in place.
+    """
+    if _lib.agency_reload_config() != STATUS_OK:
+        raise AgencyError("Error reloading configuration")
+
+
+def get_reload_stats() -> Dict[str, int]:
+    """
+    Get the count of reloads and of replaced configurations freed.
+    
+    Returns:
+        A dictionary of reload statistics.
+    """
+    stats = _ReloadStats()
+    _lib.agency_get_reload_stats(ctypes.byref(stats))
+    return {name: getattr(stats, name) for name, _ in _ReloadStats._fields_}
+
+
+def set_allocator(alloc: Callable[[int], int], realloc: Callable[[int, int], int],
+                  free: Callable[[int], None]) -> None:
+    """
+    Route every allocation the library makes through the given functions.
+    
+    Must be called before any other function of this module; the library
+    calls the functions from its own threads as well as the caller's.
+    
+    Args:
+        alloc: Takes a size and returns the address of a new block, or 0.
+        realloc: Takes an address and a size and returns the resized block's
+            address, or 0.
+        free: Takes the address of a block to release.
+    
+    Raises:
+        AgencyError: If the library has already allocated.
+    """
+    global _allocator
+    hooks = (_ALLOC_FN(lambda size, ctx: alloc(size)),
+             _REALLOC_FN(lambda ptr, size, ctx: realloc(ptr, size)),
+             _FREE_FN(lambda ptr, ctx: free(ptr)))
+    if _lib.agency_set_allocator(*hooks, None) != STATUS_OK:
+        raise AgencyError("Error setting allocator")
+    _allocator = hooks
+
+
+def get_memory_stats() -> Dict[str, Any]:
+    """
+    Get the memory the library holds, by category.
+    
+    Cheap enough to call on every metrics scrape.
+    
+    Returns:
+        A dictionary with one entry per category ("snapshot", "indexes",
+        "resource_cache", "verification_cache", "arenas"), each a dictionary
+        of bytes, objects, limit and evictions, plus "total_bytes".
+    """
+    stats = _MemoryStats()
+    _lib.agency_get_memory_stats(ctypes.byref(stats))
+    result: Dict[str, Any] = {
+        name: {field: getattr(stats.categories[i], field) for field, _ in _MemoryUsage._fields_}
+        for i, name in enumerate(_MEMORY_CATEGORY_NAMES)
+    }
+    result["total_bytes"] = stats.total_bytes
+    return result
+
+
+def set_memory_limit(category: int, limit: int) -> None:
+    """
+    Cap the memory a cache may hold; above it, the cache evicts.
+    
+    Args:
+        category: MEMORY_RESOURCE_CACHE, MEMORY_VERIFICATION_CACHE or
+            MEMORY_ARENAS.
+        limit: The ceiling in bytes, or 0 to remove it.
+    
+    Raises:
+        AgencyError: If the category cannot be evicted.
+    """
+    if _lib.agency_set_memory_limit(category, limit) != STATUS_OK:
+        raise AgencyError("Error setting memory limit")
+
+
+def start_pressure_monitor(cgroup_dir: Optional[str] = None, interval_ms: int = 0) -> None:
+    """
+    Start shrinking the library's caches as the cgroup comes under memory pressure.
+    
+    Args:
+        cgroup_dir: The cgroup v2 directory to watch, or None for the
+            process's own. Any directory holding memory.pressure,
+            memory.current and memory.max files in the kernel's format works.
+        interval_ms: Time between checks, or 0 for one second.
+    
+    Raises:
+        AgencyError: If the monitor is already running or the directory has
+            no memory files.
+    """
+    directory = cgroup_dir.encode('utf-8') if cgroup_dir is not None else None
+    if _lib.agency_pressure_monitor_start(directory, interval_ms) != STATUS_OK:
+        raise AgencyError("Error starting pressure monitor")
+
+
+def stop_pressure_monitor() -> None:
+    """
+    Stop the pressure monitor and lift the ceilings it set.
+    """
+    _lib.agency_pressure_monitor_stop()
+
+
+def get_pressure_stats() -> Dict[str, Any]:
+    """
+    Get the pressure monitor's last reading and the level in force.
+    
+    Returns:
+        A dictionary of pressure statistics.
+    """
+    stats = _PressureStats()
+    _lib.agency_get_pressure_stats(ctypes.byref(stats))
+    return {name: getattr(stats, name) for name, _ in _PressureStats._fields_}
+
+
+def prefork_prepare() -> None:
+    """
+    Build everything the library would otherwise build on first use, so
+    that workers forked afterwards share it with the parent instead of each
+    building a private copy.
+    
+    Call it from the thread that forks, while no other thread is using the
+    library.
+    
+    Raises:
+        AgencyError: If any part could not be built.
+    """
+    if _lib.agency_prefork_prepare() != STATUS_OK:
+        raise AgencyError("Error preparing for fork")
+
+
+def numa_replicate(replicas: int = 0) -> None:
+    """
+    Keep a copy of the configuration snapshot, theorem models and issue
+    matcher on each NUMA node, read by the threads running there.
+    
+    Args:
+        replicas: Copies to keep: 0 for one per node, 1 to turn replication
+            off. More than there are nodes is allowed, for testing.
+    
+    Raises:
+        AgencyError: If replicas exceeds 16 or the copies could not be made.
+    """
+    if _lib.agency_numa_replicate(replicas) != STATUS_OK:
+        raise AgencyError("Error replicating across NUMA nodes")
+
+
+def numa_set_thread_node(node: int) -> None:
+    """
+    Have the calling thread read the copy of a given node, whatever CPU it runs on.
+    
+    Args:
+        node: The node, or -1 to follow the CPU again.
+    
+    Raises:
+        AgencyError: If the node is out of range.
+    """
+    if _lib.agency_numa_set_thread_node(node) != STATUS_OK:
+        raise AgencyError(f"Invalid NUMA node: {node}")
+
+
+def get_numa_stats() -> Dict[str, Any]:
+    """
+    Get the NUMA topology, the copies kept and the one the calling thread reads.
+    
+    Returns:
+        A dictionary of NUMA statistics.
+    """
+    stats = _NumaStats()
+    _lib.agency_get_numa_stats(ctypes.byref(stats))
+    return {name: getattr(stats, name) for name, _ in _NumaStats._fields_}
+
+
+def set_huge_pages(mode: int) -> None:
+    """
+    Back the configuration snapshot, indexes and preloaded resources with
+    huge pages, falling back to smaller ones where they cannot be had.
+    
+    Applies to what is built afterwards; reload_config() rebuilds the
+    snapshot.
+    
+    Args:
+        mode: HUGE_PAGES_OFF, HUGE_PAGES_THP or HUGE_PAGES_HUGETLB.
+    
+    Raises:
+        AgencyError: If the mode is unknown.
+    """
+    if _lib.agency_set_huge_pages(mode) != STATUS_OK:
+        raise AgencyError(f"Unknown huge page mode: {mode}")
+
+
+def get_huge_page_stats() -> Dict[str, Any]:
+    """
+    Get the huge-page mode and the memory mapped for huge pages.
+    
+    Returns:
+        A dictionary of huge-page statistics.
+    """
+    stats = _HugePageStats()
+    _lib.agency_get_huge_page_stats(ctypes.byref(stats))
+    return {name: getattr(stats, name) for name, _ in _HugePageStats._fields_}
+
+
+class DedupIndex:
+    """
+    An index of issues for finding near-duplicates.
+    
+    Issues whose title, description and affected areas share most of their
+    three-word shingles resolve to the first such issue indexed, their
+    canonical issue.
+    
+    The index only reports near-duplicates; verify each issue on its own
+    with verify_issue(), which already answers resubmitted issues from its
+    verdict cache.
+    """
+    
+    _ID_CAPACITY = 256
+    
+    def __init__(self, min_similarity: float = DEDUP_DEFAULT_SIMILARITY):
+        """
+        Create an empty index.
+        
+        Args:
+            min_similarity: Jaccard similarity of shingle sets, in (0, 1],
+                at which two issues are near-duplicates.
+            
+        Raises:
+            AgencyError: If min_similarity is out of range or an error occurs.
+        """
+        self._index = _lib.agency_dedup_create(min_similarity)
+        if not self._index:
+            raise AgencyError(f"Error creating near-duplicate index with similarity {min_similarity}")
+    
+    def close(self) -> None:
+        """Release the index."""
+        if self._index:
+            _lib.agency_dedup_destroy(self._index)
+            self._index = None
+    
+    def __del__(self):
+        self.close()
+    
+    def __enter__(self) -> 'DedupIndex':
+        return self
+    
+    def __exit__(self, *exc_info) -> None:
+        self.close()
+    
+    @staticmethod
+    def _serialize(issue: Dict[str, Any]) -> bytes:
+        try:
+            return json.dumps(issue).encode('utf-8')
+        except TypeError as e:
+            raise AgencyError(f"Error serializing issue: {e}")
+    
+    def add(self, issue: Dict[str, Any]) -> Tuple[bool, str]:
+        """
+        Look up an issue, indexing it if it has no near-duplicate yet.
+        
+        Args:
+            issue: The issue to look up.
+            
+        Returns:
+            Whether a near-duplicate was already indexed, and the id of the
+            canonical issue (the issue's own id when it is new).
+            
+        Raises:
+            AgencyError: If an error occurs.
+        """
+        canonical = ctypes.create_string_buffer(self._ID_CAPACITY)
+        result = _lib.agency_dedup_add(self._index, self._serialize(issue), canonical, self._ID_CAPACITY)
+        if result < 0:
+            raise AgencyError("Error indexing issue")
+        return result == 1, canonical.value.decode('utf-8', errors='replace')
+    
+    def stats(self) -> Dict[str, int]:
+        """
+        Get the size of the index and its lookup counts.
+        
+        Returns:
+            A dictionary of index statistics.
+        """
+        stats = _DedupStats()
+        _lib.agency_get_dedup_stats(self._index, ctypes.byref(stats))
+        return {name: getattr(stats, name) for name, _ in _DedupStats._fields_}
+
+
 class Agency:
     """
     A class representing an agency.
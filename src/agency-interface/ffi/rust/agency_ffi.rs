@@ -3,8 +3,9 @@
 //! This module provides Rust bindings for the agency FFI interface,
 //! allowing Rust code to interact with the agency system.
 
-use std::ffi::{c_char, CStr, CString};
-use std::os::raw::c_int;
+use std::ffi::{c_char, c_void, CStr, CString};
+use std::os::raw::{c_int, c_uint};
+use std::os::unix::io::RawFd;
 use std::ptr;
 use std::slice;
 use std::str;
@@ -20,6 +21,448 @@ extern "C" {
     fn agency_get_agencies_by_tier(tier: c_int) -> *mut c_char;
     fn agency_get_agencies_by_domain(domain: *const c_char) -> *mut c_char;
     fn agency_verify_issue(agency: *const c_char, issue_json: *const c_char) -> c_int;
+    fn agency_fetch_async(
+        agency: *const c_char,
+        kind: c_int,
+        callback: Option<unsafe extern "C" fn(*const RawCompletion)>,
+        user_data: *mut c_void,
+    ) -> u64;
+    fn agency_poll_completions(
+        completions: *mut RawCompletion,
+        max_completions: usize,
+        timeout_ms: c_int,
+    ) -> c_int;
+    fn agency_completion_fd() -> c_int;
+    fn agency_get_context_conditional(
+        agency: *const c_char,
+        known_hash: u64,
+        context: *mut *mut c_char,
+        current_hash: *mut u64,
+    ) -> c_int;
+    fn agency_get_resource_conditional(
+        agency: *const c_char,
+        kind: c_int,
+        known_hash: u64,
+        data: *mut *mut c_char,
+        length: *mut usize,
+        current_hash: *mut u64,
+    ) -> c_int;
+    fn agency_store_preload() -> c_int;
+    fn agency_store_get_compressed(
+        agency: *const c_char,
+        kind: c_int,
+        data: *mut *const c_void,
+        compressed_length: *mut usize,
+        raw_length: *mut usize,
+    ) -> c_int;
+    fn agency_get_store_stats(stats: *mut StoreStats);
+    fn agency_stream_open(agency: *const c_char, kind: c_int, chunk_size: usize) -> *mut c_void;
+    fn agency_stream_next(stream: *mut c_void, chunk: *mut *const c_char, length: *mut usize) -> c_int;
+    fn agency_stream_close(stream: *mut c_void);
+    fn agency_verify_batch(
+        agency: *const c_char,
+        ndjson: *const c_char,
+        length: usize,
+        num_threads: usize,
+        verdicts: *mut i8,
+        max_verdicts: usize,
+        summary: *mut BatchSummary,
+    ) -> c_int;
+    fn agency_get_verdict_cache_stats(stats: *mut VerdictCacheStats);
+    fn agency_verdict_cache_clear();
+    fn agency_match_issue(issue_json: *const c_char) -> *mut c_char;
+    fn agency_verify_issue_report(
+        agency: *const c_char,
+        issue_json: *const c_char,
+        format: c_int,
+        buffer: *mut c_char,
+        capacity: usize,
+        length: *mut usize,
+    ) -> c_int;
+    fn agency_dedup_create(min_similarity: f64) -> *mut c_void;
+    fn agency_dedup_destroy(index: *mut c_void);
+    fn agency_dedup_add(index: *mut c_void, issue_json: *const c_char, canonical_id: *mut c_char, capacity: usize) -> c_int;
+    fn agency_get_dedup_stats(index: *mut c_void, stats: *mut DedupStats);
+    fn agency_set_theorem_parallelism(num_threads: usize, cutoff: usize);
+    fn agency_get_theorem_pool_stats(stats: *mut TheoremPoolStats);
+    fn agency_reload_config() -> c_int;
+    fn agency_get_reload_stats(stats: *mut ReloadStats);
+    fn agency_get_memory_stats(stats: *mut MemoryStats);
+    fn agency_set_memory_limit(category: c_int, bytes: u64) -> c_int;
+    fn agency_pressure_monitor_start(cgroup_dir: *const c_char, interval_ms: c_uint) -> c_int;
+    fn agency_pressure_monitor_stop();
+    fn agency_get_pressure_stats(stats: *mut PressureStats);
+    fn agency_prefork_prepare() -> c_int;
+    fn agency_numa_replicate(replicas: c_uint) -> c_int;
+    fn agency_numa_set_thread_node(node: c_int) -> c_int;
+    fn agency_get_numa_stats(stats: *mut NumaStats);
+    fn agency_set_huge_pages(mode: c_int) -> c_int;
+    fn agency_get_huge_page_stats(stats: *mut HugePageStats);
+    fn agency_set_allocator(
+        alloc_fn: Option<AllocFn>,
+        realloc_fn: Option<ReallocFn>,
+        free_fn: Option<FreeFn>,
+        ctx: *mut c_void,
+    ) -> c_int;
+}
+
+/// Mirror of the C `agency_completion` struct.
+#[repr(C)]
+struct RawCompletion {
+    ticket: u64,
+    status: c_int,
+    data: *mut c_char,
+    length: usize,
+    user_data: *mut c_void,
+}
+
+/// Mirror of the C `agency_report_header` struct.
+#[repr(C)]
+#[derive(Clone, Copy)]
+struct RawReportHeader {
+    verdict: i32,
+    num_rules: u32,
+    total_ns: u64,
+    error_offset: u64,
+}
+
+/// Mirror of the C `agency_report_rule` struct.
+#[repr(C)]
+#[derive(Clone, Copy)]
+struct RawReportRule {
+    kind: u16,
+    outcome: u16,
+    name_offset: u32,
+    name_length: u32,
+    field_offset: u32,
+    field_length: u32,
+    detail_offset: u32,
+    detail_length: u32,
+    reserved: u32,
+    ns: u64,
+}
+
+const AGENCY_REPORT_BINARY: c_int = 0;
+
+const AGENCY_STATUS_OK: c_int = 0;
+const AGENCY_STATUS_NOT_FOUND: c_int = 1;
+const AGENCY_STATUS_NOT_MODIFIED: c_int = 2;
+
+/// Size and hit rates of the compressed resource store.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct StoreStats {
+    /// Resources held in the store.
+    pub resources: usize,
+    /// Total uncompressed size of those resources.
+    pub raw_bytes: usize,
+    /// Total compressed size.
+    pub compressed_bytes: usize,
+    /// Memory reserved by the store arena.
+    pub arena_bytes: usize,
+    /// Decompressed reads served from a thread's cache.
+    pub hot_hits: u64,
+    /// Decompressed reads that had to decompress.
+    pub hot_misses: u64,
+    /// Total time spent decompressing, in nanoseconds.
+    pub decompress_ns: u64,
+}
+
+/// Verdict counts for a batch verification.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct BatchSummary {
+    /// Issues read (non-blank lines).
+    pub issues: usize,
+    /// Issues with verdict 1.
+    pub valid: usize,
+    /// Issues with verdict 0.
+    pub invalid: usize,
+    /// Issues with verdict -1, e.g. malformed JSON.
+    pub errors: usize,
+}
+
+/// Size and hit counts of the verification verdict cache.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct VerdictCacheStats {
+    /// Verdicts the cache can hold.
+    pub capacity: usize,
+    /// Verifications answered from the cache.
+    pub hits: u64,
+    /// Verifications that had to run.
+    pub misses: u64,
+    /// Cached verdicts replaced by newer ones.
+    pub evictions: u64,
+    /// Times the cache was emptied after a reload.
+    pub invalidations: u64,
+}
+
+/// Size and lookup counts of a near-duplicate index.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct DedupStats {
+    /// Canonical issues indexed.
+    pub issues: usize,
+    /// Bands the signature is cut into.
+    pub bands: u32,
+    /// Signature positions per band.
+    pub rows: u32,
+    /// Issues looked up, including those then indexed.
+    pub lookups: u64,
+    /// Lookups that found a near-duplicate.
+    pub duplicates: u64,
+    /// Signatures compared, over all lookups.
+    pub candidates: u64,
+}
+
+/// Configuration and work counts of the pool evaluating large issues' theorems.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct TheoremPoolStats {
+    /// Threads evaluating one issue, the caller included.
+    pub threads: usize,
+    /// Description length times keyword count, in bytes, from which the pool is used.
+    pub cutoff: usize,
+    /// Verifications whose theorems ran on the pool.
+    pub parallel_verifications: u64,
+    /// Keyword and segment searches run on the pool.
+    pub items: u64,
+    /// Ranges of searches moved to an idle thread.
+    pub steals: u64,
+}
+
+/// Configuration reloads and the reclamation of the configurations they replaced.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct ReloadStats {
+    /// Successful `reload_config` calls.
+    pub reloads: u64,
+    /// Current reclamation epoch.
+    pub epoch: u64,
+    /// Snapshots, resource manifests and issue matchers replaced by a reload.
+    pub retired: u64,
+    /// Replaced objects freed, once no reader held them.
+    pub reclaimed: u64,
+}
+
+/// Memory held in one category.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct MemoryUsage {
+    /// Bytes held.
+    pub bytes: u64,
+    /// Objects held, as `MemoryCategory` describes them.
+    pub objects: u64,
+    /// Ceiling from `set_memory_limit`, or 0 for none.
+    pub limit: u64,
+    /// Objects dropped or shrunk to bring the category under its ceiling.
+    pub evictions: u64,
+}
+
+/// Memory held by the library, by category.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct MemoryStats {
+    /// Indexed by `MemoryCategory`.
+    pub categories: [MemoryUsage; 5],
+    /// Bytes held over all categories.
+    pub total_bytes: u64,
+}
+
+/// What the pressure monitor last read, and what it did.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct PressureStats {
+    /// Nonzero while the monitor runs.
+    pub running: i32,
+    /// The `PressureLevel` in force, as an integer.
+    pub level: i32,
+    /// Percentage of time some tasks stalled on memory, over the last 10 s.
+    pub some_avg10: f64,
+    /// Percentage of time all tasks stalled on memory, over the last 10 s.
+    pub full_avg10: f64,
+    /// memory.current of the cgroup.
+    pub current_bytes: u64,
+    /// memory.max of the cgroup, or 0 for none.
+    pub max_bytes: u64,
+    /// Readings taken.
+    pub checks: u64,
+    /// Times the level rose.
+    pub escalations: u64,
+}
+
+/// The NUMA topology and replication.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct NumaStats {
+    /// Memory nodes of the host.
+    pub nodes: c_uint,
+    /// Copies readers spread over; 1 when replication is off.
+    pub replicas: c_uint,
+    /// The copy the calling thread reads; 0 is the original.
+    pub replica: c_uint,
+    /// Memory held by the copies other than the originals.
+    pub replica_bytes: usize,
+}
+
+/// Huge-page backing of the library's large regions.
+#[repr(C)]
+#[derive(Debug, Default, Clone, Copy)]
+pub struct HugePageStats {
+    /// The `HugePages` mode in force, as an integer.
+    pub mode: i32,
+    /// Size of a huge page.
+    pub page_size: usize,
+    /// Memory of the regions mapped for huge pages.
+    pub huge_bytes: usize,
+    /// Regions that got less than the mode asked for.
+    pub fallbacks: u64,
+}
+
+/// Allocates `size` bytes, suitably aligned for any type, or returns null.
+pub type AllocFn = unsafe extern "C" fn(size: usize, ctx: *mut c_void) -> *mut c_void;
+
+/// Resizes a block from the allocator to `size` bytes, as `realloc` does.
+pub type ReallocFn = unsafe extern "C" fn(ptr: *mut c_void, size: usize, ctx: *mut c_void) -> *mut c_void;
+
+/// Releases a block from the allocator. Never called with null.
+pub type FreeFn = unsafe extern "C" fn(ptr: *mut c_void, ctx: *mut c_void);
+
+/// One schema check or theorem evaluated by `verify_issue_report`.
+#[derive(Debug, Clone)]
+pub struct ReportRule {
+    /// What the rule checked.
+    pub kind: RuleKind,
+    /// Whether the rule passed, or the check that failed.
+    pub outcome: RuleOutcome,
+    /// The field or theorem name.
+    pub name: String,
+    /// The field the rule checks.
+    pub field: String,
+    /// The keyword a failed theorem lacks, else empty.
+    pub detail: String,
+    /// Time spent on the rule, in nanoseconds.
+    pub ns: u64,
+}
+
+/// Every rule evaluated while verifying one issue.
+#[derive(Debug, Clone)]
+pub struct VerificationReport {
+    /// 1 if the issue is valid, 0 if invalid, -1 if it cannot be verified.
+    pub verdict: i32,
+    /// Time spent verifying, in nanoseconds.
+    pub total_ns: u64,
+    /// Byte at which the JSON stops being valid, if it is malformed.
+    pub error_offset: Option<u64>,
+    /// Rules in evaluation order.
+    pub rules: Vec<ReportRule>,
+}
+
+/// What a reported rule checked.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RuleKind {
+    /// A schema check on one top-level field.
+    Field,
+    /// A domain theorem applied to the description.
+    Theorem,
+}
+
+/// Outcome of a reported rule.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RuleOutcome {
+    /// The rule holds.
+    Passed,
+    /// A required field is absent.
+    Missing,
+    /// The field's value has a type the schema excludes.
+    WrongType,
+    /// The string is shorter or longer than allowed.
+    BadLength,
+    /// The string is not one of the allowed values.
+    NotInEnum,
+    /// The array has too few or too many elements.
+    BadItems,
+    /// A theorem keyword is not in the description.
+    KeywordMissing,
+}
+
+impl RuleOutcome {
+    fn from_raw(outcome: u16) -> Result<RuleOutcome, AgencyError> {
+        match outcome {
+            0 => Ok(RuleOutcome::Passed),
+            1 => Ok(RuleOutcome::Missing),
+            2 => Ok(RuleOutcome::WrongType),
+            3 => Ok(RuleOutcome::BadLength),
+            4 => Ok(RuleOutcome::NotInEnum),
+            5 => Ok(RuleOutcome::BadItems),
+            6 => Ok(RuleOutcome::KeywordMissing),
+            _ => Err(AgencyError::ConversionError),
+        }
+    }
+}
+
+/// Kinds of file-backed resources an agency can provide.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum ResourceKind {
+    /// The agency's issue finder module.
+    IssueFinder = 0,
+    /// The agency's research connector module.
+    ResearchConnector = 1,
+    /// The agency's ASCII art banner.
+    AsciiArt = 2,
+}
+
+/// Kinds of memory the library holds.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum MemoryCategory {
+    /// Configuration snapshots, current and replaced; objects are agencies.
+    Snapshot = 0,
+    /// Manifest, matcher, theorems and dedup indexes; objects are entries.
+    Indexes = 1,
+    /// Resource store and decompressed copies; objects are both.
+    ResourceCache = 2,
+    /// Verdict cache; objects are verdicts.
+    VerificationCache = 3,
+    /// Response arenas and scratch buffers; objects are both.
+    Arenas = 4,
+}
+
+/// Memory pressure, as graded by the pressure monitor.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum PressureLevel {
+    /// The caches keep their own ceilings.
+    None = 0,
+    /// The verdict cache and arenas shrink.
+    Moderate = 1,
+    /// Only what calls are using is kept, besides a small verdict cache.
+    High = 2,
+    /// Only what calls are using is kept.
+    Critical = 3,
+}
+
+/// What backs the snapshot, index and resource store regions.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum HugePages {
+    /// Small pages from the allocator.
+    Off = 0,
+    /// Transparent huge pages, requested with madvise().
+    Thp = 1,
+    /// Reserved hugetlbfs pages, else transparent ones.
+    Hugetlb = 2,
+}
+
+/// The result of an asynchronous fetch.
+#[derive(Debug)]
+pub struct Completion {
+    /// The ticket returned by `fetch_async`.
+    pub ticket: u64,
+    /// The resource contents, or the reason the fetch failed.
+    pub result: Result<String, AgencyError>,
 }
 
 /// Error type for agency operations.
@@ -189,6 +632,652 @@ pub fn verify_issue(agency: &str, issue_json: &str) -> Result<bool, AgencyError>
     }
 }
 
+/// Find the theorems and domain topics an issue touches.
+///
+/// The issue's title, description and affected areas are searched for every
+/// theorem component and configured topic, ignoring ASCII case and treating
+/// underscores as spaces.
+///
+/// # Arguments
+///
+/// * `issue_json` - JSON-formatted issue data.
+///
+/// # Returns
+///
+/// A Result containing the matches as a JSON string, or an error.
+pub fn match_issue(issue_json: &str) -> Result<String, AgencyError> {
+    let issue_cstr = CString::new(issue_json).map_err(|_| AgencyError::InvalidArgument)?;
+    let matches_ptr = unsafe { agency_match_issue(issue_cstr.as_ptr()) };
+    c_string_to_string(matches_ptr)
+}
+
+/// Verify an issue and report every schema check and theorem evaluated.
+///
+/// Every theorem is evaluated, even after one fails, so the report shows the
+/// cost of each.
+///
+/// # Arguments
+///
+/// * `agency` - The agency acronym (e.g., "HHS", "DOD").
+/// * `issue_json` - JSON-formatted issue data.
+///
+/// # Returns
+///
+/// A Result containing the report, or an error.
+pub fn verify_issue_report(agency: &str, issue_json: &str) -> Result<VerificationReport, AgencyError> {
+    let agency_cstr = CString::new(agency).map_err(|_| AgencyError::InvalidArgument)?;
+    let issue_cstr = CString::new(issue_json).map_err(|_| AgencyError::InvalidArgument)?;
+
+    // The binary report's size does not depend on its timings
+    let mut buffer = vec![0u64; 512];
+    let mut length = 0usize;
+    loop {
+        let capacity = buffer.len() * 8;
+        let status = unsafe {
+            agency_verify_issue_report(
+                agency_cstr.as_ptr(),
+                issue_cstr.as_ptr(),
+                AGENCY_REPORT_BINARY,
+                buffer.as_mut_ptr() as *mut c_char,
+                capacity,
+                &mut length,
+            )
+        };
+        if status == AGENCY_STATUS_OK {
+            break;
+        }
+        if length <= capacity {
+            return Err(AgencyError::OperationError);
+        }
+        buffer = vec![0u64; (length + 7) / 8];
+    }
+
+    let bytes = unsafe { slice::from_raw_parts(buffer.as_ptr() as *const u8, length) };
+    let text = |offset: u32, length: u32| -> Result<String, AgencyError> {
+        let range = offset as usize..offset as usize + length as usize;
+        str::from_utf8(bytes.get(range).ok_or(AgencyError::ConversionError)?)
+            .map(str::to_owned)
+            .map_err(|_| AgencyError::ConversionError)
+    };
+
+    // The buffer is 8-byte aligned, as the header and rule table require
+    let header = unsafe { *(buffer.as_ptr() as *const RawReportHeader) };
+    let raw_rules = unsafe {
+        slice::from_raw_parts(
+            (buffer.as_ptr() as *const RawReportHeader).add(1) as *const RawReportRule,
+            header.num_rules as usize,
+        )
+    };
+
+    let mut rules = Vec::with_capacity(raw_rules.len());
+    for raw in raw_rules {
+        rules.push(ReportRule {
+            kind: if raw.kind == 0 { RuleKind::Field } else { RuleKind::Theorem },
+            outcome: RuleOutcome::from_raw(raw.outcome)?,
+            name: text(raw.name_offset, raw.name_length)?,
+            field: text(raw.field_offset, raw.field_length)?,
+            detail: text(raw.detail_offset, raw.detail_length)?,
+            ns: raw.ns,
+        });
+    }
+
+    Ok(VerificationReport {
+        verdict: header.verdict,
+        total_ns: header.total_ns,
+        error_offset: if header.error_offset == u64::MAX { None } else { Some(header.error_offset) },
+        rules,
+    })
+}
+
+/// Convert the outcome of a conditional fetch into `(data, hash)`.
+fn conditional_result(status: c_int, data: *mut c_char, hash: u64) -> Result<(Option<String>, u64), AgencyError> {
+    match status {
+        AGENCY_STATUS_OK => Ok((Some(c_string_to_string(data)?), hash)),
+        AGENCY_STATUS_NOT_MODIFIED => Ok((None, hash)),
+        AGENCY_STATUS_NOT_FOUND => Err(AgencyError::AgencyNotFound),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Verify NDJSON issues, one per line, on the library's worker threads.
+///
+/// # Arguments
+///
+/// * `agency` - The agency acronym (e.g., "HHS", "DOD").
+/// * `ndjson` - Newline-delimited issue JSON.
+/// * `threads` - Worker threads, or 0 for one per online CPU.
+///
+/// # Returns
+///
+/// A Result containing one verdict per issue in input order (1 valid,
+/// 0 invalid, -1 not verifiable) and the verdict counts, or an error.
+pub fn verify_batch(agency: &str, ndjson: &[u8], threads: usize) -> Result<(Vec<i8>, BatchSummary), AgencyError> {
+    let agency_cstr = CString::new(agency).map_err(|_| AgencyError::InvalidArgument)?;
+
+    // Every issue occupies at least one line
+    let mut verdicts = vec![0i8; ndjson.iter().filter(|&&b| b == b'\n').count() + 1];
+    let mut summary = BatchSummary::default();
+    let status = unsafe {
+        agency_verify_batch(
+            agency_cstr.as_ptr(),
+            ndjson.as_ptr() as *const c_char,
+            ndjson.len(),
+            threads,
+            verdicts.as_mut_ptr(),
+            verdicts.len(),
+            &mut summary,
+        )
+    };
+
+    match status {
+        AGENCY_STATUS_OK => {
+            verdicts.truncate(summary.issues);
+            Ok((verdicts, summary))
+        }
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Get the size and hit counts of the verification verdict cache.
+pub fn get_verdict_cache_stats() -> VerdictCacheStats {
+    let mut stats = VerdictCacheStats::default();
+    unsafe { agency_get_verdict_cache_stats(&mut stats) };
+    stats
+}
+
+/// Drop every cached verdict; the statistics are kept.
+pub fn clear_verdict_cache() {
+    unsafe { agency_verdict_cache_clear() };
+}
+
+/// Description length times the domain's keyword count, in bytes, from
+/// which one issue's theorems are evaluated on the pool.
+pub const DEFAULT_THEOREM_CUTOFF: usize = 1 << 20;
+
+/// Set the threads that evaluate one large issue's theorems (0 for one per
+/// online CPU, 1 to stay serial) and the cutoff (0 for `DEFAULT_THEOREM_CUTOFF`).
+pub fn set_theorem_parallelism(num_threads: usize, cutoff: usize) {
+    unsafe { agency_set_theorem_parallelism(num_threads, cutoff) };
+}
+
+/// Get the configuration and work counts of the theorem pool.
+pub fn get_theorem_pool_stats() -> TheoremPoolStats {
+    let mut stats = TheoremPoolStats::default();
+    unsafe { agency_get_theorem_pool_stats(&mut stats) };
+    stats
+}
+
+/// Reload the configuration file while other threads keep reading.
+///
+/// Calls in progress finish on the configuration they started with; on
+/// error the current configuration stays in place.
+pub fn reload_config() -> Result<(), AgencyError> {
+    match unsafe { agency_reload_config() } {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Get the reload count and how many replaced configurations have been freed.
+pub fn get_reload_stats() -> ReloadStats {
+    let mut stats = ReloadStats::default();
+    unsafe { agency_get_reload_stats(&mut stats) };
+    stats
+}
+
+/// Get the memory the library holds, by category.
+///
+/// Reads counters only, so it is cheap enough for every metrics scrape.
+pub fn get_memory_stats() -> MemoryStats {
+    let mut stats = MemoryStats::default();
+    unsafe { agency_get_memory_stats(&mut stats) };
+    stats
+}
+
+/// Cap the memory a cache may hold; above it, the cache evicts.
+///
+/// Only `ResourceCache`, `VerificationCache` and `Arenas` take a limit; a
+/// limit of 0 removes the cap.
+pub fn set_memory_limit(category: MemoryCategory, bytes: u64) -> Result<(), AgencyError> {
+    match unsafe { agency_set_memory_limit(category as c_int, bytes) } {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Start shrinking the caches as the cgroup comes under memory pressure.
+///
+/// A background thread reads memory.pressure, memory.current and memory.max
+/// from `cgroup_dir` every `interval_ms` (0 for one second); `None` selects
+/// the process's own cgroup.
+pub fn start_pressure_monitor(cgroup_dir: Option<&str>, interval_ms: u32) -> Result<(), AgencyError> {
+    let dir_cstr = match cgroup_dir {
+        Some(dir) => Some(CString::new(dir).map_err(|_| AgencyError::InvalidArgument)?),
+        None => None,
+    };
+    let dir_ptr = dir_cstr.as_ref().map_or(ptr::null(), |dir| dir.as_ptr());
+
+    match unsafe { agency_pressure_monitor_start(dir_ptr, interval_ms as c_uint) } {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Stop the pressure monitor and lift the ceilings it set.
+pub fn stop_pressure_monitor() {
+    unsafe { agency_pressure_monitor_stop() };
+}
+
+/// Get the pressure monitor's last reading and level.
+pub fn get_pressure_stats() -> PressureStats {
+    let mut stats = PressureStats::default();
+    unsafe { agency_get_pressure_stats(&mut stats) };
+    stats
+}
+
+/// Build everything the library would otherwise build on first use, so
+/// that worker processes forked afterwards share it with the parent instead
+/// of each building a private copy.
+///
+/// Call it from the thread that forks, while no other thread is using the
+/// library.
+pub fn prefork_prepare() -> Result<(), AgencyError> {
+    match unsafe { agency_prefork_prepare() } {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Keep a copy of the configuration snapshot, theorem models and issue
+/// matcher on each NUMA node, read by the threads running there.
+///
+/// `replicas` of 0 keeps one per node and 1 turns replication off; more
+/// than there are nodes is allowed, for testing.
+pub fn numa_replicate(replicas: u32) -> Result<(), AgencyError> {
+    match unsafe { agency_numa_replicate(replicas as c_uint) } {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Have the calling thread read the copy of a given node, whatever CPU it
+/// runs on, or follow its CPU again with -1.
+pub fn numa_set_thread_node(node: i32) -> Result<(), AgencyError> {
+    match unsafe { agency_numa_set_thread_node(node as c_int) } {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::InvalidArgument),
+    }
+}
+
+/// Get the NUMA topology and replication statistics.
+pub fn get_numa_stats() -> NumaStats {
+    let mut stats = NumaStats::default();
+    unsafe { agency_get_numa_stats(&mut stats) };
+    stats
+}
+
+/// Back the configuration snapshot, indexes and preloaded resources built
+/// from now on with huge pages, falling back to smaller ones where they
+/// cannot be had. `reload_config` rebuilds the snapshot.
+pub fn set_huge_pages(mode: HugePages) -> Result<(), AgencyError> {
+    match unsafe { agency_set_huge_pages(mode as c_int) } {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::InvalidArgument),
+    }
+}
+
+/// Get the huge-page mode and the memory it backs.
+pub fn get_huge_page_stats() -> HugePageStats {
+    let mut stats = HugePageStats::default();
+    unsafe { agency_get_huge_page_stats(&mut stats) };
+    stats
+}
+
+/// Route every allocation the library makes, including the strings it
+/// returns, through the given functions.
+///
+/// Must be called before any other function of this module; once the library
+/// has allocated, the allocator can no longer change.
+///
+/// # Safety
+///
+/// The functions must behave as `malloc`, `realloc` and `free` do, be safe to
+/// call from any thread, and `ctx` must stay valid for as long as the library
+/// is in use.
+pub unsafe fn set_allocator(
+    alloc_fn: AllocFn,
+    realloc_fn: ReallocFn,
+    free_fn: FreeFn,
+    ctx: *mut c_void,
+) -> Result<(), AgencyError> {
+    match agency_set_allocator(Some(alloc_fn), Some(realloc_fn), Some(free_fn), ctx) {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Get the context information for an agency unless the caller's copy is current.
+///
+/// # Arguments
+///
+/// * `agency` - The agency acronym (e.g., "HHS", "DOD").
+/// * `known_hash` - The hash returned by a previous call, or 0.
+///
+/// # Returns
+///
+/// A Result containing `(context, hash)`, where `context` is `None` when
+/// `known_hash` is current, or an error.
+pub fn get_context_if_modified(agency: &str, known_hash: u64) -> Result<(Option<String>, u64), AgencyError> {
+    let agency_cstr = CString::new(agency).map_err(|_| AgencyError::InvalidArgument)?;
+    let mut data: *mut c_char = ptr::null_mut();
+    let mut hash: u64 = 0;
+    let status = unsafe {
+        agency_get_context_conditional(agency_cstr.as_ptr(), known_hash, &mut data, &mut hash)
+    };
+    conditional_result(status, data, hash)
+}
+
+/// Get a file-backed agency resource unless the caller's copy is current.
+///
+/// # Arguments
+///
+/// * `agency` - The agency acronym (e.g., "HHS", "DOD").
+/// * `kind` - The resource to fetch.
+/// * `known_hash` - The hash returned by a previous call, or 0.
+///
+/// # Returns
+///
+/// A Result containing `(data, hash)`, where `data` is `None` when
+/// `known_hash` is current, or an error.
+pub fn get_resource_if_modified(agency: &str, kind: ResourceKind, known_hash: u64) -> Result<(Option<String>, u64), AgencyError> {
+    let agency_cstr = CString::new(agency).map_err(|_| AgencyError::InvalidArgument)?;
+    let mut data: *mut c_char = ptr::null_mut();
+    let mut length: usize = 0;
+    let mut hash: u64 = 0;
+    let status = unsafe {
+        agency_get_resource_conditional(agency_cstr.as_ptr(), kind as c_int, known_hash, &mut data, &mut length, &mut hash)
+    };
+    conditional_result(status, data, hash)
+}
+
+/// Load every file-backed resource into the compressed in-memory store.
+///
+/// # Returns
+///
+/// A Result indicating whether every resource was stored.
+pub fn store_preload() -> Result<(), AgencyError> {
+    match unsafe { agency_store_preload() } {
+        AGENCY_STATUS_OK => Ok(()),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Get a stored resource as an LZ4 block, suitable for forwarding as-is.
+///
+/// # Arguments
+///
+/// * `agency` - The agency acronym (e.g., "HHS", "DOD").
+/// * `kind` - The resource to fetch.
+///
+/// # Returns
+///
+/// A Result containing the compressed bytes and the decompressed length, or an error.
+pub fn get_compressed_resource(agency: &str, kind: ResourceKind) -> Result<(&'static [u8], usize), AgencyError> {
+    let agency_cstr = CString::new(agency).map_err(|_| AgencyError::InvalidArgument)?;
+    let mut data: *const c_void = ptr::null();
+    let mut compressed_length: usize = 0;
+    let mut raw_length: usize = 0;
+    let status = unsafe {
+        agency_store_get_compressed(agency_cstr.as_ptr(), kind as c_int, &mut data, &mut compressed_length, &mut raw_length)
+    };
+
+    match status {
+        // Stored blobs live for the rest of the process
+        AGENCY_STATUS_OK => Ok((unsafe { slice::from_raw_parts(data as *const u8, compressed_length) }, raw_length)),
+        AGENCY_STATUS_NOT_FOUND => Err(AgencyError::AgencyNotFound),
+        _ => Err(AgencyError::OperationError),
+    }
+}
+
+/// Get the size and hit rates of the compressed resource store.
+pub fn get_store_stats() -> StoreStats {
+    let mut stats = StoreStats::default();
+    unsafe { agency_get_store_stats(&mut stats) };
+    stats
+}
+
+/// Submit an asynchronous fetch of an agency resource.
+///
+/// The read runs on the library's I/O threads; collect the result with
+/// `poll_completions`.
+///
+/// # Arguments
+///
+/// * `agency` - The agency acronym (e.g., "HHS", "DOD").
+/// * `kind` - The resource to fetch.
+///
+/// # Returns
+///
+/// A Result containing the ticket identifying the request, or an error.
+pub fn fetch_async(agency: &str, kind: ResourceKind) -> Result<u64, AgencyError> {
+    let agency_cstr = CString::new(agency).map_err(|_| AgencyError::InvalidArgument)?;
+    let ticket = unsafe {
+        agency_fetch_async(agency_cstr.as_ptr(), kind as c_int, None, ptr::null_mut())
+    };
+
+    if ticket == 0 {
+        return Err(AgencyError::OperationError);
+    }
+
+    Ok(ticket)
+}
+
+/// Collect finished asynchronous fetches.
+///
+/// # Arguments
+///
+/// * `max_completions` - Maximum number of results to return.
+/// * `timeout_ms` - How long to wait when none are ready (0 returns at once,
+///   negative waits indefinitely).
+///
+/// # Returns
+///
+/// A Result containing the completed fetches, or an error.
+pub fn poll_completions(max_completions: usize, timeout_ms: i32) -> Result<Vec<Completion>, AgencyError> {
+    let mut raw: Vec<RawCompletion> = Vec::with_capacity(max_completions);
+    let count = unsafe {
+        agency_poll_completions(raw.as_mut_ptr(), max_completions, timeout_ms)
+    };
+
+    if count < 0 {
+        return Err(AgencyError::OperationError);
+    }
+
+    unsafe { raw.set_len(count as usize) };
+
+    let completions = raw
+        .into_iter()
+        .map(|completion| {
+            let result = match completion.status {
+                AGENCY_STATUS_OK => unsafe {
+                    let bytes = slice::from_raw_parts(completion.data as *const u8, completion.length);
+                    let text = str::from_utf8(bytes)
+                        .map(str::to_owned)
+                        .map_err(|_| AgencyError::ConversionError);
+                    agency_free_context(completion.data);
+                    text
+                },
+                AGENCY_STATUS_NOT_FOUND => Err(AgencyError::AgencyNotFound),
+                _ => Err(AgencyError::OperationError),
+            };
+
+            Completion {
+                ticket: completion.ticket,
+                result,
+            }
+        })
+        .collect();
+
+    Ok(completions)
+}
+
+/// Get a descriptor that becomes readable when completions are queued.
+///
+/// An event loop waits for it, reads it to clear it, then calls
+/// `poll_completions` with a zero timeout, so no thread waits inside the
+/// library. The library owns the descriptor; do not close it.
+///
+/// # Returns
+///
+/// A Result containing the descriptor, or an error.
+pub fn completion_fd() -> Result<RawFd, AgencyError> {
+    let fd = unsafe { agency_completion_fd() };
+
+    if fd < 0 {
+        return Err(AgencyError::OperationError);
+    }
+
+    Ok(fd)
+}
+
+/// A chunked stream over an agency resource.
+///
+/// Memory use is bounded by the chunk size regardless of the resource size.
+pub struct ResourceStream {
+    handle: *mut c_void,
+}
+
+impl ResourceStream {
+    /// Open a stream over an agency resource.
+    ///
+    /// # Arguments
+    ///
+    /// * `agency` - The agency acronym (e.g., "HHS", "DOD").
+    /// * `kind` - The resource to stream.
+    /// * `chunk_size` - Maximum bytes per chunk (0 selects the library default).
+    ///
+    /// # Returns
+    ///
+    /// A Result containing the stream, or an error.
+    pub fn open(agency: &str, kind: ResourceKind, chunk_size: usize) -> Result<Self, AgencyError> {
+        let agency_cstr = CString::new(agency).map_err(|_| AgencyError::InvalidArgument)?;
+        let handle = unsafe { agency_stream_open(agency_cstr.as_ptr(), kind as c_int, chunk_size) };
+
+        if handle.is_null() {
+            return Err(AgencyError::OperationError);
+        }
+
+        Ok(ResourceStream { handle })
+    }
+
+    /// Read the next chunk.
+    ///
+    /// # Returns
+    ///
+    /// A Result containing the next chunk, `None` at end of stream, or an error.
+    /// The chunk borrows the stream's buffer until the next call.
+    pub fn next_chunk(&mut self) -> Result<Option<&[u8]>, AgencyError> {
+        let mut chunk: *const c_char = ptr::null();
+        let mut length: usize = 0;
+        let result = unsafe { agency_stream_next(self.handle, &mut chunk, &mut length) };
+
+        match result {
+            0 => Ok(None),
+            1 => Ok(Some(unsafe { slice::from_raw_parts(chunk as *const u8, length) })),
+            _ => Err(AgencyError::OperationError),
+        }
+    }
+}
+
+impl Drop for ResourceStream {
+    fn drop(&mut self) {
+        unsafe { agency_stream_close(self.handle) };
+    }
+}
+
+/// Similarity threshold suiting most near-duplicate indexes.
+pub const DEFAULT_DEDUP_SIMILARITY: f64 = 0.8;
+
+/// Buffer size for canonical issue ids.
+const DEDUP_ID_CAPACITY: usize = 256;
+
+/// An index of issues for finding near-duplicates.
+///
+/// Issues whose title, description and affected areas share most of their
+/// three-word shingles resolve to the first such issue indexed, their
+/// canonical issue.
+///
+/// The index only reports near-duplicates; verify each issue on its own
+/// with `verify_issue`, whose verdict cache already answers resubmitted
+/// issues.
+pub struct DedupIndex {
+    handle: *mut c_void,
+}
+
+// The library locks the index internally
+unsafe impl Send for DedupIndex {}
+unsafe impl Sync for DedupIndex {}
+
+impl DedupIndex {
+    /// Create an empty index.
+    ///
+    /// # Arguments
+    ///
+    /// * `min_similarity` - Jaccard similarity of shingle sets, in (0, 1], at
+    ///   which two issues are near-duplicates.
+    ///
+    /// # Returns
+    ///
+    /// A Result containing the index, or an error.
+    pub fn new(min_similarity: f64) -> Result<Self, AgencyError> {
+        let handle = unsafe { agency_dedup_create(min_similarity) };
+
+        if handle.is_null() {
+            return Err(AgencyError::InvalidArgument);
+        }
+
+        Ok(DedupIndex { handle })
+    }
+
+    /// Look an issue up, indexing it if no near-duplicate is indexed yet.
+    ///
+    /// # Returns
+    ///
+    /// A Result containing whether a near-duplicate was already indexed and
+    /// the canonical issue's id, or an error.
+    pub fn add(&self, issue_json: &str) -> Result<(bool, String), AgencyError> {
+        let issue_cstr = CString::new(issue_json).map_err(|_| AgencyError::InvalidArgument)?;
+        let mut canonical = [0 as c_char; DEDUP_ID_CAPACITY];
+        let result = unsafe {
+            agency_dedup_add(self.handle, issue_cstr.as_ptr(), canonical.as_mut_ptr(), DEDUP_ID_CAPACITY)
+        };
+
+        if result < 0 {
+            return Err(AgencyError::OperationError);
+        }
+        Ok((result == 1, canonical_id(&canonical)?))
+    }
+
+    /// Get the index's size and lookup counts.
+    pub fn stats(&self) -> DedupStats {
+        let mut stats = DedupStats::default();
+        unsafe { agency_get_dedup_stats(self.handle, &mut stats) };
+        stats
+    }
+}
+
+impl Drop for DedupIndex {
+    fn drop(&mut self) {
+        unsafe { agency_dedup_destroy(self.handle) };
+    }
+}
+
+/// Read a canonical id the library wrote into a buffer.
+fn canonical_id(buffer: &[c_char]) -> Result<String, AgencyError> {
+    let cstr = unsafe { CStr::from_ptr(buffer.as_ptr()) };
+    cstr.to_str().map(str::to_owned).map_err(|_| AgencyError::ConversionError)
+}
+
 /// A struct representing an agency.
 #[derive(Debug, Clone)]
 pub struct Agency {
@@ -0,0 +1,41 @@
+"""
+Shared setup for the FFI tests.
+
+Tests that need the library request the agency_ffi fixture, or ffi_dir when
+they only run it in a subprocess; either skips the test when
+libagency_ffi.so has not been built.
+"""
+
+import os
+import sys
+
+import pytest
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+@pytest.fixture(scope="session")
+def ffi_dir():
+    """The ffi directory, which holds the built library."""
+    if not os.path.exists(os.path.join(FFI_DIR, "c", "libagency_ffi.so")):
+        pytest.skip("libagency_ffi.so is not built")
+    return FFI_DIR
+
+
+@pytest.fixture(scope="session")
+def agency_ffi(ffi_dir):
+    """The Python bindings, with the library loaded."""
+    python_dir = os.path.join(ffi_dir, "python")
+    sys.path.insert(0, python_dir)
+    try:
+        import agency_ffi
+    except OSError as e:
+        sys.path.remove(python_dir)
+        pytest.skip(f"libagency_ffi.so cannot be loaded: {e}")
+
+    # The library resolves its data directories relative to the ffi directory
+    cwd = os.getcwd()
+    os.chdir(ffi_dir)
+    yield agency_ffi
+    os.chdir(cwd)
+    sys.path.remove(python_dir)
@@ -0,0 +1,98 @@
+"""
+With an allocator installed, every block the library allocates, returns
+and frees goes through it.
+
+The allocator is installed in a subprocess, since it must come before the
+library's first allocation. Skipped when libagency_ffi.so has not been
+built.
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+import pytest
+
+
+ALLOCATOR_SCRIPT = """
+import ctypes, json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+
+libc = ctypes.CDLL(None)
+libc.malloc.restype = ctypes.c_void_p
+libc.malloc.argtypes = [ctypes.c_size_t]
+libc.realloc.restype = ctypes.c_void_p
+libc.realloc.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+libc.free.argtypes = [ctypes.c_void_p]
+
+live = set()
+counts = {{"alloc": 0, "realloc": 0, "free": 0, "foreign": 0}}
+
+def alloc(size):
+    ptr = libc.malloc(size)
+    counts["alloc"] += 1
+    live.add(ptr)
+    return ptr
+
+def realloc(ptr, size):
+    counts["realloc"] += 1
+    if ptr is not None and ptr not in live:
+        counts["foreign"] += 1
+    new = libc.realloc(ptr, size)
+    if new:
+        live.discard(ptr)
+        live.add(new)
+    return new
+
+def free(ptr):
+    counts["free"] += 1
+    if ptr not in live:
+        counts["foreign"] += 1
+    live.discard(ptr)
+    libc.free(ptr)
+
+agency_ffi.set_allocator(alloc, realloc, free)
+
+issue = {{"id": 1, "title": "t", "description": "patient data", "affected_areas": ["a"]}}
+agency_ffi.get_all_agencies()
+agency_ffi.verify_issue("HHS", issue)
+agency_ffi.match_issue(issue)
+agency_ffi.get_issue_finder("HHS")
+
+# A returned string is the allocator's, and freeing it hands it back
+context = agency_ffi._lib.agency_get_context(b"HHS")
+returned = context in live
+frees = counts["free"]
+agency_ffi._lib.agency_free_context(ctypes.cast(context, ctypes.c_char_p))
+handed_back = counts["free"] == frees + 1 and context not in live
+
+try:
+    agency_ffi.set_allocator(alloc, realloc, free)
+    locked = False
+except agency_ffi.AgencyError:
+    locked = True
+print(json.dumps([counts, returned, handed_back, locked]))
+"""
+
+
+def test_allocations_go_through_the_installed_allocator(ffi_dir):
+    script = ALLOCATOR_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"))
+    result = subprocess.run([sys.executable, "-c", script], cwd=ffi_dir,
+                            capture_output=True, text=True, check=True)
+    counts, returned, handed_back, locked = json.loads(result.stdout)
+
+    assert counts["alloc"] > 0 and counts["free"] > 0
+    # Nothing the allocator did not hand out comes back to it
+    assert counts["foreign"] == 0
+    assert returned and handed_back
+    assert locked
+
+
+def test_allocator_is_fixed_once_the_library_has_allocated(agency_ffi):
+    agency_ffi.get_all_agencies()
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.set_allocator(lambda size: 0, lambda ptr, size: 0, lambda ptr: None)
+    # The allocator in place keeps working
+    assert agency_ffi.get_context("HHS")["acronym"] == "HHS"
@@ -0,0 +1,92 @@
+"""
+An asynchronous fetch must complete exactly once, under its own ticket,
+with the same data a synchronous getter returns, whether its completion
+is polled for or delivered to a callback.
+
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import ctypes
+import os
+import select
+import threading
+
+import pytest
+
+
+@pytest.fixture
+def getters(agency_ffi):
+    return {
+        agency_ffi.RESOURCE_ISSUE_FINDER: agency_ffi.get_issue_finder,
+        agency_ffi.RESOURCE_RESEARCH_CONNECTOR: agency_ffi.get_research_connector,
+        agency_ffi.RESOURCE_ASCII_ART: agency_ffi.get_ascii_art,
+    }
+
+
+def _collect(agency_ffi, tickets):
+    results = {}
+    while len(results) < len(tickets):
+        for ticket, status, data in agency_ffi.poll_completions(8, 5000):
+            assert ticket in tickets and ticket not in results
+            results[ticket] = (status, data)
+    return results
+
+
+def test_polled_fetches_match_the_getters(agency_ffi, getters):
+    requests = {}
+    for agency in ("HHS", "DOD", "EPA"):
+        for kind in getters:
+            requests[agency_ffi.fetch_async(agency, kind)] = (agency, kind)
+    assert 0 not in requests and len(requests) == 9
+
+    for ticket, (status, data) in _collect(agency_ffi, requests).items():
+        agency, kind = requests[ticket]
+        assert status == agency_ffi.STATUS_OK
+        assert data == getters[kind](agency)
+
+    # Nothing is left over
+    assert agency_ffi.poll_completions(8, 0) == []
+
+
+def test_missing_resource_completes_not_found(agency_ffi):
+    tickets = {agency_ffi.fetch_async(agency, agency_ffi.RESOURCE_ISSUE_FINDER) for agency in ("XYZ", "X" * 100)}
+    assert _collect(agency_ffi, tickets) == {ticket: (agency_ffi.STATUS_NOT_FOUND, None) for ticket in tickets}
+
+
+def test_callback_receives_the_completion_instead_of_the_queue(agency_ffi):
+    received = []
+    done = threading.Event()
+
+    # agency_completion_fn
+    @ctypes.CFUNCTYPE(None, ctypes.POINTER(agency_ffi._Completion))
+    def on_complete(completion):
+        c = completion.contents
+        data = ctypes.string_at(c.data, c.length).decode("utf-8") if c.status == agency_ffi.STATUS_OK else None
+        if c.data:
+            agency_ffi._lib.agency_free_context(ctypes.cast(c.data, ctypes.c_char_p))
+        received.append((c.ticket, c.status, data, c.user_data))
+        done.set()
+
+    ticket = agency_ffi._lib.agency_fetch_async(b"HHS", agency_ffi.RESOURCE_ASCII_ART,
+                                                ctypes.cast(on_complete, ctypes.c_void_p), ctypes.c_void_p(42))
+    assert ticket != 0
+    assert done.wait(5)
+    assert received == [(ticket, agency_ffi.STATUS_OK, agency_ffi.get_ascii_art("HHS"), 42)]
+    assert agency_ffi.poll_completions(8, 0) == []
+
+
+def test_descriptor_wakes_a_poller_that_does_not_wait(agency_ffi):
+    fd = agency_ffi.completion_fd()
+    assert agency_ffi.completion_fd() == fd
+    # Clear wakeups left by earlier tests
+    if select.select([fd], [], [], 0)[0]:
+        os.read(fd, 8)
+
+    ticket = agency_ffi.fetch_async("HHS", agency_ffi.RESOURCE_ASCII_ART)
+    completions = []
+    while not completions:
+        assert select.select([fd], [], [], 5)[0]
+        os.read(fd, 8)
+        completions = agency_ffi.poll_completions(8, 0)
+    assert completions == [(ticket, agency_ffi.STATUS_OK, agency_ffi.get_ascii_art("HHS"))]
+    assert not select.select([fd], [], [], 0)[0]
@@ -0,0 +1,108 @@
+"""
+A conditional fetch must send the data with its content hash when the
+caller's hash is stale, and only the hash when it is current, for agency
+contexts and file-backed resources alike.
+
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+import pytest
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+INTERFACE_DIR = os.path.dirname(FFI_DIR)
+
+AGENCIES = ("HHS", "DOD", "EPA")
+
+# Fetches a template while the test rewrites it, one step per input line
+CHANGE_SCRIPT = """
+import json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+known = 0
+for line in sys.stdin:
+    data, current = agency_ffi.get_resource_if_modified("HHS", agency_ffi.RESOURCE_ASCII_ART, known)
+    print(json.dumps([data, current, agency_ffi.get_resource_if_modified("HHS", agency_ffi.RESOURCE_ASCII_ART, current)[0]]), flush=True)
+    known = current
+"""
+
+
+def test_context_is_sent_only_when_stale(agency_ffi):
+    hashes = set()
+    for agency in AGENCIES:
+        context, current = agency_ffi.get_context_if_modified(agency)
+        assert json.loads(context) == agency_ffi.get_context(agency)
+        assert current != 0
+        hashes.add(current)
+
+        assert agency_ffi.get_context_if_modified(agency, current) == (None, current)
+        assert agency_ffi.get_context_if_modified(agency, current ^ 1) == (context, current)
+    assert len(hashes) == len(AGENCIES)
+
+
+def test_resource_is_sent_only_when_stale(agency_ffi):
+    getters = {
+        agency_ffi.RESOURCE_ISSUE_FINDER: agency_ffi.get_issue_finder,
+        agency_ffi.RESOURCE_RESEARCH_CONNECTOR: agency_ffi.get_research_connector,
+        agency_ffi.RESOURCE_ASCII_ART: agency_ffi.get_ascii_art,
+    }
+    for agency in AGENCIES:
+        for kind, getter in getters.items():
+            data, current = agency_ffi.get_resource_if_modified(agency, kind)
+            assert data == getter(agency)
+            assert agency_ffi.get_resource_if_modified(agency, kind, current) == (None, current)
+            assert agency_ffi.get_resource_if_modified(agency, kind, current + 1) == (data, current)
+
+
+def test_hash_is_stable_across_reloads_of_the_same_file(agency_ffi):
+    _, before = agency_ffi.get_context_if_modified("HHS")
+    agency_ffi.reload_config()
+    assert agency_ffi.get_context_if_modified("HHS", before) == (None, before)
+
+
+def test_unknown_agency_is_not_found(agency_ffi):
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.get_context_if_modified("XYZ")
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.get_resource_if_modified("XYZ", agency_ffi.RESOURCE_ISSUE_FINDER)
+
+
+def test_hash_follows_the_file_when_it_changes(ffi_dir, tmp_path):
+    with open(os.path.join(INTERFACE_DIR, "config", "agency_data.json")) as f:
+        config = json.load(f)
+    (tmp_path / "config").mkdir()
+    (tmp_path / "config" / "agency_data.json").write_text(json.dumps(config))
+    (tmp_path / "templates").mkdir()
+    (tmp_path / "ffi").mkdir()
+    art = tmp_path / "templates" / config["agencies"][0]["ascii_template"]
+    art.write_text("first")
+
+    script = CHANGE_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"))
+    process = subprocess.Popen([sys.executable, "-c", script], cwd=tmp_path / "ffi", text=True,
+                               stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+
+    def fetch():
+        process.stdin.write("\n")
+        process.stdin.flush()
+        return json.loads(process.stdout.readline())
+
+    results = [fetch()]
+    # A longer file, then one of the same length whose mtime alone moves
+    art.write_text("second")
+    results.append(fetch())
+    art.write_text("third!")
+    os.utime(art, ns=(art.stat().st_mtime_ns + 10**9,) * 2)
+    results.append(fetch())
+    results.append(fetch())
+    process.stdin.close()
+    assert process.wait() == 0
+
+    assert [data for data, _, _ in results] == ["first", "second", "third!", None]
+    hashes = [current for _, current, _ in results]
+    assert len(set(hashes[:3])) == 3 and hashes[3] == hashes[2]
+    # Each hash, sent back at once, is current
+    assert all(again is None for _, _, again in results)
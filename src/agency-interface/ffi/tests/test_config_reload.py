@@ -0,0 +1,180 @@
+"""
+Reloading the configuration swaps in new agency data, issue schemas,
+resources and matched topics while readers keep running, and frees the
+data it replaces.
+
+The reload that changes the configuration runs in a subprocess against a
+copy of it. Skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import subprocess
+import sys
+import threading
+import time
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+INTERFACE_DIR = os.path.dirname(FFI_DIR)
+
+RELOAD_SCRIPT = """
+import json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+
+config_path, changed = sys.argv[1], json.loads(sys.argv[2])
+with open("../prover_integration/theorem_models/healthcare_theorems.json") as f:
+    text = " ".join(t["statement"] for t in json.load(f))
+issue = {{"id": 1, "title": "t", "description": text, "affected_areas": ["a"]}}
+try:
+    art = agency_ffi.get_ascii_art("NEW")
+except agency_ffi.AgencyError:
+    art = None
+before = (agency_ffi.get_all_agencies(), agency_ffi.verify_issue("HHS", issue), art)
+
+with open(config_path, "w") as f:
+    json.dump(changed, f)
+agency_ffi.reload_config()
+after = (agency_ffi.get_all_agencies(), agency_ffi.verify_issue("HHS", issue),
+         agency_ffi.get_context("NEW")["name"], agency_ffi.get_ascii_art("NEW"))
+
+# A file that does not parse leaves the configuration in place
+with open(config_path, "w") as f:
+    f.write("{{")
+try:
+    agency_ffi.reload_config()
+    failed = False
+except agency_ffi.AgencyError:
+    failed = True
+print(json.dumps([before, after, failed, agency_ffi.get_all_agencies() == after[0]]))
+"""
+
+
+def test_reload_applies_a_changed_configuration(ffi_dir, tmp_path):
+    with open(os.path.join(INTERFACE_DIR, "config", "agency_data.json")) as f:
+        config = json.load(f)
+    (tmp_path / "config").mkdir()
+    config_path = tmp_path / "config" / "agency_data.json"
+    config_path.write_text(json.dumps(config))
+    (tmp_path / "prover_integration").symlink_to(os.path.join(INTERFACE_DIR, "prover_integration"))
+    (tmp_path / "ffi").mkdir()
+    (tmp_path / "templates").mkdir()
+    (tmp_path / "templates" / "custom.txt").write_text("NEW ART")
+
+    # The new agency appears with its template override, and HHS issues now
+    # need a severity the test issue lacks
+    new_agency = {"acronym": "NEW", "name": "New Agency", "ascii_template": "custom.txt"}
+    changed = dict(config, agencies=config["agencies"] + [new_agency],
+                   issue_schemas={"agencies": {"HHS": {"severity": {"required": True}}}})
+    script = RELOAD_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"))
+    result = subprocess.run([sys.executable, "-c", script, str(config_path), json.dumps(changed)],
+                            cwd=tmp_path / "ffi", capture_output=True, text=True, check=True)
+    before, after, failed, kept = json.loads(result.stdout)
+
+    assert after[0] == before[0] + ["NEW"]
+    assert after[2] == "New Agency"
+    assert before[2] is None and after[3] == "NEW ART"
+    # The same issue, and its cached verdict, fail the reloaded schema
+    assert before[1] is True
+    assert after[1] is False
+    assert failed and kept
+
+
+MATCH_SCRIPT = """
+import json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+
+config_path, changed = sys.argv[1], json.loads(sys.argv[2])
+issue = {{"id": 1, "title": "Public health", "description": "quantum widgets", "affected_areas": []}}
+before = agency_ffi.match_issue(issue)["topics"]
+with open(config_path, "w") as f:
+    json.dump(changed, f)
+agency_ffi.reload_config()
+print(json.dumps([before, agency_ffi.match_issue(issue)["topics"]]))
+"""
+
+
+def test_reload_rebuilds_the_issue_matcher(ffi_dir, tmp_path):
+    with open(os.path.join(INTERFACE_DIR, "config", "agency_data.json")) as f:
+        config = json.load(f)
+    (tmp_path / "config").mkdir()
+    config_path = tmp_path / "config" / "agency_data.json"
+    config_path.write_text(json.dumps(config))
+    (tmp_path / "prover_integration").symlink_to(os.path.join(INTERFACE_DIR, "prover_integration"))
+    (tmp_path / "ffi").mkdir()
+
+    changed = dict(config, topics={"healthcare": ["quantum widgets"]})
+    script = MATCH_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"))
+    result = subprocess.run([sys.executable, "-c", script, str(config_path), json.dumps(changed)],
+                            cwd=tmp_path / "ffi", capture_output=True, text=True, check=True)
+    before, after = json.loads(result.stdout)
+
+    assert before == [{"domain": "healthcare", "topic": "public health"}]
+    assert after == [{"domain": "healthcare", "topic": "quantum widgets"}]
+
+
+def test_replaced_snapshots_are_freed(agency_ffi):
+    # After one reload there is an issue matcher to replace, whether or not one was used
+    agency_ffi.reload_config()
+    before = agency_ffi.get_reload_stats()
+    for _ in range(5):
+        agency_ffi.reload_config()
+    after = agency_ffi.get_reload_stats()
+
+    assert after["reloads"] == before["reloads"] + 5
+    # Each reload replaces a snapshot, a resource manifest and an issue matcher
+    assert after["retired"] == before["retired"] + 15
+    # No reader is inside, so every replaced object is freed at once
+    assert after["reclaimed"] == after["retired"]
+    assert after["epoch"] > before["epoch"]
+
+
+def test_readers_run_through_reloads(agency_ffi):
+    issue = {"id": 1, "title": "Public health", "description": "d", "affected_areas": []}
+
+    def read():
+        return agency_ffi.get_all_agencies(), agency_ffi.get_context("HHS"), agency_ffi.match_issue(issue)
+
+    expected = read()
+    stop = threading.Event()
+    mismatches = []
+
+    def reader():
+        while not stop.is_set():
+            if read() != expected:
+                mismatches.append(threading.get_ident())
+
+    threads = [threading.Thread(target=reader) for _ in range(8)]
+    for thread in threads:
+        thread.start()
+    for _ in range(50):
+        agency_ffi.reload_config()
+    stop.set()
+    for thread in threads:
+        thread.join()
+
+    assert mismatches == []
+    agency_ffi.reload_config()
+    stats = agency_ffi.get_reload_stats()
+    assert stats["reclaimed"] == stats["retired"]
+
+
+def test_batch_waiting_for_input_does_not_hold_back_reclamation(agency_ffi):
+    read_fd, write_fd = os.pipe()
+    result = []
+    batch = threading.Thread(target=lambda: result.append(agency_ffi.verify_batch_fd("HHS", read_fd, 2)))
+    batch.start()
+    try:
+        # Less than a window, so the batch goes back to read() for more
+        os.write(write_fd, b'{"id": 1}\n')
+        time.sleep(0.2)
+        agency_ffi.reload_config()
+        stats = agency_ffi.get_reload_stats()
+        assert stats["reclaimed"] == stats["retired"]
+    finally:
+        os.write(write_fd, b'{"id": 2}\n')
+        os.close(write_fd)
+        batch.join()
+        os.close(read_fd)
+    assert result == [[0, 0]]
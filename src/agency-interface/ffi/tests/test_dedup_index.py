@@ -0,0 +1,105 @@
+"""
+Near-duplicate issues must resolve to the first one indexed, and only they.
+
+The test is skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import random
+
+import pytest
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+with open(os.path.join(os.path.dirname(FFI_DIR), "prover_integration", "theorem_models",
+                       "healthcare_theorems.json")) as f:
+    HEALTHCARE_TEXT = " ".join(t["statement"] for t in json.load(f))
+
+VOCABULARY = ["w%d" % i for i in range(5000)] + ["patient", "privacy", "data", "protection", "security"]
+
+
+def _issue(rng, issue_id, words=120):
+    return {
+        "id": issue_id,
+        "title": " ".join(rng.choice(VOCABULARY) for _ in range(6)),
+        "description": " ".join(rng.choice(VOCABULARY) for _ in range(words)),
+        "affected_areas": [rng.choice(VOCABULARY), rng.choice(VOCABULARY)],
+    }
+
+
+def _edited(issue, issue_id, rng):
+    """The issue with one description word replaced."""
+    words = issue["description"].split()
+    words[rng.randrange(len(words))] = "edited"
+    return dict(issue, id=issue_id, description=" ".join(words))
+
+
+def test_case_and_punctuation_do_not_matter(agency_ffi):
+    rng = random.Random(1)
+    issue = _issue(rng, "A-1")
+    restyled = dict(issue, id="A-2", title=issue["title"].upper() + "!",
+                    description=issue["description"].replace(" ", ",  "))
+
+    with agency_ffi.DedupIndex(1.0) as index:
+        assert index.add(issue) == (False, "A-1")
+        assert index.add(restyled) == (True, "A-1")
+        assert index.stats()["issues"] == 1
+
+
+def test_small_edits_match_and_different_issues_do_not(agency_ffi):
+    rng = random.Random(2)
+    with agency_ffi.DedupIndex() as index:
+        originals = [_issue(rng, "I-%d" % i) for i in range(50)]
+        for issue in originals:
+            assert index.add(issue) == (False, issue["id"])
+
+        for i, issue in enumerate(originals):
+            assert index.add(_edited(issue, "E-%d" % i, rng)) == (True, issue["id"])
+        assert index.stats()["issues"] == len(originals)
+
+
+def test_issue_without_id_is_not_indexed(agency_ffi):
+    rng = random.Random(3)
+    issue = _issue(rng, "x")
+    del issue["id"]
+    with agency_ffi.DedupIndex() as index:
+        assert index.add(issue) == (False, "")
+        assert index.add(issue) == (False, "")
+        assert index.stats()["issues"] == 0
+
+
+def test_malformed_issue_is_an_error(agency_ffi):
+    with agency_ffi.DedupIndex() as index:
+        assert agency_ffi._lib.agency_dedup_add(index._index, b'{"id": 1, "title": ', None, 0) == -1
+    for similarity in (0.0, 1.5):
+        with pytest.raises(agency_ffi.AgencyError):
+            agency_ffi.DedupIndex(similarity)
+
+
+def test_near_duplicates_are_reported_not_verified(agency_ffi):
+    valid = {"id": "V", "title": "records", "description": HEALTHCARE_TEXT, "affected_areas": ["health"]}
+    reworded = dict(valid, id="V2", description=HEALTHCARE_TEXT.replace("interoperable", "compatible"))
+    assert agency_ffi.verify_issue("HHS", valid)
+
+    # The index reports a near-duplicate of a valid issue that fails
+    # verification on its own text, and leaves verifying it to the caller
+    with agency_ffi.DedupIndex() as index:
+        assert index.add(valid) == (False, "V")
+        assert index.add(reworded) == (True, "V")
+        assert index.stats()["issues"] == 1
+    assert not agency_ffi.verify_issue("HHS", reworded)
+    assert agency_ffi.verify_issue("HHS", valid)
+
+
+def test_lookups_are_sublinear(agency_ffi):
+    rng = random.Random(4)
+    with agency_ffi.DedupIndex() as index:
+        for i in range(2000):
+            index.add(_issue(rng, "C-%d" % i))
+        stats = index.stats()
+
+    assert stats["issues"] == 2000
+    assert stats["duplicates"] == 0
+    # A linear scan would compare about 2000 * 2000 / 2 pairs
+    assert stats["candidates"] < 2000 * 10
@@ -0,0 +1,78 @@
+"""
+A library whose snapshot, indexes and resource store lie in huge pages
+must answer exactly as one in small pages, and must still work when the
+huge pages it asks for cannot be had.
+
+Each mode runs in a subprocess, so that everything is built under it.
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+import pytest
+
+
+THP_ENABLED = "/sys/kernel/mm/transparent_hugepage/enabled"
+
+# Builds everything under a mode, then reads it all back
+HUGE_PAGES_SCRIPT = """
+import json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+
+agency_ffi.set_huge_pages({mode!r})
+agency_ffi.prefork_prepare()
+
+issue = {{"id": 1, "title": "Privacy", "description": "patient privacy and data protection",
+          "affected_areas": ["privacy", "national security"]}}
+agencies = agency_ffi.get_all_agencies()
+results = [agencies,
+           [agency_ffi.get_context(agency) for agency in agencies],
+           [agency_ffi.verify_issue(agency, issue) for agency in agencies],
+           [agency_ffi.get_agencies_by_tier(tier) for tier in range(5)],
+           agency_ffi.get_agencies_by_domain("health"),
+           agency_ffi.match_issue(issue)]
+print(json.dumps([results, agency_ffi.get_huge_page_stats()]))
+"""
+
+
+def _run(ffi_dir, mode):
+    script = HUGE_PAGES_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"), mode=mode)
+    result = subprocess.run([sys.executable, "-c", script], cwd=ffi_dir,
+                            capture_output=True, text=True, check=True)
+    return json.loads(result.stdout)
+
+
+def _thp_supported():
+    # madvise() accepts MADV_HUGEPAGE whenever the kernel has THP, even set to never
+    return os.path.exists(THP_ENABLED)
+
+
+def test_huge_pages_answer_as_small_pages(ffi_dir, agency_ffi):
+    small, stats = _run(ffi_dir, agency_ffi.HUGE_PAGES_OFF)
+    assert stats["huge_bytes"] == 0
+
+    huge, stats = _run(ffi_dir, agency_ffi.HUGE_PAGES_THP)
+    assert huge == small
+    if _thp_supported():
+        assert stats["huge_bytes"] >= stats["page_size"] and stats["fallbacks"] == 0
+    else:
+        assert stats["huge_bytes"] == 0 and stats["fallbacks"] > 0
+
+
+def test_hugetlb_falls_back_when_no_pages_are_reserved(ffi_dir, agency_ffi):
+    small, _ = _run(ffi_dir, agency_ffi.HUGE_PAGES_OFF)
+    huge, stats = _run(ffi_dir, agency_ffi.HUGE_PAGES_HUGETLB)
+    assert huge == small
+    assert stats["mode"] == agency_ffi.HUGE_PAGES_HUGETLB
+    # Every region is accounted for, in hugetlbfs pages or after a fallback
+    assert stats["huge_bytes"] > 0 or stats["fallbacks"] > 0
+
+
+def test_unknown_mode_is_rejected(agency_ffi):
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.set_huge_pages(3)
+    assert agency_ffi.get_huge_page_stats()["mode"] == agency_ffi.HUGE_PAGES_OFF
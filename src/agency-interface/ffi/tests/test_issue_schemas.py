@@ -0,0 +1,134 @@
+"""
+Per-agency and per-domain issue schemas declared in the configuration.
+
+Each case runs the library in a subprocess against a copy of the
+configuration with extra schema declarations, since the configuration is
+loaded once per process. Skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+INTERFACE_DIR = os.path.dirname(FFI_DIR)
+
+with open(os.path.join(INTERFACE_DIR, "prover_integration", "theorem_models", "healthcare_theorems.json")) as f:
+    HEALTHCARE_TEXT = " ".join(t["statement"] for t in json.load(f))
+
+SCHEMAS = {
+    "default": {
+        "id": {"required": True, "type": ["string", "integer"]},
+        "title": {"required": True, "type": "string", "min_length": 3, "max_length": 10},
+        "description": {"required": True, "type": "string"},
+        "affected_areas": {"required": True, "type": "array", "min_items": 1, "max_items": 2},
+    },
+    "domains": {
+        "healthcare": {"severity": {"required": True, "enum": ["low", "high"]}},
+    },
+    "agencies": {
+        "hrsa.ai": {"title": {"type": "string"}},
+    },
+}
+
+VERIFY_SCRIPT = """
+import json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+for agency, issue in json.load(sys.stdin):
+    print(agency_ffi.verify_issue(agency, issue))
+"""
+
+
+REPORT_SCRIPT = """
+import json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+for agency, issue in json.load(sys.stdin):
+    print(json.dumps(agency_ffi.verify_issue_report(agency, issue)))
+"""
+
+
+# Reports on issue text as given, which json.dumps could not produce
+RAW_REPORT_SCRIPT = """
+import ctypes, json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+for agency, text in json.load(sys.stdin):
+    buffer = ctypes.create_string_buffer(1 << 16)
+    length = ctypes.c_size_t()
+    agency_ffi._lib.agency_verify_issue_report(agency.encode(), text.encode(), agency_ffi.REPORT_JSON,
+                                               buffer, len(buffer), ctypes.byref(length))
+    print(buffer.raw[:length.value].decode())
+"""
+
+
+def _run(ffi_dir, tmp_path, script, cases, schemas):
+    """Run a script over (agency, issue) pairs with schemas added to the configuration."""
+    with open(os.path.join(INTERFACE_DIR, "config", "agency_data.json")) as f:
+        config = json.load(f)
+    config["issue_schemas"] = schemas
+
+    (tmp_path / "config").mkdir()
+    (tmp_path / "config" / "agency_data.json").write_text(json.dumps(config))
+    (tmp_path / "prover_integration").symlink_to(os.path.join(INTERFACE_DIR, "prover_integration"))
+    (tmp_path / "ffi").mkdir()
+
+    script = script.format(python_dir=os.path.join(ffi_dir, "python"))
+    result = subprocess.run([sys.executable, "-c", script], cwd=tmp_path / "ffi", input=json.dumps(cases),
+                            capture_output=True, text=True, check=True)
+    return result.stdout.splitlines()
+
+
+def _verify(ffi_dir, tmp_path, cases):
+    """Verify (agency, issue) pairs with SCHEMAS added to the configuration."""
+    return [line == "True" for line in _run(ffi_dir, tmp_path, VERIFY_SCRIPT, cases, SCHEMAS)]
+
+
+def _issue(**overrides):
+    issue = {"id": 7, "title": "Outage", "description": HEALTHCARE_TEXT,
+             "affected_areas": ["records"], "severity": "high"}
+    issue.update(overrides)
+    return {k: v for k, v in issue.items() if v is not None}
+
+
+def test_schema_checks(ffi_dir, tmp_path):
+    cases = [
+        ("HHS", _issue()),
+        ("HHS", _issue(id=7.5)),
+        ("HHS", _issue(title="ab")),
+        ("HHS", _issue(title="x" * 11)),
+        ("HHS", _issue(title="ééé")),
+        ("HHS", _issue(affected_areas=[])),
+        ("HHS", _issue(affected_areas=["a", "b", "c"])),
+        ("HHS", _issue(severity="medium")),
+        ("HHS", _issue(severity=None)),
+        ("hrsa.ai", _issue(title=None)),
+        ("hrsa.ai", _issue(title=5)),
+    ]
+    expected = [True, False, False, False, True, False, False, False, False, True, False]
+    assert _verify(ffi_dir, tmp_path, cases) == expected
+
+
+def test_full_schema_without_description_reports_theorems(ffi_dir, tmp_path):
+    # No room is left for the description the theorems read, so they read ""
+    fields = {f"f{i}": {"required": True, "type": "integer"} for i in range(64)}
+    issue = {f"f{i}": i for i in range(64)}
+    report, = map(json.loads, _run(ffi_dir, tmp_path, REPORT_SCRIPT, [("HHS", issue)], {"default": fields}))
+    theorems = [rule for rule in report["rules"] if rule["kind"] == "theorem"]
+    assert report["verdict"] == 0 and theorems
+    assert all(rule["field"] == "" and rule["outcome"] == "keyword_missing" for rule in theorems)
+
+
+def test_repeated_key_checks_its_last_value(ffi_dir, tmp_path):
+    # As json.loads does, the last value of a repeated key is the one checked
+    issue = '{{"id": 7, "title": {}, "title": {}, "description": "d", "affected_areas": ["a"]}}'
+    cases = [("HHS", issue.format('"Outage"', 5)), ("HHS", issue.format(5, '"Outage"'))]
+    failed, passed = map(json.loads, _run(ffi_dir, tmp_path, RAW_REPORT_SCRIPT, cases, SCHEMAS))
+
+    def titles(report):
+        return [rule["outcome"] for rule in report["rules"] if rule["kind"] == "field" and rule["name"] == "title"]
+
+    assert failed["verdict"] == 0 and titles(failed) == ["wrong_type"]
+    assert titles(passed) == ["passed"]
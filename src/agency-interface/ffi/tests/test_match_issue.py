@@ -0,0 +1,92 @@
+"""
+Issue matching must find exactly the components and topics a scan would.
+
+The automaton's results are compared with a plain substring search over the
+theorem models and configured topics. The test is skipped when
+libagency_ffi.so has not been built.
+"""
+
+import glob
+import json
+import os
+import random
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+MODELS_DIR = os.path.join(FFI_DIR, "..", "prover_integration", "theorem_models")
+CONFIG_FILE = os.path.join(FFI_DIR, "..", "config", "agency_data.json")
+
+
+def _fold(text):
+    return text.lower().replace("_", " ")
+
+
+def _theorems():
+    theorems = []
+    for path in sorted(glob.glob(os.path.join(MODELS_DIR, "*_theorems.json"))):
+        domain = os.path.basename(path)[:-len("_theorems.json")]
+        with open(path) as f:
+            for theorem in json.load(f):
+                theorems.append((domain, theorem.get("name", "unknown"), theorem.get("components", [])))
+    return theorems
+
+
+def _topics():
+    with open(CONFIG_FILE) as f:
+        return [(domain, topic) for domain, topics in json.load(f).get("topics", {}).items() for topic in topics]
+
+
+def _expected(issue):
+    texts = [issue.get("title"), issue.get("description")] + list(issue.get("affected_areas", []))
+    texts = [_fold(text) for text in texts if isinstance(text, str)]
+
+    def found(pattern):
+        return any(_fold(pattern) in text for text in texts)
+
+    theorems = {(domain, name): [c for c in components if found(c)] for domain, name, components in _theorems()}
+    return ({key: value for key, value in theorems.items() if value},
+            sorted(key for key in _topics() if found(key[1])))
+
+
+def _actual(agency_ffi, issue):
+    matches = agency_ffi.match_issue(issue)
+    return ({(t["domain"], t["name"]): t["components"] for t in matches["theorems"]},
+            sorted((t["domain"], t["topic"]) for t in matches["topics"]))
+
+
+def _raw_topics(agency_ffi, issue_json):
+    data = agency_ffi._lib.agency_match_issue(issue_json)
+    text = agency_ffi.ctypes.string_at(data).decode()
+    agency_ffi._lib.agency_free_context(agency_ffi.ctypes.cast(data, agency_ffi.ctypes.c_char_p))
+    return json.loads(text)["topics"]
+
+
+def test_matches_follow_substring_search(agency_ffi):
+    patterns = [c for _, _, components in _theorems() for c in components] + [t for _, t in _topics()]
+    assert patterns
+    rng = random.Random(38)
+    for _ in range(300):
+        words = [rng.choice(patterns) for _ in range(rng.randint(0, 4))] + ["filler", "x"]
+        rng.shuffle(words)
+        words = [w.upper() if rng.random() < 0.2 else w.replace("_", " ") if rng.random() < 0.3 else w
+                 for w in words]
+        issue = {
+            "id": 1,
+            "title": " ".join(words[:2]),
+            "description": "".join(words[2:4]),
+            "affected_areas": words[4:] + [7, {"nested": rng.choice(patterns)}],
+        }
+        assert _actual(agency_ffi, issue) == _expected(issue), issue
+
+
+def test_matches_stay_inside_fields(agency_ffi):
+    theorems, topics = _actual(agency_ffi, {"title": "public", "description": "health"})
+    assert ("healthcare", "public health") not in topics
+    assert (_raw_topics(agency_ffi, rb'{"title": "Public\u0020Health"}')
+            == _raw_topics(agency_ffi, b'{"title": "public health"}'))
+    assert _raw_topics(agency_ffi, b'{"title": "public health"}')
+    assert _actual(agency_ffi, {"other": "public health"}) == ({}, [])
+
+
+def test_malformed_issue_is_rejected(agency_ffi):
+    assert agency_ffi._lib.agency_match_issue(b'{"title": "public health"') is None
@@ -0,0 +1,103 @@
+"""
+The pressure monitor must shrink the caches as pressure rises and restore
+them as it falls, driven here by a synthetic cgroup directory.
+
+The test is skipped when libagency_ffi.so has not been built.
+"""
+
+import os
+import time
+
+import pytest
+
+
+FULL_VERDICT_CACHE = 1 << 20
+
+
+def _write(cgroup, some=0.0, full=0.0, current=0, maximum="max"):
+    with open(os.path.join(cgroup, "memory.pressure"), "w") as f:
+        f.write(f"some avg10={some:.2f} avg60=0.00 avg300=0.00 total=0\n"
+                f"full avg10={full:.2f} avg60=0.00 avg300=0.00 total=0\n")
+    with open(os.path.join(cgroup, "memory.current"), "w") as f:
+        f.write(f"{current}\n")
+    with open(os.path.join(cgroup, "memory.max"), "w") as f:
+        f.write(f"{maximum}\n")
+
+
+def _wait_for_level(agency_ffi, level, timeout=5.0):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        stats = agency_ffi.get_pressure_stats()
+        if stats["level"] == level:
+            return stats
+        time.sleep(0.01)
+    pytest.fail(f"pressure level stayed at {agency_ffi.get_pressure_stats()['level']}, wanted {level}")
+
+
+def _verdict_cache_bytes(agency_ffi):
+    return agency_ffi.get_memory_stats()["verification_cache"]["bytes"]
+
+
+@pytest.fixture
+def cgroup(agency_ffi, tmp_path):
+    _write(str(tmp_path))
+    yield str(tmp_path)
+    agency_ffi.stop_pressure_monitor()
+
+
+def test_caches_shrink_as_stalls_rise_and_recover(agency_ffi, cgroup):
+    agency_ffi.start_pressure_monitor(cgroup, interval_ms=10)
+    stats = agency_ffi.get_pressure_stats()
+    assert stats["running"] and stats["level"] == agency_ffi.PRESSURE_NONE
+    assert _verdict_cache_bytes(agency_ffi) == FULL_VERDICT_CACHE
+
+    _write(cgroup, some=12.5)
+    assert _wait_for_level(agency_ffi, agency_ffi.PRESSURE_MODERATE)["some_avg10"] == 12.5
+    moderate = _verdict_cache_bytes(agency_ffi)
+    assert moderate < FULL_VERDICT_CACHE
+
+    _write(cgroup, some=80.0, full=40.0)
+    _wait_for_level(agency_ffi, agency_ffi.PRESSURE_CRITICAL)
+    assert _verdict_cache_bytes(agency_ffi) < moderate
+    assert agency_ffi.get_memory_stats()["resource_cache"]["limit"] != 0
+
+    # Verification keeps working under the tightest ceilings
+    issue = {"id": 1, "title": "t", "description": "patient privacy", "affected_areas": []}
+    assert agency_ffi.verify_issue("HHS", issue) == agency_ffi.verify_issue("HHS", issue)
+
+    _write(cgroup)
+    _wait_for_level(agency_ffi, agency_ffi.PRESSURE_NONE)
+    assert _verdict_cache_bytes(agency_ffi) == FULL_VERDICT_CACHE
+    assert agency_ffi.get_memory_stats()["resource_cache"]["limit"] == 0
+
+
+def test_usage_near_the_cgroup_limit_counts_as_pressure(agency_ffi, cgroup):
+    _write(cgroup, current=91 << 20, maximum=100 << 20)
+    agency_ffi.start_pressure_monitor(cgroup, interval_ms=10)
+
+    stats = agency_ffi.get_pressure_stats()
+    assert stats["level"] == agency_ffi.PRESSURE_HIGH
+    assert stats["max_bytes"] == 100 << 20
+
+
+def test_stopping_lifts_the_ceilings_but_keeps_the_callers(agency_ffi, cgroup):
+    agency_ffi.set_memory_limit(agency_ffi.MEMORY_VERIFICATION_CACHE, 512 * 1024)
+    try:
+        _write(cgroup, full=30.0)
+        agency_ffi.start_pressure_monitor(cgroup, interval_ms=10)
+        assert _verdict_cache_bytes(agency_ffi) < 512 * 1024
+
+        agency_ffi.stop_pressure_monitor()
+        assert not agency_ffi.get_pressure_stats()["running"]
+        assert _verdict_cache_bytes(agency_ffi) == 512 * 1024
+    finally:
+        agency_ffi.set_memory_limit(agency_ffi.MEMORY_VERIFICATION_CACHE, 0)
+
+
+def test_monitor_needs_memory_files_and_runs_once(agency_ffi, cgroup, tmp_path_factory):
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.start_pressure_monitor(str(tmp_path_factory.mktemp("empty")))
+
+    agency_ffi.start_pressure_monitor(cgroup, interval_ms=10)
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.start_pressure_monitor(cgroup, interval_ms=10)
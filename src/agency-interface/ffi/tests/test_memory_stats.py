@@ -0,0 +1,117 @@
+"""
+Memory accounting must reflect what the library holds, and ceilings must
+make the caches give memory back.
+
+The test is skipped when libagency_ffi.so has not been built.
+"""
+
+import ctypes
+import json
+import os
+
+import pytest
+
+
+ISSUE = {"id": 1, "title": "Patient privacy", "description": "patient privacy and data protection",
+         "affected_areas": ["privacy"]}
+
+
+@pytest.fixture
+def no_limits(agency_ffi):
+    yield
+    for category in (agency_ffi.MEMORY_RESOURCE_CACHE, agency_ffi.MEMORY_VERIFICATION_CACHE,
+                     agency_ffi.MEMORY_ARENAS):
+        agency_ffi.set_memory_limit(category, 0)
+
+
+def test_categories_report_what_is_held(agency_ffi, ffi_dir):
+    agency_ffi.match_issue(ISSUE)
+    agency_ffi.verify_issue("HHS", ISSUE)
+    stats = agency_ffi.get_memory_stats()
+
+    with open(os.path.join(ffi_dir, "..", "config", "agency_data.json")) as f:
+        num_agencies = len(json.load(f)["agencies"])
+    assert stats["snapshot"]["objects"] == num_agencies
+    assert stats["snapshot"]["bytes"] > 0
+    assert stats["indexes"]["objects"] > 0
+    assert stats["verification_cache"]["bytes"] == 1 << 20
+    assert stats["verification_cache"]["objects"] > 0
+    assert stats["arenas"]["objects"] > 0
+    assert stats["total_bytes"] == sum(stats[name]["bytes"] for name in
+                                       ("snapshot", "indexes", "resource_cache", "verification_cache", "arenas"))
+
+
+def test_reloads_do_not_accumulate_snapshots(agency_ffi):
+    agency_ffi.reload_config()
+    before = agency_ffi.get_memory_stats()["snapshot"]
+    for _ in range(5):
+        agency_ffi.reload_config()
+    after = agency_ffi.get_memory_stats()["snapshot"]
+
+    # Replaced snapshots are reclaimed; at most one may still await it
+    assert after["bytes"] <= 2 * before["bytes"]
+
+
+def test_verification_cache_shrinks_to_its_ceiling(agency_ffi, no_limits):
+    for i in range(64):
+        agency_ffi.verify_issue("HHS", dict(ISSUE, id=i))
+    held = agency_ffi.get_memory_stats()["verification_cache"]["objects"]
+
+    agency_ffi.set_memory_limit(agency_ffi.MEMORY_VERIFICATION_CACHE, 5000)
+    stats = agency_ffi.get_memory_stats()["verification_cache"]
+    assert stats["bytes"] == 4096
+    assert stats["limit"] == 5000
+    assert stats["objects"] <= held
+    assert agency_ffi.get_verdict_cache_stats()["capacity"] == 4096 // 16
+
+    # Verification still works, through the smaller table
+    assert agency_ffi.verify_issue("HHS", ISSUE) == agency_ffi.verify_issue("HHS", ISSUE)
+
+    agency_ffi.set_memory_limit(agency_ffi.MEMORY_VERIFICATION_CACHE, 0)
+    assert agency_ffi.get_memory_stats()["verification_cache"]["bytes"] == 1 << 20
+
+
+def test_arenas_give_blocks_back_over_their_ceiling(agency_ffi, no_limits):
+    agency_ffi.match_issue(ISSUE)
+    before = agency_ffi.get_memory_stats()["arenas"]
+
+    agency_ffi.set_memory_limit(agency_ffi.MEMORY_ARENAS, 1)
+    agency_ffi.match_issue(ISSUE)
+    after = agency_ffi.get_memory_stats()["arenas"]
+    assert after["evictions"] > before["evictions"]
+    assert after["bytes"] < before["bytes"]
+
+
+def _store_get(agency_ffi, agency):
+    lib = agency_ffi._lib
+    lib.agency_store_get.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.POINTER(ctypes.c_char_p),
+                                     ctypes.POINTER(ctypes.c_size_t)]
+    data = ctypes.c_char_p()
+    length = ctypes.c_size_t()
+    assert lib.agency_store_get(agency.encode(), agency_ffi.RESOURCE_ASCII_ART, ctypes.byref(data),
+                                ctypes.byref(length)) == agency_ffi.STATUS_OK
+    return data.value
+
+
+def test_resource_copies_are_dropped_over_the_ceiling(agency_ffi, no_limits):
+    agency_ffi.store_preload()
+    agencies = agency_ffi.get_all_agencies()[:3]
+    for agency in agencies:
+        _store_get(agency_ffi, agency)
+    before = agency_ffi.get_memory_stats()["resource_cache"]
+    assert before["objects"] >= len(agencies)
+
+    agency_ffi.set_memory_limit(agency_ffi.MEMORY_RESOURCE_CACHE, 1)
+    copies = {agency: _store_get(agency_ffi, agency) for agency in reversed(agencies)}
+    after = agency_ffi.get_memory_stats()["resource_cache"]
+    assert after["evictions"] > before["evictions"]
+    assert after["bytes"] < before["bytes"]
+
+    # The copy returned last is still served intact
+    assert _store_get(agency_ffi, agencies[0]) == copies[agencies[0]]
+
+
+def test_snapshots_and_indexes_take_no_ceiling(agency_ffi):
+    for category in (agency_ffi.MEMORY_SNAPSHOT, agency_ffi.MEMORY_INDEXES):
+        with pytest.raises(agency_ffi.AgencyError):
+            agency_ffi.set_memory_limit(category, 1 << 20)
@@ -0,0 +1,65 @@
+"""
+Readers of a NUMA replica must get exactly what readers of the original
+get. The replica count is forced above the number of nodes, so the copies
+are exercised on any machine.
+
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import pytest
+
+
+REPLICAS = 3
+
+ISSUE = {"id": 1, "title": "Privacy", "description": "patient privacy and data protection",
+         "affected_areas": ["privacy", "national security"]}
+
+
+def _read_everything(agency_ffi):
+    agencies = agency_ffi.get_all_agencies()
+    return (agencies,
+            [agency_ffi.get_context(agency) for agency in agencies],
+            [agency_ffi.verify_issue(agency, ISSUE) for agency in agencies],
+            agency_ffi.get_agencies_by_tier(1),
+            agency_ffi.get_agencies_by_domain("health"),
+            agency_ffi.match_issue(ISSUE))
+
+
+@pytest.fixture
+def replicated(agency_ffi):
+    agency_ffi.numa_replicate(REPLICAS)
+    yield
+    agency_ffi.numa_set_thread_node(-1)
+    agency_ffi.numa_replicate(1)
+
+
+def test_every_replica_reads_the_same(agency_ffi, replicated):
+    stats = agency_ffi.get_numa_stats()
+    assert stats["replicas"] == REPLICAS and stats["replica_bytes"] > 0
+
+    agency_ffi.numa_set_thread_node(0)
+    expected = _read_everything(agency_ffi)
+    for node in range(1, REPLICAS):
+        agency_ffi.numa_set_thread_node(node)
+        assert agency_ffi.get_numa_stats()["replica"] == node
+        assert _read_everything(agency_ffi) == expected
+
+
+def test_reload_replaces_every_replica(agency_ffi, replicated):
+    agency_ffi.numa_set_thread_node(REPLICAS - 1)
+    before = _read_everything(agency_ffi)
+    agency_ffi.reload_config()
+    assert _read_everything(agency_ffi) == before
+
+    # The replaced snapshot's copies go with it
+    agency_ffi.numa_set_thread_node(-1)
+    stats = agency_ffi.get_reload_stats()
+    assert stats["retired"] == stats["reclaimed"]
+
+
+def test_replica_count_is_bounded(agency_ffi):
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.numa_replicate(17)
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.numa_set_thread_node(-2)
+    assert agency_ffi.get_numa_stats()["replicas"] >= 1
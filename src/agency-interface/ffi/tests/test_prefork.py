@@ -0,0 +1,102 @@
+"""
+Workers forked after agency_prefork_prepare() must share what the library
+built with the parent, rather than each building a private copy on first
+use.
+
+Each parent runs in a subprocess, so that it starts with nothing built.
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+import pytest
+
+
+if not os.path.exists("/proc/self/smaps_rollup"):
+    pytest.skip("private memory is read from /proc/self/smaps_rollup", allow_module_level=True)
+
+WORKERS = 3
+
+# Forks workers that each run a read-heavy workload, and reports how much
+# private memory each gained doing so
+PREFORK_SCRIPT = """
+import gc, json, os, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+
+def private_kb():
+    with open("/proc/self/smaps_rollup") as f:
+        return sum(int(line.split()[1]) for line in f if line.startswith("Private_Dirty:"))
+
+issue = {{"id": 1, "title": "Privacy", "description": "patient privacy and data protection",
+          "affected_areas": ["privacy"]}}
+agencies = agency_ffi.get_all_agencies()
+
+def workload():
+    for _ in range(20):
+        for agency in agencies:
+            agency_ffi.get_context(agency)
+            agency_ffi.verify_issue(agency, issue)
+        agency_ffi.match_issue(issue)
+        agency_ffi.get_agencies_by_tier(1)
+        agency_ffi.get_agencies_by_domain("health")
+
+if {prepare!r}:
+    agency_ffi.prefork_prepare()
+indexes = agency_ffi.get_memory_stats()["indexes"]["bytes"]
+
+# Keep the collector from writing to every object the parent made
+gc.freeze()
+growth = []
+for _ in range({workers}):
+    read, write = os.pipe()
+    pid = os.fork()
+    if pid == 0:
+        before = private_kb()
+        workload()
+        os.write(write, str(private_kb() - before).encode())
+        os._exit(0)
+    os.close(write)
+    growth.append(int(os.read(read, 64) or -1))
+    os.close(read)
+    os.waitpid(pid, 0)
+
+print(json.dumps([growth, indexes]))
+"""
+
+
+def _fork_workers(ffi_dir, prepare):
+    script = PREFORK_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"), prepare=prepare,
+                                   workers=WORKERS)
+    result = subprocess.run([sys.executable, "-c", script], cwd=ffi_dir,
+                            capture_output=True, text=True, check=True)
+    return json.loads(result.stdout)
+
+
+def test_prepared_workers_share_what_the_parent_built(ffi_dir):
+    prepared, shared_indexes = _fork_workers(ffi_dir, True)
+    unprepared, _ = _fork_workers(ffi_dir, False)
+    assert len(prepared) == len(unprepared) == WORKERS
+    assert min(prepared) > 0 and shared_indexes > 0
+
+    # Without preparation every worker builds and holds the indexes itself;
+    # with it they stay shared, leaving each worker only its working memory
+    for own, rebuilt in zip(prepared, unprepared):
+        assert rebuilt - own >= shared_indexes // 2 // 1024
+
+
+def test_prepare_is_repeatable_and_reads_still_work(agency_ffi):
+    agency_ffi.prefork_prepare()
+    agency_ffi.prefork_prepare()
+
+    agencies = agency_ffi.get_all_agencies()
+    assert agency_ffi.get_context(agencies[0])["acronym"] == agencies[0]
+
+    # A reload replaces the sealed snapshot with a new one, sealed in turn
+    agency_ffi.reload_config()
+    agency_ffi.prefork_prepare()
+    assert agency_ffi.get_all_agencies() == agencies
+    assert agency_ffi.get_reload_stats()["retired"] == agency_ffi.get_reload_stats()["reclaimed"]
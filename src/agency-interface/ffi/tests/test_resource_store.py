@@ -0,0 +1,102 @@
+"""
+Every preloaded resource must decode, with a plain LZ4 block decoder, to
+exactly what the file holds, and the getters must serve the same bytes
+from the store as they did from disk.
+
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import pytest
+
+
+def _read_length(data, i):
+    total = 0
+    while True:
+        byte = data[i]
+        i += 1
+        total += byte
+        if byte != 255:
+            return total, i
+
+
+def lz4_block_decode(data, raw_length):
+    """Decode an LZ4 block as the format specification describes it."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        token = data[i]
+        i += 1
+        literals = token >> 4
+        if literals == 15:
+            extra, i = _read_length(data, i)
+            literals += extra
+        out += data[i:i + literals]
+        i += literals
+        if i == len(data):
+            break
+
+        offset = data[i] | data[i + 1] << 8
+        i += 2
+        assert 0 < offset <= len(out)
+        match = token & 15
+        if match == 15:
+            extra, i = _read_length(data, i)
+            match += extra
+        start = len(out) - offset
+        for k in range(match + 4):
+            out.append(out[start + k])
+    assert len(out) == raw_length
+    return bytes(out)
+
+
+def _getters(agency_ffi):
+    return {
+        agency_ffi.RESOURCE_ISSUE_FINDER: agency_ffi.get_issue_finder,
+        agency_ffi.RESOURCE_RESEARCH_CONNECTOR: agency_ffi.get_research_connector,
+        agency_ffi.RESOURCE_ASCII_ART: agency_ffi.get_ascii_art,
+    }
+
+
+def _resources(agency_ffi):
+    for agency in agency_ffi.get_all_agencies():
+        for kind, getter in _getters(agency_ffi).items():
+            try:
+                yield agency, kind, getter(agency)
+            except agency_ffi.AgencyError:
+                continue
+
+
+def test_store_round_trips_every_resource(agency_ffi):
+    from_disk = list(_resources(agency_ffi))
+    agency_ffi.store_preload()
+    stats = agency_ffi.get_store_stats()
+    assert stats["resources"] >= len(from_disk) > 0
+
+    raw_bytes = 0
+    for agency, kind, text in from_disk:
+        compressed, raw_length = agency_ffi.get_compressed_resource(agency, kind)
+        expected = text.encode("utf-8")
+        assert raw_length == len(expected)
+        assert lz4_block_decode(compressed, raw_length) == expected
+        # The getters now decompress instead of reading the file
+        assert _getters(agency_ffi)[kind](agency) == text
+        raw_bytes += raw_length
+
+    assert stats["raw_bytes"] >= raw_bytes
+    assert 0 < stats["compressed_bytes"] < stats["raw_bytes"]
+    assert stats["arena_bytes"] >= stats["compressed_bytes"]
+
+
+def test_preload_is_repeatable(agency_ffi):
+    agency_ffi.store_preload()
+    before = agency_ffi.get_store_stats()
+    agency_ffi.store_preload()
+    after = agency_ffi.get_store_stats()
+    for name in ("resources", "raw_bytes", "compressed_bytes", "arena_bytes"):
+        assert after[name] == before[name]
+
+
+def test_unstored_resource_is_not_found(agency_ffi):
+    agency_ffi.store_preload()
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.get_compressed_resource("XYZ", agency_ffi.RESOURCE_ISSUE_FINDER)
@@ -0,0 +1,97 @@
+"""
+A streamed resource must arrive whole and in order, in chunks no larger
+than asked for, and a stream of a resource that does not exist must fail
+at once rather than yield nothing. A resource in the store streams from
+the store, with the same bytes.
+
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import random
+import subprocess
+import sys
+
+import pytest
+
+
+# Mirrors AGENCY_STREAM_CHUNK_SIZE and AGENCY_STREAM_MAX_CHUNK_SIZE in agency_ffi.h
+DEFAULT_CHUNK_SIZE = 16384
+MAX_CHUNK_SIZE = 4 * 1024 * 1024
+
+INTERFACE_DIR = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+
+@pytest.mark.parametrize("chunk_size", [1, 1000, 4096, 0])
+def test_chunks_reassemble_the_resource(agency_ffi, chunk_size):
+    expected = agency_ffi.get_research_connector("HHS").encode("utf-8")
+    chunks = list(agency_ffi.stream_resource("HHS", agency_ffi.RESOURCE_RESEARCH_CONNECTOR, chunk_size))
+    assert b"".join(chunks) == expected
+
+    # Every chunk but the last is full, and the stream ends without an empty one
+    limit = chunk_size or DEFAULT_CHUNK_SIZE
+    assert all(len(chunk) == limit for chunk in chunks[:-1])
+    assert 0 < len(chunks[-1]) <= limit
+    assert len(chunks) == -(-len(expected) // limit)
+
+
+def test_chunk_larger_than_the_resource(agency_ffi):
+    expected = agency_ffi.get_ascii_art("HHS").encode("utf-8")
+    chunks = list(agency_ffi.stream_resource("HHS", agency_ffi.RESOURCE_ASCII_ART, 1 << 20))
+    assert chunks == [expected]
+
+
+def test_oversized_chunk_size_is_capped(agency_ffi):
+    # A size the buffer header would wrap around on
+    for chunk_size in (MAX_CHUNK_SIZE + 1, 2**64 - 8):
+        chunks = list(agency_ffi.stream_resource("HHS", agency_ffi.RESOURCE_ISSUE_FINDER, chunk_size))
+        assert b"".join(chunks) == agency_ffi.get_issue_finder("HHS").encode("utf-8")
+
+
+def test_missing_resource_fails_to_open(agency_ffi):
+    for agency, kind in (("XYZ", agency_ffi.RESOURCE_ISSUE_FINDER), ("HHS", 99)):
+        with pytest.raises(agency_ffi.AgencyError):
+            next(agency_ffi.stream_resource(agency, kind))
+
+
+STORED_STREAM_SCRIPT = """
+import json, os, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+
+template = sys.argv[1]
+with open(template, "rb") as f:
+    expected = f.read()
+agency_ffi.store_preload()
+# Only the store still has the bytes
+os.remove(template)
+streams = {{size: b"".join(agency_ffi.stream_resource("BIG", agency_ffi.RESOURCE_ASCII_ART, size))
+           == expected for size in (1, 1000, 70000, 0)}}
+print(json.dumps([streams, agency_ffi.get_ascii_art("BIG").encode("utf-8") == expected]))
+"""
+
+
+def test_stored_resource_streams_from_the_store(ffi_dir, tmp_path):
+    with open(os.path.join(INTERFACE_DIR, "config", "agency_data.json")) as f:
+        config = json.load(f)
+    config["agencies"].append({"acronym": "BIG", "name": "Big Agency", "ascii_template": "big.txt"})
+    (tmp_path / "config").mkdir()
+    (tmp_path / "config" / "agency_data.json").write_text(json.dumps(config))
+    (tmp_path / "prover_integration").symlink_to(os.path.join(INTERFACE_DIR, "prover_integration"))
+    (tmp_path / "ffi").mkdir()
+    (tmp_path / "templates").mkdir()
+
+    # Several times the decode window, with matches reaching back across chunks
+    rng = random.Random(28)
+    words = ["agency", "issue", "finder", "connector", "theorem", "verdict", "schema", "epoch"]
+    lines = [" ".join(rng.choice(words) for _ in range(rng.randint(3, 12))) for _ in range(400)]
+    template = tmp_path / "templates" / "big.txt"
+    template.write_text("\n".join(rng.choice(lines) + str(rng.randint(0, 99)) for _ in range(6000)))
+
+    script = STORED_STREAM_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"))
+    result = subprocess.run([sys.executable, "-c", script, str(template)],
+                            cwd=tmp_path / "ffi", capture_output=True, text=True, check=True)
+    streams, getter = json.loads(result.stdout)
+    assert streams == {"1": True, "1000": True, "70000": True, "0": True}
+    assert getter
@@ -0,0 +1,89 @@
+"""
+Responses are built in a per-thread arena: once a thread is warm, a call
+allocates only the result it returns, and nothing when the caller supplies
+the buffer.
+
+Allocations are counted through an installed allocator in a subprocess.
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+
+COUNT_SCRIPT = """
+import ctypes, json, sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+
+libc = ctypes.CDLL(None)
+libc.malloc.restype = ctypes.c_void_p
+libc.malloc.argtypes = [ctypes.c_size_t]
+libc.realloc.restype = ctypes.c_void_p
+libc.realloc.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+libc.free.argtypes = [ctypes.c_void_p]
+counts = [0]
+
+def alloc(size):
+    counts[0] += 1
+    return libc.malloc(size)
+
+def realloc(ptr, size):
+    counts[0] += 1
+    return libc.realloc(ptr, size)
+
+agency_ffi.set_allocator(alloc, realloc, libc.free)
+lib = agency_ffi._lib
+
+with open("../prover_integration/theorem_models/healthcare_theorems.json") as f:
+    text = " ".join(t["statement"] for t in json.load(f))
+issue = json.dumps({{"id": 1, "title": "t", "description": text * 20, "affected_areas": ["a"]}}).encode()
+buffer = ctypes.create_string_buffer(1 << 20)
+length = ctypes.c_size_t()
+
+def match():
+    result = lib.agency_match_issue(issue)
+    lib.agency_free_context(ctypes.cast(result, ctypes.c_char_p))
+
+def report():
+    assert lib.agency_verify_issue_report(b"HHS", issue, agency_ffi.REPORT_JSON, buffer,
+                                          len(buffer), ctypes.byref(length)) == 0
+
+per_call = {{}}
+for name, call in (("match", match), ("report", report)):
+    for _ in range(3):
+        call()
+    before = counts[0]
+    for _ in range(10):
+        call()
+    per_call[name] = (counts[0] - before) / 10
+print(json.dumps(per_call))
+"""
+
+
+def test_warm_calls_allocate_only_their_result(ffi_dir):
+    script = COUNT_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"))
+    result = subprocess.run([sys.executable, "-c", script], cwd=ffi_dir,
+                            capture_output=True, text=True, check=True)
+    per_call = json.loads(result.stdout)
+
+    assert per_call["match"] == 1
+    assert per_call["report"] == 0
+
+
+def test_large_responses_stay_well_formed(agency_ffi, ffi_dir):
+    # Enough theorems and topics to outgrow the arena's first block
+    with open(os.path.join(ffi_dir, "..", "prover_integration", "theorem_models",
+                           "healthcare_theorems.json")) as f:
+        text = " ".join(t["statement"] for t in json.load(f))
+    issue = {"id": 1, "title": "a/b \"c\"\n\t", "description": text * 50, "affected_areas": ["a"]}
+
+    first = agency_ffi.match_issue(issue)
+    assert first["theorems"]
+    assert agency_ffi.match_issue(issue) == first
+
+    report = agency_ffi.verify_issue_report("HHS", issue)
+    assert report["rules"]
+    assert agency_ffi.verify_issue_report("HHS", issue)["rules"][0]["name"] == report["rules"][0]["name"]
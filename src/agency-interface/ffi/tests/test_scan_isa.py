@@ -0,0 +1,97 @@
+"""
+Structural scanner implementations must agree with each other and with JSON.
+
+The same issues are verified with the scanner forced to each instruction
+set through AGENCY_SCAN_ISA, in a subprocess per instruction set since the
+choice is made once per process. Values are shifted across the scanner's
+64-byte blocks so escapes, quotes and scalars straddle block boundaries.
+Skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import random
+import subprocess
+import sys
+
+import pytest
+
+
+ISAS = ["scalar", "sse4.2", "avx2"]
+
+VERIFY_SCRIPT = """
+import sys
+sys.path.insert(0, {python_dir!r})
+import agency_ffi
+print(" ".join(str(v) for v in agency_ffi.verify_batch("HHS", sys.stdin.buffer.read(), threads=1)))
+"""
+
+# Values placed before the required fields, so they are always fully scanned
+VALUES = [
+    r'"plain"', r'"esc\\aped\\\\"', r'"quote\"inside"', r'"\\"', r'"\u00e9\ud83d\ude00"', r'"tab\there"',
+    r'"{[,:]}"', r'{"a": [1, 2.5e-3, true, false, null], "b\"": {}}', r'[[[[]]], {"x": "}"}]', "-0.5",
+    "12345678901234567890",
+]
+
+MALFORMED = [
+    r'"bad \x escape"', r'"short \u12"', r'"unterminated', r'"\\', "tru", "nul", "-", "1.", "01x", "[1 2]",
+    r'{"a" 1}', r'{"a":}', "[1,,2]", "}", r'"ok" "extra"',
+]
+
+# Well-formed, but nested deeper than the validator's limit of 32
+TOO_DEEP = "[" * 40 + "]" * 40
+
+
+def _issue(pad, value):
+    return ('{"pad": "%s", "value": %s, "id": "X", "title": "t", "description": "d", "affected_areas": []}'
+            % ("p" * pad, value))
+
+
+def _corpus():
+    rng = random.Random(35)
+    lines = [_issue(pad, value) for pad in range(0, 130, 3) for value in VALUES + MALFORMED + [TOO_DEEP]]
+    # Random damage, to compare the implementations on odd input
+    for _ in range(2000):
+        line = list(_issue(rng.randrange(130), rng.choice(VALUES)))
+        for _ in range(rng.randint(1, 3)):
+            line[rng.randrange(len(line))] = rng.choice('"\\{}[]:, x0e.-')
+        lines.append("".join(line))
+    return lines
+
+
+def _verdicts(ffi_dir, isa, lines):
+    env = dict(os.environ, AGENCY_SCAN_ISA=isa)
+    script = VERIFY_SCRIPT.format(python_dir=os.path.join(ffi_dir, "python"))
+    result = subprocess.run([sys.executable, "-c", script], cwd=ffi_dir, env=env,
+                            input="\n".join(lines).encode(), capture_output=True, check=True)
+    return [int(v) for v in result.stdout.split()]
+
+
+@pytest.fixture(scope="module")
+def corpus():
+    return _corpus()
+
+
+@pytest.fixture(scope="module")
+def scalar_verdicts(ffi_dir, corpus):
+    return _verdicts(ffi_dir, "scalar", corpus)
+
+
+@pytest.mark.parametrize("isa", ISAS[1:])
+def test_instruction_sets_agree(ffi_dir, isa, corpus, scalar_verdicts):
+    # An instruction set the CPU lacks falls back to another, which must agree too
+    assert _verdicts(ffi_dir, isa, corpus) == scalar_verdicts
+
+
+def test_verdicts_follow_json_validity(corpus, scalar_verdicts):
+    assert all(json.loads(_issue(0, value)) for value in VALUES + [TOO_DEEP])
+    for value in MALFORMED:
+        with pytest.raises(ValueError):
+            json.loads(_issue(0, value))
+
+    verdicts = dict(zip(corpus, scalar_verdicts))
+    for pad in range(0, 130, 3):
+        for value in VALUES:
+            assert verdicts[_issue(pad, value)] != -1, (pad, value)
+        for value in MALFORMED + [TOO_DEEP]:
+            assert verdicts[_issue(pad, value)] == -1, (pad, value)
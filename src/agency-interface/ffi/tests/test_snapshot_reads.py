@@ -0,0 +1,74 @@
+"""
+The configuration getters must answer from the snapshot exactly as the
+configuration file says, from any number of threads at once.
+
+The test is skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import threading
+
+import pytest
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+with open(os.path.join(FFI_DIR, "..", "config", "agency_data.json")) as f:
+    AGENCIES = json.load(f)["agencies"]
+
+
+def test_getters_match_the_configuration(agency_ffi):
+    assert agency_ffi.get_all_agencies() == [a["acronym"] for a in AGENCIES]
+    for agency in AGENCIES:
+        assert agency_ffi.get_context(agency["acronym"]) == agency
+
+    # Not every agency declares a tier or a domain
+    for tier in {a.get("tier") for a in AGENCIES} - {None} | {0, 99}:
+        assert agency_ffi.get_agencies_by_tier(tier) == [a["acronym"] for a in AGENCIES if a.get("tier") == tier]
+    for domain in {a.get("domain") for a in AGENCIES} - {None} | {"nope"}:
+        assert agency_ffi.get_agencies_by_domain(domain) == \
+            [a["acronym"] for a in AGENCIES if a.get("domain") == domain]
+
+    with pytest.raises(agency_ffi.AgencyError):
+        agency_ffi.get_context("hhs")
+
+
+def test_domain_lookup_only_matches_domains(agency_ffi):
+    # Acronyms share the snapshot's string table with domains, but name no domain
+    for agency in AGENCIES[:5]:
+        assert agency_ffi.get_agencies_by_domain(agency["acronym"]) == []
+    assert agency_ffi.get_agencies_by_domain("") == []
+
+
+def test_context_hash_is_stable(agency_ffi):
+    for agency in AGENCIES[:5]:
+        context, current = agency_ffi.get_context_if_modified(agency["acronym"])
+        assert json.loads(context) == agency
+        assert agency_ffi.get_context_if_modified(agency["acronym"], current) == (None, current)
+
+
+def _read_all(agency_ffi):
+    return (
+        agency_ffi.get_all_agencies(),
+        [agency_ffi.get_context(a["acronym"]) for a in AGENCIES],
+        [agency_ffi.get_agencies_by_tier(t) for t in range(5)],
+        [agency_ffi.get_agencies_by_domain(a.get("domain", "general")) for a in AGENCIES],
+    )
+
+
+def test_concurrent_readers_see_the_same_answers(agency_ffi):
+    expected = _read_all(agency_ffi)
+    mismatches = []
+
+    def reader():
+        for _ in range(20):
+            if _read_all(agency_ffi) != expected:
+                mismatches.append(threading.get_ident())
+
+    threads = [threading.Thread(target=reader) for _ in range(16)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    assert mismatches == []
@@ -0,0 +1,81 @@
+"""
+Theorems evaluated on the work-stealing pool must give the serial verdict.
+
+Large descriptions are verified with the pool forced on and compared with
+the verification report, whose theorem evaluation is always serial. The
+test is skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import random
+
+import pytest
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+MODELS_DIR = os.path.join(FFI_DIR, "..", "prover_integration", "theorem_models")
+
+# Bytes of description each parallel search item covers (THEOREM_SEGMENT_BYTES)
+SEGMENT = 32 << 10
+
+
+def _keywords(domain):
+    with open(os.path.join(MODELS_DIR, domain + "_theorems.json")) as f:
+        return sorted({w.lower() for t in json.load(f) for w in t.get("statement", "").split() if len(w) > 4})
+
+
+@pytest.fixture(autouse=True)
+def parallel_pool(agency_ffi):
+    agency_ffi.set_theorem_parallelism(threads=4, cutoff=1)
+    yield
+    agency_ffi.set_theorem_parallelism()
+
+
+def _issue(description):
+    return {"id": 1, "title": "t", "description": description, "affected_areas": ["a"] * 300}
+
+
+def _check(agency_ffi, agency, description):
+    issue = _issue(description)
+    agency_ffi.clear_verdict_cache()
+    expected = agency_ffi.verify_issue_report(agency, issue)["verdict"]
+    assert agency_ffi.verify_issue(agency, issue) == (expected == 1)
+    return expected
+
+
+def test_large_issues_match_serial_verdicts(agency_ffi):
+    rng = random.Random(5)
+    keywords = _keywords("healthcare")
+    verdicts = set()
+    for _ in range(20):
+        words = ["filler%d" % rng.randrange(1000) for _ in range(rng.randrange(2000, 30000))]
+        for keyword in rng.sample(keywords, rng.choice([len(keywords), len(keywords) - 1])):
+            words.insert(rng.randrange(len(words) + 1), keyword)
+        verdicts.add(_check(agency_ffi, "HHS", " ".join(words)))
+    assert verdicts == {0, 1}
+
+
+def test_keywords_across_segment_boundaries_are_found(agency_ffi):
+    keywords = _keywords("defense")
+    for keyword in keywords:
+        # Straddle the first boundary, with every other keyword far away
+        others = " ".join(k for k in keywords if k != keyword)
+        prefix = "x" * (SEGMENT - len(keyword) // 2)
+        assert _check(agency_ffi, "DOD", prefix + keyword + " " + "y" * SEGMENT + " " + others) == 1
+
+
+def test_large_issues_use_the_pool(agency_ffi):
+    before = agency_ffi.get_theorem_pool_stats()
+    assert before["threads"] == 4
+    _check(agency_ffi, "HHS", " ".join(_keywords("healthcare")) + " z" * 100000)
+    after = agency_ffi.get_theorem_pool_stats()
+    assert after["parallel_verifications"] == before["parallel_verifications"] + 1
+    assert after["items"] > before["items"]
+
+
+def test_serial_setting_bypasses_the_pool(agency_ffi):
+    agency_ffi.set_theorem_parallelism(threads=1, cutoff=1)
+    before = agency_ffi.get_theorem_pool_stats()
+    _check(agency_ffi, "HHS", " ".join(_keywords("healthcare")) + " z" * 100000)
+    assert agency_ffi.get_theorem_pool_stats()["parallel_verifications"] == before["parallel_verifications"]
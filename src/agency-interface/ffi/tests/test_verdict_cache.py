@@ -0,0 +1,62 @@
+"""
+Cached verdicts must match fresh verification, keyed by content and agency.
+
+The test is skipped when libagency_ffi.so has not been built.
+"""
+
+ISSUE = '{"id": 1, "title": "t", "description": "patient privacy and data protection", "affected_areas": []}'
+
+# The same issue as ISSUE with different whitespace between tokens, on one line
+RESPACED = '{ "id":1,\t  "title" : "t", "description":"patient privacy and data protection",\t"affected_areas":[ ] }'
+
+
+def _verify(agency_ffi, agency, *lines):
+    return agency_ffi.verify_batch(agency, "\n".join(lines).encode("utf-8"), threads=1)
+
+
+def test_cached_verdicts_match_fresh_ones(agency_ffi):
+    lines = [ISSUE, '{"id": 3}', '{', '{"id": 1, "title": "t", "description": 5, "affected_areas": []}']
+    agency_ffi.clear_verdict_cache()
+    fresh = _verify(agency_ffi, "HHS", *lines)
+
+    before = agency_ffi.get_verdict_cache_stats()
+    assert _verify(agency_ffi, "HHS", *lines) == fresh
+    after = agency_ffi.get_verdict_cache_stats()
+    assert after["hits"] - before["hits"] == len(lines)
+    assert after["misses"] == before["misses"]
+
+
+def test_key_ignores_whitespace_only(agency_ffi):
+    agency_ffi.clear_verdict_cache()
+    verdict = _verify(agency_ffi, "HHS", ISSUE)
+
+    before = agency_ffi.get_verdict_cache_stats()
+    assert _verify(agency_ffi, "HHS", RESPACED) == verdict
+    assert agency_ffi.get_verdict_cache_stats()["hits"] == before["hits"] + 1
+
+    # Content inside strings and between scalars is significant
+    _verify(agency_ffi, "HHS", ISSUE.replace("privacy", "privacy "), '[tr ue]', '[true]')
+    assert agency_ffi.get_verdict_cache_stats()["misses"] == before["misses"] + 3
+
+
+def test_key_includes_agency(agency_ffi):
+    agency_ffi.clear_verdict_cache()
+    _verify(agency_ffi, "HHS", ISSUE)
+
+    before = agency_ffi.get_verdict_cache_stats()
+    _verify(agency_ffi, "DOD", ISSUE)
+    assert agency_ffi.get_verdict_cache_stats()["misses"] == before["misses"] + 1
+    assert before["capacity"] > 0
+
+
+def test_reload_empties_the_cache(agency_ffi):
+    verdict = _verify(agency_ffi, "HHS", ISSUE)
+
+    # The resubmitted issue is verified again rather than answered from the cache
+    agency_ffi.reload_config()
+    before = agency_ffi.get_verdict_cache_stats()
+    assert _verify(agency_ffi, "HHS", ISSUE) == verdict
+    after = agency_ffi.get_verdict_cache_stats()
+    assert after["invalidations"] > before["invalidations"]
+    assert after["misses"] == before["misses"] + 1
+    assert after["hits"] == before["hits"]
@@ -0,0 +1,93 @@
+"""
+Batch verification must give the same verdicts as one call per issue,
+whether the issues are passed in memory or read from a descriptor.
+
+The test is skipped when libagency_ffi.so has not been built.
+"""
+
+import json
+import os
+import threading
+
+import pytest
+
+
+LINES = [
+    '{"id": 1, "title": "t", "description": "d", "affected_areas": []}',
+    '{"id": 2, "title": "t", "description": 5, "affected_areas": []}',
+    '{"id": 3}',
+    '{"id": 4, "title": "t", "description": "patient privacy and data protection", "affected_areas": []}',
+    '{',
+    '123',
+    'not json',
+]
+
+# Mirrors BATCH_WINDOW_BYTES in c/agency_batch.c
+WINDOW_BYTES = 4 << 20
+
+
+def _single(agency_ffi, agency, line):
+    try:
+        return 1 if agency_ffi.verify_issue(agency, json.loads(line)) else 0
+    except (ValueError, agency_ffi.AgencyError):
+        return -1
+
+
+@pytest.mark.parametrize("threads", [1, 2, 8])
+def test_batch_matches_single_calls(agency_ffi, threads):
+    lines = LINES * 100
+    ndjson = ("\n".join(lines) + "\n\n  \r\n").encode("utf-8")
+    for agency in ("HHS", "DOD", "UNKNOWN"):
+        assert agency_ffi.verify_batch(agency, ndjson, threads) == [_single(agency_ffi, agency, l) for l in lines]
+
+
+def test_batch_accepts_issue_objects(agency_ffi):
+    issues = [json.loads(LINES[0]), {"id": 5}]
+    assert agency_ffi.verify_batch("HHS", issues) == [0, 0]
+    assert agency_ffi.verify_batch("HHS", b"") == []
+
+
+def _verify_through_pipe(agency_ffi, agency, data, threads):
+    read_fd, write_fd = os.pipe()
+
+    # Uneven writes leave lines split across reads
+    def feed():
+        view = memoryview(data)
+        step = 65521
+        while view:
+            written = os.write(write_fd, view[:step])
+            view = view[written:]
+        os.close(write_fd)
+
+    feeder = threading.Thread(target=feed)
+    feeder.start()
+    try:
+        return agency_ffi.verify_batch_fd(agency, read_fd, threads)
+    finally:
+        feeder.join()
+        os.close(read_fd)
+
+
+@pytest.mark.parametrize("threads", [1, 4])
+def test_descriptor_batch_matches_the_in_memory_batch(agency_ffi, threads):
+    # Several windows of short lines, so one is always cut off at a window's
+    # end; then a line longer than a window, which makes the window grow, and
+    # no newline after it, so it is only verified at end of file
+    lines = LINES * 15000
+    long_issue = {"id": 9, "title": "t", "affected_areas": [],
+                  "description": "patient privacy and data protection " * (WINDOW_BYTES // 30)}
+    long_line = json.dumps(long_issue)
+    assert len(long_line) > WINDOW_BYTES
+    ndjson = ("\n".join(lines) + "\n" + long_line).encode("utf-8")
+    assert len(ndjson) > 2 * WINDOW_BYTES
+
+    verdicts = _verify_through_pipe(agency_ffi, "HHS", ndjson, threads)
+    assert verdicts == agency_ffi.verify_batch("HHS", ndjson, threads)
+    assert len(verdicts) == len(lines) + 1
+    assert verdicts[:len(LINES)] == [_single(agency_ffi, "HHS", line) for line in LINES]
+    assert verdicts[-1] == _single(agency_ffi, "HHS", long_line)
+
+
+def test_descriptor_batch_of_nothing(agency_ffi):
+    assert _verify_through_pipe(agency_ffi, "HHS", b"", 2) == []
+    assert _verify_through_pipe(agency_ffi, "HHS", b"\n  \n" + LINES[0].encode("utf-8"), 2) == [0]
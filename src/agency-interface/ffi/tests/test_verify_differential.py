@@ -0,0 +1,107 @@
+"""
+Differential test for the native theorem engine behind agency_verify_issue.
+
+Every issue in the corpus is verified both through the C library and through
+AgencyProverIntegration in prover_integration.py; the verdicts must match.
+The test is skipped when libagency_ffi.so has not been built.
+"""
+
+import itertools
+import json
+import logging
+import os
+import random
+import sys
+
+import pytest
+
+FFI_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+INTERFACE_DIR = os.path.dirname(FFI_DIR)
+
+
+def _load_json(*parts):
+    with open(os.path.join(INTERFACE_DIR, *parts)) as f:
+        return json.load(f)
+
+
+def _descriptions():
+    """Build descriptions that hit, partly hit and miss every theorem."""
+    models_dir = os.path.join(INTERFACE_DIR, "prover_integration", "theorem_models")
+    statements = []
+    for name in sorted(os.listdir(models_dir)):
+        if name.endswith("_theorems.json"):
+            statements.extend(t.get("statement", "") for t in _load_json("prover_integration", "theorem_models", name))
+
+    words = sorted({w for s in statements for w in s.split()})
+    rng = random.Random(1234)
+
+    descriptions = ["", "unrelated text", " ".join(statements), " ".join(statements).upper()]
+    descriptions.extend(statements)
+    descriptions.extend(s.replace(" ", "") for s in statements)
+    # Escapes and non-ASCII text reach the native validator as \uXXXX sequences
+    descriptions.extend(s.replace(" ", sep, 3) for s in statements for sep in ("\n", '"', "\\", "\u00e9 ", " \U0001f600 "))
+    for size in (3, 10, 30, len(words)):
+        for _ in range(20):
+            descriptions.append(" ".join(rng.sample(words, min(size, len(words)))))
+    return descriptions
+
+
+def _issues():
+    for index, description in enumerate(_descriptions()):
+        yield {"id": f"ISSUE-{index}", "title": "t", "description": description, "affected_areas": ["a"]}
+
+    # Nested values in other fields must be skipped, not interpreted
+    yield {"meta": {"description": 5, "id": [{"x": "}"}]}, "id": "Y", "title": "t",
+           "description": " ".join(_descriptions()[:3]), "affected_areas": [["a"], {"b": None}]}
+
+    base = {"id": "X", "title": "t", "description": "d", "affected_areas": []}
+    for field in base:
+        yield {k: v for k, v in base.items() if k != field}
+    yield dict(base, description=None)
+    yield dict(base, description=42)
+
+
+AGENCIES = [a["acronym"] for a in _load_json("config", "agency_data.json")["agencies"]] + ["UNKNOWN"]
+
+
+@pytest.fixture(scope="module")
+def prover():
+    prover_dir = os.path.join(INTERFACE_DIR, "prover_integration")
+    sys.path.insert(0, prover_dir)
+    try:
+        from prover_integration import AgencyProverIntegration
+    finally:
+        sys.path.remove(prover_dir)
+    logging.getLogger("prover_integration").setLevel(logging.CRITICAL)
+    return AgencyProverIntegration()
+
+
+def _python_verdict(prover, agency, issue):
+    try:
+        return prover.verify_issue(agency, issue)[0]
+    except Exception:
+        return "error"
+
+
+def _native_verdict(agency_ffi, agency, issue):
+    try:
+        return agency_ffi.verify_issue(agency, issue)
+    except agency_ffi.AgencyError:
+        return "error"
+
+
+def test_native_verdicts_match_python(agency_ffi, prover):
+    issues = list(_issues())
+    mismatches = []
+    for agency, issue in itertools.product(AGENCIES, issues):
+        expected = _python_verdict(prover, agency, issue)
+        actual = _native_verdict(agency_ffi, agency, issue)
+        if expected != actual:
+            mismatches.append((agency, issue, expected, actual))
+
+    assert not mismatches, mismatches[:5]
+
+
+def test_corpus_exercises_both_verdicts(prover):
+    verdicts = {_python_verdict(prover, agency, issue) for agency in ("HHS", "DOD") for issue in _issues()}
+    assert {True, False, "error"} <= verdicts
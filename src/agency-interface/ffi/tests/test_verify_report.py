@@ -0,0 +1,87 @@
+"""
+Verification reports must agree with plain verification and name each rule.
+
+The test is skipped when libagency_ffi.so has not been built.
+"""
+
+import ctypes
+import json
+import struct
+
+import pytest
+
+
+ISSUES = [
+    {"id": 1, "title": "t", "description": "d", "affected_areas": []},
+    {"id": 2, "title": "t", "description": 5, "affected_areas": []},
+    {"id": 3},
+    {"id": 4, "title": "t", "description": "patient privacy and data protection", "affected_areas": []},
+    [1, 2],
+]
+
+HEADER = struct.Struct("=iIQQ")
+RULE = struct.Struct("=HH7IQ")
+
+
+def _raw_report(agency_ffi, agency, text, format):
+    length = ctypes.c_size_t()
+    agency_ffi._lib.agency_verify_issue_report(agency.encode(), text.encode(), format, None, 0,
+                                               ctypes.byref(length))
+    buffer = ctypes.create_string_buffer(length.value + 256)
+    status = agency_ffi._lib.agency_verify_issue_report(agency.encode(), text.encode(), format, buffer,
+                                                        len(buffer), ctypes.byref(length))
+    assert status == agency_ffi.STATUS_OK
+    return buffer.raw[:length.value]
+
+
+@pytest.mark.parametrize("agency", ["HHS", "DOD", "UNKNOWN"])
+def test_report_verdict_matches_verification(agency_ffi, agency):
+    ndjson = "".join(json.dumps(issue) + "\n" for issue in ISSUES).encode()
+    verdicts = agency_ffi.verify_batch(agency, ndjson, threads=1)
+    assert [agency_ffi.verify_issue_report(agency, issue)["verdict"] for issue in ISSUES] == verdicts
+
+
+def test_report_names_failing_rules(agency_ffi):
+    report = agency_ffi.verify_issue_report("HHS", ISSUES[2])
+    missing = [rule["name"] for rule in report["rules"] if rule["outcome"] == "missing"]
+    assert report["verdict"] == 0 and missing == ["title", "description", "affected_areas"]
+
+    # Every theorem is reported, even after the first one fails
+    report = agency_ffi.verify_issue_report("HHS", ISSUES[0])
+    theorems = [rule for rule in report["rules"] if rule["kind"] == "theorem"]
+    assert len(theorems) > 1
+    assert all(rule["outcome"] == "keyword_missing" and rule["missing"] for rule in theorems)
+    assert all(rule["field"] == "description" for rule in theorems)
+    assert report["error_offset"] is None
+
+
+def test_report_locates_syntax_errors(agency_ffi):
+    text = '{"id": 1, "title": "t" x'
+    report = json.loads(_raw_report(agency_ffi, "HHS", text, agency_ffi.REPORT_JSON))
+    assert report["verdict"] == -1 and report["error_offset"] == text.index("x")
+
+    # json.loads rejects data after the issue, even once a field has failed
+    for text in ('{"id": 1} x', '[1, 2] x', '{"id": 1, "title": 5} {'):
+        report = json.loads(_raw_report(agency_ffi, "HHS", text, agency_ffi.REPORT_JSON))
+        assert report["verdict"] == -1 and report["error_offset"] == len(text) - 1
+
+
+def test_binary_report_matches_json(agency_ffi):
+    text = json.dumps(ISSUES[0])
+    report = json.loads(_raw_report(agency_ffi, "HHS", text, agency_ffi.REPORT_JSON))
+    data = _raw_report(agency_ffi, "HHS", text, agency_ffi.REPORT_BINARY)
+
+    verdict, num_rules, _, error_offset = HEADER.unpack_from(data)
+    assert (verdict, num_rules, error_offset) == (report["verdict"], len(report["rules"]), 2**64 - 1)
+
+    def string(offset, length):
+        assert data[offset + length] == 0
+        return data[offset:offset + length].decode()
+
+    for i, expected in enumerate(report["rules"]):
+        fields = RULE.unpack_from(data, HEADER.size + i * RULE.size)
+        kind, _, name_offset, name_length, field_offset, field_length, detail_offset, detail_length, _, _ = fields
+        assert ["field", "theorem"][kind] == expected["kind"]
+        assert string(name_offset, name_length) == expected["name"]
+        assert string(field_offset, field_length) == expected["field"]
+        assert string(detail_offset, detail_length) == expected.get("missing", "")